@@ -8,6 +8,7 @@ if(FAST_MODULE_NeuralNetwork)
     message("-- Neural network module with tensorflow enabled.")
     set(CMAKE_POSITION_INDEPENDENT_CODE ON)
     add_definitions(-DEIGEN_AVOID_STL_ARRAY)
+    add_definitions("-DFAST_MODULE_NEURAL_NETWORK")
     if(WIN32)
         # Some definitions needed to compile with tensorflow on windows
         # These are taken from tensorflow/contrib/cmake/CMakeLists.txt
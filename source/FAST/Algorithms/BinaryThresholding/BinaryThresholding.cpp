@@ -1,5 +1,6 @@
 #include "BinaryThresholding.hpp"
 #include "FAST/Data/Segmentation.hpp"
+#include <limits>
 
 namespace fast {
 
@@ -15,15 +16,43 @@ void BinaryThresholding::setUpperThreshold(float threshold) {
     mIsModified = true;
 }
 
+void BinaryThresholding::loadAttributes() {
+    // The defaults are the limits of float, which have the same effect as not setting the threshold
+    setLowerThreshold(getFloatAttribute("lower-threshold"));
+    setUpperThreshold(getFloatAttribute("upper-threshold"));
+}
+
 BinaryThresholding::BinaryThresholding() {
     mLowerThresholdSet = false;
     mUpperThresholdSet = false;
+    createFloatAttribute("lower-threshold", "Lower threshold", "Lower threshold", std::numeric_limits<float>::lowest());
+    createFloatAttribute("upper-threshold", "Upper threshold", "Upper threshold", std::numeric_limits<float>::max());
     createInputPort<Image>(0);
     createOutputPort<Segmentation>(0);
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/BinaryThresholding/BinaryThresholding3D.cl", "3D");
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/BinaryThresholding/BinaryThresholding2D.cl", "2D");
 }
 
+PointwiseOperator BinaryThresholding::getPointwiseOperator() {
+    if(!mLowerThresholdSet && !mUpperThresholdSet) {
+        throw Exception("BinaryThresholding need at least one threshold to be set.");
+    }
+
+    const float lower = mLowerThresholdSet ? mLowerThreshold : -std::numeric_limits<float>::infinity();
+    const float upper = mUpperThresholdSet ? mUpperThreshold : std::numeric_limits<float>::infinity();
+    const float label = mLabel;
+    PointwiseOperator op;
+    op.expression = "value >= {p0} && value <= {p1} ? {p2} : 0.0f";
+    op.function = makePointwiseFunction([lower, upper, label](float value, float operand, float minimum, float maximum) {
+        return value >= lower && value <= upper ? label : 0.0f;
+    });
+    op.parameters = {lower, upper, label};
+    op.keepsDataType = false;
+    op.outputType = TYPE_UINT8;
+    op.isSegmentation = true;
+    return op;
+}
+
 void BinaryThresholding::execute() {
     if(!mLowerThresholdSet && !mUpperThresholdSet) {
         throw Exception("BinaryThresholding need at least one threshold to be set.");
@@ -2,14 +2,17 @@
 #define BINARY_THRESHOLDING_HPP
 
 #include "FAST/Algorithms/SegmentationAlgorithm.hpp"
+#include "FAST/Algorithms/PointwiseOperatorChain/PointwiseOperator.hpp"
 
 namespace fast {
 
-class FAST_EXPORT  BinaryThresholding : public SegmentationAlgorithm {
+class FAST_EXPORT  BinaryThresholding : public SegmentationAlgorithm, public PointwiseProcessObject {
     FAST_OBJECT(BinaryThresholding)
     public:
         void setLowerThreshold(float threshold);
         void setUpperThreshold(float threshold);
+        PointwiseOperator getPointwiseOperator();
+        void loadAttributes() override;
     private:
         BinaryThresholding();
         void execute();
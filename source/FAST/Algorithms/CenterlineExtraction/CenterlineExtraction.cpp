@@ -400,8 +400,8 @@ void CenterlineExtraction::execute() {
     	neighbors2.push_back(Vector3i(a,b,c));
     }}}
 
-	std::vector<MeshVertex> vertices;
-	std::vector<MeshLine> lines;
+	std::vector<float> coordinates;
+	std::vector<uint> lines;
     std::unordered_set<int> refinedCenterline;
     std::unordered_set<int> processed;
 	// Do backtrace
@@ -478,20 +478,27 @@ void CenterlineExtraction::execute() {
 
 		if(pointsToAdd.size() > 10) { // minimum length
 			growFromPointsAdded(pointsToAdd, G, Sc, processed, size);
-			int counter = vertices.size();
-            vertices.push_back(MeshVertex(pointsToAdd[0].cast<float>().cwiseProduct(spacing)));
-            refinedCenterline.insert(linearPosition(pointsToAdd[0], size));
-			for(int i = 1; i < pointsToAdd.size(); ++i) {
+			uint counter = coordinates.size() / 3;
+			for(int i = 0; i < pointsToAdd.size(); ++i) {
                 refinedCenterline.insert(linearPosition(pointsToAdd[i], size));
-				vertices.push_back(MeshVertex(pointsToAdd[i].cast<float>().cwiseProduct(spacing)));
-				lines.push_back(MeshLine(counter, counter+1));
-				counter += 1;
+                Vector3f position = pointsToAdd[i].cast<float>().cwiseProduct(spacing);
+                coordinates.insert(coordinates.end(), {position.x(), position.y(), position.z()});
+                if(i > 0) {
+                    lines.insert(lines.end(), {counter, counter + 1});
+                    counter += 1;
+                }
 			}
 		}
 	}
 
 	Mesh::pointer output = getOutputData<Mesh>();
-    output->create(vertices, lines);
+    // Same vertex color as the MeshVertex default, lines don't need normals
+    std::vector<float> colors;
+    colors.reserve(coordinates.size());
+    const Color color = Color::Green();
+    for(int i = 0; i < coordinates.size() / 3; ++i)
+        colors.insert(colors.end(), {color.getRedValue(), color.getGreenValue(), color.getBlueValue()});
+    output->create(std::move(coordinates), std::vector<float>(), std::move(colors), std::move(lines), std::vector<uint>());
 	SceneGraph::setParentNode(output, input);
 }
 
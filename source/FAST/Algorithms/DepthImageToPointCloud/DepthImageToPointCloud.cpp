@@ -0,0 +1,243 @@
+#include "DepthImageToPointCloud.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Mesh.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace fast {
+
+DepthImageToPointCloud::DepthImageToPointCloud() {
+    createInputPort<Image>(0);
+    createInputPort<Image>(1, false);
+    createOutputPort<Mesh>(0);
+
+    mFocalLength = Vector2f::Zero();
+    mPrincipalPoint = Vector2f::Zero();
+    mDepthScale = 1.0f;
+    mMinRange = 0;
+    mMaxRange = std::numeric_limits<float>::max();
+    mVoxelSize = 0;
+    mEdgeFiltering = false;
+    mMaxDepthDifference = 10.0f;
+}
+
+void DepthImageToPointCloud::setIntrinsics(float focalLengthX, float focalLengthY, float principalPointX, float principalPointY) {
+    if(focalLengthX <= 0 || focalLengthY <= 0)
+        throw Exception("Focal length must be larger than 0 in DepthImageToPointCloud");
+    mFocalLength = Vector2f(focalLengthX, focalLengthY);
+    mPrincipalPoint = Vector2f(principalPointX, principalPointY);
+    mIsModified = true;
+}
+
+void DepthImageToPointCloud::setDepthScale(float scale) {
+    if(scale <= 0)
+        throw Exception("Depth scale must be larger than 0 in DepthImageToPointCloud");
+    mDepthScale = scale;
+    mIsModified = true;
+}
+
+void DepthImageToPointCloud::setMinRange(float range) {
+    if(range < 0)
+        throw Exception("Range has to be >= 0");
+    mMinRange = range;
+    mIsModified = true;
+}
+
+void DepthImageToPointCloud::setMaxRange(float range) {
+    if(range < 0)
+        throw Exception("Range has to be >= 0");
+    mMaxRange = range;
+    mIsModified = true;
+}
+
+void DepthImageToPointCloud::setVoxelSize(float size) {
+    if(size < 0)
+        throw Exception("Voxel size has to be >= 0");
+    mVoxelSize = size;
+    mIsModified = true;
+}
+
+void DepthImageToPointCloud::setEdgeFiltering(bool enabled, float maxDepthDifference) {
+    mEdgeFiltering = enabled;
+    mMaxDepthDifference = maxDepthDifference;
+    mIsModified = true;
+}
+
+template <class T>
+static void copyChannel(const T* input, float* output, int size, int components, float scale) {
+    #pragma omp parallel for
+    for(int i = 0; i < size; ++i)
+        output[i] = input[i*components]*scale;
+}
+
+template <class T>
+static void copyColors(const T* input, float* output, int size, int components, float scale) {
+    #pragma omp parallel for
+    for(int i = 0; i < size; ++i) {
+        for(int j = 0; j < 3; ++j) // Gray scale images are replicated to all channels
+            output[i*3 + j] = input[i*components + std::min(j, components - 1)]*scale;
+    }
+}
+
+inline bool isValidDepth(float depth) {
+    return depth > 0 && depth < std::numeric_limits<float>::infinity();
+}
+
+/**
+ * Replace the points in each voxel with their average. The points are sorted by voxel, so that the points of
+ * each voxel are consecutive.
+ */
+static void voxelGridDownsample(std::vector<float>& coordinates, std::vector<float>& colors, float voxelSize) {
+    const int nrOfPoints = coordinates.size() / 3;
+    std::vector<std::pair<uint64_t, int> > keys(nrOfPoints);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfPoints; ++i) {
+        uint64_t key = 0;
+        for(int j = 0; j < 3; ++j) {
+            // 21 bits per dimension
+            const int64_t index = (int64_t)std::floor(coordinates[i*3 + j] / voxelSize) + (1 << 20);
+            key = (key << 21) | (uint64_t)(std::max<int64_t>(0, std::min<int64_t>(index, (1 << 21) - 1)));
+        }
+        keys[i] = std::make_pair(key, i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<float> newCoordinates;
+    std::vector<float> newColors;
+    newCoordinates.reserve(coordinates.size());
+    if(!colors.empty())
+        newColors.reserve(colors.size());
+    int start = 0;
+    while(start < nrOfPoints) {
+        int end = start + 1;
+        while(end < nrOfPoints && keys[end].first == keys[start].first)
+            ++end;
+        Vector3f position = Vector3f::Zero();
+        Vector3f color = Vector3f::Zero();
+        for(int i = start; i < end; ++i) {
+            const int index = keys[i].second;
+            position += Vector3f(coordinates[index*3], coordinates[index*3 + 1], coordinates[index*3 + 2]);
+            if(!colors.empty())
+                color += Vector3f(colors[index*3], colors[index*3 + 1], colors[index*3 + 2]);
+        }
+        position /= (end - start);
+        newCoordinates.insert(newCoordinates.end(), {position.x(), position.y(), position.z()});
+        if(!colors.empty()) {
+            color /= (end - start);
+            newColors.insert(newColors.end(), {color.x(), color.y(), color.z()});
+        }
+        start = end;
+    }
+    coordinates = std::move(newCoordinates);
+    colors = std::move(newColors);
+}
+
+void DepthImageToPointCloud::execute() {
+    if(mFocalLength.x() <= 0 || mFocalLength.y() <= 0)
+        throw Exception("Camera intrinsics must be given to DepthImageToPointCloud");
+
+    Image::pointer depthImage = getInputData<Image>(0);
+    if(depthImage->getDimensions() != 2)
+        throw Exception("DepthImageToPointCloud requires a 2D depth image");
+    const int width = depthImage->getWidth();
+    const int height = depthImage->getHeight();
+    const int size = width*height;
+
+    // Convert depth to millimeters
+    std::vector<float> depth(size);
+    {
+        ImageAccess::pointer access = depthImage->getImageAccess(ACCESS_READ);
+        switch(depthImage->getDataType()) {
+            fastSwitchTypeMacro(copyChannel<FAST_TYPE>((const FAST_TYPE*)access->get(), depth.data(), size, depthImage->getNrOfComponents(), mDepthScale));
+        }
+    }
+
+    const bool hasColors = getNrOfInputConnections() > 1;
+    std::vector<float> pixelColors;
+    if(hasColors) {
+        Image::pointer colorImage = getInputData<Image>(1);
+        if(colorImage->getWidth() != width || colorImage->getHeight() != height)
+            throw Exception("Color image given to DepthImageToPointCloud must have the same size as the depth image");
+        float scale = 1.0f;
+        if(colorImage->getDataType() == TYPE_UINT8) {
+            scale = 1.0f / 255.0f;
+        } else if(colorImage->getDataType() == TYPE_UINT16 || colorImage->getDataType() == TYPE_UNORM_INT16) {
+            scale = 1.0f / 65535.0f;
+        }
+        pixelColors.resize(size*3);
+        ImageAccess::pointer access = colorImage->getImageAccess(ACCESS_READ);
+        switch(colorImage->getDataType()) {
+            fastSwitchTypeMacro(copyColors<FAST_TYPE>((const FAST_TYPE*)access->get(), pixelColors.data(), size, colorImage->getNrOfComponents(), scale));
+        }
+    }
+
+    // Find the points to keep
+    std::vector<uchar> keep(size);
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y) {
+        for(int x = 0; x < width; ++x) {
+            const float value = depth[x + y*width];
+            bool valid = isValidDepth(value) && value >= mMinRange && value <= mMaxRange;
+            if(valid && mEdgeFiltering) {
+                for(int a = std::max(y - 1, 0); a <= std::min(y + 1, height - 1) && valid; ++a) {
+                    for(int b = std::max(x - 1, 0); b <= std::min(x + 1, width - 1); ++b) {
+                        const float neighbor = depth[b + a*width];
+                        if(!isValidDepth(neighbor) || std::fabs(value - neighbor) > mMaxDepthDifference) {
+                            valid = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            keep[x + y*width] = valid ? 1 : 0;
+        }
+    }
+
+    // Count points per row, to find where each row starts in the output arrays
+    std::vector<int> rowOffsets(height + 1, 0);
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y) {
+        int count = 0;
+        for(int x = 0; x < width; ++x)
+            count += keep[x + y*width];
+        rowOffsets[y + 1] = count;
+    }
+    for(int y = 0; y < height; ++y)
+        rowOffsets[y + 1] += rowOffsets[y];
+    const int nrOfPoints = rowOffsets[height];
+
+    // Back-project, the per column factors are the same for all rows
+    std::vector<float> columnFactors(width);
+    for(int x = 0; x < width; ++x)
+        columnFactors[x] = (x - mPrincipalPoint.x()) / mFocalLength.x();
+    std::vector<float> coordinates(nrOfPoints*3);
+    std::vector<float> colors(hasColors ? nrOfPoints*3 : 0);
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y) {
+        const float rowFactor = (y - mPrincipalPoint.y()) / mFocalLength.y();
+        int index = rowOffsets[y];
+        for(int x = 0; x < width; ++x) {
+            const int i = x + y*width;
+            if(keep[i] == 0)
+                continue;
+            coordinates[index*3] = columnFactors[x]*depth[i];
+            coordinates[index*3 + 1] = rowFactor*depth[i];
+            coordinates[index*3 + 2] = depth[i];
+            if(hasColors) {
+                colors[index*3] = pixelColors[i*3];
+                colors[index*3 + 1] = pixelColors[i*3 + 1];
+                colors[index*3 + 2] = pixelColors[i*3 + 2];
+            }
+            ++index;
+        }
+    }
+
+    if(mVoxelSize > 0)
+        voxelGridDownsample(coordinates, colors, mVoxelSize);
+
+    Mesh::pointer output = getOutputData<Mesh>(0);
+    output->create(std::move(coordinates), std::vector<float>(), std::move(colors), std::vector<uint>(), std::vector<uint>());
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef DEPTH_IMAGE_TO_POINT_CLOUD_HPP
+#define DEPTH_IMAGE_TO_POINT_CLOUD_HPP
+
+#include "FAST/ProcessObject.hpp"
+
+namespace fast {
+
+/**
+ * Converts a depth image to a point cloud by back-projecting each pixel with pinhole camera intrinsics:
+ * x = (column - cx)*depth/fx, y = (row - cy)*depth/fy, z = depth.
+ *
+ * Pixels with zero, negative or non-finite depth are skipped.
+ *
+ * Input port 0: Depth image (one channel, in millimeters after multiplying with the depth scale)
+ * Input port 1: Optional color image registered to the depth image (uint8 or float RGB(A))
+ * Output port 0: Point cloud as a Mesh with coordinates in millimeters, and colors if a color image is given
+ */
+class FAST_EXPORT  DepthImageToPointCloud : public ProcessObject {
+    FAST_OBJECT(DepthImageToPointCloud)
+    public:
+        /**
+         * Set the camera intrinsics of the depth image, in pixels. Must be set before execution.
+         * @param focalLengthX
+         * @param focalLengthY
+         * @param principalPointX
+         * @param principalPointY
+         */
+        void setIntrinsics(float focalLengthX, float focalLengthY, float principalPointX, float principalPointY);
+        /**
+         * Set the factor to multiply depth values with to get millimeters. Default is 1.
+         * @param scale
+         */
+        void setDepthScale(float scale);
+        /**
+         * Set minimum range in millimeters. All points below this range will be dropped.
+         * @param range
+         */
+        void setMinRange(float range);
+        /**
+         * Set maximum range in millimeters. All points above this range will be dropped.
+         * @param range
+         */
+        void setMaxRange(float range);
+        /**
+         * Downsample the point cloud by replacing all points inside each voxel of a regular grid with their average.
+         * Set to 0 to disable, which is the default.
+         * @param size voxel size in millimeters
+         */
+        void setVoxelSize(float size);
+        /**
+         * Drop points which have an invalid neighbor pixel, or a neighbor pixel with a depth difference larger
+         * than maxDepthDifference. This removes most of the spurious points along object edges.
+         * @param enabled
+         * @param maxDepthDifference in millimeters
+         */
+        void setEdgeFiltering(bool enabled, float maxDepthDifference = 10.0f);
+    private:
+        DepthImageToPointCloud();
+        void execute();
+
+        Vector2f mFocalLength;
+        Vector2f mPrincipalPoint;
+        float mDepthScale;
+        float mMinRange;
+        float mMaxRange;
+        float mVoxelSize;
+        bool mEdgeFiltering;
+        float mMaxDepthDifference;
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "FAST/Testing.hpp"
+#include "DepthImageToPointCloud.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Mesh.hpp"
+
+using namespace fast;
+
+static Mesh::pointer convert(DepthImageToPointCloud::pointer converter) {
+    DataPort::pointer port = converter->getOutputPort();
+    converter->update(0);
+    return port->getNextFrame();
+}
+
+TEST_CASE("DepthImageToPointCloud back-projects valid pixels", "[fast][DepthImageToPointCloud]") {
+    // 3x2 depth image in millimeters, with one invalid pixel
+    const float depth[6] = {
+            100, 200, 0,
+            400, 500, 600
+    };
+    Image::pointer depthImage = Image::New();
+    depthImage->create(3, 2, TYPE_FLOAT, 1, depth);
+
+    DepthImageToPointCloud::pointer converter = DepthImageToPointCloud::New();
+    converter->setInputData(depthImage);
+    CHECK_THROWS(converter->update(0));
+
+    converter->setIntrinsics(2, 4, 1, 0.5);
+    Mesh::pointer cloud = convert(converter);
+    REQUIRE(cloud->getNrOfVertices() == 5);
+    MeshAccess::pointer access = cloud->getMeshAccess(ACCESS_READ);
+    const std::vector<float>& coordinates = access->getCoordinateArray();
+    CHECK(access->getColorArray().empty());
+    // First pixel: x = (0 - 1)/2*100, y = (0 - 0.5)/4*100
+    CHECK(coordinates[0] == Approx(-50));
+    CHECK(coordinates[1] == Approx(-12.5));
+    CHECK(coordinates[2] == Approx(100));
+    // Last pixel: x = (2 - 1)/2*600, y = (1 - 0.5)/4*600
+    CHECK(coordinates[12] == Approx(300));
+    CHECK(coordinates[13] == Approx(75));
+    CHECK(coordinates[14] == Approx(600));
+}
+
+TEST_CASE("DepthImageToPointCloud with colors, range and voxel grid", "[fast][DepthImageToPointCloud]") {
+    const ushort depth[4] = {10, 11, 12, 90};
+    Image::pointer depthImage = Image::New();
+    depthImage->create(2, 2, TYPE_UINT16, 1, depth);
+    const uchar color[12] = {
+            255, 0, 0,   255, 0, 0,
+            0, 0, 255,   0, 255, 0
+    };
+    Image::pointer colorImage = Image::New();
+    colorImage->create(2, 2, TYPE_UINT8, 3, color);
+
+    DepthImageToPointCloud::pointer converter = DepthImageToPointCloud::New();
+    converter->setInputData(0, depthImage);
+    converter->setInputData(1, colorImage);
+    converter->setIntrinsics(1000, 1000, 0, 0);
+    converter->setDepthScale(10); // centimeters to millimeters
+    converter->setMaxRange(500);
+    Mesh::pointer cloud = convert(converter);
+    CHECK(cloud->getNrOfVertices() == 3);
+
+    // The three remaining points are within one 5 cm voxel
+    converter->setVoxelSize(50);
+    cloud = convert(converter);
+    REQUIRE(cloud->getNrOfVertices() == 1);
+    MeshAccess::pointer access = cloud->getMeshAccess(ACCESS_READ);
+    CHECK(access->getCoordinateArray()[2] == Approx(110));
+    CHECK(access->getColorArray()[0] == Approx(2.0f/3.0f));
+    CHECK(access->getColorArray()[1] == Approx(0));
+    CHECK(access->getColorArray()[2] == Approx(1.0f/3.0f));
+}
+
+TEST_CASE("DepthImageToPointCloud edge filtering", "[fast][DepthImageToPointCloud]") {
+    // Left half close, right half far away
+    float depth[4*4];
+    for(int i = 0; i < 16; ++i)
+        depth[i] = i % 4 < 2 ? 100 : 1000;
+    Image::pointer depthImage = Image::New();
+    depthImage->create(4, 4, TYPE_FLOAT, 1, depth);
+
+    DepthImageToPointCloud::pointer converter = DepthImageToPointCloud::New();
+    converter->setInputData(depthImage);
+    converter->setIntrinsics(1, 1, 0, 0);
+    converter->setEdgeFiltering(true);
+    Mesh::pointer cloud = convert(converter);
+    // Only the first and last column have no neighbor on the other side of the edge
+    CHECK(cloud->getNrOfVertices() == 8);
+}
@@ -50,7 +50,7 @@ GaussianSmoothingFilter::~GaussianSmoothingFilter() {
 
 // TODO have to set mRecreateMask to true if input change dimension
 void GaussianSmoothingFilter::createMask(Image::pointer input, uchar maskSize, bool useSeperableFilter) {
-    if(!mRecreateMask)
+    if(!mRecreateMask && getMainDevice() == mDeviceMaskCreatedFor)
         return;
 
     unsigned char halfSize = (maskSize-1)/2;
@@ -115,12 +115,14 @@ void GaussianSmoothingFilter::createMask(Image::pointer input, uchar maskSize, b
     }
 
     mRecreateMask = false;
+    mDeviceMaskCreatedFor = getMainDevice();
 }
 
 void GaussianSmoothingFilter::recompileOpenCLCode(Image::pointer input) {
     // Check if there is a need to recompile OpenCL code
     if(input->getDimensions() == mDimensionCLCodeCompiledFor &&
-            input->getDataType() == mTypeCLCodeCompiledFor)
+            input->getDataType() == mTypeCLCodeCompiledFor &&
+            getMainDevice() == mDeviceCLCodeCompiledFor)
         return;
 
     OpenCLDevice::pointer device = getMainDevice();
@@ -137,6 +139,7 @@ void GaussianSmoothingFilter::recompileOpenCLCode(Image::pointer input) {
     mKernel = cl::Kernel(program, "gaussianSmoothing");
     mDimensionCLCodeCompiledFor = input->getDimensions();
     mTypeCLCodeCompiledFor = input->getDataType();
+    mDeviceCLCodeCompiledFor = getMainDevice();
 }
 
 template <class T>
@@ -27,6 +27,9 @@ class FAST_EXPORT  GaussianSmoothingFilter : public ProcessObject {
         cl::Buffer mCLMask;
         float * mMask;
         bool mRecreateMask;
+        // The mask and kernel have to be created again if the main device is changed
+        ExecutionDevice::pointer mDeviceMaskCreatedFor;
+        ExecutionDevice::pointer mDeviceCLCodeCompiledFor;
 
         cl::Kernel mKernel;
         unsigned char mDimensionCLCodeCompiledFor;
@@ -32,6 +32,53 @@ __kernel void GVF2DIteration(__read_only image2d_t init_vector_field, __read_onl
     write_imagef(write_vector_field, writePos, (float4)(f.x,f.y,0,0));
 }
 
+/**
+ * Sum the values of all work-items in a work-group and store it in partialSums.
+ * The local size must be a power of two.
+ */
+void storeWorkGroupSum(float sum, __local float* scratch, __global float* partialSums) {
+    const int id = get_local_id(0);
+    scratch[id] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for(int offset = get_local_size(0)/2; offset > 0; offset /= 2) {
+        if(id < offset)
+            scratch[id] += scratch[id + offset];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if(id == 0)
+        partialSums[get_group_id(0)] = scratch[0];
+}
+
+/**
+ * Sum of the absolute residual of each vector component over all interior pixels,
+ * computed as one partial sum per work-group
+ */
+__kernel void GVF2DResidual(
+        __read_only image2d_t init_vector_field,
+        __read_only image2d_t vector_field,
+        __private float mu,
+        __global float* partialSums,
+        __local float* scratch
+    ) {
+    const int width = get_image_width(init_vector_field);
+    const int height = get_image_height(init_vector_field);
+    const int interiorWidth = width - 2;
+    const int total = interiorWidth*(height - 2);
+    float sum = 0.0f;
+    for(int i = get_global_id(0); i < total; i += get_global_size(0)) {
+        const int2 pos = {i % interiorWidth + 1, i / interiorWidth + 1};
+        const float2 init_vector = read_imagef(init_vector_field, sampler, pos).xy;
+        const float2 f = read_imagef(vector_field, sampler, pos).xy;
+        const float2 laplacian = -4*f +
+            read_imagef(vector_field, sampler, pos + (int2)(1,0)).xy +
+            read_imagef(vector_field, sampler, pos - (int2)(1,0)).xy +
+            read_imagef(vector_field, sampler, pos + (int2)(0,1)).xy +
+            read_imagef(vector_field, sampler, pos - (int2)(0,1)).xy;
+        const float2 residual = mu*laplacian - (f - init_vector)*(init_vector.x*init_vector.x + init_vector.y*init_vector.y);
+        sum += fabs(residual.x) + fabs(residual.y);
+    }
+    storeWorkGroupSum(sum, scratch, partialSums);
+}
 
 // If device supports writing to 3D textures
 #ifdef fast_3d_image_writes
@@ -81,6 +128,35 @@ __kernel void GVF3DIteration(
     write_imagef(write_vector_field, writePos, f.xyzz);
 }
 
+__kernel void GVF3DResidual(
+        __read_only image3d_t init_vector_field,
+        __read_only image3d_t vector_field,
+        __private float mu,
+        __global float* partialSums,
+        __local float* scratch
+    ) {
+    const int interiorWidth = get_image_width(init_vector_field) - 2;
+    const int interiorHeight = get_image_height(init_vector_field) - 2;
+    const int total = interiorWidth*interiorHeight*(get_image_depth(init_vector_field) - 2);
+    float sum = 0.0f;
+    for(int i = get_global_id(0); i < total; i += get_global_size(0)) {
+        const int4 pos = {i % interiorWidth + 1, (i / interiorWidth) % interiorHeight + 1, i / (interiorWidth*interiorHeight) + 1, 0};
+        const float3 init_vector = read_imagef(init_vector_field, sampler, pos).xyz;
+        const float3 f = read_imagef(vector_field, sampler, pos).xyz;
+        const float3 laplacian = -6*f +
+            read_imagef(vector_field, sampler, pos + (int4)(1,0,0,0)).xyz +
+            read_imagef(vector_field, sampler, pos - (int4)(1,0,0,0)).xyz +
+            read_imagef(vector_field, sampler, pos + (int4)(0,1,0,0)).xyz +
+            read_imagef(vector_field, sampler, pos - (int4)(0,1,0,0)).xyz +
+            read_imagef(vector_field, sampler, pos + (int4)(0,0,1,0)).xyz +
+            read_imagef(vector_field, sampler, pos - (int4)(0,0,1,0)).xyz;
+        const float3 residual = mu*laplacian - (f - init_vector)*
+            (init_vector.x*init_vector.x + init_vector.y*init_vector.y + init_vector.z*init_vector.z);
+        sum += fabs(residual.x) + fabs(residual.y) + fabs(residual.z);
+    }
+    storeWorkGroupSum(sum, scratch, partialSums);
+}
+
 #else
 
 #define LPOS(pos) pos.x+pos.y*get_global_size(0)+pos.z*get_global_size(0)*get_global_size(1)
@@ -149,6 +225,38 @@ __kernel void GVF3DIteration(
 }
 
 
+__kernel void GVF3DResidual(
+        __read_only image3d_t init_vector_field,
+        __global VECTOR_FIELD_TYPE const * restrict vector_field,
+        __private float mu,
+        __global float* partialSums,
+        __local float* scratch
+    ) {
+    const int width = get_image_width(init_vector_field);
+    const int height = get_image_height(init_vector_field);
+    const int interiorWidth = width - 2;
+    const int interiorHeight = height - 2;
+    const int total = interiorWidth*interiorHeight*(get_image_depth(init_vector_field) - 2);
+    float sum = 0.0f;
+    for(int i = get_global_id(0); i < total; i += get_global_size(0)) {
+        const int4 pos = {i % interiorWidth + 1, (i / interiorWidth) % interiorHeight + 1, i / (interiorWidth*interiorHeight) + 1, 0};
+        const int offset = pos.x + pos.y*width + pos.z*width*height;
+        const float3 init_vector = read_imagef(init_vector_field, sampler, pos).xyz;
+        const float3 v = SNORM16_TO_FLOAT_3(vload3(offset, vector_field));
+        const float3 laplacian = -6*v +
+            SNORM16_TO_FLOAT_3(vload3(offset+1, vector_field)) +
+            SNORM16_TO_FLOAT_3(vload3(offset-1, vector_field)) +
+            SNORM16_TO_FLOAT_3(vload3(offset+width, vector_field)) +
+            SNORM16_TO_FLOAT_3(vload3(offset-width, vector_field)) +
+            SNORM16_TO_FLOAT_3(vload3(offset+width*height, vector_field)) +
+            SNORM16_TO_FLOAT_3(vload3(offset-width*height, vector_field));
+        const float3 residual = mu*laplacian - (v - init_vector)*
+            (init_vector.x*init_vector.x + init_vector.y*init_vector.y + init_vector.z*init_vector.z);
+        sum += fabs(residual.x) + fabs(residual.y) + fabs(residual.z);
+    }
+    storeWorkGroupSum(sum, scratch, partialSums);
+}
+
 __kernel void GVF3DInit(
         __read_only image3d_t vectorFieldImage,
         __global VECTOR_FIELD_TYPE * vectorField
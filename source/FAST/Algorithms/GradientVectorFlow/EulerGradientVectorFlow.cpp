@@ -38,6 +38,10 @@ inline uint getPeakMemoryUsage(Image::pointer input, bool use16bit, bool writing
     return result;
 }
 
+// Work-group size and nr of work-groups used by the residual reduction kernels
+static const uint residualWorkGroupSize = 64;
+static const uint residualWorkGroups = 64;
+
 EulerGradientVectorFlow::EulerGradientVectorFlow() {
     createInputPort<Image>(0);
     createOutputPort<Image>(0);
@@ -45,6 +49,9 @@ EulerGradientVectorFlow::EulerGradientVectorFlow() {
     mIterations = 0;
     mMu = 0.05f;
     mUse16bitFormat = true;
+    mConvergenceTolerance = 0;
+    mConvergenceCheckInterval = 10;
+    mIterationsPerformed = 0;
 }
 
 void EulerGradientVectorFlow::setIterations(uint iterations) {
@@ -71,6 +78,57 @@ void EulerGradientVectorFlow::set32bitStorageFormat() {
     mUse16bitFormat = false;
 }
 
+void EulerGradientVectorFlow::setConvergenceTolerance(float tolerance) {
+    if(tolerance < 0)
+        throw Exception("Convergence tolerance can't be negative in EulerGradientVectorFlow.");
+    mConvergenceTolerance = tolerance;
+    mIsModified = true;
+}
+
+void EulerGradientVectorFlow::setConvergenceCheckInterval(uint interval) {
+    if(interval == 0)
+        throw Exception("Convergence check interval can't be zero in EulerGradientVectorFlow.");
+    mConvergenceCheckInterval = interval;
+    mIsModified = true;
+}
+
+uint EulerGradientVectorFlow::getIterationsPerformed() const {
+    return mIterationsPerformed;
+}
+
+cl::Kernel EulerGradientVectorFlow::createResidualKernel(cl::Program program, std::string kernelName, const cl::Memory& initVectorField, const cl::Buffer& partialSums) {
+    cl::Kernel residualKernel(program, kernelName.c_str());
+    residualKernel.setArg(0, initVectorField);
+    residualKernel.setArg(2, mMu);
+    residualKernel.setArg(3, partialSums);
+    residualKernel.setArg(4, cl::Local(residualWorkGroupSize*sizeof(float)));
+    return residualKernel;
+}
+
+bool EulerGradientVectorFlow::hasConverged(cl::Kernel& residualKernel, const cl::Buffer& partialSums, uint iteration, uint nrOfResiduals) {
+    if(mConvergenceTolerance <= 0 || (iteration + 1) % mConvergenceCheckInterval != 0)
+        return false;
+
+    // Each work-group writes a partial sum, the final sum is done on the host
+    OpenCLDevice::pointer device = getMainDevice();
+    cl::CommandQueue queue = device->getCommandQueue();
+    queue.enqueueNDRangeKernel(
+            residualKernel,
+            cl::NullRange,
+            cl::NDRange(residualWorkGroupSize*residualWorkGroups),
+            cl::NDRange(residualWorkGroupSize)
+    );
+    std::vector<float> partialSumsHost(residualWorkGroups);
+    queue.enqueueReadBuffer(partialSums, CL_TRUE, 0, residualWorkGroups*sizeof(float), partialSumsHost.data());
+    double sum = 0;
+    for(float partialSum : partialSumsHost)
+        sum += partialSum;
+    const float residual = nrOfResiduals > 0 ? sum / nrOfResiduals : 0;
+    reportInfo() << "Euler GVF mean residual after " << iteration + 1 << " iterations: " << residual << reportEnd();
+
+    return residual < mConvergenceTolerance;
+}
+
 void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer output, uint iterations) {
     OpenCLDevice::pointer device = getMainDevice();
     cl::Program program = getOpenCLProgram(device);
@@ -143,6 +201,10 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
     iterationKernel.setArg(0, *inputVectorField);
     iterationKernel.setArg(3, mMu);
 
+    cl::Buffer partialSums(context, CL_MEM_WRITE_ONLY, residualWorkGroups*sizeof(float));
+    cl::Kernel residualKernel = createResidualKernel(program, "GVF2DResidual", *inputVectorField, partialSums);
+    const uint nrOfResiduals = (width - 2)*(height - 2)*2;
+
     for(int i = 0; i < iterations; ++i) {
         if(i % 2 == 0) {
             iterationKernel.setArg(1, vectorField);
@@ -157,7 +219,13 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
             cl::NDRange(width, height),
             cl::NullRange
         );
+        mIterationsPerformed = i + 1;
+        residualKernel.setArg(1, i % 2 == 0 ? vectorField2 : vectorField);
+        if(hasConverged(residualKernel, partialSums, i, nrOfResiduals))
+            break;
     }
+    // The last iteration wrote to the second buffer if an odd nr of iterations was performed
+    cl::Image2D& result = mIterationsPerformed % 2 == 1 ? vectorField2 : vectorField;
 
 
     // Copy result to output
@@ -166,7 +234,7 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16) {
         // Have to convert type back to float
         cl::Kernel resultKernel(program, "GVF2DCopy");
-        resultKernel.setArg(0, vectorField);
+        resultKernel.setArg(0, result);
         resultKernel.setArg(1, *outputCLImage);
         queue.enqueueNDRangeKernel(
             resultKernel,
@@ -176,7 +244,7 @@ void EulerGradientVectorFlow::execute2DGVF(Image::pointer input, Image::pointer
         );
     } else {
         queue.enqueueCopyImage(
-                vectorField,
+                result,
                 *outputCLImage,
                 createOrigoRegion(),
                 createOrigoRegion(),
@@ -245,6 +313,10 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
     iterationKernel.setArg(0, *inputVectorField);
     iterationKernel.setArg(3, mMu);
 
+    cl::Buffer partialSums(context, CL_MEM_WRITE_ONLY, residualWorkGroups*sizeof(float));
+    cl::Kernel residualKernel = createResidualKernel(program, "GVF3DResidual", *inputVectorField, partialSums);
+    const uint nrOfResiduals = (width - 2)*(height - 2)*(depth - 2)*3;
+
     for(int i = 0; i < iterations; ++i) {
         if(i % 2 == 0) {
             iterationKernel.setArg(1, vectorField);
@@ -259,14 +331,19 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
             cl::NDRange(width, height, depth),
             cl::NullRange
         );
+        mIterationsPerformed = i + 1;
+        residualKernel.setArg(1, i % 2 == 0 ? vectorField2 : vectorField);
+        if(hasConverged(residualKernel, partialSums, i, nrOfResiduals))
+            break;
     }
+    cl::Image3D& result = mIterationsPerformed % 2 == 1 ? vectorField2 : vectorField;
 
     // Copy result to output
     OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
     cl::Image3D* outputCLImage = outputAccess->get3DImage();
     if(storageFormat.image_channel_data_type == CL_SNORM_INT16) {
         cl::Kernel resultKernel(program, "GVF3DCopy");
-        resultKernel.setArg(0, vectorField);
+        resultKernel.setArg(0, result);
         resultKernel.setArg(1, *outputCLImage);
         queue.enqueueNDRangeKernel(
             resultKernel,
@@ -276,7 +353,7 @@ void EulerGradientVectorFlow::execute3DGVF(Image::pointer input, Image::pointer
         );
     } else {
         queue.enqueueCopyImage(
-                vectorField,
+                result,
                 *outputCLImage,
                 createOrigoRegion(),
                 createOrigoRegion(),
@@ -351,6 +428,10 @@ void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image:
 		iterationKernel.setArg(0, *inputVectorField);
 		iterationKernel.setArg(3, mMu);
 
+		cl::Buffer partialSums(context, CL_MEM_WRITE_ONLY, residualWorkGroups*sizeof(float));
+		cl::Kernel residualKernel = createResidualKernel(program, "GVF3DResidual", *inputVectorField, partialSums);
+		const uint nrOfResiduals = (width - 2)*(height - 2)*(depth - 2)*3;
+
 		for (int i = 0; i < iterations; i++) {
 			if (i % 2 == 0) {
 				iterationKernel.setArg(1, vectorFieldBuffer);
@@ -366,7 +447,14 @@ void EulerGradientVectorFlow::execute3DGVFNo3DWrite(Image::pointer input, Image:
 				cl::NDRange(width, height, depth),
 				cl::NullRange
 				);
+			mIterationsPerformed = i + 1;
+			residualKernel.setArg(1, i % 2 == 0 ? vectorFieldBuffer1 : vectorFieldBuffer);
+			if (hasConverged(residualKernel, partialSums, i, nrOfResiduals))
+				break;
 		}
+		// Make sure the final result ends up in vectorFieldBuffer
+		if (mIterationsPerformed % 2 == 1)
+			queue.enqueueCopyBuffer(vectorFieldBuffer1, vectorFieldBuffer, 0, 0, 3*vectorFieldSize*totalSize);
 	}
 
     cl::Buffer finalVectorFieldBuffer(
@@ -418,7 +506,7 @@ void EulerGradientVectorFlow::execute() {
     output->create(input->getSize(), TYPE_FLOAT, input->getNrOfComponents());
     output->setSpacing(input->getSpacing());
     SceneGraph::setParentNode(output, input);
-
+    mIterationsPerformed = 0;
 
     if(input->getDimensions() == 2) {
         execute2DGVF(input, output, iterations);
@@ -23,16 +23,35 @@ class FAST_EXPORT  EulerGradientVectorFlow : public ProcessObject {
          * Use 32 bit format internally instead of 16 bit.
          */
         void set32bitStorageFormat();
+        /**
+         * Stop iterating when the mean absolute residual of the GVF equation
+         * drops below this tolerance. The number of iterations then acts as an upper limit.
+         * Zero (default) disables the convergence check.
+         */
+        void setConvergenceTolerance(float tolerance);
+        /**
+         * Number of iterations between each convergence check. Default is 10.
+         */
+        void setConvergenceCheckInterval(uint interval);
+        /**
+         * @return number of iterations performed in the last execute
+         */
+        uint getIterationsPerformed() const;
     private:
         EulerGradientVectorFlow();
         void execute();
         void execute2DGVF(SharedPointer<Image> input, SharedPointer<Image> output, uint iterations);
         void execute3DGVF(SharedPointer<Image> input, SharedPointer<Image> output, uint iterations);
         void execute3DGVFNo3DWrite(SharedPointer<Image> input, SharedPointer<Image> output, uint iterations);
+        cl::Kernel createResidualKernel(cl::Program program, std::string kernelName, const cl::Memory& initVectorField, const cl::Buffer& partialSums);
+        bool hasConverged(cl::Kernel& residualKernel, const cl::Buffer& partialSums, uint iteration, uint nrOfResiduals);
 
         float mMu;
         uint mIterations;
         bool mUse16bitFormat;
+        float mConvergenceTolerance;
+        uint mConvergenceCheckInterval;
+        uint mIterationsPerformed;
 };
 
 } // end namespace fast
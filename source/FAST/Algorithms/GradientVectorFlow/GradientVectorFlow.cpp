@@ -0,0 +1,143 @@
+#include "GradientVectorFlow.hpp"
+#include "EulerGradientVectorFlow.hpp"
+#include "MultigridGradientVectorFlow.hpp"
+#include "FAST/Data/Image.hpp"
+
+namespace fast {
+
+GradientVectorFlow::GradientVectorFlow() {
+    createInputPort<Image>(0);
+    createOutputPort<Image>(0);
+    mSolver = SOLVER_AUTOMATIC;
+    mSelectedSolver = SOLVER_AUTOMATIC;
+    mMu = 0.1f;
+    mIterations = 0;
+    mConvergenceTolerance = 0;
+    mIterationsPerformed = 0;
+    mUse16bitFormat = true;
+}
+
+void GradientVectorFlow::setSolver(Solver solver) {
+    mSolver = solver;
+    mIsModified = true;
+}
+
+GradientVectorFlow::Solver GradientVectorFlow::getSelectedSolver() const {
+    return mSelectedSolver;
+}
+
+void GradientVectorFlow::setIterations(uint iterations) {
+    mIterations = iterations;
+    mIsModified = true;
+}
+
+void GradientVectorFlow::setMuConstant(float mu) {
+    if(mu > 0.2 || mu < 0)
+        throw Exception("The constant mu must be larger than 0 and smaller than 0.2 in GradientVectorFlow.");
+    mMu = mu;
+    mIsModified = true;
+}
+
+float GradientVectorFlow::getMuConstant() const {
+    return mMu;
+}
+
+uint GradientVectorFlow::getIterationsPerformed() const {
+    return mIterationsPerformed;
+}
+
+void GradientVectorFlow::setConvergenceTolerance(float tolerance) {
+    if(tolerance < 0)
+        throw Exception("Convergence tolerance can't be negative in GradientVectorFlow.");
+    mConvergenceTolerance = tolerance;
+    mIsModified = true;
+}
+
+void GradientVectorFlow::set16bitStorageFormat() {
+    mUse16bitFormat = true;
+    mIsModified = true;
+}
+
+void GradientVectorFlow::set32bitStorageFormat() {
+    mUse16bitFormat = false;
+    mIsModified = true;
+}
+
+GradientVectorFlow::Solver GradientVectorFlow::selectSolver(Image::pointer input) {
+    // The multigrid solver only supports 3D
+    if(input->getDimensions() == 2)
+        return SOLVER_EULER;
+
+    // Small volumes give too few grid levels for the multigrid solver to pay off
+    if(input->getSize().minCoeff() < 32)
+        return SOLVER_EULER;
+
+    // The multigrid solver stores every component, residual and smoothing buffer as single channel 3D images
+    OpenCLDevice::pointer device = getMainDevice();
+    const cl_channel_type channelType = mUse16bitFormat ? CL_SNORM_INT16 : CL_FLOAT;
+    if(!device->isImageFormatSupported(CL_R, channelType, CL_MEM_OBJECT_IMAGE3D))
+        return SOLVER_EULER;
+
+    // Roughly ten full size single channel volumes are alive at the same time, in addition to the
+    // input and output vector fields. The coarser grid levels add about one seventh on top of this.
+    const unsigned long long voxels = (unsigned long long)input->getWidth()*input->getHeight()*input->getDepth();
+    const unsigned long long elementSize = mUse16bitFormat ? sizeof(short) : sizeof(float);
+    const unsigned long long requiredMemory = voxels*elementSize*10*8/7 + voxels*4*sizeof(float)*2;
+    const unsigned long long deviceMemory = device->getDevice().getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+    if(requiredMemory > deviceMemory) {
+        reportInfo() << "Not enough device memory for multigrid GVF, using Euler GVF instead" << reportEnd();
+        return SOLVER_EULER;
+    }
+
+    return SOLVER_MULTIGRID;
+}
+
+void GradientVectorFlow::execute() {
+    Image::pointer input = getInputData<Image>();
+
+    mSelectedSolver = mSolver;
+    if(mSelectedSolver == SOLVER_AUTOMATIC)
+        mSelectedSolver = selectSolver(input);
+
+    ProcessObject::pointer solver;
+    MultigridGradientVectorFlow::pointer multigrid;
+    EulerGradientVectorFlow::pointer euler;
+    if(mSelectedSolver == SOLVER_MULTIGRID) {
+        if(input->getDimensions() == 2)
+            throw Exception("The multigrid GVF only supports 3D");
+        reportInfo() << "Using multigrid GVF" << reportEnd();
+        multigrid = MultigridGradientVectorFlow::New();
+        multigrid->setMuConstant(mMu);
+        if(mIterations > 0)
+            multigrid->setIterations(mIterations);
+        multigrid->setConvergenceTolerance(mConvergenceTolerance);
+        if(mUse16bitFormat) {
+            multigrid->set16bitStorageFormat();
+        } else {
+            multigrid->set32bitStorageFormat();
+        }
+        solver = multigrid;
+    } else {
+        reportInfo() << "Using Euler GVF" << reportEnd();
+        euler = EulerGradientVectorFlow::New();
+        euler->setMuConstant(mMu);
+        if(mIterations > 0)
+            euler->setIterations(mIterations);
+        euler->setConvergenceTolerance(mConvergenceTolerance);
+        if(mUse16bitFormat) {
+            euler->set16bitStorageFormat();
+        } else {
+            euler->set32bitStorageFormat();
+        }
+        solver = euler;
+    }
+
+    solver->setMainDevice(getMainDevice());
+    solver->setInputData(input);
+    DataPort::pointer port = solver->getOutputPort();
+    solver->update(0);
+    mIterationsPerformed = multigrid.isValid() ? multigrid->getIterationsPerformed() : euler->getIterationsPerformed();
+    addOutputData(0, port->getNextFrame());
+}
+
+} // end namespace fast
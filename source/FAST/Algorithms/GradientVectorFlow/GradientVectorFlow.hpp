@@ -0,0 +1,72 @@
+#ifndef GRADIENT_VECTOR_FLOW_HPP_
+#define GRADIENT_VECTOR_FLOW_HPP_
+
+#include "FAST/ProcessObject.hpp"
+
+namespace fast {
+
+class Image;
+
+/**
+ * Gradient vector flow (GVF) which selects between the Euler and the multigrid solver.
+ *
+ * With automatic solver selection (default), the multigrid solver is used for 3D volumes
+ * when the device supports the needed single channel 3D image format and has enough memory.
+ * Otherwise the Euler solver is used. Both solvers can stop early when a convergence tolerance is set.
+ */
+class FAST_EXPORT  GradientVectorFlow : public ProcessObject {
+    FAST_OBJECT(GradientVectorFlow)
+    public:
+        enum Solver {
+            SOLVER_AUTOMATIC,
+            SOLVER_EULER,
+            SOLVER_MULTIGRID
+        };
+        void setSolver(Solver solver);
+        /**
+         * @return the solver used in the last execute
+         */
+        Solver getSelectedSolver() const;
+        /**
+         * Maximum number of iterations (Euler) or full multigrid cycles per component (multigrid).
+         * Zero (default) uses the default of the selected solver.
+         */
+        void setIterations(uint iterations);
+        void setMuConstant(float mu);
+        float getMuConstant() const;
+        /**
+         * Stop when the mean absolute residual drops below this tolerance.
+         * Zero (default) disables the convergence check.
+         */
+        void setConvergenceTolerance(float tolerance);
+        /**
+         * @return nr of iterations (Euler), or full multigrid cycles of all components (multigrid), in the last execute
+         */
+        uint getIterationsPerformed() const;
+        /**
+         * Use 16 bit format internally to reduce memory usage and
+         * increase performance.
+         * This will slightly reduce accuracy/convergence.
+         */
+        void set16bitStorageFormat();
+        /**
+         * Use 32 bit format internally instead of 16 bit.
+         */
+        void set32bitStorageFormat();
+    private:
+        GradientVectorFlow();
+        void execute();
+        Solver selectSolver(SharedPointer<Image> input);
+
+        Solver mSolver;
+        Solver mSelectedSolver;
+        float mMu;
+        uint mIterations;
+        float mConvergenceTolerance;
+        uint mIterationsPerformed;
+        bool mUse16bitFormat;
+};
+
+} // end namespace fast
+
+#endif
@@ -1,6 +1,7 @@
 #include "FAST/Testing.hpp"
 #include "EulerGradientVectorFlow.hpp"
 #include "MultigridGradientVectorFlow.hpp"
+#include "GradientVectorFlow.hpp"
 #include "FAST/Algorithms/ScaleImage/ScaleImage.hpp"
 #include "FAST/Algorithms/ImageGradient/ImageGradient.hpp"
 #include "FAST/Importers/ImageFileImporter.hpp"
@@ -200,4 +201,76 @@ TEST_CASE("Gradient vector flow with Multigrid method 3D 32 bit", "[fast][GVF][G
           < 0.001);
 }
 
+TEST_CASE("Gradient vector flow with Euler method 2D stops when converged", "[fast][GVF][GradientVectorFlow][EulerGradientVectorFlow][2D]") {
+    ImageFileImporter::pointer importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "US/Heart/ApicalFourChamber/US-2D_0.mhd");
+
+    ScaleImage::pointer normalize = ScaleImage::New();
+    normalize->setInputConnection(importer->getOutputPort());
+
+    ImageGradient::pointer gradient = ImageGradient::New();
+    gradient->setInputConnection(normalize->getOutputPort());
+    auto gradientPort = gradient->getOutputPort();
+
+    EulerGradientVectorFlow::pointer gvf = EulerGradientVectorFlow::New();
+    gvf->setInputConnection(gradient->getOutputPort());
+    gvf->set32bitStorageFormat();
+    gvf->setIterations(10000);
+    gvf->setConvergenceTolerance(0.0001);
+    auto gvfPort = gvf->getOutputPort();
+    gvf->update(0);
+
+    CHECK(gvf->getIterationsPerformed() < 10000);
+    CHECK(calculateGVFVectorFieldResidual(gradientPort->getNextFrame(), gvfPort->getNextFrame(), gvf->getMuConstant())
+          < 0.001);
+}
+
+TEST_CASE("Gradient vector flow with Multigrid method 3D 16 bit stops when converged", "[fast][GVF][GradientVectorFlow][MultigridGradientVectorFlow][3D]") {
+    ImageFileImporter::pointer importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "US/Ball/US-3Dt_0.mhd");
+
+    ScaleImage::pointer normalize = ScaleImage::New();
+    normalize->setInputConnection(importer->getOutputPort());
+
+    ImageGradient::pointer gradient = ImageGradient::New();
+    gradient->setInputConnection(normalize->getOutputPort());
+    gradient->set16bitStorageFormat();
+
+    // The tolerance must reach the solver also when the default 16 bit format is used
+    GradientVectorFlow::pointer gvf = GradientVectorFlow::New();
+    gvf->setInputConnection(gradient->getOutputPort());
+    gvf->setSolver(GradientVectorFlow::SOLVER_MULTIGRID);
+    gvf->setIterations(100);
+    gvf->setConvergenceTolerance(0.001);
+    auto gvfPort = gvf->getOutputPort();
+    gvf->update(0);
+
+    // The cycles of all three components are counted
+    CHECK(gvf->getIterationsPerformed() > 0);
+    CHECK(gvf->getIterationsPerformed() < 3*100);
+}
+
+TEST_CASE("Gradient vector flow with automatic solver selection 3D", "[fast][GVF][GradientVectorFlow][3D]") {
+    ImageFileImporter::pointer importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "US/Ball/US-3Dt_0.mhd");
+
+    ScaleImage::pointer normalize = ScaleImage::New();
+    normalize->setInputConnection(importer->getOutputPort());
+
+    ImageGradient::pointer gradient = ImageGradient::New();
+    gradient->setInputConnection(normalize->getOutputPort());
+    gradient->set16bitStorageFormat();
+    auto gradientPort = gradient->getOutputPort();
+
+    GradientVectorFlow::pointer gvf = GradientVectorFlow::New();
+    gvf->setInputConnection(gradient->getOutputPort());
+    gvf->set16bitStorageFormat();
+    auto gvfPort = gvf->getOutputPort();
+    gvf->update(0);
+
+    CHECK(gvf->getSelectedSolver() != GradientVectorFlow::SOLVER_AUTOMATIC);
+    CHECK(calculateGVFVectorFieldResidual(gradientPort->getNextFrame(), gvfPort->getNextFrame(), gvf->getMuConstant())
+          < 0.001);
+}
+
 }
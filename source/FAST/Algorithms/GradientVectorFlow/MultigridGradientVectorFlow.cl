@@ -405,3 +405,33 @@ __kernel void initFloatBuffer(
     buffer[get_global_id(0)] = FLOAT_TO_SNORM16(0.0f);
 }
 #endif
+
+/**
+ * Sum of the absolute values of a single channel volume, stored as one partial sum per work-group.
+ * The local size must be a power of two.
+ */
+__kernel void sumAbsoluteValues(
+        __read_only image3d_t volume,
+        __global float* partialSums,
+        __local float* scratch
+        ) {
+    const int width = get_image_width(volume);
+    const int height = get_image_height(volume);
+    const int total = width*height*get_image_depth(volume);
+    float sum = 0.0f;
+    for(int i = get_global_id(0); i < total; i += get_global_size(0)) {
+        const int4 pos = {i % width, (i / width) % height, i / (width*height), 0};
+        sum += fabs(read_imagef(volume, sampler, pos).x);
+    }
+
+    const int id = get_local_id(0);
+    scratch[id] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for(int offset = get_local_size(0)/2; offset > 0; offset /= 2) {
+        if(id < offset)
+            scratch[id] += scratch[id + offset];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if(id == 0)
+        partialSums[get_group_id(0)] = scratch[0];
+}
@@ -4,6 +4,10 @@
 
 namespace fast {
 
+// Work size of the reduction in the convergence check
+static const uint convergenceWorkGroupSize = 64;
+static const uint convergenceWorkGroups = 64;
+
 cl::Image3D MultigridGradientVectorFlow::initSolutionToZero(Vector3ui size, int imageType, int bufferSize) {
     OpenCLDevice::pointer device = getMainDevice();
     cl::CommandQueue queue = device->getCommandQueue();
@@ -566,13 +570,56 @@ void MultigridGradientVectorFlow::set32bitStorageFormat() {
     mUse16bitFormat = false;
 }
 
+void MultigridGradientVectorFlow::setConvergenceTolerance(float tolerance) {
+    if(tolerance < 0)
+        throw Exception("Convergence tolerance can't be negative in MultigridGradientVectorFlow.");
+    mConvergenceTolerance = tolerance;
+    mIsModified = true;
+}
+
+uint MultigridGradientVectorFlow::getIterationsPerformed() const {
+    return mIterationsPerformed;
+}
+
+bool MultigridGradientVectorFlow::hasConverged(cl::Image3D& residual, int cycle, int component) {
+    if(mConvergenceTolerance <= 0)
+        return false;
+
+    // Reduce to one partial sum per work-group on the device, and do the final sum on the host.
+    // The kernel and partial sum buffer are created once per execute, only the residual changes.
+    OpenCLDevice::pointer device = getMainDevice();
+    cl::CommandQueue queue = device->getCommandQueue();
+    mSumKernel.setArg(0, residual);
+    queue.enqueueNDRangeKernel(
+            mSumKernel,
+            cl::NullRange,
+            cl::NDRange(convergenceWorkGroupSize*convergenceWorkGroups),
+            cl::NDRange(convergenceWorkGroupSize)
+    );
+    std::vector<float> partialSumsHost(convergenceWorkGroups);
+    queue.enqueueReadBuffer(mPartialSums, CL_TRUE, 0, convergenceWorkGroups*sizeof(float), partialSumsHost.data());
+    double sum = 0;
+    for(float partialSum : partialSumsHost)
+        sum += partialSum;
+    const float meanResidual = sum / ((double)residual.getImageInfo<CL_IMAGE_WIDTH>()*
+            residual.getImageInfo<CL_IMAGE_HEIGHT>()*residual.getImageInfo<CL_IMAGE_DEPTH>());
+    reportInfo() << "Multigrid GVF mean residual of component " << component << " after " << cycle <<
+            " cycles: " << meanResidual << reportEnd();
+
+    return meanResidual < mConvergenceTolerance;
+}
+
 MultigridGradientVectorFlow::MultigridGradientVectorFlow() {
     createInputPort<Image>(0);
     createOutputPort<Image>(0);
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/GradientVectorFlow/MultigridGradientVectorFlow.cl");
+    // Keeps OpenCL objects of the main device between executions, so it is not moved by the device scheduler
+    mDeviceSchedulingAllowed = false;
     mIterations = 10;
     mMu = 0.1f;
     mUse16bitFormat = true;
+    mConvergenceTolerance = 0;
+    mIterationsPerformed = 0;
 }
 
 void MultigridGradientVectorFlow::execute() {
@@ -599,6 +646,13 @@ void MultigridGradientVectorFlow::execute() {
         } else {
             mProgram = getOpenCLProgram(device);
         }
+        if(mConvergenceTolerance > 0) {
+            mSumKernel = cl::Kernel(mProgram, "sumAbsoluteValues");
+            mPartialSums = cl::Buffer(device->getContext(), CL_MEM_WRITE_ONLY, convergenceWorkGroups*sizeof(float));
+            mSumKernel.setArg(1, mPartialSums);
+            mSumKernel.setArg(2, cl::Local(convergenceWorkGroupSize*sizeof(float)));
+        }
+        mIterationsPerformed = 0;
         execute3DGVF(input, output, mIterations);
     }
 }
@@ -675,6 +729,9 @@ void MultigridGradientVectorFlow::execute3DGVF(SharedPointer<Image> input,
     // X component
     for(int i = 0; i < iterations; i++) {
         cl::Image3D rx = computeNewResidual(fx,*inputAccess->get3DImage(),mMu,spacing,1,size,imageType,bufferTypeSize);
+        if(hasConverged(rx, i, 1))
+            break;
+        mIterationsPerformed++;
         cl::Image3D fx2 = fullMultigrid(rx,sqrMag,0,v0,v1,v2,l_max,mMu,spacing,size,imageType,bufferTypeSize);
         queue.finish();
         if(no3Dwrite) {
@@ -728,6 +785,9 @@ void MultigridGradientVectorFlow::execute3DGVF(SharedPointer<Image> input,
     cl::Image3D fy = initSolutionToZero(size,imageType,bufferTypeSize);
     for(int i = 0; i < iterations; i++) {
         cl::Image3D ry = computeNewResidual(fy,*inputAccess->get3DImage(),mMu,spacing,2,size,imageType,bufferTypeSize);
+        if(hasConverged(ry, i, 2))
+            break;
+        mIterationsPerformed++;
         cl::Image3D fy2 = fullMultigrid(ry,sqrMag,0,v0,v1,v2,l_max,mMu,spacing,size,imageType,bufferTypeSize);
         queue.finish();
         if(no3Dwrite) {
@@ -782,6 +842,9 @@ void MultigridGradientVectorFlow::execute3DGVF(SharedPointer<Image> input,
     cl::Image3D fz = initSolutionToZero(size,imageType,bufferTypeSize);
     for(int i = 0; i < iterations; i++) {
         cl::Image3D rz = computeNewResidual(fz,*inputAccess->get3DImage(),mMu,spacing,3,size,imageType,bufferTypeSize);
+        if(hasConverged(rz, i, 3))
+            break;
+        mIterationsPerformed++;
         cl::Image3D fz2 = fullMultigrid(rz,sqrMag,0,v0,v1,v2,l_max,mMu,spacing,size,imageType,bufferTypeSize);
         queue.finish();
         if(no3Dwrite) {
@@ -23,6 +23,16 @@ class FAST_EXPORT  MultigridGradientVectorFlow : public ProcessObject {
          * Use 32 bit format internally instead of 16 bit.
          */
         void set32bitStorageFormat();
+        /**
+         * Stop the full multigrid cycles of a component when the mean absolute residual
+         * drops below this tolerance. The number of iterations then acts as an upper limit.
+         * Zero (default) disables the convergence check.
+         */
+        void setConvergenceTolerance(float tolerance);
+        /**
+         * @return total number of full multigrid cycles performed for all components in the last execute
+         */
+        uint getIterationsPerformed() const;
     private:
         MultigridGradientVectorFlow();
         void execute();
@@ -31,7 +41,14 @@ class FAST_EXPORT  MultigridGradientVectorFlow : public ProcessObject {
         float mMu;
         uint mIterations;
         bool mUse16bitFormat;
+        float mConvergenceTolerance;
+        uint mIterationsPerformed;
         cl::Program mProgram;
+        // Used by hasConverged
+        cl::Kernel mSumKernel;
+        cl::Buffer mPartialSums;
+
+        bool hasConverged(cl::Image3D& residual, int cycle, int component);
 
         cl::Image3D initSolutionToZero(Vector3ui size, int imageType, int bufferSize);
         void gaussSeidelSmoothing(
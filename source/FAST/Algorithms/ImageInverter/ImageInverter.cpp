@@ -10,6 +10,21 @@ ImageInverter::ImageInverter() {
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/ImageInverter/ImageInverter.cl");
 }
 
+PointwiseOperator ImageInverter::getPointwiseOperator() {
+    PointwiseOperator op;
+    op.expression = "({max} - {min}) - value";
+    op.function = makePointwiseFunction([](float value, float operand, float minimum, float maximum) {
+        return (maximum - minimum) - value;
+    });
+    op.requiresIntensityRange = true;
+    op.transformIntensityRange = [](float& minimum, float& maximum) {
+        const float newMinimum = -minimum;
+        maximum = maximum - 2*minimum;
+        minimum = newMinimum;
+    };
+    return op;
+}
+
 void ImageInverter::execute() {
     Image::pointer input = getInputData<Image>();
     Image::pointer output = getOutputData<Image>();
@@ -2,12 +2,14 @@
 #define IMAGE_INVERTER_HPP_
 
 #include "FAST/ProcessObject.hpp"
+#include "FAST/Algorithms/PointwiseOperatorChain/PointwiseOperator.hpp"
 
 namespace fast {
 
-class FAST_EXPORT  ImageInverter : public ProcessObject {
+class FAST_EXPORT  ImageInverter : public ProcessObject, public PointwiseProcessObject {
     FAST_OBJECT(ImageInverter)
     public:
+        PointwiseOperator getPointwiseOperator();
     private:
         ImageInverter();
         void execute();
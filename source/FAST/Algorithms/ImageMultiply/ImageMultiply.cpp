@@ -10,6 +10,16 @@ ImageMultiply::ImageMultiply() {
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/ImageMultiply/ImageMultiply.cl");
 }
 
+PointwiseOperator ImageMultiply::getPointwiseOperator() {
+    PointwiseOperator op;
+    op.expression = "value*{operand}";
+    op.function = makePointwiseFunction([](float value, float operand, float minimum, float maximum) {
+        return value*operand;
+    });
+    op.hasOperand = true;
+    return op;
+}
+
 void ImageMultiply::execute() {
     Image::pointer input1 = getInputData<Image>(0);
     Image::pointer input2 = getInputData<Image>(1);
@@ -2,12 +2,14 @@
 #define FAST_IMAGE_MULTIPLY_HPP_
 
 #include "FAST/ProcessObject.hpp"
+#include "FAST/Algorithms/PointwiseOperatorChain/PointwiseOperator.hpp"
 
 namespace fast {
 
-class FAST_EXPORT  ImageMultiply : public ProcessObject {
+class FAST_EXPORT  ImageMultiply : public ProcessObject, public PointwiseProcessObject {
     FAST_OBJECT(ImageMultiply)
     public:
+        PointwiseOperator getPointwiseOperator();
     private:
         ImageMultiply();
         void execute();
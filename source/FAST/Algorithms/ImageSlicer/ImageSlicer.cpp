@@ -46,13 +46,10 @@ void ImageSlicer::execute() {
 	}
 }
 
-void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output) {
-    OpenCLDevice::pointer device = getMainDevice();
-
+int ImageSlicer::createOrthogonalSlice(Image::pointer input, Image::pointer output, PlaneType orthogonalSlicePlane, int sliceNr) {
     // Determine slice nr and width and height
-    int sliceNr;
-    if(mOrthogonalSliceNr < 0) {
-        switch(mOrthogonalSlicePlane) {
+    if(sliceNr < 0) {
+        switch(orthogonalSlicePlane) {
         case PLANE_X:
             sliceNr = input->getWidth()/2;
             break;
@@ -65,8 +62,7 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
         }
     } else {
         // Check that mSliceNr is valid
-        sliceNr = mOrthogonalSliceNr;
-        switch(mOrthogonalSlicePlane) {
+        switch(orthogonalSlicePlane) {
         case PLANE_X:
             if(sliceNr >= input->getWidth())
                 sliceNr = input->getWidth()-1;
@@ -81,12 +77,11 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
             break;
         }
     }
-    unsigned int slicePlaneNr, width, height;
+    unsigned int width, height;
     Vector3f spacing(0,0,0);
     Affine3f transform = Affine3f::Identity();
-    switch(mOrthogonalSlicePlane) {
+    switch(orthogonalSlicePlane) {
         case PLANE_X:
-            slicePlaneNr = 0;
             width = input->getHeight();
             height = input->getDepth();
             spacing.x() = input->getSpacing().y();
@@ -96,7 +91,6 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
             transform.translation() = Vector3f(sliceNr*input->getSpacing().x(), 0, 0);
             break;
         case PLANE_Y:
-            slicePlaneNr = 1;
             width = input->getWidth();
             height = input->getDepth();
             spacing.x() = input->getSpacing().x();
@@ -105,7 +99,6 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
             transform.translation() = Vector3f(0, sliceNr*input->getSpacing().y(), 0);
             break;
         case PLANE_Z:
-            slicePlaneNr = 2;
             width = input->getWidth();
             height = input->getHeight();
             spacing.x() = input->getSpacing().x();
@@ -121,6 +114,17 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
     output->getSceneGraphNode()->setTransformation(T);
     SceneGraph::setParentNode(output, input);
 
+    return sliceNr;
+}
+
+void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output) {
+    OpenCLDevice::pointer device = getMainDevice();
+
+    const int sliceNr = createOrthogonalSlice(input, output, mOrthogonalSlicePlane, mOrthogonalSliceNr);
+    const int slicePlaneNr = mOrthogonalSlicePlane;
+    const uint width = output->getWidth();
+    const uint height = output->getHeight();
+
     OpenCLImageAccess::pointer inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
     OpenCLImageAccess::pointer outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
 
@@ -138,8 +142,6 @@ void ImageSlicer::orthogonalSlicing(Image::pointer input, Image::pointer output)
             cl::NDRange(width, height),
             cl::NullRange
     );
-
-    // TODO set scene graph transformation
 }
 
 bool inline cornersAreAdjacent(Vector3f cornerA, Vector3f cornerB, Image::pointer input) {
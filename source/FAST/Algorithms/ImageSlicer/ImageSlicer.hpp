@@ -14,6 +14,16 @@ class FAST_EXPORT  ImageSlicer : public ProcessObject {
 	public:
 		void setOrthogonalSlicePlane(PlaneType orthogonalSlicePlane, int sliceNr = -1);
 		void setArbitrarySlicePlane(Plane slicePlane);
+		/**
+		 * Create output as an orthogonal slice of input, with size, spacing and scene graph transformation, but
+		 * without filling it with data.
+		 * @param input 3D image
+		 * @param output
+		 * @param orthogonalSlicePlane
+		 * @param sliceNr slice to extract, the center slice is used if negative, and it is clamped to the image
+		 * @return the slice nr which was used
+		 */
+		static int createOrthogonalSlice(SharedPointer<Image> input, SharedPointer<Image> output, PlaneType orthogonalSlicePlane, int sliceNr = -1);
 	private:
 		ImageSlicer();
 		void execute();
@@ -45,7 +45,7 @@ LaplacianOfGaussian::~LaplacianOfGaussian() {
 
 // TODO have to set mRecreateMask to true if input change dimension
 void LaplacianOfGaussian::createMask(Image::pointer input) {
-    if(!mRecreateMask)
+    if(!mRecreateMask && getMainDevice() == mDeviceMaskCreatedFor)
         return;
 
     unsigned char halfSize = (mMaskSize-1)/2;
@@ -89,49 +89,28 @@ void LaplacianOfGaussian::createMask(Image::pointer input) {
     }
 
     mRecreateMask = false;
+    mDeviceMaskCreatedFor = getMainDevice();
 }
 
 void LaplacianOfGaussian::recompileOpenCLCode(Image::pointer input) {
     // Check if there is a need to recompile OpenCL code
     if(input->getDimensions() == mDimensionCLCodeCompiledFor &&
-            input->getDataType() == mTypeCLCodeCompiledFor)
+            input->getDataType() == mTypeCLCodeCompiledFor &&
+            getMainDevice() == mDeviceCLCodeCompiledFor)
         return;
 
+    // The program is specialized for the type of the input by getOpenCLProgram
     OpenCLDevice::pointer device = getMainDevice();
-    std::string buildOptions = "";
-    if(input->getDataType() == TYPE_FLOAT) {
-        buildOptions = "-DTYPE_FLOAT";
-    } else if(input->getDataType() == TYPE_INT8 || input->getDataType() == TYPE_INT16) {
-        buildOptions = "-DTYPE_INT";
-    } else {
-        buildOptions = "-DTYPE_UINT";
-    }
-    switch(input->getDataType()) {
-        case TYPE_FLOAT:
-            buildOptions += " -DTYPE=float";
-            break;
-        case TYPE_INT8:
-            buildOptions += " -DTYPE=char";
-            break;
-        case TYPE_UINT8:
-            buildOptions += " -DTYPE=uchar";
-            break;
-        case TYPE_INT16:
-            buildOptions += " -DTYPE=short";
-            break;
-        case TYPE_UINT16:
-            buildOptions += " -DTYPE=ushort";
-            break;
-        }
     cl::Program program;
     if(input->getDimensions() == 2) {
-        program = getOpenCLProgram(device, "2D", buildOptions);
+        program = getOpenCLProgram(device, "2D");
     } else {
-        program = getOpenCLProgram(device, "3D", buildOptions);
+        program = getOpenCLProgram(device, "3D");
     }
     mKernel = cl::Kernel(program, "laplacianOfGaussian");
     mDimensionCLCodeCompiledFor = input->getDimensions();
     mTypeCLCodeCompiledFor = input->getDataType();
+    mDeviceCLCodeCompiledFor = getMainDevice();
 }
 
 template <class T>
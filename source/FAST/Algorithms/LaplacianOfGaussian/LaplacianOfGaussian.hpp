@@ -26,6 +26,9 @@ class FAST_EXPORT  LaplacianOfGaussian : public ProcessObject {
         cl::Buffer mCLMask;
         float * mMask;
         bool mRecreateMask;
+        // The mask and kernel have to be created again if the main device is changed
+        ExecutionDevice::pointer mDeviceMaskCreatedFor;
+        ExecutionDevice::pointer mDeviceCLCodeCompiledFor;
 
         cl::Kernel mKernel;
         unsigned char mDimensionCLCodeCompiledFor;
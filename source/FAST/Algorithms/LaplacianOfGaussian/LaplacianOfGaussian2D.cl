@@ -14,9 +14,9 @@ __kernel void laplacianOfGaussian(
     for(int x = -halfSize; x <= halfSize; x++) {
     for(int y = -halfSize; y <= halfSize; y++) {
         const int2 offset = {x,y};
-#ifdef TYPE_FLOAT
+#if defined(FAST_INPUT0_TYPE_FLOAT)
         sum += mask[x+halfSize+(y+halfSize)*maskSize]*read_imagef(input, sampler, pos+offset).x;
-#elif TYPE_UINT
+#elif defined(FAST_INPUT0_TYPE_UINT)
         sum += mask[x+halfSize+(y+halfSize)*maskSize]*read_imageui(input, sampler, pos+offset).x;
 #else
         sum += mask[x+halfSize+(y+halfSize)*maskSize]*read_imagei(input, sampler, pos+offset).x;
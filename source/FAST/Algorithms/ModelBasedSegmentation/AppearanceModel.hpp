@@ -23,7 +23,20 @@ class FAST_EXPORT  AppearanceModel : public Object {
 	public:
 		typedef SharedPointer<AppearanceModel> pointer;
 		virtual std::vector<Measurement> getMeasurements(SharedPointer<Image> image, SharedPointer<Shape> shape, ExecutionDevice::pointer device) = 0;
-
+		/**
+		 * Get the measurements of several shapes in the same image, e.g. from several objects or hypotheses.
+		 * Models which can sample all shapes in one pass over the image override this.
+		 * @param image
+		 * @param shapes
+		 * @param device
+		 * @return one vector of measurements for each shape
+		 */
+		virtual std::vector<std::vector<Measurement>> getMeasurementsOfShapes(SharedPointer<Image> image, const std::vector<Shape::pointer>& shapes, ExecutionDevice::pointer device) {
+			std::vector<std::vector<Measurement>> measurements;
+			for(const Shape::pointer& shape : shapes)
+				measurements.push_back(getMeasurements(image, shape, device));
+			return measurements;
+		};
 
 };
 
@@ -1,6 +1,7 @@
 #include "StepEdgeModel.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/Algorithms/ModelBasedSegmentation/Shape.hpp"
+#include <algorithm>
 
 
 namespace fast {
@@ -77,133 +78,122 @@ inline bool isInBounds(Image::pointer image, const Vector4f& position) {
         position(0) < image->getWidth() && position(1) < image->getHeight() && position(2) < image->getDepth();
 }
 
-inline float getValue(void* pixelPointer, Image::pointer image, const Vector4f& position) {
-
-    uint index = (int)position(0)+(int)position(1)*image->getWidth()+(int)position(2)*image->getWidth()*image->getHeight();
-    float value;
-    switch(image->getDataType()) {
-        // This macro creates a case statement for each data type and sets FAST_TYPE to the correct C++ data type
-        fastSwitchTypeMacro(value = ((FAST_TYPE*)pixelPointer)[index]);
-    }
-    return value;
+template <class T>
+Measurement StepEdgeModel::measureVertex(const T* data, Image::pointer image, const MeshVertex& vertex, const Matrix4f& transform) const {
+	std::vector<float> intensityProfile;
+	unsigned int startPos = 0;
+	bool startFound = false;
+	const Vector3f spacing = image->getSpacing();
+	const Vector3i size = image->getSize().cast<int>();
+	const uint nrOfComponents = image->getNrOfComponents();
+	// Normalized integers are converted to float as in ImageAccess::getScalar
+	float scale = 1.0f;
+	if(image->getDataType() == TYPE_SNORM_INT16) {
+		scale = 1.0f/32767.0f;
+	} else if(image->getDataType() == TYPE_UNORM_INT16) {
+		scale = 1.0f/65535.0f;
+	}
+	for(float d = -mLineLength/2; d < mLineLength/2; d += mLineSampleSpacing) {
+		Vector3i pixelPosition;
+		if(image->getDimensions() == 3) {
+			// Apply model transform and image inverse transform to get image voxel position
+			// TODO the line search normal*d should propably be applied after the model transform, so that we know that is correct units?
+			const Vector3f position = vertex.getPosition() + vertex.getNormal()*d;
+			const Vector4f positionInt = transform*position.homogeneous();
+			pixelPosition = Vector3i(positionInt.x(), positionInt.y(), positionInt.z());
+		} else {
+			// For 2D, we probably want to ignore scene graph, and only use spacing.
+			const Vector2f position = vertex.getPosition().head(2) + vertex.getNormal().head(2)*d;
+			if(position.y() < mMinimumDepth)
+				continue;
+			pixelPosition = Vector3i(round(position.x() / spacing.x()), round(position.y() / spacing.y()), 0);
+		}
+		if((pixelPosition.array() >= 0).all() && (pixelPosition.array() < size.array()).all()) {
+			const size_t index = pixelPosition.x() + pixelPosition.y()*size.x() + (size_t)pixelPosition.z()*size.x()*size.y();
+			float value = data[index*nrOfComponents];
+			if(scale != 1.0f)
+				value = std::max(-1.0f, value*scale);
+			if(value > 0) {
+				intensityProfile.push_back(value);
+				startFound = true;
+			} else if(!startFound) {
+				startPos++;
+			}
+		} else if(!startFound) {
+			startPos++;
+		}
+	}
+	Measurement m;
+	m.uncertainty = 1;
+	m.displacement = 0;
+	if(startFound){
+		DetectedEdge edge = findEdge(intensityProfile, mIntensityDifferenceThreshold, mEdgeType);
+		if(edge.edgeIndex != -1) {
+			// The edge is on the normal, so the displacement along the normal is the distance d of the edge
+			const float d = -mLineLength/2.0f + (startPos + edge.edgeIndex)*mLineSampleSpacing;
+			m.uncertainty = edge.uncertainty;
+			if(image->getDimensions() == 3) {
+				m.displacement = vertex.getNormal().dot(vertex.getNormal()*d);
+			} else {
+				m.displacement = vertex.getNormal().head(2).dot(vertex.getNormal().head(2)*d);
+			}
+		}
+	}
+	return m;
 }
 
-
 std::vector<Measurement> StepEdgeModel::getMeasurements(SharedPointer<Image> image, SharedPointer<Shape> shape, ExecutionDevice::pointer device) {
+	return getMeasurementsOfShapes(image, {shape}, device)[0];
+}
+
+std::vector<std::vector<Measurement>> StepEdgeModel::getMeasurementsOfShapes(SharedPointer<Image> image, const std::vector<SharedPointer<Shape>>& shapes, ExecutionDevice::pointer device) {
 	if(mLineLength == 0 || mLineSampleSpacing == 0)
 		throw Exception("Line length and sample spacing must be given to the StepEdgeModel");
 
-	std::vector<Measurement> measurements;
-	Mesh::pointer predictedMesh = shape->getMesh();
-	MeshAccess::pointer predictedMeshAccess = predictedMesh->getMeshAccess(ACCESS_READ);
-	std::vector<MeshVertex> points = predictedMeshAccess->getVertices();
-
-	ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
-
-	// For each point on the shape do a line search in the direction of the normal
-	// Return set of displacements and uncertainties
+	// Collect the vertices of all shapes, so that the image is accessed once and all vertices are sampled in one parallel loop
+	std::vector<std::vector<MeshVertex>> points(shapes.size());
+	std::vector<Matrix4f> transforms(shapes.size(), Matrix4f::Identity());
+	std::vector<int> offsets(shapes.size() + 1, 0);
+	Matrix4f inverseTransformMatrix = Matrix4f::Identity();
 	if(image->getDimensions() == 3) {
 		AffineTransformation::pointer transformMatrix = SceneGraph::getAffineTransformationFromData(image);
-		Matrix4f inverseTransformMatrix = transformMatrix->getTransform().scale(image->getSpacing()).matrix().inverse();
-
-		// Get model scene graph transform
-		AffineTransformation::pointer modelTransformation = SceneGraph::getAffineTransformationFromData(shape->getMesh());
-		MatrixXf modelTransformMatrix = modelTransformation->getTransform().affine();
-
-		// Do edge detection for each vertex
-		int counter = 0;
-		for(int i = 0; i < points.size(); ++i) {
-			std::vector<float> intensityProfile;
-			unsigned int startPos = 0;
-			bool startFound = false;
-			for(float d = -mLineLength/2; d < mLineLength/2; d += mLineSampleSpacing) {
-				Vector3f position = points[i].getPosition() + points[i].getNormal()*d;
-				// Apply model transform
-				// TODO the line search normal*d should propably be applied after this transform, so that we know that is correct units?
-				position = modelTransformMatrix*position.homogeneous();
-				const Vector4f longPosition(position(0), position(1), position(2), 1);
-				// Apply image inverse transform to get image voxel position
-				const Vector4f positionInt = inverseTransformMatrix*longPosition;
-				try {
-					const float value = access->getScalar(positionInt.cast<int>());
-					if(value > 0) {
-						intensityProfile.push_back(value);
-						startFound = true;
-					} else if(!startFound) {
-						startPos++;
-					}
-				} catch(Exception &e) {
-					if(!startFound) {
-						startPos++;
-					}
-				}
-			}
-			Measurement m;
-			m.uncertainty = 1;
-			m.displacement = 0;
-			if(startFound){
-				DetectedEdge edge = findEdge(intensityProfile, mIntensityDifferenceThreshold, mEdgeType);
-				if(edge.edgeIndex != -1) {
-					float d = -mLineLength/2.0f + (startPos + edge.edgeIndex)*mLineSampleSpacing;
-					const Vector3f position = points[i].getPosition() + points[i].getNormal()*d;
-					m.uncertainty = edge.uncertainty;
-					const Vector3f normal = points[i].getNormal();
-					m.displacement = normal.dot(position-points[i].getPosition());
-					counter++;
-				}
-			}
-			measurements.push_back(m);
-		}
-	} else {
-		Vector3f spacing = image->getSpacing();
-		// For 2D images
-		// For 2D, we probably want to ignore scene graph, and only use spacing.
-		// Do edge detection for each vertex
-		int counter = 0;
-		for(int i = 0; i < points.size(); ++i) {
-			std::vector<float> intensityProfile;
-			unsigned int startPos = 0;
-			bool startFound = false;
-			for(float d = -mLineLength/2; d < mLineLength/2; d += mLineSampleSpacing) {
-				Vector2f position = points[i].getPosition().head(2) + points[i].getNormal().head(2)*d;
-				const Vector2i pixelPosition(round(position.x() / spacing.x()), round(position.y() / spacing.y()));
-				if(position.y() < mMinimumDepth)
-					continue;
-				try {
-					const float value = access->getScalar(pixelPosition);
-					if(value > 0) {
-						intensityProfile.push_back(value);
-						startFound = true;
-					} else if(!startFound) {
-						startPos++;
-					}
-				} catch(Exception &e) {
-					if(!startFound) {
-						startPos++;
-					}
-				}
-			}
-			Measurement m;
-			m.uncertainty = 1;
-			m.displacement = 0;
-			if(startFound){
-				DetectedEdge edge = findEdge(intensityProfile, mIntensityDifferenceThreshold, mEdgeType);
-				if(edge.edgeIndex != -1) {
-					float d = -mLineLength/2.0f + (startPos + edge.edgeIndex)*mLineSampleSpacing;
-					const Vector2f position = points[i].getPosition().head(2) + points[i].getNormal().head(2)*d;
-					m.uncertainty = edge.uncertainty;
-					const Vector2f normal = points[i].getNormal().head(2);
-					m.displacement = normal.dot(position-points[i].getPosition().head(2));
-					counter++;
-				}
-			}
-			measurements.push_back(m);
+		inverseTransformMatrix = transformMatrix->getTransform().scale(image->getSpacing()).matrix().inverse();
+	}
+	for(int i = 0; i < shapes.size(); ++i) {
+		MeshAccess::pointer predictedMeshAccess = shapes[i]->getMesh()->getMeshAccess(ACCESS_READ);
+		points[i] = predictedMeshAccess->getVertices();
+		offsets[i + 1] = offsets[i] + points[i].size();
+		if(image->getDimensions() == 3) {
+			// Model scene graph transform followed by the image inverse transform
+			AffineTransformation::pointer modelTransformation = SceneGraph::getAffineTransformationFromData(shapes[i]->getMesh());
+			transforms[i] = inverseTransformMatrix*modelTransformation->getTransform().matrix();
 		}
 	}
 
+	std::vector<std::vector<Measurement>> measurements(shapes.size());
+	for(int i = 0; i < shapes.size(); ++i)
+		measurements[i].resize(points[i].size());
+
+	ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+	const void* data = access->get();
+	fastDispatchTypeMacro(image->getDataType(), measureVertices<FAST_TYPE>((const FAST_TYPE*)data, image, points, transforms, offsets, measurements))
+
 	return measurements;
 }
 
+template <class T>
+void StepEdgeModel::measureVertices(const T* data, Image::pointer image, const std::vector<std::vector<MeshVertex>>& points, const std::vector<Matrix4f>& transforms, const std::vector<int>& offsets, std::vector<std::vector<Measurement>>& measurements) const {
+	// For each point on the shapes do a line search in the direction of the normal
+	// Return set of displacements and uncertainties
+	const int totalSize = offsets.back();
+#pragma omp parallel for schedule(dynamic, 16)
+	for(int i = 0; i < totalSize; ++i) {
+		const int shapeNr = std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin() - 1;
+		const int vertexNr = i - offsets[shapeNr];
+		measurements[shapeNr][vertexNr] = measureVertex(data, image, points[shapeNr][vertexNr], transforms[shapeNr]);
+	}
+}
+
 void StepEdgeModel::setLineLength(float length) {
 	if(length <= 0)
 		throw Exception("Length must be > 0");
@@ -6,6 +6,7 @@
 namespace fast {
 
 class Image;
+class ImageAccess;
 class Shape;
 
 class FAST_EXPORT  StepEdgeModel : public AppearanceModel {
@@ -16,6 +17,7 @@ class FAST_EXPORT  StepEdgeModel : public AppearanceModel {
 		void setIntensityDifferenceThreshold(float threshold);
 		void setMinimumDepth(float depth);
 		std::vector<Measurement> getMeasurements(SharedPointer<Image> image, SharedPointer<Shape> shape, ExecutionDevice::pointer device);
+		std::vector<std::vector<Measurement>> getMeasurementsOfShapes(SharedPointer<Image> image, const std::vector<SharedPointer<Shape>>& shapes, ExecutionDevice::pointer device);
 		enum EdgeType {
 			EDGE_TYPE_ANY,
 			EDGE_TYPE_BLACK_INSIDE_WHITE_OUTSIDE,
@@ -24,6 +26,11 @@ class FAST_EXPORT  StepEdgeModel : public AppearanceModel {
 		void setEdgeType(EdgeType type);
 	private:
 		StepEdgeModel();
+		// Measure all vertices, with the image data type as a template parameter
+		template <class T>
+		void measureVertices(const T* data, SharedPointer<Image> image, const std::vector<std::vector<MeshVertex>>& points, const std::vector<Matrix4f>& transforms, const std::vector<int>& offsets, std::vector<std::vector<Measurement>>& measurements) const;
+		template <class T>
+		Measurement measureVertex(const T* data, SharedPointer<Image> image, const MeshVertex& vertex, const Matrix4f& transform) const;
 
 		float mLineLength;
 		float mLineSampleSpacing;
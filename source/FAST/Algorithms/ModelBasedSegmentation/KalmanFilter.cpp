@@ -5,19 +5,6 @@
 
 namespace fast {
 
-void KalmanFilter::predict() {
-	// Use temporal/motion model to predict the next state and covariance
-	// This is done using matrices from the shape model
-	MatrixXf A1 = mShapeModel->getStateTransitionMatrix1();
-	MatrixXf A2 = mShapeModel->getStateTransitionMatrix2();
-	MatrixXf A3 = mShapeModel->getStateTransitionMatrix3();
-	mPredictedState = A1*mCurrentState + A2*mPreviousState + A3*mDefaultState;
-	mPredictedCovariance = A1*mCurrentCovariance*A1.transpose() + A2*mPreviousCovariance*A2.transpose() +
-			A1*mCurrentCovariance*A2.transpose() + A2*mPreviousCovariance*A1.transpose() + mShapeModel->getProcessErrorMatrix();
-
-	mPredictedState = mShapeModel->restrictState(mPredictedState);
-}
-
 void KalmanFilter::setShapeModel(ShapeModel::pointer shapeModel) {
 	mShapeModel = shapeModel;
 }
@@ -30,7 +17,7 @@ void KalmanFilter::setAppearanceModel(
 VectorXf KalmanFilter::getCurrentState() const {
 	if(!mInitialized)
 		throw Exception("Can't get current state before first execute in Kalman filter.");
-	return mCurrentState;
+	return mState.getCurrentState();
 }
 
 void KalmanFilter::execute() {
@@ -42,11 +29,7 @@ void KalmanFilter::execute() {
 
 	if(!mInitialized) {
 		// Initialize state using shape model
-		mCurrentState = mShapeModel->getInitialState(image);
-		mPreviousState = mCurrentState;
-		mDefaultState = mCurrentState;
-		mCurrentCovariance = MatrixXf::Zero(mCurrentState.size(), mCurrentState.size());
-		mPreviousCovariance = mCurrentCovariance;
+		mState = KalmanFilterState(mShapeModel->getInitialState(image));
 		mInitialized = true;
 	}
 
@@ -58,23 +41,23 @@ void KalmanFilter::execute() {
 		counter = mStartIterations;
 	}
 	while(counter--) {
-		predict();
+		mState.predict(mShapeModel);
 		estimate(image);
 	}
-	reportInfo() << "Current state: " << mCurrentState.transpose() << reportEnd();
+	reportInfo() << "Current state: " << mState.getCurrentState().transpose() << reportEnd();
     reportInfo() << "Finished one round of Kalman filter" << reportEnd();
     if(mOutputDisplacements) {
     	Mesh::pointer displacements = getDisplacementVectors(image);
 		addOutputData(1, displacements);
     }
 
-	Shape::pointer shape = mShapeModel->getShape(mCurrentState);
+	Shape::pointer shape = mShapeModel->getShape(mState.getCurrentState());
 	addOutputData(0, shape->getMesh());
 }
 
 Mesh::pointer KalmanFilter::getDisplacementVectors(Image::pointer image) {
 
-	Shape::pointer shape = mShapeModel->getShape(mCurrentState);
+	Shape::pointer shape = mShapeModel->getShape(mState.getCurrentState());
 	Mesh::pointer mesh = shape->getMesh();
 	MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
 	std::vector<Measurement> measurements = mAppearanceModel->getMeasurements(image, shape, getMainDevice());
@@ -139,31 +122,10 @@ void KalmanFilter::setStartIterations(int iterations) {
 }
 
 void KalmanFilter::estimate(SharedPointer<Image> image) {
-
-	Shape::pointer shape = mShapeModel->getShape(mPredictedState);
+	Shape::pointer shape = mShapeModel->getShape(mState.getPredictedState());
 	std::vector<Measurement> measurements = mAppearanceModel->getMeasurements(image, shape, getMainDevice());
-	std::vector<MatrixXf> measurementVectors = mShapeModel->getMeasurementVectors(mPredictedState, shape);
-
-	// Assimilate the measurements into HRH and HRv
-	const uint nrOfMeasurements = measurements.size();
-	const uint stateSize = mPredictedState.size();
-	MatrixXf HRH = MatrixXf::Zero(stateSize, stateSize);
-	VectorXf HRv = VectorXf::Zero(stateSize);
-	for(uint i = 0; i < nrOfMeasurements; ++i) {
-		MatrixXf measurementVector = measurementVectors[i];
-		if(measurements[i].uncertainty < 1) {
-			HRH += measurementVector.transpose()*(1.0f/measurements[i].uncertainty)*measurementVector;
-			HRv += measurementVector.transpose()*(1.0f/measurements[i].uncertainty)*measurements[i].displacement;
-		}
-	}
-
-
-	// Update covariance and state
-	mPreviousState = mCurrentState;
-	mPreviousCovariance = mCurrentCovariance;
-	mCurrentCovariance = (mPredictedCovariance.inverse() + HRH).inverse();
-	mCurrentState = mPredictedState + mCurrentCovariance*HRv;
-	mCurrentState = mShapeModel->restrictState(mCurrentState);
+	MatrixXf measurementMatrix = mShapeModel->getMeasurementMatrix(mState.getPredictedState(), shape);
+	mState.update(mShapeModel, measurements, measurementMatrix);
 }
 
 }
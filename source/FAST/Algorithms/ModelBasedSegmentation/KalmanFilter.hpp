@@ -4,6 +4,7 @@
 #include "FAST/ProcessObject.hpp"
 #include "AppearanceModel.hpp"
 #include "ShapeModel.hpp"
+#include "KalmanFilterState.hpp"
 
 namespace fast {
 
@@ -23,21 +24,13 @@ class FAST_EXPORT  KalmanFilter : public ProcessObject {
 	private:
 		KalmanFilter();
 		void execute(); // runs a loop with predict, measure and update
-		void predict();
 		void estimate(SharedPointer<Image> image);
 		SharedPointer<Mesh> getDisplacementVectors(SharedPointer<Image> image);
 
 		AppearanceModel::pointer mAppearanceModel;
 		ShapeModel::pointer mShapeModel;
 
-		VectorXf mCurrentState;
-		VectorXf mPreviousState;
-		VectorXf mDefaultState;
-		VectorXf mPredictedState;
-
-		MatrixXf mCurrentCovariance;
-		MatrixXf mPreviousCovariance;
-		MatrixXf mPredictedCovariance;
+		KalmanFilterState mState;
 
 		bool mInitialized;
 		bool mFirstExecute;
@@ -1,5 +1,6 @@
 %include "FAST/ProcessObject.i"
 %shared_ptr(fast::KalmanFilter)
+%shared_ptr(fast::KalmanFilterTracker)
 %shared_ptr(fast::AppearanceModel)
 %shared_ptr(fast::ShapeModel)
 
@@ -27,4 +28,18 @@ class KalmanFilter : public ProcessObject {
 
 %template(KalmanFilterPtr) SharedPointer<KalmanFilter>;
 
+class KalmanFilterTracker : public ProcessObject {
+	public:
+		static SharedPointer<KalmanFilterTracker> New();
+		int addObject(SharedPointer<ShapeModel> shapeModel, SharedPointer<AppearanceModel> appearanceModel);
+		void setIterations(int iterations);
+		void setStartIterations(int iterations);
+		void setPruningFactor(float factor);
+		void setMaximumNrOfHypotheses(int hypotheses);
+		int getNrOfObjects() const;
+		int getNrOfHypotheses(int objectNr) const;
+};
+
+%template(KalmanFilterTrackerPtr) SharedPointer<KalmanFilterTracker>;
+
 }
@@ -0,0 +1,84 @@
+#include "KalmanFilterState.hpp"
+#include <limits>
+
+namespace fast {
+
+KalmanFilterState::KalmanFilterState() {
+	mInnovation = std::numeric_limits<float>::infinity();
+}
+
+KalmanFilterState::KalmanFilterState(VectorXf initialState) {
+	mCurrentState = initialState;
+	mPreviousState = mCurrentState;
+	mDefaultState = mCurrentState;
+	mPredictedState = mCurrentState;
+	mCurrentCovariance = MatrixXf::Zero(mCurrentState.size(), mCurrentState.size());
+	mPreviousCovariance = mCurrentCovariance;
+	mPredictedCovariance = mCurrentCovariance;
+	mInnovation = std::numeric_limits<float>::infinity();
+}
+
+void KalmanFilterState::predict(ShapeModel::pointer shapeModel) {
+	// Use temporal/motion model to predict the next state and covariance
+	// This is done using matrices from the shape model
+	MatrixXf A1 = shapeModel->getStateTransitionMatrix1();
+	MatrixXf A2 = shapeModel->getStateTransitionMatrix2();
+	MatrixXf A3 = shapeModel->getStateTransitionMatrix3();
+	mPredictedState = A1*mCurrentState + A2*mPreviousState + A3*mDefaultState;
+	mPredictedCovariance = A1*mCurrentCovariance*A1.transpose() + A2*mPreviousCovariance*A2.transpose() +
+			A1*mCurrentCovariance*A2.transpose() + A2*mPreviousCovariance*A1.transpose() + shapeModel->getProcessErrorMatrix();
+
+	mPredictedState = shapeModel->restrictState(mPredictedState);
+}
+
+float KalmanFilterState::update(ShapeModel::pointer shapeModel, const std::vector<Measurement>& measurements, const MatrixXf& measurementMatrix) {
+	// Assimilate the measurements into HRH and HRv, using only the measurements which are certain enough
+	const uint nrOfMeasurements = measurements.size();
+	const uint stateSize = mPredictedState.size();
+	std::vector<uint> accepted;
+	for(uint i = 0; i < nrOfMeasurements; ++i) {
+		if(measurements[i].uncertainty < 1)
+			accepted.push_back(i);
+	}
+	MatrixXf H(accepted.size(), stateSize);
+	VectorXf inverseUncertainty(accepted.size());
+	VectorXf displacement(accepted.size());
+	for(uint i = 0; i < accepted.size(); ++i) {
+		H.row(i) = measurementMatrix.row(accepted[i]);
+		inverseUncertainty(i) = 1.0f/measurements[accepted[i]].uncertainty;
+		displacement(i) = measurements[accepted[i]].displacement;
+	}
+	MatrixXf RH = inverseUncertainty.asDiagonal()*H;
+	MatrixXf HRH = H.transpose()*RH;
+	VectorXf HRv = RH.transpose()*displacement;
+
+	if(accepted.empty()) {
+		mInnovation = std::numeric_limits<float>::infinity();
+	} else {
+		const float acceptedFraction = (float)accepted.size() / nrOfMeasurements;
+		mInnovation = displacement.cwiseProduct(displacement).dot(inverseUncertainty) / accepted.size() / acceptedFraction;
+	}
+
+	// Update covariance and state
+	mPreviousState = mCurrentState;
+	mPreviousCovariance = mCurrentCovariance;
+	mCurrentCovariance = (mPredictedCovariance.inverse() + HRH).inverse();
+	mCurrentState = mPredictedState + mCurrentCovariance*HRv;
+	mCurrentState = shapeModel->restrictState(mCurrentState);
+
+	return mInnovation;
+}
+
+VectorXf KalmanFilterState::getCurrentState() const {
+	return mCurrentState;
+}
+
+VectorXf KalmanFilterState::getPredictedState() const {
+	return mPredictedState;
+}
+
+float KalmanFilterState::getInnovation() const {
+	return mInnovation;
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef KALMAN_FILTER_STATE_HPP
+#define KALMAN_FILTER_STATE_HPP
+
+#include "AppearanceModel.hpp"
+#include "ShapeModel.hpp"
+
+namespace fast {
+
+/**
+ * The state and covariance of one Kalman filter, with the predict and update steps.
+ * This is used by KalmanFilter for its single state, and by KalmanFilterTracker for each object and hypothesis.
+ */
+class FAST_EXPORT  KalmanFilterState {
+	public:
+		KalmanFilterState();
+		explicit KalmanFilterState(VectorXf initialState);
+		/**
+		 * Use the temporal/motion model of the shape model to predict the next state and covariance
+		 * @param shapeModel
+		 */
+		void predict(ShapeModel::pointer shapeModel);
+		/**
+		 * Assimilate the measurements of the predicted shape into the state, using only the measurements which
+		 * are certain enough.
+		 * @param shapeModel
+		 * @param measurements
+		 * @param measurementMatrix one row per measurement, see ShapeModel::getMeasurementMatrix
+		 * @return the innovation of the update, see getInnovation
+		 */
+		float update(ShapeModel::pointer shapeModel, const std::vector<Measurement>& measurements, const MatrixXf& measurementMatrix);
+		VectorXf getCurrentState() const;
+		VectorXf getPredictedState() const;
+		/**
+		 * The normalized innovation squared of the last update, averaged over the accepted measurements and divided by
+		 * the fraction of measurements which were accepted. Low values mean that the predicted shape fits the image
+		 * well. Infinite if no measurements were accepted.
+		 */
+		float getInnovation() const;
+	private:
+		VectorXf mCurrentState;
+		VectorXf mPreviousState;
+		VectorXf mDefaultState;
+		VectorXf mPredictedState;
+
+		MatrixXf mCurrentCovariance;
+		MatrixXf mPreviousCovariance;
+		MatrixXf mPredictedCovariance;
+
+		float mInnovation;
+};
+
+} // end namespace fast
+
+#endif
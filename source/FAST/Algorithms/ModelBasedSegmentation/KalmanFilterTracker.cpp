@@ -0,0 +1,250 @@
+#include "KalmanFilterTracker.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Mesh.hpp"
+#include "Shape.hpp"
+#include <algorithm>
+
+namespace fast {
+
+KalmanFilterTracker::KalmanFilterTracker() {
+	createInputPort<Image>(0);
+
+	mInitialized = false;
+	mStartIterations = 20;
+	mIterations = 5;
+	mPruningFactor = 2;
+	mMaximumNrOfHypotheses = 0;
+}
+
+int KalmanFilterTracker::addObject(ShapeModel::pointer shapeModel, AppearanceModel::pointer appearanceModel) {
+	if(!shapeModel.isValid() || !appearanceModel.isValid())
+		throw Exception("Shape and appearance model must be given when adding an object to the Kalman filter tracker.");
+
+	TrackedObject object;
+	object.shapeModel = shapeModel;
+	object.appearanceModel = appearanceModel;
+	mObjects.push_back(object);
+	const int objectNr = mObjects.size() - 1;
+	createOutputPort<Mesh>(objectNr);
+	mInitialized = false;
+	mIsModified = true;
+	return objectNr;
+}
+
+void KalmanFilterTracker::addHypothesis(int objectNr, VectorXf initialState) {
+	validateObjectNr(objectNr);
+	mObjects[objectNr].initialStates.push_back(initialState);
+	mInitialized = false;
+	mIsModified = true;
+}
+
+void KalmanFilterTracker::setIterations(int iterations) {
+	if(iterations <= 0)
+		throw Exception("Kalman filter iterations must be > 0");
+
+	mIterations = iterations;
+}
+
+void KalmanFilterTracker::setStartIterations(int iterations) {
+	if(iterations <= 0)
+		throw Exception("Kalman filter iterations must be > 0");
+
+	mStartIterations = iterations;
+}
+
+void KalmanFilterTracker::setPruningFactor(float factor) {
+	if(factor < 1)
+		throw Exception("Pruning factor must be >= 1 in the Kalman filter tracker");
+
+	mPruningFactor = factor;
+	mIsModified = true;
+}
+
+void KalmanFilterTracker::setMaximumNrOfHypotheses(int hypotheses) {
+	if(hypotheses < 0)
+		throw Exception("Maximum nr of hypotheses must be >= 0 in the Kalman filter tracker");
+
+	mMaximumNrOfHypotheses = hypotheses;
+	mIsModified = true;
+}
+
+int KalmanFilterTracker::getNrOfObjects() const {
+	return mObjects.size();
+}
+
+int KalmanFilterTracker::getNrOfHypotheses(int objectNr) const {
+	validateObjectNr(objectNr);
+	if(!mInitialized)
+		return std::max<int>(mObjects[objectNr].initialStates.size(), 1);
+
+	int count = 0;
+	for(const Hypothesis& hypothesis : mHypotheses) {
+		if(hypothesis.objectNr == objectNr)
+			count++;
+	}
+	return count;
+}
+
+VectorXf KalmanFilterTracker::getCurrentState(int objectNr) const {
+	validateObjectNr(objectNr);
+	if(!mInitialized)
+		throw Exception("Can't get current state before first execute in Kalman filter tracker.");
+	return mHypotheses[getBestHypothesis(objectNr)].state.getCurrentState();
+}
+
+DataPort::pointer KalmanFilterTracker::getSegmentationOutputPort(int objectNr) {
+	validateObjectNr(objectNr);
+	return getOutputPort(objectNr);
+}
+
+void KalmanFilterTracker::validateObjectNr(int objectNr) const {
+	if(objectNr < 0 || objectNr >= mObjects.size())
+		throw Exception("Object nr " + std::to_string(objectNr) + " does not exist in the Kalman filter tracker");
+}
+
+void KalmanFilterTracker::initialize(SharedPointer<Image> image) {
+	mHypotheses.clear();
+	for(int objectNr = 0; objectNr < mObjects.size(); ++objectNr) {
+		TrackedObject& object = mObjects[objectNr];
+		std::vector<VectorXf> initialStates = object.initialStates;
+		if(initialStates.empty())
+			initialStates.push_back(object.shapeModel->getInitialState(image));
+		for(const VectorXf& initialState : initialStates) {
+			Hypothesis hypothesis;
+			hypothesis.objectNr = objectNr;
+			hypothesis.state = KalmanFilterState(initialState);
+			mHypotheses.push_back(hypothesis);
+		}
+	}
+	updateGroups();
+	mInitialized = true;
+}
+
+void KalmanFilterTracker::updateGroups() {
+	mShapeModelGroups.clear();
+	mAppearanceModelGroups.clear();
+	std::vector<ShapeModel::pointer> shapeModels;
+	std::vector<AppearanceModel::pointer> appearanceModels;
+	for(int i = 0; i < mHypotheses.size(); ++i) {
+		TrackedObject& object = mObjects[mHypotheses[i].objectNr];
+		int group = 0;
+		while(group < shapeModels.size() && !(shapeModels[group] == object.shapeModel))
+			group++;
+		if(group == shapeModels.size()) {
+			shapeModels.push_back(object.shapeModel);
+			mShapeModelGroups.push_back(std::vector<int>());
+		}
+		mShapeModelGroups[group].push_back(i);
+
+		group = 0;
+		while(group < appearanceModels.size() && !(appearanceModels[group] == object.appearanceModel))
+			group++;
+		if(group == appearanceModels.size()) {
+			appearanceModels.push_back(object.appearanceModel);
+			mAppearanceModelGroups.push_back(std::vector<int>());
+		}
+		mAppearanceModelGroups[group].push_back(i);
+	}
+}
+
+int KalmanFilterTracker::getBestHypothesis(int objectNr) const {
+	int best = -1;
+	for(int i = 0; i < mHypotheses.size(); ++i) {
+		if(mHypotheses[i].objectNr != objectNr)
+			continue;
+		if(best == -1 || mHypotheses[i].state.getInnovation() < mHypotheses[best].state.getInnovation())
+			best = i;
+	}
+	return best;
+}
+
+void KalmanFilterTracker::prune() {
+	std::vector<Hypothesis> keptHypotheses;
+	for(int objectNr = 0; objectNr < mObjects.size(); ++objectNr) {
+		std::vector<int> hypotheses;
+		for(int i = 0; i < mHypotheses.size(); ++i) {
+			if(mHypotheses[i].objectNr == objectNr)
+				hypotheses.push_back(i);
+		}
+		std::stable_sort(hypotheses.begin(), hypotheses.end(), [this](int a, int b) {
+			return mHypotheses[a].state.getInnovation() < mHypotheses[b].state.getInnovation();
+		});
+
+		// The best hypothesis is always kept
+		const float limit = mHypotheses[hypotheses[0]].state.getInnovation()*mPruningFactor;
+		for(int i = 0; i < hypotheses.size(); ++i) {
+			if(mMaximumNrOfHypotheses > 0 && i >= mMaximumNrOfHypotheses)
+				break;
+			if(i > 0 && !(mHypotheses[hypotheses[i]].state.getInnovation() <= limit))
+				break;
+			keptHypotheses.push_back(mHypotheses[hypotheses[i]]);
+		}
+	}
+	if(keptHypotheses.size() != mHypotheses.size()) {
+		FAST_REPORT(reportInfo(), "Pruned " << mHypotheses.size() - keptHypotheses.size() << " hypotheses in Kalman filter tracker");
+		mHypotheses = keptHypotheses;
+		updateGroups();
+	}
+}
+
+void KalmanFilterTracker::execute() {
+	if(mObjects.empty())
+		throw Exception("At least one object must be added to the Kalman filter tracker before execution.");
+
+	Image::pointer image = getInputData<Image>();
+	ExecutionDevice::pointer device = getMainDevice();
+
+	int counter = mIterations;
+	if(!mInitialized) {
+		initialize(image);
+		counter = mStartIterations;
+	}
+
+	const int nrOfHypotheses = mHypotheses.size();
+	while(counter--) {
+		#pragma omp parallel for
+		for(int i = 0; i < nrOfHypotheses; ++i)
+			mHypotheses[i].state.predict(mObjects[mHypotheses[i].objectNr].shapeModel);
+
+		// Create the predicted shapes with one call for each shape model
+		std::vector<Shape::pointer> shapes(nrOfHypotheses);
+		for(const std::vector<int>& group : mShapeModelGroups) {
+			std::vector<VectorXf> states;
+			for(int i : group)
+				states.push_back(mHypotheses[i].state.getPredictedState());
+			std::vector<Shape::pointer> groupShapes = mObjects[mHypotheses[group[0]].objectNr].shapeModel->getShapes(states);
+			for(int j = 0; j < group.size(); ++j)
+				shapes[group[j]] = groupShapes[j];
+		}
+
+		// Sample the shapes with one call for each appearance model
+		std::vector<std::vector<Measurement>> measurements(nrOfHypotheses);
+		for(const std::vector<int>& group : mAppearanceModelGroups) {
+			std::vector<Shape::pointer> groupShapes;
+			for(int i : group)
+				groupShapes.push_back(shapes[i]);
+			std::vector<std::vector<Measurement>> groupMeasurements =
+					mObjects[mHypotheses[group[0]].objectNr].appearanceModel->getMeasurementsOfShapes(image, groupShapes, device);
+			for(int j = 0; j < group.size(); ++j)
+				measurements[group[j]] = std::move(groupMeasurements[j]);
+		}
+
+		#pragma omp parallel for
+		for(int i = 0; i < nrOfHypotheses; ++i) {
+			ShapeModel::pointer shapeModel = mObjects[mHypotheses[i].objectNr].shapeModel;
+			MatrixXf measurementMatrix = shapeModel->getMeasurementMatrix(mHypotheses[i].state.getPredictedState(), shapes[i]);
+			mHypotheses[i].state.update(shapeModel, measurements[i], measurementMatrix);
+		}
+	}
+
+	prune();
+
+	for(int objectNr = 0; objectNr < mObjects.size(); ++objectNr) {
+		const VectorXf state = mHypotheses[getBestHypothesis(objectNr)].state.getCurrentState();
+		FAST_REPORT(reportInfo(), "Current state of object " << objectNr << ": " << state.transpose());
+		Shape::pointer shape = mObjects[objectNr].shapeModel->getShape(state);
+		addOutputData(objectNr, shape->getMesh());
+	}
+}
+
+}
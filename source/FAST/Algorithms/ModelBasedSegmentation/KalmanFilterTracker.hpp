@@ -0,0 +1,106 @@
+#ifndef KALMAN_FILTER_TRACKER_HPP
+#define KALMAN_FILTER_TRACKER_HPP
+
+#include "FAST/ProcessObject.hpp"
+#include "AppearanceModel.hpp"
+#include "ShapeModel.hpp"
+#include "KalmanFilterState.hpp"
+
+namespace fast {
+
+class Image;
+class Mesh;
+
+/**
+ * Tracks several objects in the same image, each with one or more state hypotheses, using Kalman filters.
+ *
+ * In each iteration all hypotheses are predicted in parallel, the predicted shapes of each shape model are created
+ * together, and the shapes of all hypotheses which share an appearance model are sampled in one call to
+ * AppearanceModel::getMeasurementsOfShapes, so that the image is only transferred and accessed once per iteration.
+ * The states are then updated in parallel.
+ *
+ * After the iterations of each frame, the hypotheses of each object are pruned by innovation: hypotheses with an
+ * innovation larger than the pruning factor times the lowest innovation of the object are removed, and only the
+ * maximum nr of hypotheses with the lowest innovations are kept. The segmentation of an object is the shape of its
+ * hypothesis with the lowest innovation.
+ *
+ * Shape models and appearance models may be shared between objects.
+ * The measurement matrix of a shape model must be safe to calculate for different shapes in parallel.
+ */
+class FAST_EXPORT  KalmanFilterTracker : public ProcessObject {
+	FAST_OBJECT(KalmanFilterTracker)
+	public:
+		/**
+		 * Add an object to track
+		 * @param shapeModel
+		 * @param appearanceModel
+		 * @return the object nr, which is also the nr of the output port of its segmentation
+		 */
+		int addObject(ShapeModel::pointer shapeModel, AppearanceModel::pointer appearanceModel);
+		/**
+		 * Add an initial state hypothesis of an object. If an object has no hypotheses, the initial state of its
+		 * shape model is used. Adding objects or hypotheses restarts the tracking at the next execute.
+		 * @param objectNr
+		 * @param initialState
+		 */
+		void addHypothesis(int objectNr, VectorXf initialState);
+		void setIterations(int iterations);
+		/**
+		 * Set nr of iterations for the first frame
+		 * @param iterations
+		 */
+		void setStartIterations(int iterations);
+		/**
+		 * Hypotheses with an innovation larger than this factor times the lowest innovation of the object are removed.
+		 * Default is 2.
+		 * @param factor
+		 */
+		void setPruningFactor(float factor);
+		/**
+		 * Set maximum nr of hypotheses to keep for each object after each frame. Default is 0, which is no limit.
+		 * @param hypotheses
+		 */
+		void setMaximumNrOfHypotheses(int hypotheses);
+		int getNrOfObjects() const;
+		int getNrOfHypotheses(int objectNr) const;
+		/**
+		 * @param objectNr
+		 * @return current state of the hypothesis of the object with the lowest innovation
+		 */
+		VectorXf getCurrentState(int objectNr) const;
+		DataPort::pointer getSegmentationOutputPort(int objectNr);
+	private:
+		KalmanFilterTracker();
+		void execute();
+		void initialize(SharedPointer<Image> image);
+		void prune();
+		void updateGroups();
+		int getBestHypothesis(int objectNr) const;
+		void validateObjectNr(int objectNr) const;
+
+		struct TrackedObject {
+			ShapeModel::pointer shapeModel;
+			AppearanceModel::pointer appearanceModel;
+			std::vector<VectorXf> initialStates;
+		};
+		struct Hypothesis {
+			int objectNr;
+			KalmanFilterState state;
+		};
+
+		std::vector<TrackedObject> mObjects;
+		std::vector<Hypothesis> mHypotheses;
+		// Indices of the hypotheses which share a shape model, and which share an appearance model
+		std::vector<std::vector<int>> mShapeModelGroups;
+		std::vector<std::vector<int>> mAppearanceModelGroups;
+
+		bool mInitialized;
+		int mIterations;
+		int mStartIterations;
+		float mPruningFactor;
+		int mMaximumNrOfHypotheses;
+};
+
+} // end namespace fast
+
+#endif
@@ -24,6 +24,31 @@ class FAST_EXPORT  ShapeModel : public Object {
 		virtual VectorXf getInitialState(SharedPointer<Image> image) = 0;
 		virtual std::vector<MatrixXf> getMeasurementVectors(VectorXf state, Shape::pointer shape) = 0;
 		virtual VectorXf restrictState(VectorXf state) { return state; };
+		/**
+		 * Get the shapes of several states. Models which can evaluate the states together override this.
+		 * @param states
+		 * @return
+		 */
+		virtual std::vector<Shape::pointer> getShapes(const std::vector<VectorXf>& states) {
+			std::vector<Shape::pointer> shapes;
+			for(const VectorXf& state : states)
+				shapes.push_back(getShape(state));
+			return shapes;
+		};
+		/**
+		 * Get the measurement vectors as the rows of one matrix, with one row per measurement.
+		 * Models which can create this matrix directly override this.
+		 * @param state
+		 * @param shape
+		 * @return
+		 */
+		virtual MatrixXf getMeasurementMatrix(VectorXf state, Shape::pointer shape) {
+			std::vector<MatrixXf> vectors = getMeasurementVectors(state, shape);
+			MatrixXf matrix(vectors.size(), state.size());
+			for(int i = 0; i < vectors.size(); ++i)
+				matrix.row(i) = vectors[i].row(0);
+			return matrix;
+		};
 	private:
 
 };
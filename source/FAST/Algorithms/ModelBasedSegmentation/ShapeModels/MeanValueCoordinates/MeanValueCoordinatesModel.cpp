@@ -10,78 +10,13 @@ MeanValueCoordinatesModel::MeanValueCoordinatesModel() {
 	mInitialTranslation = Vector3f::Zero();
 	mGlobalProcessError = 0.01;
 	mLocalProcessError = 0.000001;
+	mWeightPruningThreshold = 0;
 }
 
 inline float sign(float v) {
     return v < 0.0f ? -1.0f : 1.0f;
 }
 
-std::vector<MeshVertex> MeanValueCoordinatesModel::getDeformedVertices(
-        const std::vector<Vector3f>& displacements) {
-    MeshAccess::pointer modelMeshAccess = mSurfaceMesh->getMeshAccess(ACCESS_READ);
-    std::vector<MeshVertex> vertices = modelMeshAccess->getVertices();
-    MeshAccess::pointer controlMeshAccess = mControlMesh->getMeshAccess(ACCESS_READ);
-    std::vector<MeshVertex> nodes = controlMeshAccess->getVertices();
-
-    if(displacements.size() != mControlMesh->getNrOfVertices()) {
-        throw Exception("The number of displacements is not equal to the number of control nodes.");
-    }
-    // Get original vertices from the model mesh
-    std::vector<MeshVertex> newVertices;
-
-    // Deform these vertices using the weights and displacement vector
-    Vector3f* controlNodes = new Vector3f[nodes.size()];
-    // TODO this loop could be run in parallel
-    for(int i = 0; i < nodes.size(); i++) {
-        controlNodes[i] = (nodes[i].getPosition() + displacements[i]);
-    }
-
-    for(uint i = 0; i < vertices.size(); i++) {
-        Vector3f newVertex(0,0,0);
-        for(uint j = 0; j < nodes.size(); j++) {
-            newVertex = newVertex + controlNodes[j]*getNormalizedWeight(i, j);
-        }
-        MeshVertex v(newVertex);
-        newVertices.push_back(v);
-    }
-    delete[] controlNodes;
-
-    // Calculate new normals
-    // TODO this loop could be run in parallel
-    for(int i = 0; i < vertices.size(); i++) {
-        // Find the normal of all triangles
-        std::vector<uint> triangles = mModelVertexTrianglesMap[i];//vertices[i].getConnections();
-        Vector3f average = Vector3f::Constant(0);
-        int counter = 0;
-        for(int j = 0; j < triangles.size(); j++) {
-            MeshTriangle triangle = modelMeshAccess->getTriangle(triangles[j]);
-            Vector3f a;
-            Vector3f b;
-            if(triangle.getEndpoint1() == i) {
-                a = newVertices[triangle.getEndpoint2()].getPosition()-newVertices[i].getPosition();
-                b = newVertices[triangle.getEndpoint3()].getPosition()-newVertices[i].getPosition();
-            } else if(triangle.getEndpoint2() == i) {
-                a = newVertices[triangle.getEndpoint1()].getPosition()-newVertices[i].getPosition();
-                b = newVertices[triangle.getEndpoint3()].getPosition()-newVertices[i].getPosition();
-            } else {
-                a = newVertices[triangle.getEndpoint1()].getPosition()-newVertices[i].getPosition();
-                b = newVertices[triangle.getEndpoint2()].getPosition()-newVertices[i].getPosition();
-            }
-            Vector3f faceNormal = a.cross(b);
-            faceNormal.normalize();
-            // Have to make sure that all the normals are pointing out of the object
-            float direction = sign(faceNormal.dot(vertices[i].getNormal()));
-            average = average + faceNormal*direction;
-            counter++;
-        }
-        average = average / counter;
-        average.normalize();
-        newVertices[i].setNormal(average);
-    }
-
-    return newVertices;
-}
-
 void MeanValueCoordinatesModel::loadMeshes(std::string surfaceMeshFilename, std::string controlMeshFilename) {
 	VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
 	importer->setFilename(surfaceMeshFilename);
@@ -102,12 +37,11 @@ void MeanValueCoordinatesModel::loadMeshes(Mesh::pointer surfaceMesh,
 		Mesh::pointer controlMesh) {
 	mSurfaceMesh = surfaceMesh;
 	mControlMesh = controlMesh;
-    const float epsilon = 0.00001f;
 
 	MeshAccess::pointer access = mSurfaceMesh->getMeshAccess(ACCESS_READ);
     MeshAccess::pointer access2 = mControlMesh->getMeshAccess(ACCESS_READ);
-    std::vector<MeshVertex> nodes = access2->getVertices();
-    mStateSize = 9 + nodes.size()*3;
+    const uint nrOfNodes = mControlMesh->getNrOfVertices();
+    mStateSize = 9 + nrOfNodes*3;
 
     // Create state transition matrices
     const float dampening = 0.5;
@@ -151,48 +85,48 @@ void MeanValueCoordinatesModel::loadMeshes(Mesh::pointer surfaceMesh,
     }
 
 
-	// Calculate weights
-    // Calculate the weights using the original vertices of the model
-    std::vector<MeshVertex> vertices = getOriginalVertices();
-
-    // Calculate vertex triangle maps
-    std::vector<MeshTriangle> triangles = access->getTriangles();
-    for(uint i = 0; i < triangles.size(); ++i) {
-        MeshTriangle triangle = triangles[i];
-        mModelVertexTrianglesMap[triangle.getEndpoint1()].push_back(i);
-        mModelVertexTrianglesMap[triangle.getEndpoint2()].push_back(i);
-        mModelVertexTrianglesMap[triangle.getEndpoint3()].push_back(i);
-    }
-    triangles = access2->getTriangles();
-    for(uint i = 0; i < triangles.size(); ++i) {
-        MeshTriangle triangle = triangles[i];
-        mControlVertexTrianglesMap[triangle.getEndpoint1()].push_back(i);
-        mControlVertexTrianglesMap[triangle.getEndpoint2()].push_back(i);
-        mControlVertexTrianglesMap[triangle.getEndpoint3()].push_back(i);
+    // Keep the positions and triangles in contiguous arrays, since they are used for every shape
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> Positions;
+    const uint nrOfVertices = mSurfaceMesh->getNrOfVertices();
+    mVertexPositions = Eigen::Map<const Positions>(access->getCoordinateArray().data(), nrOfVertices, 3);
+    if(access->getNormalArray().empty()) {
+        mVertexNormals = MatrixXf::Zero(nrOfVertices, 3);
+    } else {
+        mVertexNormals = Eigen::Map<const Positions>(access->getNormalArray().data(), nrOfVertices, 3);
     }
+    mControlNodePositions = Eigen::Map<const Positions>(access2->getCoordinateArray().data(), nrOfNodes, 3);
+    mSurfaceTriangles = access->getTriangleArray();
+    mCentroid = mVertexPositions.colwise().mean().transpose();
 
-    // Allocate memory for the weights
-    mNormalizedWeights = UniquePointer<float[]>(new float[vertices.size()*(mControlMesh->getNrOfTriangles()*3)]());
-    mNormalizedWeightsPerNode = UniquePointer<float[]>(new float[vertices.size()*mControlMesh->getNrOfVertices()]);
+    calculateWeights(access2->getTriangleArray());
+    reportInfo() << "Finished loading meshes in mean value coordinates model, " << mWeights.nonZeros() <<
+        " weights of " << nrOfVertices*nrOfNodes << " are used" << reportEnd();
+}
 
-    mCentroid = Vector3f::Zero();
-    for(int vertexNr = 0; vertexNr < vertices.size(); vertexNr++) {
-        MeshVertex x = vertices[vertexNr];
-        mCentroid += x.getPosition();
-        float totalWeight = 0.0f; // Total weight for this vertex
-        float * distances = new float[nodes.size()];
-        Vector3f* u = new Vector3f[nodes.size()];
-        for(int j = 0; j < nodes.size(); j++) {
-            distances[j] = (x.getPosition()-nodes[j].getPosition()).norm();
-            Vector3f newPos = (nodes[j].getPosition() - x.getPosition()) / distances[j];
-            u[j] = Vector3f(newPos(0),newPos(1),newPos(2));
+void MeanValueCoordinatesModel::calculateWeights(const std::vector<uint>& controlTriangles) {
+    const float epsilon = 0.00001f;
+    const int nrOfVertices = mVertexPositions.rows();
+    const int nrOfNodes = mControlNodePositions.rows();
+
+    // The weights of each vertex are calculated independently, and stored as one row of a sparse matrix
+    std::vector<std::vector<Eigen::Triplet<float>>> rows(nrOfVertices);
+    #pragma omp parallel for
+    for(int vertexNr = 0; vertexNr < nrOfVertices; vertexNr++) {
+        const Vector3f x = mVertexPositions.row(vertexNr).transpose();
+        VectorXf distances(nrOfNodes);
+        std::vector<Vector3f> u(nrOfNodes);
+        for(int j = 0; j < nrOfNodes; j++) {
+            const Vector3f node = mControlNodePositions.row(j).transpose();
+            distances[j] = (x - node).norm();
+            u[j] = (node - x) / distances[j];
         }
 
-        for(int t = 0; t < mControlMesh->getNrOfTriangles(); t++) {
-            MeshTriangle triangle = access2->getTriangle(t);
-            const int t1 = triangle.getEndpoint1();
-            const int t2 = triangle.getEndpoint2();
-            const int t3 = triangle.getEndpoint3();
+        VectorXf weights = VectorXf::Zero(nrOfNodes);
+        float totalWeight = 0.0f; // Total weight for this vertex
+        for(int t = 0; t < controlTriangles.size(); t += 3) {
+            const int t1 = controlTriangles[t];
+            const int t2 = controlTriangles[t+1];
+            const int t3 = controlTriangles[t+2];
 
             const float l1 = (u[t2]-u[t3]).norm();
             const float l2 = (u[t3]-u[t1]).norm();
@@ -244,33 +178,37 @@ void MeanValueCoordinatesModel::loadMeshes(Mesh::pointer surfaceMesh,
                 weight2 = (theta2-c3*theta1-c1*theta3)/(distances[t2]*sin(theta3)*s1);
                 weight3 = (theta3-c1*theta2-c2*theta1)/(distances[t3]*sin(theta1)*s2);
             }
-            setNormalizedWeight(vertexNr, t, 0, weight1);
-            setNormalizedWeight(vertexNr, t, 1, weight2);
-            setNormalizedWeight(vertexNr, t, 2, weight3);
+            // The weight of a control node is the sum of its weights in all triangles
+            weights[t1] += weight1;
+            weights[t2] += weight2;
+            weights[t3] += weight3;
             totalWeight += weight1 + weight2 + weight3;
         } // for each triangle
-        delete[] distances;
-        delete[] u;
 
         // Normalize the weight using totalWeight
-        for(int t = 0; t < mControlMesh->getNrOfTriangles(); t++) {
-            setNormalizedWeight(vertexNr, t, 0, getNormalizedWeight(vertexNr, t, 0) / totalWeight);
-            setNormalizedWeight(vertexNr, t, 1, getNormalizedWeight(vertexNr, t, 1) / totalWeight);
-            setNormalizedWeight(vertexNr, t, 2, getNormalizedWeight(vertexNr, t, 2) / totalWeight);
+        weights /= totalWeight;
+
+        if(mWeightPruningThreshold > 0) {
+            float remainingWeight = 0.0f;
+            for(int j = 0; j < nrOfNodes; j++) {
+                if(fabs(weights[j]) < mWeightPruningThreshold)
+                    weights[j] = 0.0f;
+                remainingWeight += weights[j];
+            }
+            weights /= remainingWeight;
         }
-    } // for each vertex in the model mesh
 
-
-    // Do some caching
-    for(int vertexNr = 0; vertexNr < vertices.size(); vertexNr++) {
-        for(int nodeNr = 0; nodeNr < nodes.size(); nodeNr++) {
-            setNormalizedWeightPerNode(vertexNr, nodeNr);
+        for(int j = 0; j < nrOfNodes; j++) {
+            if(weights[j] != 0.0f)
+                rows[vertexNr].push_back(Eigen::Triplet<float>(vertexNr, j, weights[j]));
         }
-    }
+    } // for each vertex in the model mesh
 
-    // Calculate centroid
-    mCentroid /= vertices.size();
-    reportInfo() << "Finished loading meshes in mean value coordinates model" << reportEnd();
+    std::vector<Eigen::Triplet<float>> triplets;
+    for(const auto& row : rows)
+        triplets.insert(triplets.end(), row.begin(), row.end());
+    mWeights = Eigen::SparseMatrix<float, Eigen::RowMajor>(nrOfVertices, nrOfNodes);
+    mWeights.setFromTriplets(triplets.begin(), triplets.end());
 }
 
 void MeanValueCoordinatesModel::assertLoadedMeshes() {
@@ -278,11 +216,6 @@ void MeanValueCoordinatesModel::assertLoadedMeshes() {
 		throw Exception("Must load surface and control mesh before using mean value coordinates model.");
 }
 
-std::vector<MeshVertex> MeanValueCoordinatesModel::getOriginalVertices() {
-    MeshAccess::pointer access = mSurfaceMesh->getMeshAccess(ACCESS_READ);
-    return access->getVertices();
-}
-
 VectorXf MeanValueCoordinatesModel::getState(Vector3f translation, Vector3f scale, Vector3f rotation) {
 	assertLoadedMeshes();
 
@@ -300,145 +233,128 @@ VectorXf MeanValueCoordinatesModel::getState(Vector3f translation, Vector3f scal
 	return state;
 }
 
-Shape::pointer MeanValueCoordinatesModel::getShape(VectorXf state) {
-	assertLoadedMeshes();
-
-	// Deform surface mesh using the state and control mesh
-    /* Local transformation */
-    std::vector<MeshVertex> pL;
-	std::vector<Vector3f> displacements;
-	for(int i = 9; i < state.size(); i += 3) {
-		Vector3f displacement(state(i), state(i+1), state(i+2));
-		displacements.push_back(displacement);
-	}
-
-	pL = getDeformedVertices(displacements);
-
-    // Calculate centroid of pL
-    Vector3f c = Vector3f::Zero();
-    int nrOfNans = 0;
-    for(int i = 0; i < pL.size(); i++) {
-    	Vector3f position = pL[i].getPosition();
-        if(std::isnan(position.x()) || std::isnan(position.y()) || std::isnan(position.z())) {
-            nrOfNans++;
-            continue;
-        }
-        c = c + position;
-    }
-    c = c / (pL.size()-nrOfNans);
-
-    /* Global transformation */
+Matrix3f MeanValueCoordinatesModel::getRotationAndScaling(const VectorXf& state) {
     Vector3f rotation(state(6), state(7), state(8));
 
     // Create transformation matrices, source: http://en.wikipedia.org/wiki/Rotation_matrix
-    Matrix4f Rx = Matrix4f::Constant(0.0f);
+    Matrix3f Rx = Matrix3f::Constant(0.0f);
     Rx(0,0) = 1.0f;
     Rx(1,1) = cos(rotation.x());
     Rx(1,2) = -sin(rotation.x());
     Rx(2,1) = sin(rotation.x());
     Rx(2,2) = cos(rotation.x());
-    Rx(3,3) = 1.0f;
 
-    Matrix4f Ry = Matrix4f::Constant(0.0f);
+    Matrix3f Ry = Matrix3f::Constant(0.0f);
     Ry(0,0) = cos(rotation.y());
     Ry(0,2) = sin(rotation.y());
     Ry(1,1) = 1.0f;
     Ry(2,0) = -sin(rotation.y());
     Ry(2,2) = cos(rotation.y());
-    Ry(3,3) = 1.0f;
 
-    Matrix4f Rz = Matrix4f::Constant(0.0f);
+    Matrix3f Rz = Matrix3f::Constant(0.0f);
     Rz(0,0) = cos(rotation.z());
     Rz(0,1) = -sin(rotation.z());
     Rz(1,0) = sin(rotation.z());
     Rz(1,1) = cos(rotation.z());
     Rz(2,2) = 1.0f;
-    Rz(3,3) = 1.0f;
 
-    Matrix4f S = Matrix4f::Constant(0.0f);
+    Matrix3f S = Matrix3f::Constant(0.0f);
     S(0,0) = state(3);
     S(1,1) = state(4);
     S(2,2) = state(5);
-    S(3,3) = 1.0f;
 
+    return Rz*Ry*Rx*S;
+}
+
+Shape::pointer MeanValueCoordinatesModel::getShape(VectorXf state) {
+    return getShapes({state})[0];
+}
+
+std::vector<Shape::pointer> MeanValueCoordinatesModel::getShapes(const std::vector<VectorXf>& states) {
+	assertLoadedMeshes();
+
+    /* Local transformation */
+    // Deform the control mesh of every state, and put the control nodes of each state in 3 columns
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> Displacements;
+    const int nrOfNodes = mControlNodePositions.rows();
+    MatrixXf controlNodes(nrOfNodes, states.size()*3);
+    for(int i = 0; i < states.size(); ++i) {
+        if(states[i].size() != mStateSize)
+            throw Exception("The number of displacements is not equal to the number of control nodes.");
+        controlNodes.middleCols(i*3, 3) = mControlNodePositions + Eigen::Map<const Displacements>(states[i].data() + 9, nrOfNodes, 3);
+    }
+
+    // Deform the surface mesh of all states with one sparse matrix product
+    const MatrixXf deformedVertices = mWeights*controlNodes;
+
+    std::vector<Shape::pointer> shapes;
+    for(int i = 0; i < states.size(); ++i)
+        shapes.push_back(createShape(states[i], deformedVertices.middleCols(i*3, 3)));
+    return shapes;
+}
+
+Shape::pointer MeanValueCoordinatesModel::createShape(const VectorXf& state, const MatrixXf& deformedVertices) {
+    const int nrOfVertices = deformedVertices.rows();
+
+    // Calculate new normals as the average of the normals of the triangles of each vertex.
+    // Have to make sure that all the normals are pointing out of the object, as the original normals.
+    MatrixXf normals = MatrixXf::Zero(nrOfVertices, 3);
+    for(int i = 0; i < mSurfaceTriangles.size(); i += 3) {
+        const uint endpoints[3] = {mSurfaceTriangles[i], mSurfaceTriangles[i+1], mSurfaceTriangles[i+2]};
+        const Vector3f a = (deformedVertices.row(endpoints[1]) - deformedVertices.row(endpoints[0])).transpose();
+        const Vector3f b = (deformedVertices.row(endpoints[2]) - deformedVertices.row(endpoints[0])).transpose();
+        Vector3f faceNormal = a.cross(b);
+        faceNormal.normalize();
+        for(uint endpoint : endpoints) {
+            const float direction = sign(faceNormal.dot(mVertexNormals.row(endpoint).transpose()));
+            normals.row(endpoint) += direction*faceNormal.transpose();
+        }
+    }
+    normals.rowwise().normalize();
+
+    // Calculate centroid of the deformed vertices
+    Vector3f c = Vector3f::Zero();
+    int nrOfNans = 0;
+    for(int i = 0; i < nrOfVertices; i++) {
+    	Vector3f position = deformedVertices.row(i).transpose();
+        if(std::isnan(position.x()) || std::isnan(position.y()) || std::isnan(position.z())) {
+            nrOfNans++;
+            continue;
+        }
+        c = c + position;
+    }
+    c = c / (nrOfVertices-nrOfNans);
+
+    /* Global transformation */
     // TODO: fix this transformation
     // TODO: have to use centroid etc.
-    Matrix4f RS = Rz*Ry*Rx*S;
+    Matrix4f RS = Matrix4f::Identity();
+    RS.block<3,3>(0,0) = getRotationAndScaling(state);
     Vector4f centroid(c.x(), c.y(), c.z(), 1.0);
     Vector4f T(state(0), state(1), state(2), 1.0);
 
-    std::vector<MeshVertex> result;
-    for(int i = 0; i < pL.size(); i++) {
-        Vector3f ov = pL[i].getPosition();
-        Vector3f nv = pL[i].getNormal();
-
-        Vector4f v(ov(0), ov(1), ov(2), 1.0);
+    std::vector<float> coordinates(nrOfVertices*3);
+    std::vector<float> newNormals(nrOfVertices*3);
+    for(int i = 0; i < nrOfVertices; i++) {
+        Vector4f v(deformedVertices(i,0), deformedVertices(i,1), deformedVertices(i,2), 1.0);
         v = RS*(v-centroid) + centroid + T;
-        Vector4f n(nv(0), nv(1), nv(2), 1.0);
+        Vector4f n(normals(i,0), normals(i,1), normals(i,2), 1.0);
         n = RS*n;
         n.normalize();
-        MeshVertex newVertex(v.head(3), n.head(3));
-        result.push_back(newVertex);
+        for(int j = 0; j < 3; j++) {
+            coordinates[i*3 + j] = v(j);
+            newNormals[i*3 + j] = n(j);
+        }
     }
 
-    MeshAccess::pointer meshAccess = mSurfaceMesh->getMeshAccess(ACCESS_READ);
     Mesh::pointer mesh = Mesh::New();
-    mesh->create(result, {}, meshAccess->getTriangles());
+    mesh->create(std::move(coordinates), std::move(newNormals), std::vector<uint>(mSurfaceTriangles));
 	Shape::pointer shape = Shape::New();
 	shape->setMesh(mesh);
 
 	return shape;
 }
 
-void MeanValueCoordinatesModel::setNormalizedWeight(
-        const int vertexNr,
-        const int triangleNr,
-        const int triangleVertexNr,
-        float weight) {
-    mNormalizedWeights[vertexNr + (triangleNr*3+triangleVertexNr)*mSurfaceMesh->getNrOfVertices()] = weight;
-}
-
-float MeanValueCoordinatesModel::getNormalizedWeight(
-        const int vertexNr,
-        const int triangleNr,
-        const int triangleVertexNr) {
-    return mNormalizedWeights[vertexNr + (triangleNr*3+triangleVertexNr)*mSurfaceMesh->getNrOfVertices()];
-}
-
-float MeanValueCoordinatesModel::getNormalizedWeight(
-        const uint vertexNr,
-        const uint controlNodeNr) {
-    return mNormalizedWeightsPerNode[vertexNr + controlNodeNr*mSurfaceMesh->getNrOfVertices()];
-}
-
-void MeanValueCoordinatesModel::setNormalizedWeightPerNode(
-    const uint vertexNr,
-    const uint controlNodeNr
-    ) {
-   float weight = 0.0f;
-    // Go trough triangle vector
-    MeshAccess::pointer access = mControlMesh->getMeshAccess(ACCESS_READ);
-    MeshVertex controlNode = access->getVertex(controlNodeNr);
-    std::vector<uint> triangles = mControlVertexTrianglesMap[controlNodeNr];
-    for(int i = 0; i < triangles.size(); i++) {
-        uint t = triangles[i];
-        MeshTriangle triangle = access->getTriangle(t);
-
-        // For each occurence of controlNodeNr, get the weight
-        if(triangle.getEndpoint1() == controlNodeNr){
-            weight += getNormalizedWeight(vertexNr, t, 0);
-        }
-        if(triangle.getEndpoint2() == controlNodeNr){
-            weight += getNormalizedWeight(vertexNr, t, 1);
-        }
-        if(triangle.getEndpoint3() == controlNodeNr){
-            weight += getNormalizedWeight(vertexNr, t, 2);
-        }
-    }
-
-    mNormalizedWeightsPerNode[vertexNr + controlNodeNr*mSurfaceMesh->getNrOfVertices()] = weight;
-}
-
 MatrixXf MeanValueCoordinatesModel::getStateTransitionMatrix1() {
 	assertLoadedMeshes();
 
@@ -465,99 +381,71 @@ MatrixXf MeanValueCoordinatesModel::getProcessErrorMatrix() {
 
 std::vector<MatrixXf> MeanValueCoordinatesModel::getMeasurementVectors(
 		VectorXf state, Shape::pointer shape) {
+	const MatrixXf measurementMatrix = getMeasurementMatrix(state, shape);
+	std::vector<MatrixXf> result;
+	for(int j = 0; j < measurementMatrix.rows(); ++j)
+		result.push_back(measurementMatrix.row(j));
+
+	return result;
+}
+
+MatrixXf MeanValueCoordinatesModel::getMeasurementMatrix(
+		VectorXf state, Shape::pointer shape) {
 	assertLoadedMeshes();
 
-	Shape::pointer meshShape = shape;
-	Mesh::pointer mesh = meshShape->getMesh();
+	Mesh::pointer mesh = shape->getMesh();
 	MeshAccess::pointer meshAccess = mesh->getMeshAccess(ACCESS_READ);
-	MeshAccess::pointer originalMeshAccess = mSurfaceMesh->getMeshAccess(ACCESS_READ);
-	uint meshSize = mesh->getNrOfVertices();
+	const std::vector<float>& normals = meshAccess->getNormalArray();
+	const int meshSize = mesh->getNrOfVertices();
 
 	const Vector3f rotation(state(6), state(7), state(8));
     const Vector3f s(state(3), state(4), state(5)); // scaling
     const Vector3f cosine(cos(rotation(0)), cos(rotation(1)), cos(rotation(2)));
     const Vector3f sine(sin(rotation(0)),sin(rotation(1)),sin(rotation(2)));
-    Matrix3f Rx = Matrix3f::Constant(0.0f);
-    Rx(0,0) = 1.0f;
-    Rx(1,1) = cosine(0);
-    Rx(1,2) = -sine(0);
-    Rx(2,1) = sine(0);
-    Rx(2,2) = cosine(0);
-
-    Matrix3f Ry = Matrix3f::Constant(0.0f);
-    Ry(0,0) = cosine(1);
-    Ry(0,2) = sine(1);
-    Ry(1,1) = 1.0f;
-    Ry(2,0) = -sine(1);
-    Ry(2,2) = cosine(1);
+    const Matrix3f RS = getRotationAndScaling(state);
 
-    Matrix3f Rz = Matrix3f::Constant(0.0f);
-    Rz(0,0) = cosine(2);
-    Rz(0,1) = -sine(2);
-    Rz(1,0) = sine(2);
-    Rz(1,1) = cosine(2);
-    Rz(2,2) = 1.0f;
-
-    Matrix3f S = Matrix3f::Constant(0.0f);
-    S(0,0) = s(0);
-    S(1,1) = s(1);
-    S(2,2) = s(2);
-
-    Matrix3f RS = Rz*Ry*Rx*S;
-
-    std::vector<MatrixXf> result;
+    // One measurement vector per row
+    MatrixXf result = MatrixXf::Zero(meshSize, mStateSize);
 
+	#pragma omp parallel for
 	for(int j = 0; j < meshSize; ++j) {
-		MatrixXf hT(1, mStateSize);
-
-		MeshVertex v = meshAccess->getVertex(j);
+		Eigen::Matrix<float, 1, 9> global;
 
-		Vector3f n = v.getNormal();
+		const Vector3f n(normals[j*3], normals[j*3 + 1], normals[j*3 + 2]);
 		// Translation
-		hT(0) = n(0); // tx
-		hT(1) = n(1); // ty
-		hT(2) = n(2); // tz
+		global(0) = n(0); // tx
+		global(1) = n(1); // ty
+		global(2) = n(2); // tz
 
 		// Original position - centroid of original mesh
-		Vector3f posMinusC = originalMeshAccess->getVertex(j).getPosition() - mCentroid; // TODO I don't think this should be original vertex and centroid.., should be after local transformation?
-
+		const Vector3f posMinusC = mVertexPositions.row(j).transpose() - mCentroid; // TODO I don't think this should be original vertex and centroid.., should be after local transformation?
 
 		// Scaling
-		hT(3) = cosine(2)*cosine(1)*posMinusC(0)*n(0) + sine(2)*cosine(1)*posMinusC(0)*n(1) - sine(1)*posMinusC(0)*n(2); // sx
-		hT(4) = (-sine(2)*cosine(0) + sine(2)*sine(1)*sine(0))*posMinusC(1)*n(0) + (cosine(2)*cosine(0)+sine(2)*sine(1)*sine(0))*posMinusC(1)*n(1) + (cosine(1)*sine(0))*posMinusC(1)*n(2); // sy
-		hT(5) = (sine(2)*sine(0)+cosine(2)*sine(1)*cosine(0))*posMinusC(2)*n(0) + (-cosine(2)*sine(0)+sine(2)*sine(1)*cosine(0))*posMinusC(2)*n(1) + cosine(1)*cosine(0)*posMinusC(2)*n(2); // sz
+		global(3) = cosine(2)*cosine(1)*posMinusC(0)*n(0) + sine(2)*cosine(1)*posMinusC(0)*n(1) - sine(1)*posMinusC(0)*n(2); // sx
+		global(4) = (-sine(2)*cosine(0) + sine(2)*sine(1)*sine(0))*posMinusC(1)*n(0) + (cosine(2)*cosine(0)+sine(2)*sine(1)*sine(0))*posMinusC(1)*n(1) + (cosine(1)*sine(0))*posMinusC(1)*n(2); // sy
+		global(5) = (sine(2)*sine(0)+cosine(2)*sine(1)*cosine(0))*posMinusC(2)*n(0) + (-cosine(2)*sine(0)+sine(2)*sine(1)*cosine(0))*posMinusC(2)*n(1) + cosine(1)*cosine(0)*posMinusC(2)*n(2); // sz
 
 		// Rotation
-		hT(6) = ((sine(2)*sine(0)+cosine(2)*sine(1)*cosine(0))*s(1)*posMinusC(1) + (sine(2)*cosine(0)-cosine(2)*sine(1)*sine(0))*s(2)*posMinusC(2))*n(0) +
+		global(6) = ((sine(2)*sine(0)+cosine(2)*sine(1)*cosine(0))*s(1)*posMinusC(1) + (sine(2)*cosine(0)-cosine(2)*sine(1)*sine(0))*s(2)*posMinusC(2))*n(0) +
 				((-cosine(2)*sine(0)+sine(2)*sine(1)*cosine(0))*s(1)*posMinusC(1) + (-cosine(2)*cosine(0)-sine(2)*sine(1)*sine(0))*s(2)*posMinusC(2))*n(1) +
 				((cosine(1)*cosine(0))*s(1)*posMinusC(1) - cosine(1)*sine(0)*s(2)*posMinusC(2))*n(2); // theta_x
-		hT(7) = (-cosine(2)*sine(1)*s(0)*posMinusC(0) + cosine(2)*cosine(1)*sine(0)*s(1)*posMinusC(1) + cosine(2)*cosine(1)*cosine(0)*s(2)*posMinusC(2))*n(0) +
+		global(7) = (-cosine(2)*sine(1)*s(0)*posMinusC(0) + cosine(2)*cosine(1)*sine(0)*s(1)*posMinusC(1) + cosine(2)*cosine(1)*cosine(0)*s(2)*posMinusC(2))*n(0) +
 				(-sine(2)*sine(1)*s(0)*posMinusC(0) + sine(2)*cosine(1)*sine(0)*s(1)*posMinusC(1) + sine(2)*cosine(1)*cosine(0)*s(2)*posMinusC(2))*n(1) +
 				(-cosine(1)*s(0)*posMinusC(0) - sine(1)*sine(0)*s(1)*posMinusC(1) - sine(1)*cosine(0)*s(2)*posMinusC(2))*n(2); // theta_y
-		hT(8) = (-sine(2)*cosine(1)*s(0)*posMinusC(0) + (-cosine(2)*cosine(0)-sine(2)*sine(1)*sine(0))*s(1)*posMinusC(1) + (cosine(2)*sine(0)-sine(2)*sine(1)*cosine(0))*s(2)*posMinusC(2))*n(0) +
+		global(8) = (-sine(2)*cosine(1)*s(0)*posMinusC(0) + (-cosine(2)*cosine(0)-sine(2)*sine(1)*sine(0))*s(1)*posMinusC(1) + (cosine(2)*sine(0)-sine(2)*sine(1)*cosine(0))*s(2)*posMinusC(2))*n(0) +
 				(cosine(2)*cosine(1)*s(0)*posMinusC(0) + (-sine(2)*cosine(0) + cosine(2)*sine(1)*sine(0))*s(1)*posMinusC(1) + (sine(2)*sine(0) + cosine(2)*sine(1)*cosine(0))*s(2)*posMinusC(2))*n(1) +
 				0; // theta_z
 
+		result.block<1,9>(j, 0) = global;
 
-		const uint controlMeshSize = mControlMesh->getNrOfVertices();
-		// Create the local part of the measurement vector
-
-		MatrixXf localJacobian = MatrixXf::Constant(3, controlMeshSize*3, 0);
-		for(int i = 0; i < controlMeshSize; i ++) {
-			float value = getNormalizedWeight(j, i);
-			localJacobian(0,i*3) = value;
-			localJacobian(1,i*3+1) = value;
-			localJacobian(2,i*3+2) = value;
+		// The local part of the measurement vector is n^T*RS*J, where J has the weight of each
+		// control node on its diagonal. Only the control nodes with a weight for this vertex contribute.
+		const Vector3f localPart = RS.transpose()*n;
+		for(Eigen::SparseMatrix<float, Eigen::RowMajor>::InnerIterator it(mWeights, j); it; ++it) {
+			result(j, 9 + it.col()*3) = it.value()*localPart(0);
+			result(j, 9 + it.col()*3 + 1) = it.value()*localPart(1);
+			result(j, 9 + it.col()*3 + 2) = it.value()*localPart(2);
 		}
-
-		MatrixXf localPart = n.transpose()*RS*localJacobian; // 1 x NL
-
-		for(int i = 0; i < controlMeshSize*3; i++) {
-			hT(9+i) = localPart(0,i);
-		}
-
-		//VectorXf asd = hT.transpose();
-		result.push_back(hT);
 	}
 
 	return result;
@@ -605,6 +493,11 @@ void MeanValueCoordinatesModel::setLocalProcessError(float error) {
 void MeanValueCoordinatesModel::setGlobalProcessError(float error) {
 	mGlobalProcessError = error;
 }
+void MeanValueCoordinatesModel::setWeightPruningThreshold(float threshold) {
+	if(threshold < 0)
+		throw Exception("Weight pruning threshold must be >= 0");
+	mWeightPruningThreshold = threshold;
+}
 
 } // end namespace fast
 
@@ -4,6 +4,7 @@
 #include "FAST/Algorithms/ModelBasedSegmentation/ShapeModel.hpp"
 #include "FAST/Algorithms/ModelBasedSegmentation/Shape.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include <Eigen/Sparse>
 
 
 namespace fast {
@@ -16,44 +17,52 @@ class FAST_EXPORT  MeanValueCoordinatesModel : public ShapeModel {
 		void loadMeshes(std::string surfaceMeshFilename, std::string controlMeshFilename);
 		void loadMeshes(Mesh::pointer surfaceMesh, Mesh::pointer controlMesh);
 		Shape::pointer getShape(VectorXf state);
+		/**
+		 * Get the shapes of several states. The control meshes of all states are deformed with one
+		 * sparse matrix product.
+		 * @param states
+		 * @return
+		 */
+		std::vector<Shape::pointer> getShapes(const std::vector<VectorXf>& states);
 		MatrixXf getStateTransitionMatrix1();
 		MatrixXf getStateTransitionMatrix2();
 		MatrixXf getStateTransitionMatrix3();
 		MatrixXf getProcessErrorMatrix();
 		VectorXf getInitialState(SharedPointer<Image> image);
 		std::vector<MatrixXf> getMeasurementVectors(VectorXf state, Shape::pointer shape);
+		MatrixXf getMeasurementMatrix(VectorXf state, Shape::pointer shape);
 		void initializeShapeToImageCenter();
 		void setInitialScaling(float x, float y, float z);
 		void setInitialTranslation(float x, float y, float z);
 		void setLocalProcessError(float error);
 		void setGlobalProcessError(float error);
+		/**
+		 * Weights of control nodes which are smaller than this are removed when the meshes are loaded, and the
+		 * remaining weights of each vertex are normalized again. This makes the weight matrix sparser for dense
+		 * control meshes. Must be set before loadMeshes. Default is 0, which keeps all weights.
+		 * @param threshold
+		 */
+		void setWeightPruningThreshold(float threshold);
 	private:
 		MeanValueCoordinatesModel();
 		VectorXf getState(Vector3f translation, Vector3f scale, Vector3f rotation);
 		void assertLoadedMeshes();
-        void setNormalizedWeight(
-                const int vertexNr,
-                const int triangleNr,
-                const int triangleVertexNr,
-                float weight
-        );
-        float getNormalizedWeight(const int vertexNr, const int triangleNr, const int triangleVertexNr);
-        float getNormalizedWeight(const uint vertexNr, const uint i);
-        void setNormalizedWeightPerNode(
-            const uint vertexNr,
-            const uint controlNodeNr
-            );
-        std::vector<MeshVertex> getDeformedVertices(const std::vector<Vector3f>& displacements);
-		std::vector<MeshVertex> getOriginalVertices();
+		void calculateWeights(const std::vector<uint>& controlTriangles);
+		Shape::pointer createShape(const VectorXf& state, const MatrixXf& deformedVertices);
+		Matrix3f getRotationAndScaling(const VectorXf& state);
 
 		Mesh::pointer mSurfaceMesh;
 		Mesh::pointer mControlMesh;
-		std::unordered_map<uint, std::vector<uint>> mModelVertexTrianglesMap;
-		std::unordered_map<uint, std::vector<uint>> mControlVertexTrianglesMap;
 		Vector3f mCentroid;
 
-		UniquePointer<float[]> mNormalizedWeights;
-		UniquePointer<float[]> mNormalizedWeightsPerNode;
+		// Mean value coordinate weights, with one row per surface vertex and one column per control node
+		Eigen::SparseMatrix<float, Eigen::RowMajor> mWeights;
+		float mWeightPruningThreshold;
+		// Original positions of the control nodes, and positions and normals of the surface vertices, one per row
+		MatrixXf mControlNodePositions;
+		MatrixXf mVertexPositions;
+		MatrixXf mVertexNormals;
+		std::vector<uint> mSurfaceTriangles;
 
 		uint mStateSize;
 		MatrixXf mA1;
@@ -2,6 +2,7 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Streamers/ImageFileStreamer.hpp"
 #include "KalmanFilter.hpp"
+#include "KalmanFilterTracker.hpp"
 #include "FAST/Visualization/TriangleRenderer/TriangleRenderer.hpp"
 #include "FAST/Visualization/SliceRenderer/SliceRenderer.hpp"
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
@@ -17,6 +18,95 @@
 
 using namespace fast;
 
+// Cube with corners at +-size and triangles ordered so that all normals point out of the cube
+static Mesh::pointer createCubeMesh(float size) {
+	std::vector<MeshVertex> vertices;
+	for(int i = 0; i < 8; ++i) {
+		Vector3f position((i & 1 ? 1 : -1)*size, (i & 2 ? 1 : -1)*size, (i & 4 ? 1 : -1)*size);
+		vertices.push_back(MeshVertex(position, position.normalized()));
+	}
+	std::vector<MeshTriangle> triangles = {
+			MeshTriangle(0, 2, 3), MeshTriangle(0, 3, 1), MeshTriangle(4, 5, 7), MeshTriangle(4, 7, 6),
+			MeshTriangle(0, 1, 5), MeshTriangle(0, 5, 4), MeshTriangle(2, 6, 7), MeshTriangle(2, 7, 3),
+			MeshTriangle(0, 4, 6), MeshTriangle(0, 6, 2), MeshTriangle(1, 3, 7), MeshTriangle(1, 7, 5)
+	};
+	Mesh::pointer mesh = Mesh::New();
+	mesh->create(vertices, {}, triangles);
+	return mesh;
+}
+
+TEST_CASE("Mean value coordinates model reproduces the surface mesh and evaluates several states at once", "[fast][ModelBasedSegmentation][MeanValueCoordinates]") {
+	Mesh::pointer surfaceMesh = createCubeMesh(0.5f);
+	MeanValueCoordinatesModel::pointer model = MeanValueCoordinatesModel::New();
+	model->loadMeshes(surfaceMesh, createCubeMesh(1.0f));
+	model->setInitialScaling(1, 1, 1);
+
+	VectorXf state = model->getInitialState(Image::pointer());
+	REQUIRE(state.size() == 9 + 8*3);
+	VectorXf displacedState = state;
+	for(int i = 9; i < displacedState.size(); i += 3)
+		displacedState(i + 1) = 0.25f; // Move all control nodes in y direction
+
+	std::vector<Shape::pointer> shapes = model->getShapes({state, displacedState});
+	REQUIRE(shapes.size() == 2);
+	MeshAccess::pointer originalAccess = surfaceMesh->getMeshAccess(ACCESS_READ);
+	MeshAccess::pointer access = shapes[0]->getMesh()->getMeshAccess(ACCESS_READ);
+	MeshAccess::pointer displacedAccess = shapes[1]->getMesh()->getMeshAccess(ACCESS_READ);
+	for(int i = 0; i < 8; ++i) {
+		const Vector3f original = originalAccess->getVertex(i).getPosition();
+		CHECK((access->getVertex(i).getPosition() - original).norm() < 0.001f);
+		CHECK((displacedAccess->getVertex(i).getPosition() - original - Vector3f(0, 0.25f, 0)).norm() < 0.001f);
+	}
+
+	// Measurement vectors are the rows of the measurement matrix
+	MatrixXf measurementMatrix = model->getMeasurementMatrix(state, shapes[0]);
+	std::vector<MatrixXf> measurementVectors = model->getMeasurementVectors(state, shapes[0]);
+	REQUIRE(measurementMatrix.rows() == measurementVectors.size());
+	REQUIRE(measurementMatrix.cols() == state.size());
+	for(int i = 0; i < measurementVectors.size(); ++i)
+		CHECK(measurementMatrix.row(i).isApprox(measurementVectors[i].row(0)));
+}
+
+TEST_CASE("Kalman filter tracker tracks several objects and prunes hypotheses without edges", "[fast][ModelBasedSegmentation][KalmanFilterTracker]") {
+	// Two bright disks with radius 5 on a dark background
+	const int size = 64;
+	std::vector<uchar> data(size*size);
+	for(int y = 0; y < size; ++y) {
+		for(int x = 0; x < size; ++x) {
+			const bool inside = Vector2f(x - 20, y - 20).norm() <= 5 || Vector2f(x - 44, y - 44).norm() <= 5;
+			data[x + y*size] = inside ? 200 : 10;
+		}
+	}
+	Image::pointer image = Image::New();
+	image->create(size, size, TYPE_UINT8, 1, data.data());
+
+	EllipseModel::pointer shapeModel = EllipseModel::New();
+	StepEdgeModel::pointer appearanceModel = StepEdgeModel::New();
+	appearanceModel->setLineLength(8);
+	appearanceModel->setLineSampleSpacing(0.25);
+	appearanceModel->setIntensityDifferenceThreshold(50);
+
+	KalmanFilterTracker::pointer tracker = KalmanFilterTracker::New();
+	tracker->setInputData(image);
+	const int first = tracker->addObject(shapeModel, appearanceModel);
+	const int second = tracker->addObject(shapeModel, appearanceModel);
+	REQUIRE(tracker->getNrOfObjects() == 2);
+	// One hypothesis close to each disk, and one in the background where there are no edges
+	tracker->addHypothesis(first, Vector4f(21, 20, 5, 5));
+	tracker->addHypothesis(first, Vector4f(20, 44, 5, 5));
+	tracker->addHypothesis(second, Vector4f(44, 43, 5, 5));
+	tracker->addHypothesis(second, Vector4f(44, 20, 5, 5));
+	REQUIRE(tracker->getNrOfHypotheses(first) == 2);
+	tracker->update(0);
+
+	CHECK(tracker->getNrOfHypotheses(first) == 1);
+	CHECK(tracker->getNrOfHypotheses(second) == 1);
+	const VectorXf firstState = tracker->getCurrentState(first);
+	const VectorXf secondState = tracker->getCurrentState(second);
+	CHECK((firstState.head(2) - Vector2f(20, 20)).norm() < 1.5f);
+	CHECK((secondState.head(2) - Vector2f(44, 44)).norm() < 1.5f);
+}
+
 /*
 TEST_CASE("Model based segmentation with mean value coordinates on 3D cardiac US data", "[fast][ModelBasedSegmentation][cardiac][3d][visual]") {
 	ImageFileStreamer::pointer streamer = ImageFileStreamer::New();
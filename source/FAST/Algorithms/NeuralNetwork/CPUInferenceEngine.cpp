@@ -0,0 +1,338 @@
+#include "CPUInferenceEngine.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace fast {
+
+CPUInferenceEngine::CPUInferenceEngine() {
+    mLoaded = false;
+}
+
+CPUInferenceEngine::Shape CPUInferenceEngine::getOutputShape(const Layer& layer, Shape input) const {
+    Shape output = input;
+    switch(layer.type) {
+        case LAYER_CONV2D:
+            if(input.flat)
+                throw Exception("conv2d layer can't be used after flatten or dense layers in CPUInferenceEngine");
+            if(layer.inputChannels != input.channels)
+                throw Exception("Nr of input channels of conv2d layer does not match its input in CPUInferenceEngine");
+            if(layer.samePadding) {
+                output.height = (input.height + layer.stride - 1) / layer.stride;
+                output.width = (input.width + layer.stride - 1) / layer.stride;
+            } else {
+                output.height = (input.height - layer.kernelHeight) / layer.stride + 1;
+                output.width = (input.width - layer.kernelWidth) / layer.stride + 1;
+            }
+            output.channels = layer.outputChannels;
+            break;
+        case LAYER_DENSE:
+            if(input.height*input.width*input.channels != layer.inputChannels)
+                throw Exception("Input size of dense layer does not match its input in CPUInferenceEngine");
+            output.height = 1;
+            output.width = 1;
+            output.channels = layer.outputChannels;
+            output.flat = true;
+            break;
+        case LAYER_MAXPOOL2D:
+            output.height = (input.height - layer.kernelHeight) / layer.stride + 1;
+            output.width = (input.width - layer.kernelWidth) / layer.stride + 1;
+            break;
+        case LAYER_UPSAMPLE2D:
+            output.height = input.height*layer.stride;
+            output.width = input.width*layer.stride;
+            break;
+        case LAYER_FLATTEN:
+            output.height = 1;
+            output.width = 1;
+            output.channels = input.height*input.width*input.channels;
+            output.flat = true;
+            break;
+        default:
+            break;
+    }
+    if(output.height <= 0 || output.width <= 0)
+        throw Exception("Input to a layer is too small in CPUInferenceEngine");
+
+    return output;
+}
+
+void CPUInferenceEngine::load(std::string filename) {
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if(!file.is_open())
+        throw Exception("Could not open network file " + filename);
+
+    std::string line;
+    std::getline(file, line);
+    if(line.substr(0, 8) != "FASTNN 1")
+        throw Exception("Network file " + filename + " is not a FAST network file");
+
+    mLayers.clear();
+    mInputName = "";
+    mOutputs.clear();
+    bool foundWeights = false;
+    while(std::getline(file, line)) {
+        if(!line.empty() && line[line.size()-1] == '\r')
+            line.erase(line.size()-1);
+        if(line.empty())
+            continue;
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+        if(keyword == "weights") {
+            foundWeights = true;
+            break;
+        } else if(keyword == "input") {
+            stream >> mInputName >> mInputShape.height >> mInputShape.width >> mInputShape.channels;
+            mInputShape.flat = false;
+        } else if(keyword == "output") {
+            std::string name;
+            int layers = -1;
+            stream >> name;
+            if(!(stream >> layers))
+                layers = -1;
+            mOutputs[name] = layers;
+        } else {
+            Layer layer;
+            if(keyword == "conv2d") {
+                std::string padding;
+                layer.type = LAYER_CONV2D;
+                stream >> layer.kernelHeight >> layer.kernelWidth >> layer.inputChannels >> layer.outputChannels >> layer.stride >> padding;
+                if(padding != "same" && padding != "valid")
+                    throw Exception("Unknown padding " + padding + " in network file " + filename);
+                layer.samePadding = padding == "same";
+                layer.weights.resize(layer.kernelHeight*layer.kernelWidth*layer.inputChannels*layer.outputChannels);
+                layer.bias.resize(layer.outputChannels);
+            } else if(keyword == "dense") {
+                layer.type = LAYER_DENSE;
+                stream >> layer.inputChannels >> layer.outputChannels;
+                layer.weights.resize(layer.inputChannels*layer.outputChannels);
+                layer.bias.resize(layer.outputChannels);
+            } else if(keyword == "maxpool2d") {
+                layer.type = LAYER_MAXPOOL2D;
+                stream >> layer.kernelHeight >> layer.stride;
+                layer.kernelWidth = layer.kernelHeight;
+            } else if(keyword == "upsample2d") {
+                layer.type = LAYER_UPSAMPLE2D;
+                stream >> layer.stride;
+            } else if(keyword == "relu") {
+                layer.type = LAYER_RELU;
+            } else if(keyword == "sigmoid") {
+                layer.type = LAYER_SIGMOID;
+            } else if(keyword == "softmax") {
+                layer.type = LAYER_SOFTMAX;
+            } else if(keyword == "flatten") {
+                layer.type = LAYER_FLATTEN;
+            } else {
+                throw Exception("Unknown layer " + keyword + " in network file " + filename);
+            }
+            if(stream.fail() || layer.stride <= 0)
+                throw Exception("Invalid parameters for layer " + keyword + " in network file " + filename);
+            mLayers.push_back(layer);
+        }
+    }
+    if(!foundWeights)
+        throw Exception("Weights are missing in network file " + filename);
+    if(mInputName == "" || mOutputs.empty())
+        throw Exception("Input and output must be specified in network file " + filename);
+    for(auto& output : mOutputs) {
+        if(output.second == -1)
+            output.second = mLayers.size();
+        if(output.second < 0 || output.second > mLayers.size())
+            throw Exception("Output " + output.first + " is after more layers than the network has in network file " + filename);
+    }
+
+    // Read weights and validate that the layers fit together
+    Shape shape = mInputShape;
+    for(Layer& layer : mLayers) {
+        file.read((char*)layer.weights.data(), layer.weights.size()*sizeof(float));
+        file.read((char*)layer.bias.data(), layer.bias.size()*sizeof(float));
+        if(file.fail())
+            throw Exception("Not enough weights in network file " + filename);
+        shape = getOutputShape(layer, shape);
+    }
+
+    reportInfo() << "Network with " << mLayers.size() << " layers loaded from: " << filename << reportEnd();
+    mLoaded = true;
+}
+
+std::string CPUInferenceEngine::getDefaultInputName() const {
+    return mInputName;
+}
+
+void CPUInferenceEngine::runLayer(const Layer& layer, const Shape& inputShape, const Shape& outputShape,
+        const std::vector<float>& input, std::vector<float>& output) const {
+    output.resize(outputShape.height*outputShape.width*outputShape.channels);
+    const int inputSize = inputShape.height*inputShape.width*inputShape.channels;
+
+    switch(layer.type) {
+        case LAYER_CONV2D: {
+            int padTop = 0;
+            int padLeft = 0;
+            if(layer.samePadding) {
+                padTop = std::max((outputShape.height - 1)*layer.stride + layer.kernelHeight - inputShape.height, 0) / 2;
+                padLeft = std::max((outputShape.width - 1)*layer.stride + layer.kernelWidth - inputShape.width, 0) / 2;
+            }
+            const int inputChannels = layer.inputChannels;
+            const int outputChannels = layer.outputChannels;
+            #pragma omp parallel for
+            for(int y = 0; y < outputShape.height; ++y) {
+                for(int x = 0; x < outputShape.width; ++x) {
+                    float* result = &output[(y*outputShape.width + x)*outputChannels];
+                    for(int c = 0; c < outputChannels; ++c)
+                        result[c] = layer.bias[c];
+                    for(int ky = 0; ky < layer.kernelHeight; ++ky) {
+                        const int inputY = y*layer.stride + ky - padTop;
+                        if(inputY < 0 || inputY >= inputShape.height)
+                            continue;
+                        for(int kx = 0; kx < layer.kernelWidth; ++kx) {
+                            const int inputX = x*layer.stride + kx - padLeft;
+                            if(inputX < 0 || inputX >= inputShape.width)
+                                continue;
+                            const float* in = &input[(inputY*inputShape.width + inputX)*inputChannels];
+                            const float* weights = &layer.weights[(ky*layer.kernelWidth + kx)*inputChannels*outputChannels];
+                            for(int i = 0; i < inputChannels; ++i) {
+                                const float value = in[i];
+                                const float* weightRow = weights + i*outputChannels;
+                                for(int c = 0; c < outputChannels; ++c)
+                                    result[c] += value*weightRow[c];
+                            }
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        case LAYER_DENSE: {
+            const int outputChannels = layer.outputChannels;
+            std::copy(layer.bias.begin(), layer.bias.end(), output.begin());
+            for(int i = 0; i < inputSize; ++i) {
+                const float value = input[i];
+                const float* weightRow = &layer.weights[i*outputChannels];
+                for(int c = 0; c < outputChannels; ++c)
+                    output[c] += value*weightRow[c];
+            }
+            break;
+        }
+        case LAYER_MAXPOOL2D: {
+            const int channels = inputShape.channels;
+            #pragma omp parallel for
+            for(int y = 0; y < outputShape.height; ++y) {
+                for(int x = 0; x < outputShape.width; ++x) {
+                    float* result = &output[(y*outputShape.width + x)*channels];
+                    for(int c = 0; c < channels; ++c)
+                        result[c] = -std::numeric_limits<float>::max();
+                    for(int ky = 0; ky < layer.kernelHeight; ++ky) {
+                        for(int kx = 0; kx < layer.kernelWidth; ++kx) {
+                            const float* in = &input[((y*layer.stride + ky)*inputShape.width + x*layer.stride + kx)*channels];
+                            for(int c = 0; c < channels; ++c)
+                                result[c] = std::max(result[c], in[c]);
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        case LAYER_UPSAMPLE2D: {
+            const int channels = inputShape.channels;
+            #pragma omp parallel for
+            for(int y = 0; y < outputShape.height; ++y) {
+                for(int x = 0; x < outputShape.width; ++x) {
+                    const float* in = &input[((y / layer.stride)*inputShape.width + x / layer.stride)*channels];
+                    std::copy(in, in + channels, &output[(y*outputShape.width + x)*channels]);
+                }
+            }
+            break;
+        }
+        case LAYER_RELU:
+            for(int i = 0; i < inputSize; ++i)
+                output[i] = std::max(input[i], 0.0f);
+            break;
+        case LAYER_SIGMOID:
+            for(int i = 0; i < inputSize; ++i)
+                output[i] = 1.0f / (1.0f + std::exp(-input[i]));
+            break;
+        case LAYER_SOFTMAX: {
+            const int channels = inputShape.channels;
+            for(int i = 0; i < inputSize; i += channels) {
+                const float maximum = *std::max_element(&input[i], &input[i] + channels);
+                float sum = 0;
+                for(int c = 0; c < channels; ++c) {
+                    output[i + c] = std::exp(input[i + c] - maximum);
+                    sum += output[i + c];
+                }
+                for(int c = 0; c < channels; ++c)
+                    output[i + c] /= sum;
+            }
+            break;
+        }
+        case LAYER_FLATTEN:
+            // Data is in row major NHWC order, thus flattening does not move any data
+            std::copy(input.begin(), input.end(), output.begin());
+            break;
+    }
+}
+
+std::vector<NetworkTensor> CPUInferenceEngine::run(
+        const std::vector<std::pair<std::string, NetworkTensor> >& inputs,
+        const std::vector<std::string>& outputNames) {
+    if(!mLoaded)
+        throw Exception("A network must be loaded before running the CPUInferenceEngine");
+    if(inputs.size() != 1 || inputs[0].first != mInputName)
+        throw Exception("CPUInferenceEngine expects one input named " + mInputName);
+    std::vector<int> outputLayers;
+    for(const std::string& name : outputNames) {
+        auto output = mOutputs.find(name);
+        if(output == mOutputs.end())
+            throw Exception("CPUInferenceEngine has no output named " + name);
+        outputLayers.push_back(output->second);
+    }
+
+    const NetworkTensor& input = inputs[0].second;
+    const std::vector<int>& inputShape = input.getShape();
+    if(inputShape.size() != 4 || inputShape[1] != mInputShape.height || inputShape[2] != mInputShape.width ||
+            inputShape[3] != mInputShape.channels)
+        throw Exception("Input tensor given to CPUInferenceEngine does not match the input size of the network");
+
+    // Size of the data after each layer
+    std::vector<Shape> shapes = {mInputShape};
+    for(const Layer& layer : mLayers)
+        shapes.push_back(getOutputShape(layer, shapes.back()));
+
+    const int batchSize = inputShape[0];
+    std::vector<NetworkTensor> outputs;
+    for(int layers : outputLayers) {
+        const Shape& outputShape = shapes[layers];
+        outputs.push_back(NetworkTensor(outputShape.flat ?
+                std::vector<int>({batchSize, outputShape.channels}) :
+                std::vector<int>({batchSize, outputShape.height, outputShape.width, outputShape.channels})
+        ));
+    }
+    const int inputSize = mInputShape.height*mInputShape.width*mInputShape.channels;
+
+    // Ping pong between two buffers
+    std::vector<float> current;
+    std::vector<float> next;
+    for(int n = 0; n < batchSize; ++n) {
+        current.assign(input.getData() + n*inputSize, input.getData() + (n + 1)*inputSize);
+        for(int i = 0; i <= mLayers.size(); ++i) {
+            // Store the outputs which are taken after the i first layers
+            for(int j = 0; j < outputLayers.size(); ++j) {
+                if(outputLayers[j] != i)
+                    continue;
+                const int outputSize = shapes[i].height*shapes[i].width*shapes[i].channels;
+                std::copy(current.begin(), current.begin() + outputSize, outputs[j].getData() + n*outputSize);
+            }
+            if(i < mLayers.size()) {
+                runLayer(mLayers[i], shapes[i], shapes[i + 1], current, next);
+                std::swap(current, next);
+            }
+        }
+    }
+
+    return outputs;
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef CPU_INFERENCE_ENGINE_HPP_
+#define CPU_INFERENCE_ENGINE_HPP_
+
+#include "InferenceEngine.hpp"
+#include <map>
+
+namespace fast {
+
+/**
+ * Lightweight built-in inference engine for small sequential networks, which runs on the CPU
+ * without any external runtime.
+ *
+ * Networks are stored in FAST network files (.fnn), which have a text header followed by binary weights:
+ *
+ *     FASTNN 1
+ *     input <name> <height> <width> <channels>
+ *     output <name> [<nr of layers>]
+ *     <one line per layer>
+ *     weights
+ *     <raw little endian 32 bit float weights and biases of each conv2d and dense layer, in layer order>
+ *
+ * A network can have several outputs. The optional nr of layers of an output is how many of the layers the
+ * output is taken after, and is by default all layers. This allows intermediate results of the network to be
+ * outputs as well.
+ *
+ * Supported layers:
+ *
+ *     conv2d <kernel height> <kernel width> <input channels> <output channels> <stride> <same|valid>
+ *     dense <input size> <output size>
+ *     maxpool2d <size> <stride>
+ *     upsample2d <factor>
+ *     relu
+ *     sigmoid
+ *     softmax
+ *     flatten
+ *
+ * Data is in NHWC order. Convolution weights are stored in HWIO order and dense weights as input x output,
+ * which is the same as Keras. Softmax is done over the last dimension.
+ */
+class FAST_EXPORT CPUInferenceEngine : public InferenceEngine {
+    FAST_OBJECT(CPUInferenceEngine)
+    public:
+        void load(std::string filename);
+        std::string getDefaultInputName() const;
+        std::vector<NetworkTensor> run(
+                const std::vector<std::pair<std::string, NetworkTensor> >& inputs,
+                const std::vector<std::string>& outputNames
+        );
+    private:
+        CPUInferenceEngine();
+
+        enum LayerType {
+            LAYER_CONV2D,
+            LAYER_DENSE,
+            LAYER_MAXPOOL2D,
+            LAYER_UPSAMPLE2D,
+            LAYER_RELU,
+            LAYER_SIGMOID,
+            LAYER_SOFTMAX,
+            LAYER_FLATTEN
+        };
+        struct Layer {
+            LayerType type;
+            int kernelHeight = 0;
+            int kernelWidth = 0;
+            int inputChannels = 0;
+            int outputChannels = 0;
+            int stride = 1;
+            bool samePadding = false;
+            std::vector<float> weights;
+            std::vector<float> bias;
+        };
+        // Size of the data between layers, in height x width x channels
+        struct Shape {
+            int height;
+            int width;
+            int channels;
+            bool flat;
+        };
+
+        Shape getOutputShape(const Layer& layer, Shape input) const;
+        void runLayer(const Layer& layer, const Shape& inputShape, const Shape& outputShape,
+                const std::vector<float>& input, std::vector<float>& output) const;
+
+        std::string mInputName;
+        // Nr of layers each output is taken after, -1 is all layers
+        std::map<std::string, int> mOutputs;
+        Shape mInputShape;
+        std::vector<Layer> mLayers;
+        bool mLoaded;
+};
+
+}
+
+#endif
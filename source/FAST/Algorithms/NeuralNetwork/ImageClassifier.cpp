@@ -16,33 +16,72 @@ void ImageClassifier::setOutputName(std::string outputName)	 {
 	mOutputName = outputName;
 }
 
-void ImageClassifier::execute() {
-    mRuntimeManager->enable();
-    mRuntimeManager->startRegularTimer("image_classifier");
-	NeuralNetwork::execute();
-
-	// Create output data
-    tensorflow::Tensor result;
+std::vector<std::map<std::string, float> > ImageClassifier::getClassifications() {
+    NetworkTensor result;
 	if(mOutputName == "") {
 		result = getNetworkOutput();
 	} else {
 		result = getNetworkOutput(mOutputName);
 	}
-	Eigen::Tensor<float, 2, 1> tensor = result.tensor<float, 2>();
-	ImageClassification::pointer output = getOutputData<ImageClassification>(0);
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > tensor = result.getTensor<2>();
+	std::vector<std::map<std::string, float> > classifications;
 	for(int i = 0; i < tensor.dimension(0); ++i) { // for each input image
 		std::map<std::string, float> mapResult;
 		for(int j = 0; j < tensor.dimension(1); ++j) { // for each class
 			mapResult[mLabels[j]] = tensor(i, j);
 			reportInfo() << mLabels[j] << ": " << tensor(i, j) << reportEnd();
 		}
-
-		output->create(mapResult);
+		classifications.push_back(mapResult);
 	}
+	return classifications;
+}
+
+void ImageClassifier::execute() {
+    mRuntimeManager->enable();
+    mRuntimeManager->startRegularTimer("image_classifier");
+	NeuralNetwork::execute();
+
+	// Create output data
+	ImageClassification::pointer output = getOutputData<ImageClassification>(0);
+	for(const std::map<std::string, float>& classification : getClassifications())
+		output->create(classification);
     mRuntimeManager->stopRegularTimer("image_classifier");
     getRuntime("image_classifier")->print();
 }
 
+std::vector<ImageClassification::pointer> ImageClassifier::classify(const std::vector<SharedPointer<Image> >& images, uint batchSize) {
+	if(batchSize == 0)
+		throw Exception("Batch size must be larger than zero in ImageClassifier");
+	if(mFramesToRemember > 1)
+		throw Exception("ImageClassifier::classify does not support remembering frames");
+
+	std::vector<ImageClassification::pointer> outputs;
+	for(std::size_t start = 0; start < images.size(); start += batchSize) {
+		const std::size_t end = std::min(start + batchSize, images.size());
+		processBatch(std::vector<Image::pointer>(images.begin() + start, images.begin() + end));
+		for(const std::map<std::string, float>& classification : getClassifications()) {
+			ImageClassification::pointer output = ImageClassification::New();
+			output->create(classification);
+			outputs.push_back(output);
+		}
+	}
+
+	return outputs;
+}
+
+std::vector<ImageClassification::pointer> ImageClassifier::classify(NetworkTensor batch) {
+	processTensor(batch);
+
+	std::vector<ImageClassification::pointer> outputs;
+	for(const std::map<std::string, float>& classification : getClassifications()) {
+		ImageClassification::pointer output = ImageClassification::New();
+		output->create(classification);
+		outputs.push_back(output);
+	}
+
+	return outputs;
+}
+
 void ImageClassifier::loadAttributes() {
 	NeuralNetwork::loadAttributes();
 	setLabels(getStringListAttribute("labels"));
@@ -22,9 +22,24 @@ class FAST_EXPORT  ImageClassifier : public NeuralNetwork {
 		void setLabels(std::vector<std::string> labels);
         void setOutputName(std::string outputName);
         void loadAttributes();
+        /**
+         * Classify a set of images, e.g. all frames of a recorded sequence, outside of the pipeline.
+         * The network is run on batchSize images at a time.
+         * @param images
+         * @param batchSize
+         * @return one classification per image
+         */
+        std::vector<ImageClassification::pointer> classify(const std::vector<SharedPointer<Image> >& images, uint batchSize = 16);
+        /**
+         * Classify a batch which has already been prepared as a network input tensor, see NeuralNetwork::processTensor.
+         * @param batch
+         * @return one classification per entry in the batch
+         */
+        std::vector<ImageClassification::pointer> classify(NetworkTensor batch);
 	private:
 		ImageClassifier();
 		void execute();
+		std::vector<std::map<std::string, float> > getClassifications();
 
 		// A map of label -> score
 		std::vector<std::string> mLabels;
@@ -3,9 +3,48 @@
 #include "FAST/Streamers/ImageFileStreamer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
+#include <fstream>
 
 using namespace fast;
 
+TEST_CASE("Image classifier with prepared batch tensor", "[fast][ImageClassifier]") {
+	// Network which gives class A for positive images and class B for negative images
+	const std::string filename = "image_classifier_batch_test.fnn";
+	{
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+		file << "FASTNN 1\n"
+				"input input_1 2 2 1\n"
+				"output output_1\n"
+				"flatten\n"
+				"dense 4 2\n"
+				"softmax\n"
+				"weights\n";
+		std::vector<float> weights = {1, -1, 1, -1, 1, -1, 1, -1, 0, 0};
+		file.write((const char*)weights.data(), weights.size()*sizeof(float));
+	}
+
+	ImageClassifier::pointer classifier = ImageClassifier::New();
+	classifier->load(filename);
+	classifier->setInputSize(2, 2);
+	classifier->setOutputParameters({"output_1"});
+	classifier->setLabels({"A", "B"});
+
+	NetworkTensor batch({3, 2, 2, 1});
+	const float values[3] = {1, -1, 2};
+	for(int i = 0; i < 3; ++i) {
+		for(int j = 0; j < 4; ++j)
+			batch.getData()[i*4 + j] = values[i];
+	}
+	std::vector<ImageClassification::pointer> results = classifier->classify(batch);
+	REQUIRE(results.size() == 3);
+	for(int i = 0; i < 3; ++i) {
+		std::map<std::string, float> scores = results[i]->getAccess(ACCESS_READ)->getData();
+		CHECK((scores["A"] > scores["B"]) == (values[i] > 0));
+	}
+
+	CHECK_THROWS(classifier->classify(NetworkTensor({1, 3, 3, 1})));
+}
+
 /*
 TEST_CASE("Image classifier", "[fast][ImageClassifier]") {
 
@@ -0,0 +1,58 @@
+#include "InferenceEngine.hpp"
+
+namespace fast {
+
+NetworkTensor::NetworkTensor() {
+    mSize = 0;
+}
+
+NetworkTensor::NetworkTensor(std::vector<int> shape) {
+    int size = 1;
+    for(int dimension : shape) {
+        if(dimension < 0)
+            throw Exception("Network tensor dimensions can't be negative");
+        size *= dimension;
+    }
+    mShape = shape;
+    mSize = size;
+    mData = std::shared_ptr<float>(new float[size](), std::default_delete<float[]>());
+}
+
+NetworkTensor::NetworkTensor(std::vector<int> shape, float* data, std::shared_ptr<void> owner) {
+    int size = 1;
+    for(int dimension : shape) {
+        if(dimension < 0)
+            throw Exception("Network tensor dimensions can't be negative");
+        size *= dimension;
+    }
+    mShape = shape;
+    mSize = size;
+    // Aliasing constructor: shares ownership of owner, but points to data
+    mData = std::shared_ptr<float>(owner, data);
+}
+
+const std::vector<int>& NetworkTensor::getShape() const {
+    return mShape;
+}
+
+int NetworkTensor::getDimensions() const {
+    return mShape.size();
+}
+
+int NetworkTensor::getSize() const {
+    return mSize;
+}
+
+float* NetworkTensor::getData() {
+    return mData.get();
+}
+
+const float* NetworkTensor::getData() const {
+    return mData.get();
+}
+
+NetworkTensor InferenceEngine::createInputTensor(std::string name, std::vector<int> shape) {
+    return NetworkTensor(shape);
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef INFERENCE_ENGINE_HPP_
+#define INFERENCE_ENGINE_HPP_
+
+#include "FAST/Object.hpp"
+#include "FAST/Exception.hpp"
+#include <unsupported/Eigen/CXX11/Tensor>
+#include <memory>
+#include <vector>
+
+namespace fast {
+
+/**
+ * Dense float tensor stored in row major order, used to pass data to and from inference engines.
+ * Copies of a tensor share the same data.
+ */
+class FAST_EXPORT NetworkTensor {
+    public:
+        NetworkTensor();
+        explicit NetworkTensor(std::vector<int> shape);
+        /**
+         * Wrap memory owned by another object, e.g. a tensor of an inference engine, without copying it.
+         * The owner is kept alive as long as a copy of this tensor exists.
+         * @param shape
+         * @param data
+         * @param owner
+         */
+        NetworkTensor(std::vector<int> shape, float* data, std::shared_ptr<void> owner);
+        const std::vector<int>& getShape() const;
+        /**
+         * @return nr of dimensions of the tensor
+         */
+        int getDimensions() const;
+        /**
+         * @return total nr of elements in the tensor
+         */
+        int getSize() const;
+        float* getData();
+        const float* getData() const;
+        /**
+         * Get an Eigen tensor map of the data. N has to match the nr of dimensions.
+         */
+        template <int N>
+        Eigen::TensorMap<Eigen::Tensor<float, N, Eigen::RowMajor> > getTensor();
+    private:
+        std::vector<int> mShape;
+        std::shared_ptr<float> mData;
+        int mSize;
+};
+
+template <int N>
+Eigen::TensorMap<Eigen::Tensor<float, N, Eigen::RowMajor> > NetworkTensor::getTensor() {
+    if(mShape.size() != N)
+        throw Exception("Nr of dimensions requested does not match the network tensor");
+    Eigen::array<Eigen::Index, N> dimensions;
+    for(int i = 0; i < N; ++i)
+        dimensions[i] = mShape[i];
+    return Eigen::TensorMap<Eigen::Tensor<float, N, Eigen::RowMajor> >(getData(), dimensions);
+}
+
+/**
+ * Abstract interface for the engines which execute neural networks
+ */
+class FAST_EXPORT InferenceEngine : public Object {
+    public:
+        typedef SharedPointer<InferenceEngine> pointer;
+        /**
+         * Load a network model from file
+         * @param filename
+         */
+        virtual void load(std::string filename) = 0;
+        /**
+         * @return name of the input node used if no input name is given to the network
+         */
+        virtual std::string getDefaultInputName() const = 0;
+        /**
+         * Create a tensor which can be given to run as the input with this name. Engines can override this to
+         * return a tensor which wraps their own input memory, so that the input is not copied when running.
+         * @param name of the input node
+         * @param shape
+         */
+        virtual NetworkTensor createInputTensor(std::string name, std::vector<int> shape);
+        /**
+         * Execute the network
+         * @param inputs list of input node name and tensor pairs
+         * @param outputNames names of the output nodes to return
+         * @return one output tensor per output name, in the same order
+         */
+        virtual std::vector<NetworkTensor> run(
+                const std::vector<std::pair<std::string, NetworkTensor> >& inputs,
+                const std::vector<std::string>& outputNames
+        ) = 0;
+        virtual std::string getNameOfClass() const = 0;
+        virtual ~InferenceEngine() {};
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "FAST/Testing.hpp"
+#include "CPUInferenceEngine.hpp"
+#include <fstream>
+#include <cstdio>
+#include <QDir>
+#include <cmath>
+
+using namespace fast;
+
+static void writeNetworkFile(std::string filename, std::string header, std::vector<float> weights) {
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+	file << header;
+	file.write((const char*)weights.data(), weights.size()*sizeof(float));
+}
+
+TEST_CASE("CPU inference engine with convolution and dense layers", "[fast][NeuralNetwork][CPUInferenceEngine]") {
+	const std::string filename = QDir::tempPath().toStdString() + "/cpu_inference_engine_test.fnn";
+	writeNetworkFile(filename,
+		"FASTNN 1\n"
+		"input input_1 2 2 1\n"
+		"output output_1\n"
+		"conv2d 1 1 1 2 1 valid\n"
+		"relu\n"
+		"flatten\n"
+		"dense 8 2\n"
+		"softmax\n"
+		"weights\n",
+		{
+			// conv2d weights and bias: channel 0 = 2x+1, channel 1 = -x
+			2, -1, 1, 0,
+			// dense weights: output 0 sums channel 0, output 1 sums channel 1
+			1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1,
+			0, 0
+		}
+	);
+
+	CPUInferenceEngine::pointer engine = CPUInferenceEngine::New();
+	engine->load(filename);
+	std::remove(filename.c_str());
+	CHECK(engine->getDefaultInputName() == "input_1");
+
+	NetworkTensor input = engine->createInputTensor("input_1", {2, 2, 2, 1});
+	REQUIRE(input.getShape() == std::vector<int>({2, 2, 2, 1}));
+	float* data = input.getData();
+	// First image positive, second negative
+	for(int i = 0; i < 4; ++i) {
+		data[i] = 0.25f;
+		data[4 + i] = -1.0f;
+	}
+	std::vector<NetworkTensor> outputs = engine->run({{"input_1", input}}, {"output_1"});
+	REQUIRE(outputs.size() == 1);
+	REQUIRE(outputs[0].getShape() == std::vector<int>({2, 2}));
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > result = outputs[0].getTensor<2>();
+
+	// Image 1: channel 0 = 1.5 per pixel (sum 6), channel 1 = 0 after relu
+	float expected = 1.0f / (1.0f + std::exp(-6.0f));
+	CHECK(result(0, 0) == Approx(expected));
+	CHECK(result(0, 1) == Approx(1.0f - expected));
+	// Image 2: channel 0 = 0 after relu, channel 1 = 1 per pixel (sum 4)
+	expected = 1.0f / (1.0f + std::exp(-4.0f));
+	CHECK(result(1, 1) == Approx(expected));
+	CHECK(result(1, 0) == Approx(1.0f - expected));
+
+	CHECK_THROWS(engine->run({{"wrong_name", input}}, {"output_1"}));
+}
+
+TEST_CASE("CPU inference engine with a batch of several images", "[fast][NeuralNetwork][CPUInferenceEngine]") {
+	const std::string filename = QDir::tempPath().toStdString() + "/cpu_inference_engine_batch_test.fnn";
+	// Network which outputs the sum and the max of each image
+	writeNetworkFile(filename,
+		"FASTNN 1\n"
+		"input input_1 4 4 1\n"
+		"output output_1\n"
+		"conv2d 1 1 1 1 1 same\n"
+		"maxpool2d 4 4\n"
+		"flatten\n"
+		"dense 1 2\n"
+		"weights\n",
+		{
+			1, 0,
+			1, 2,
+			0, 1
+		}
+	);
+
+	CPUInferenceEngine::pointer engine = CPUInferenceEngine::New();
+	engine->load(filename);
+	std::remove(filename.c_str());
+
+	const int batchSize = 5;
+	NetworkTensor input = engine->createInputTensor("input_1", {batchSize, 4, 4, 1});
+	for(int n = 0; n < batchSize; ++n) {
+		for(int i = 0; i < 16; ++i)
+			input.getData()[n*16 + i] = (float)(n*i);
+	}
+	std::vector<NetworkTensor> outputs = engine->run({{"input_1", input}}, {"output_1"});
+	REQUIRE(outputs.size() == 1);
+	REQUIRE(outputs[0].getShape() == std::vector<int>({batchSize, 2}));
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > result = outputs[0].getTensor<2>();
+	for(int n = 0; n < batchSize; ++n) {
+		// Max of image n is 15n
+		CHECK(result(n, 0) == Approx(15.0f*n));
+		CHECK(result(n, 1) == Approx(30.0f*n + 1.0f));
+	}
+
+	CHECK_THROWS(engine->run({{"input_1", NetworkTensor({1, 3, 4, 1})}}, {"output_1"}));
+}
+
+TEST_CASE("CPU inference engine with several outputs", "[fast][NeuralNetwork][CPUInferenceEngine]") {
+	const std::string filename = QDir::tempPath().toStdString() + "/cpu_inference_engine_outputs_test.fnn";
+	writeNetworkFile(filename,
+		"FASTNN 1\n"
+		"input input_1 1 1 2\n"
+		"output features 3\n"
+		"output output_1\n"
+		"flatten\n"
+		"dense 2 2\n"
+		"relu\n"
+		"dense 2 1\n"
+		"sigmoid\n"
+		"weights\n",
+		{
+			// features = relu(x0 - x1, x1 - x0)
+			1, -1, -1, 1,
+			0, 0,
+			// output = sigmoid(feature 0 + feature 1)
+			1, 1,
+			0
+		}
+	);
+
+	CPUInferenceEngine::pointer engine = CPUInferenceEngine::New();
+	engine->load(filename);
+	std::remove(filename.c_str());
+
+	NetworkTensor input = engine->createInputTensor("input_1", {2, 1, 1, 2});
+	const float values[4] = {3, 1, 0, 2};
+	std::copy(values, values + 4, input.getData());
+
+	// Outputs are returned in the requested order
+	std::vector<NetworkTensor> outputs = engine->run({{"input_1", input}}, {"output_1", "features"});
+	REQUIRE(outputs.size() == 2);
+	REQUIRE(outputs[0].getShape() == std::vector<int>({2, 1}));
+	REQUIRE(outputs[1].getShape() == std::vector<int>({2, 2}));
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > result = outputs[0].getTensor<2>();
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > features = outputs[1].getTensor<2>();
+	CHECK(features(0, 0) == Approx(2.0f));
+	CHECK(features(0, 1) == Approx(0.0f));
+	CHECK(features(1, 0) == Approx(0.0f));
+	CHECK(features(1, 1) == Approx(2.0f));
+	const float expected = 1.0f / (1.0f + std::exp(-2.0f));
+	CHECK(result(0, 0) == Approx(expected));
+	CHECK(result(1, 0) == Approx(expected));
+
+	CHECK_THROWS(engine->run({{"input_1", input}}, {"output_1", "missing"}));
+}
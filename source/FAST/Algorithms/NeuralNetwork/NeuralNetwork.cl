@@ -4,7 +4,8 @@ __kernel void normalizeInput(
 	__read_only image2d_t input,
 	__global float* output,
 	__private float scaleFactor,
-	__private int horizontalFlip
+	__private int horizontalFlip,
+	__private int outputOffset
 	) {
 	
 	const int2 pos = {get_global_id(0), get_global_id(1)};
@@ -21,9 +22,9 @@ __kernel void normalizeInput(
 	value = value*scaleFactor;
 
 	if(horizontalFlip == 1) {
-        output[pos.x + (get_global_size(0) - pos.y - 1)*get_global_size(0)] = value;
+        output[outputOffset + (get_global_size(0) - pos.x - 1) + pos.y*get_global_size(0)] = value;
     } else {
-        output[pos.x + pos.y*get_global_size(0)] = value;
+        output[outputOffset + pos.x + pos.y*get_global_size(0)] = value;
     }
 }
 	
\ No newline at end of file
@@ -2,76 +2,53 @@
 #include "FAST/Data/Image.hpp"
 #include "FAST/Algorithms/ImageResizer/ImageResizer.hpp"
 
-#include <tensorflow/core/framework/step_stats.pb.h>
-#include <tensorflow/core/framework/tensor.h>
-#include <tensorflow/core/framework/types.pb.h>
-#include <tensorflow/core/lib/strings/stringprintf.h>
-#include <tensorflow/core/platform/env.h>
-#include <tensorflow/core/platform/logging.h>
-#include <tensorflow/core/platform/mutex.h>
-#include <tensorflow/core/platform/types.h>
-#include <tensorflow/core/public/session.h>
-#include <tensorflow/core/graph/default_device.h>
-#include <tensorflow/core/platform/init_main.h>
-#include <tensorflow/cc/framework/ops.h>
+#include "CPUInferenceEngine.hpp"
+#ifdef FAST_MODULE_NEURAL_NETWORK
+#include "TensorFlowInferenceEngine.hpp"
+#endif
 
 namespace fast {
 
-// See here for reference: https://github.com/tensorflow/tensorflow/blob/86f5ab7474825da756838b34e1b4eac93f5fc68a/tensorflow/contrib/android/jni/tensorflow_inference_jni.cc
-
 void NeuralNetwork::load(std::string networkFilename) {
-
-	char** argv = new char*[1];
-	argv[0] = new char[255];
-    int argc = 1;
-    tensorflow::port::InitMain(argv[0], &argc, &argv);
-	tensorflow::SessionOptions options;
-	tensorflow::ConfigProto &config = options.config;
-	tensorflow::GPUOptions* gpuOptions = config.mutable_gpu_options();
-	gpuOptions->set_allow_growth(true); // Set this so that tensorflow will not use up all GPU memory
-	//gpuOptions->set_per_process_gpu_memory_fraction(0.5);
-	mSession.reset(tensorflow::NewSession(options));
-	tensorflow::GraphDef tensorflow_graph;
-
-	{
-		tensorflow::Status s = ReadBinaryProto(tensorflow::Env::Default(), networkFilename, &tensorflow_graph);
-		if (!s.ok()) {
-			throw Exception("Could not read TensorFlow graph file " + networkFilename);
+	if(!mEngine.isValid()) {
+		const std::string extension = networkFilename.size() > 4 ? networkFilename.substr(networkFilename.size() - 4) : "";
+		if(extension == ".fnn") {
+			mEngine = CPUInferenceEngine::New();
+		} else {
+#ifdef FAST_MODULE_NEURAL_NETWORK
+			mEngine = TensorFlowInferenceEngine::New();
+#else
+			throw Exception("FAST was built without TensorFlow, thus only FAST network files (.fnn) can be loaded: " + networkFilename);
+#endif
 		}
 	}
+	reportInfo() << "Loading network using " << mEngine->getNameOfClass() << reportEnd();
+	mEngine->load(networkFilename);
 
 	// Assume first node is input node
 	if(mInputName == "")
-        mInputName = tensorflow_graph.node(0).name();
-    for(int i = 0; i < tensorflow_graph.node_size(); ++i) {
-		tensorflow::NodeDef node = tensorflow_graph.node(i);
-        //reportInfo() << "Node " << i << " with name " << node.name() << reportEnd();
-        //reportInfo() << "Op name " << node.op() << reportEnd();
-        //reportInfo() << "inputs: " << node.input_size() << reportEnd();
-        if(node.name().find("keras_learning_phase") != std::string::npos) {
-			mLearningPhaseTensors.push_back(node.name());
-		}
-	}
-
-	reportInfo() << "Creating session." << reportEnd();
-	tensorflow::Status s = mSession->Create(tensorflow_graph);
-	if (!s.ok()) {
-		throw Exception("Could not create TensorFlow Graph");
-	}
+		mInputName = mEngine->getDefaultInputName();
 
-	//tensorflow::graph::SetDefaultDevice("/gpu:0", &tensorflow_graph);
+	mModelLoaded = true;
+}
 
-	// Clear the proto to save memory space.
-	tensorflow_graph.Clear();
-	reportInfo() << "TensorFlow graph loaded from: " << networkFilename << reportEnd();
+void NeuralNetwork::setInferenceEngine(InferenceEngine::pointer engine) {
+	mEngine = engine;
+	mModelLoaded = false;
+}
 
-	mModelLoaded = true;
+InferenceEngine::pointer NeuralNetwork::getInferenceEngine() const {
+	return mEngine;
 }
 
 void NeuralNetwork::setScaleFactor(float factor) {
     mScaleFactor = factor;
 }
 
+float NeuralNetwork::getScaleFactor() const {
+    return mScaleFactor;
+}
+
 void NeuralNetwork::setPreserveAspectRatio(bool preserve) {
     mPreserveAspectRatio = preserve;
 }
@@ -80,16 +57,22 @@ void NeuralNetwork::setHorizontalFlipping(bool flip) {
 	mHorizontalImageFlipping = flip;
 }
 
+bool NeuralNetwork::getHorizontalFlipping() const {
+	return mHorizontalImageFlipping;
+}
+
 NeuralNetwork::NeuralNetwork() {
 	createInputPort<Image>(0);
 	mModelLoaded = false;
+	// Keeps OpenCL objects of the main device between executions, so it is not moved by the device scheduler
+	mDeviceSchedulingAllowed = false;
 	mPreserveAspectRatio = false;
 	mInputName = "";
 	mWidth = -1;
 	mHeight = -1;
 	mScaleFactor = 1.0f;
 	createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/NeuralNetwork/NeuralNetwork.cl");
-	createStringAttribute("model", "Model path", "Path to neural network tensorflow model", "");
+	createStringAttribute("model", "Model path", "Path to neural network model", "");
 	createIntegerAttribute("input_size", "Input size", "Image input size", 128);
 	createFloatAttribute("scale_factor", "Scale factor", "Scale factor", mScaleFactor);
 	createStringAttribute("output_names", "Output names", "Name of output nodes", "");
@@ -125,17 +108,40 @@ void NeuralNetwork::setOutputParameters(std::vector<std::string> outputNodeNames
     mOutputNames = outputNodeNames;
 }
 
-tensorflow::Tensor NeuralNetwork::getNetworkOutput() {
+NetworkTensor NeuralNetwork::getNetworkOutput() {
     if(mOutputNames.size() != 1)
 		throw Exception("If network has more than 1 output can't return network output without name.");
 
 	return mOutputData[mOutputNames[0]];
 }
 
-tensorflow::Tensor NeuralNetwork::getNetworkOutput(std::string name) {
+NetworkTensor NeuralNetwork::getNetworkOutput(std::string name) {
 	return mOutputData.at(name);
 }
 
+void NeuralNetwork::processBatch(const std::vector<Image::pointer>& images) {
+	if(mWidth < 0 || mHeight < 0)
+		throw Exception("Network input layer width and height has to be specified before running the network");
+
+	executeNetwork(resizeImages(images));
+}
+
+template <class T>
+static void copyImageToTensor(const T* input, float* output, int width, int height, int components, float scaleFactor, bool horizontalFlip) {
+	// Only the first channel is used, same as the normalizeInput kernel
+	for(int y = 0; y < height; ++y) {
+		const T* inputRow = input + y*width*components;
+		float* outputRow = output + y*width;
+		if(horizontalFlip) {
+			for(int x = 0; x < width; ++x)
+				outputRow[width - x - 1] = inputRow[x*components]*scaleFactor;
+		} else {
+			for(int x = 0; x < width; ++x)
+				outputRow[x] = inputRow[x*components]*scaleFactor;
+		}
+	}
+}
+
 void NeuralNetwork::executeNetwork(const std::vector<Image::pointer>& images) {
     if(!mModelLoaded)
 		throw Exception("Network and weights must be loaded in NeuralNetwork before execution.");
@@ -143,146 +149,108 @@ void NeuralNetwork::executeNetwork(const std::vector<Image::pointer>& images) {
 		throw Exception("An input name must ge given to the NeuralNetwork before execution");
 	if(mOutputNames.size() == 0)
 		throw Exception("An output name must ge given to the NeuralNetwork before execution");
-
-    int batchSize = 1;//images.size();
-	if(batchSize == 0)
+	if(images.size() == 0)
 		throw Exception("Need at least one image to execute network.");
+	if(images.size() % mFramesToRemember != 0)
+		throw Exception("Nr of images given to the network must be a multiple of the nr of frames to remember");
 
-	// Create input tensor
-	tensorflow::TensorShape shape = tensorflow::TensorShape({batchSize, mHeight, mWidth, 1});
+	const int batchSize = images.size() / mFramesToRemember;
+	for(Image::pointer image : images) {
+		if(image->getWidth() != mWidth || image->getHeight() != mHeight)
+			throw Exception("Input image sent to executeNetwork was of incrorrect size");
+	}
+
+	// Create input tensor, images are stored consecutively in the tensor
+	std::vector<int> shape = {batchSize, mHeight, mWidth, 1};
 	if(mFramesToRemember > 1)
-		shape = tensorflow::TensorShape({batchSize, mFramesToRemember, mHeight, mWidth, 1});
+		shape = {batchSize, (int)mFramesToRemember, mHeight, mWidth, 1};
+	if(mInputTensor.getShape() != shape)
+		mInputTensor = mEngine->createInputTensor(mInputName, shape);
 
     mRuntimeManager->startRegularTimer("input_data_copy");
-    float* values = new float[batchSize*mWidth*mHeight];
-
-	OpenCLDevice::pointer device = getMainDevice();
-    cl::Program program = getOpenCLProgram(device);
-	cl::Kernel kernel(program, "normalizeInput");
-	Image::pointer image = images[0];
-	OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
-    cl::Buffer buffer(
-			device->getContext(),
-			CL_MEM_WRITE_ONLY,
-			sizeof(float)*mWidth*mHeight
-	);
-	kernel.setArg(0, *access->get2DImage());
-	kernel.setArg(1, buffer);
-	kernel.setArg(2, mScaleFactor);
-	kernel.setArg(3, (int)(mHorizontalImageFlipping ? 1 : 0));
-
-	device->getCommandQueue().enqueueNDRangeKernel(
-			kernel,
-			cl::NullRange,
-			cl::NDRange(mWidth, mHeight),
-			cl::NullRange
-	);
-
-	device->getCommandQueue().enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(float)*mWidth*mHeight, values);
-
-	tensorflow::Tensor input_tensor(
-			tensorflow::DT_FLOAT,
-			shape
-	);
-    if(image->getWidth() != mWidth || image->getHeight() != mHeight)
-        throw Exception("Input image sent to executeNetwork was of incrorrect size");
-
-	auto input_tensor_mapped = input_tensor.tensor<float, 4>();
-    for(int i = 0; i < mHeight; ++i) { // y
-        for(int j = 0; j < mWidth; ++j) { // x
-			input_tensor_mapped(0, i, j, 0) = values[j+i*mWidth];
-        }
-    }
-    delete[] values;
-
-	/*
-    if(mFramesToRemember > 1) {
-        auto input_tensor_mapped = input_tensor.tensor<float, 5>();
-
-		mRuntimeManager->startRegularTimer("input_data_copy");
-		reportInfo() << "TensorFlow: Copying Data." << reportEnd();
-		for(int n = 0; n < batchSize; ++n) {
-            for(int t = 0; t < images.size(); ++t) {
-				Image::pointer image = images[t];
-				if(image->getWidth() != mWidth || image->getHeight() != mHeight)
-					throw Exception("Input image sent to executeNetwork was of incrorrect size");
-
-				ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
-				if(mHorizontalImageFlipping) {
-					for(int i = 0; i < mHeight; ++i) { // y
-						for(int j = 0; j < mWidth; ++j) { // x
-							input_tensor_mapped(n, t, i, mWidth - j - 1, 0) =
-                                access->getScalar(Vector2i(j, i)) * mScaleFactor;
-						}
-					}
-				} else {
-					for(int i = 0; i < mHeight; ++i) { // y
-						for(int j = 0; j < mWidth; ++j) { // x
-							input_tensor_mapped(n, t, i, j, 0) = access->getScalar(Vector2i(j, i)) * mScaleFactor;
-						}
-					}
-				}
-			}
-		}
-	} else {
-		auto input_tensor_mapped = input_tensor.flat<float>();
-
-		mRuntimeManager->startRegularTimer("input_data_copy");
-		reportInfo() << "TensorFlow: Copying Data." << reportEnd();
-		for(int n = 0; n < batchSize; ++n) {
-			Image::pointer image = images[n];
-			if(image->getWidth() != mWidth || image->getHeight() != mHeight)
-				throw Exception("Input image sent to executeNetwork was of incrorrect size");
+	float* values = mInputTensor.getData();
+	const int imageSize = mWidth*mHeight;
 
+	if(getMainDevice()->isHost()) {
+		for(int i = 0; i < images.size(); ++i) {
+			Image::pointer image = images[i];
 			ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
-			if(mHorizontalImageFlipping) {
-				for(int i = 0; i < mHeight; ++i) { // y
-					for(int j = 0; j < mWidth; ++j) { // x
-						input_tensor_mapped(n + i + (mWidth - j - 1)*mHeight) = access->getScalar(Vector2i(j, i)) * mScaleFactor;
-					}
-				}
-			} else {
-				for(int i = 0; i < mHeight; ++i) { // y
-					for(int j = 0; j < mWidth; ++j) { // x
-						input_tensor_mapped(n, i, j, 0) = access->getScalar(Vector2i(j, i)) * mScaleFactor;
-					}
-				}
+			switch(image->getDataType()) {
+				fastSwitchTypeMacro(copyImageToTensor<FAST_TYPE>(
+						(const FAST_TYPE*)access->get(),
+						values + i*imageSize,
+						mWidth,
+						mHeight,
+						image->getNrOfComponents(),
+						mScaleFactor,
+						mHorizontalImageFlipping
+				));
 			}
 		}
+	} else {
+		// Normalize all images into one buffer, and transfer the entire batch at once
+		OpenCLDevice::pointer device = getMainDevice();
+		cl::Program program = getOpenCLProgram(device);
+		cl::Kernel kernel(program, "normalizeInput");
+		const std::size_t bufferSize = sizeof(float)*imageSize*images.size();
+		if(mInputBufferSize != bufferSize) {
+			mInputBuffer = cl::Buffer(
+					device->getContext(),
+					CL_MEM_WRITE_ONLY,
+					bufferSize
+			);
+			mInputBufferSize = bufferSize;
+		}
+		kernel.setArg(1, mInputBuffer);
+		kernel.setArg(2, mScaleFactor);
+		kernel.setArg(3, (int)(mHorizontalImageFlipping ? 1 : 0));
+
+		for(int i = 0; i < images.size(); ++i) {
+			OpenCLImageAccess::pointer access = images[i]->getOpenCLImageAccess(ACCESS_READ, device);
+			kernel.setArg(0, *access->get2DImage());
+			kernel.setArg(4, i*imageSize);
+			device->getCommandQueue().enqueueNDRangeKernel(
+					kernel,
+					cl::NullRange,
+					cl::NDRange(mWidth, mHeight),
+					cl::NullRange
+			);
+		}
+
+		device->getCommandQueue().enqueueReadBuffer(mInputBuffer, CL_TRUE, 0, bufferSize, values);
 	}
-	 */
 	mRuntimeManager->stopRegularTimer("input_data_copy");
 
-    // TODO Need to know names of inputs and outputs in advance
-	// Input: Only single for now
-	// Output: Can be multiple
+	runNetwork(mInputTensor);
+}
 
+void NeuralNetwork::processTensor(NetworkTensor input) {
+    if(!mModelLoaded)
+		throw Exception("Network and weights must be loaded in NeuralNetwork before execution.");
+	if(mInputName == "")
+		throw Exception("An input name must ge given to the NeuralNetwork before execution");
+	if(mOutputNames.size() == 0)
+		throw Exception("An output name must ge given to the NeuralNetwork before execution");
+	const std::vector<int>& shape = input.getShape();
+	if(shape.size() != 4 || shape[0] == 0 || shape[3] != 1)
+		throw Exception("Input tensor given to processTensor must have shape batch size x height x width x 1");
+	if((mWidth >= 0 && shape[2] != mWidth) || (mHeight >= 0 && shape[1] != mHeight))
+		throw Exception("Input tensor sent to processTensor was of incorrect size");
 
-	std::vector <std::pair<std::string, tensorflow::Tensor>> input_tensors(
-			{{mInputName, input_tensor}});
+	runNetwork(input);
+}
 
-    for(std::string name : mLearningPhaseTensors) {
-        // Create a scalar tensor which tells the system we are NOT doing training
-        tensorflow::Tensor input_tensor2(
-                tensorflow::DT_BOOL,
-                tensorflow::TensorShape() // Scalar
-        );
-        auto input_tensor_mapped2 = input_tensor2.tensor<bool, 0>();
-        input_tensor_mapped2(0) = false;
-        input_tensors.push_back(std::make_pair(name, input_tensor2));
-    }
+void NeuralNetwork::runNetwork(NetworkTensor input) {
+    // TODO Need to know names of inputs and outputs in advance
+	// Input: Only single for now
+	// Output: Can be multiple
 
-	std::vector <tensorflow::Tensor> output_tensors;
 
 	reportInfo() << "Running network" << reportEnd();
-	tensorflow::Status s;
 	mRuntimeManager->startRegularTimer("network_execution");
-	s = mSession->Run(input_tensors, mOutputNames, {}, &output_tensors);
+	std::vector<NetworkTensor> output_tensors = mEngine->run({{mInputName, input}}, mOutputNames);
 	mRuntimeManager->stopRegularTimer("network_execution");
 
-	if (!s.ok()) {
-		throw Exception("Error during inference: " + s.ToString());
-	}
 	reportInfo() << "Finished executing network" << reportEnd();
     // Store all output data
     for(int j = 0; j < mOutputNames.size(); ++j) {
@@ -2,8 +2,7 @@
 #define NEURAL_NETWORK_HPP_
 
 #include "FAST/ProcessObject.hpp"
-#include <tensorflow/core/public/session.h>
-#include <tensorflow/core/framework/tensor.h>
+#include "InferenceEngine.hpp"
 #include <queue>
 
 namespace fast {
@@ -12,11 +11,24 @@ class Image;
 
 class FAST_EXPORT  NeuralNetwork : public ProcessObject {
 public:
+    /**
+     * Load a network from file. If no inference engine has been set, the engine is selected from the file extension:
+     * FAST network files (.fnn) are run with the built-in CPUInferenceEngine, everything else with TensorFlow.
+     * TensorFlow is only available when FAST is built with the neural network module.
+     * @param networkFilename
+     */
     void load(std::string networkFilename);
+    /**
+     * Set which inference engine to use for executing the network. Must be set before calling load.
+     * @param engine
+     */
+    void setInferenceEngine(InferenceEngine::pointer engine);
+    InferenceEngine::pointer getInferenceEngine() const;
     void setInputSize(int width, int height);
     void setInputName(std::string inputName);
     void setOutputParameters(std::vector<std::string> outputNodeNames);
     void setScaleFactor(float scale);
+    float getScaleFactor() const;
     void setPreserveAspectRatio(bool preserve);
     /**
      * Setting this parameter to true will flip the input image horizontally.
@@ -24,6 +36,7 @@ public:
      * @param flip
      */
     void setHorizontalFlipping(bool flip);
+    bool getHorizontalFlipping() const;
 
     /**
      * Set the nr of frames to keep and give to the network.
@@ -33,32 +46,54 @@ public:
      */
     void setRememberFrames(uint nrOfFrames);
 
+    /**
+     * Run the network on several images in one batch, outside of the pipeline.
+     * This is useful for offline processing of recorded sequences, as the network is only executed once per batch.
+     * Images are resized to the input size if needed. If remember frames is set to N > 1,
+     * each consecutive group of N images becomes one entry in the batch.
+     * The first dimension of the network output tensors will be the batch size.
+     * @param images
+     */
+    void processBatch(const std::vector<SharedPointer<Image> >& images);
+
+    /**
+     * Run the network on an input tensor which has already been prepared, e.g. a batch of image regions
+     * sampled directly on the GPU. The tensor is given to the network as is, thus no resizing, scaling or
+     * flipping is done. The shape has to be batch size x height x width x 1.
+     * @param input
+     */
+    void processTensor(NetworkTensor input);
+
     // Use this if only one output node
-    tensorflow::Tensor getNetworkOutput();
+    NetworkTensor getNetworkOutput();
 
     // Get output by layer name
-    tensorflow::Tensor getNetworkOutput(std::string layerName);
+    NetworkTensor getNetworkOutput(std::string layerName);
 
     void loadAttributes();
 protected:
     NeuralNetwork();
-    UniquePointer<tensorflow::Session> mSession;
+    InferenceEngine::pointer mEngine;
     bool mModelLoaded;
     bool mPreserveAspectRatio;
     bool mHorizontalImageFlipping = false;
-    std::vector<std::string> mLearningPhaseTensors;
     int mWidth;
     int mHeight;
     uint mFramesToRemember = 1;
     float mScaleFactor;
     std::string mInputName;
     std::vector<std::string> mOutputNames;
-    std::map<std::string, tensorflow::Tensor> mOutputData;
+    std::map<std::string, NetworkTensor> mOutputData;
     std::deque<SharedPointer<Image>> mImages;
+    // Input tensor and device buffer are kept between executions, and only reallocated if the batch size changes
+    NetworkTensor mInputTensor;
+    cl::Buffer mInputBuffer;
+    std::size_t mInputBufferSize = 0;
 
     void execute();
 
     void executeNetwork(const std::vector<SharedPointer<Image> >& images);
+    void runNetwork(NetworkTensor input);
     std::vector<SharedPointer<Image> > resizeImages(const std::vector<SharedPointer<Image> >& images);
 };
 
@@ -68,7 +68,8 @@ void ObjectDetection::execute() {
 
 	mRuntimeManager->startRegularTimer("create_mesh");
     // Get outputs
-	std::vector<float> result = getNetworkOutput("concat_v2")[0];
+	NetworkTensor output = getNetworkOutput("concat_v2");
+	std::vector<float> result(output.getData(), output.getData() + output.getShape().back()); // First image in batch
 	std::vector<float> detectorResult(result.begin(), result.begin()+5);
 	std::vector<float> positionResult(result.begin()+5, result.begin()+15);
 	std::vector<float> sizeResult(result.begin()+15, result.end());
@@ -39,8 +39,8 @@ void PixelClassifier::execute() {
     }
     NeuralNetwork::execute();
 
-    tensorflow::Tensor tensor = getNetworkOutput();
-    Eigen::Tensor<float, 4, 1> tensor_mapped = tensor.tensor<float, 4>();
+    NetworkTensor tensor = getNetworkOutput();
+    Eigen::TensorMap<Eigen::Tensor<float, 4, Eigen::RowMajor> > tensor_mapped = tensor.getTensor<4>();
     int outputHeight = tensor_mapped.dimension(1);
     int outputWidth = tensor_mapped.dimension(2);
 
@@ -19,20 +19,20 @@ void ShapeRegressor::execute() {
 
 	// Create output data
 	reportInfo() << "RESULT: " << reportEnd();
-	std::vector<std::vector<float> > result;
-    result = getNetworkOutput("Sigmoid");
+	NetworkTensor tensor = getNetworkOutput("Sigmoid");
+	Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor> > result = tensor.getTensor<2>();
 
 	Mesh::pointer output = getOutputData<Mesh>(0);
     std::vector<MeshVertex> vertices;
 	std::vector<VectorXui> lines;
-	for(int i = 0; i < result.size(); ++i) { // For each input image
-        for(int j = 0; j < result[i].size(); j += 2) { // For each landmark
-			float x = result[i][j];
+	for(int i = 0; i < result.dimension(0); ++i) { // For each input image
+        for(int j = 0; j < result.dimension(1); j += 2) { // For each landmark
+			float x = result(i, j);
 			x *= mImage->getWidth();
             x *= mImage->getSpacing().x();
 			//x *= (float)mImage->getWidth() / mWidth;
 			std::cout << "x: " << x << std::endl;
-			float y = result[i][j+1];
+			float y = result(i, j+1);
 			y *= mImage->getHeight();
 			y *= mImage->getSpacing().y();
 			//y *= (float)mImage->getHeight() / mHeight;
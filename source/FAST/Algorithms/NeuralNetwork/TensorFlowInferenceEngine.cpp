@@ -0,0 +1,144 @@
+#include "TensorFlowInferenceEngine.hpp"
+
+#include <tensorflow/core/framework/step_stats.pb.h>
+#include <tensorflow/core/framework/tensor.h>
+#include <tensorflow/core/framework/types.pb.h>
+#include <tensorflow/core/lib/strings/stringprintf.h>
+#include <tensorflow/core/platform/env.h>
+#include <tensorflow/core/platform/logging.h>
+#include <tensorflow/core/platform/mutex.h>
+#include <tensorflow/core/platform/types.h>
+#include <tensorflow/core/public/session.h>
+#include <tensorflow/core/graph/default_device.h>
+#include <tensorflow/core/platform/init_main.h>
+#include <tensorflow/cc/framework/ops.h>
+#include <cstring>
+
+namespace fast {
+
+// See here for reference: https://github.com/tensorflow/tensorflow/blob/86f5ab7474825da756838b34e1b4eac93f5fc68a/tensorflow/contrib/android/jni/tensorflow_inference_jni.cc
+
+TensorFlowInferenceEngine::TensorFlowInferenceEngine() {
+}
+
+void TensorFlowInferenceEngine::load(std::string filename) {
+
+	char** argv = new char*[1];
+	argv[0] = new char[255];
+    int argc = 1;
+    tensorflow::port::InitMain(argv[0], &argc, &argv);
+	tensorflow::SessionOptions options;
+	tensorflow::ConfigProto &config = options.config;
+	tensorflow::GPUOptions* gpuOptions = config.mutable_gpu_options();
+	gpuOptions->set_allow_growth(true); // Set this so that tensorflow will not use up all GPU memory
+	//gpuOptions->set_per_process_gpu_memory_fraction(0.5);
+	mSession.reset(tensorflow::NewSession(options));
+	tensorflow::GraphDef tensorflow_graph;
+
+	{
+		tensorflow::Status s = ReadBinaryProto(tensorflow::Env::Default(), filename, &tensorflow_graph);
+		if (!s.ok()) {
+			throw Exception("Could not read TensorFlow graph file " + filename);
+		}
+	}
+
+	// Assume first node is input node
+	mFirstNodeName = tensorflow_graph.node(0).name();
+	mLearningPhaseTensors.clear();
+    for(int i = 0; i < tensorflow_graph.node_size(); ++i) {
+		tensorflow::NodeDef node = tensorflow_graph.node(i);
+        //reportInfo() << "Node " << i << " with name " << node.name() << reportEnd();
+        //reportInfo() << "Op name " << node.op() << reportEnd();
+        //reportInfo() << "inputs: " << node.input_size() << reportEnd();
+        if(node.name().find("keras_learning_phase") != std::string::npos) {
+			mLearningPhaseTensors.push_back(node.name());
+		}
+	}
+
+	reportInfo() << "Creating session." << reportEnd();
+	tensorflow::Status s = mSession->Create(tensorflow_graph);
+	if (!s.ok()) {
+		throw Exception("Could not create TensorFlow Graph");
+	}
+
+	//tensorflow::graph::SetDefaultDevice("/gpu:0", &tensorflow_graph);
+
+	// Clear the proto to save memory space.
+	tensorflow_graph.Clear();
+	reportInfo() << "TensorFlow graph loaded from: " << filename << reportEnd();
+}
+
+std::string TensorFlowInferenceEngine::getDefaultInputName() const {
+	return mFirstNodeName;
+}
+
+NetworkTensor TensorFlowInferenceEngine::createInputTensor(std::string name, std::vector<int> shape) {
+	tensorflow::TensorShape tensorShape;
+	for(int dimension : shape) {
+		if(dimension < 0)
+			throw Exception("Network tensor dimensions can't be negative");
+		tensorShape.AddDim(dimension);
+	}
+	// Tensor copies share the same reference counted buffer
+	auto tensor = std::make_shared<tensorflow::Tensor>(tensorflow::DT_FLOAT, tensorShape);
+	mInputTensors[name] = *tensor;
+	return NetworkTensor(shape, tensor->flat<float>().data(), tensor);
+}
+
+std::vector<NetworkTensor> TensorFlowInferenceEngine::run(
+		const std::vector<std::pair<std::string, NetworkTensor> >& inputs,
+		const std::vector<std::string>& outputNames) {
+	if(!mSession)
+		throw Exception("A TensorFlow graph must be loaded before running the inference engine");
+
+	std::vector <std::pair<std::string, tensorflow::Tensor>> input_tensors;
+	for(const std::pair<std::string, NetworkTensor>& input : inputs) {
+		tensorflow::TensorShape shape;
+		for(int dimension : input.second.getShape())
+			shape.AddDim(dimension);
+		auto it = mInputTensors.find(input.first);
+		if(it != mInputTensors.end() && it->second.flat<float>().data() == input.second.getData() &&
+				it->second.shape().IsSameSize(shape)) {
+			// Input was created by createInputTensor, and already wraps the memory of a tensorflow tensor
+			input_tensors.push_back(std::make_pair(input.first, it->second));
+		} else {
+			tensorflow::Tensor tensor(tensorflow::DT_FLOAT, shape);
+			std::memcpy(tensor.flat<float>().data(), input.second.getData(), input.second.getSize()*sizeof(float));
+			input_tensors.push_back(std::make_pair(input.first, tensor));
+		}
+	}
+
+    for(std::string name : mLearningPhaseTensors) {
+        // Create a scalar tensor which tells the system we are NOT doing training
+        tensorflow::Tensor input_tensor2(
+                tensorflow::DT_BOOL,
+                tensorflow::TensorShape() // Scalar
+        );
+        auto input_tensor_mapped2 = input_tensor2.tensor<bool, 0>();
+        input_tensor_mapped2(0) = false;
+        input_tensors.push_back(std::make_pair(name, input_tensor2));
+    }
+
+	std::vector <tensorflow::Tensor> output_tensors;
+	tensorflow::Status s = mSession->Run(input_tensors, outputNames, {}, &output_tensors);
+	if (!s.ok()) {
+		throw Exception("Error during inference: " + s.ToString());
+	}
+
+	std::vector<NetworkTensor> outputs;
+	for(const tensorflow::Tensor& tensor : output_tensors) {
+		// NetworkTensor only holds float data
+		if(tensor.dtype() != tensorflow::DT_FLOAT)
+			throw Exception("Output tensors of the network must be float, got " + tensorflow::DataType_Name(tensor.dtype()));
+		std::vector<int> shape;
+		for(int i = 0; i < tensor.dims(); ++i)
+			shape.push_back(tensor.dim_size(i));
+		// The output wraps the tensor memory, and keeps a reference to the tensor buffer
+		auto owner = std::make_shared<tensorflow::Tensor>(tensor);
+		outputs.push_back(NetworkTensor(shape, owner->flat<float>().data(), owner));
+	}
+
+	return outputs;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef TENSORFLOW_INFERENCE_ENGINE_HPP_
+#define TENSORFLOW_INFERENCE_ENGINE_HPP_
+
+#include "InferenceEngine.hpp"
+#include <tensorflow/core/public/session.h>
+#include <tensorflow/core/framework/tensor.h>
+
+namespace fast {
+
+/**
+ * Inference engine which executes frozen TensorFlow graphs (.pb files)
+ */
+class FAST_EXPORT TensorFlowInferenceEngine : public InferenceEngine {
+    FAST_OBJECT(TensorFlowInferenceEngine)
+    public:
+        void load(std::string filename);
+        std::string getDefaultInputName() const;
+        NetworkTensor createInputTensor(std::string name, std::vector<int> shape) override;
+        std::vector<NetworkTensor> run(
+                const std::vector<std::pair<std::string, NetworkTensor> >& inputs,
+                const std::vector<std::string>& outputNames
+        );
+    private:
+        TensorFlowInferenceEngine();
+
+        UniquePointer<tensorflow::Session> mSession;
+        std::string mFirstNodeName;
+        std::vector<std::string> mLearningPhaseTensors;
+        // Input tensors created by createInputTensor. Inputs which wrap one of these are given to the session
+        // without copying.
+        std::map<std::string, tensorflow::Tensor> mInputTensors;
+};
+
+}
+
+#endif
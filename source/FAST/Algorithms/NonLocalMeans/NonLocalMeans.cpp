@@ -9,6 +9,8 @@ using namespace fast;
 NonLocalMeans::NonLocalMeans() {
 	createInputPort<Image>(0);
 	createOutputPort<Image>(0);
+	// Keeps OpenCL objects of the main device between executions, so it is not moved by the device scheduler
+	mDeviceSchedulingAllowed = false;
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/NonLocalMeans/NonLocalMeans2Dgs.cl", "2D");
     //createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/NonLocalMeans/NonLocalMeans2Dgaussian.cl", "2Dg");
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/NonLocalMeans/NonLocalMeans3Dgs.cl", "3D");
@@ -1,5 +1,22 @@
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
 
+// The data types of the input and output are given by the build options of ProcessObject::getOpenCLProgram
+#if defined(FAST_INPUT0_TYPE_FLOAT)
+#define readInput(pos) read_imagef(input, sampler, pos).x
+#elif defined(FAST_INPUT0_TYPE_UINT)
+#define readInput(pos) (float)read_imageui(input, sampler, pos).x
+#else
+#define readInput(pos) (float)read_imagei(input, sampler, pos).x
+#endif
+
+#if defined(FAST_OUTPUT0_TYPE_FLOAT)
+#define writeOutput(pos, value) write_imagef(output, pos, value)
+#elif defined(FAST_OUTPUT0_TYPE_UINT)
+#define writeOutput(pos, value) write_imageui(output, pos, round(value))
+#else
+#define writeOutput(pos, value) write_imagei(output, pos, round(value))
+#endif
+
 __kernel void noneLocalMeans(
 		__read_only image2d_t input,
 		__write_only image2d_t output,
@@ -10,7 +27,6 @@ __kernel void noneLocalMeans(
 		
 		){
     
-    const int dataType = get_image_channel_data_type(input);
     const float pi = 3.14159265359;
     const int2 iD = get_image_dim(input);
     const int2 pos = {get_global_id(0), get_global_id(1)};
@@ -51,13 +67,7 @@ __kernel void noneLocalMeans(
                         int2 mPos = {mX,mY};
                         int2 sPos = {k,l};
                         
-                        if(dataType == CLK_FLOAT){
-                            indi = read_imagef(input, sampler,mPos).x - read_imagef(input, sampler, sPos).x;
-                        }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                            indi = read_imageui(input, sampler,mPos).x - read_imageui(input, sampler, sPos).x;
-                        }else{
-                            indi = read_imagei(input, sampler,mPos).x - read_imagei(input, sampler, sPos).x;
-                        }
+                        indi = readInput(mPos) - readInput(sPos);
                         indi = fabs(indi*indi);
                         
                         if(EUCLID ==  1){
@@ -79,13 +89,7 @@ __kernel void noneLocalMeans(
                     
                 }
                 int2 coord = {i,j};
-                if(dataType == CLK_FLOAT){
-                    value = read_imagef(input,sampler,coord).x;
-                }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                    value = read_imageui(input,sampler,coord).x;
-                }else{
-                    value = read_imagei(input,sampler,coord).x;
-                }
+                value = readInput(coord);
                 if(EUCLID ==  1){
                     float dist = ((pos.x - coord.x) * (pos.x - coord.x)) + ((pos.y - coord.y) * (pos.y - coord.y));
                     dist = native_sqrt(fabs(dist));
@@ -117,14 +121,7 @@ __kernel void noneLocalMeans(
         value = 1.0f;
     }
     
-    int outputDataType = get_image_channel_data_type(output);
-    if(outputDataType == CLK_FLOAT) {
-        write_imagef(output, pos, value);
-    } else if(outputDataType == CLK_UNSIGNED_INT8 || outputDataType == CLK_UNSIGNED_INT16) {
-        write_imageui(output, pos, round(value));
-    } else {
-        write_imagei(output, pos, round(value));
-    }
+    writeOutput(pos, value);
     /*
     if(outputDataType == CLK_FLOAT) {
         float holder = native_divide(totSum,normSum);
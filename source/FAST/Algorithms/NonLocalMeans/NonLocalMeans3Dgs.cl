@@ -1,6 +1,15 @@
 //#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
 
+// The data type of the input is given by the build options of ProcessObject::getOpenCLProgram
+#if defined(FAST_INPUT0_TYPE_FLOAT)
+#define readInput(pos) read_imagef(input, sampler, pos).x
+#elif defined(FAST_INPUT0_TYPE_UINT)
+#define readInput(pos) (float)read_imageui(input, sampler, pos).x
+#else
+#define readInput(pos) (float)read_imagei(input, sampler, pos).x
+#endif
+
 #ifdef fast_3d_image_writes
 __kernel void noneLocalMeans(
 		__read_only image3d_t input,
@@ -9,7 +18,6 @@ __kernel void noneLocalMeans(
 		__private float sigma2
 		){
     
-	const int dataType = get_image_channel_data_type(input);
     
     //const int4 iD = get_image_dim(input);
     const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2),0};
@@ -35,13 +43,7 @@ __kernel void noneLocalMeans(
                                 int4 mPos = {mX,mY,mZ,0};
                                 int4 sPos = {l,m,n,0};
                                 
-                                if(dataType == CLK_FLOAT){
-                                    indi = read_imagef(input, sampler,mPos).x - read_imagef(input, sampler, sPos).x;
-                                }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                                    indi = read_imageui(input, sampler,mPos).x - read_imageui(input, sampler, sPos).x;
-                                }else{
-                                    indi = read_imagei(input, sampler,mPos).x - read_imagei(input, sampler, sPos).x;
-                                }
+                                indi = readInput(mPos) - readInput(sPos);
                                 
                                 //indi = fabs(indi*indi);
                                 indi = indi * indi;
@@ -56,13 +58,7 @@ __kernel void noneLocalMeans(
                     int4 coord = {i,j,k,0};
                     
 					float value = 0.0f;
-                    if(dataType == CLK_FLOAT){
-                        value = read_imagef(input,sampler,coord).x;
-                    }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                        value = read_imageui(input,sampler,coord).x;
-                    }else{
-                        value = read_imagei(input,sampler,coord).x;
-                    }
+                    value = readInput(coord);
                     groupTot = K * groupTot;
                     groupTot = native_exp(-groupTot/strength2);
                     normSum += groupTot;
@@ -75,8 +71,8 @@ __kernel void noneLocalMeans(
     float value = native_divide(totSum,normSum);
     
     
-    int outputDataType = get_image_channel_data_type(output);
-    if(outputDataType == CLK_FLOAT) {
+#if defined(FAST_OUTPUT0_TYPE_FLOAT)
+    {
         float holder = native_divide(totSum,normSum);
         if(holder > 0){
             value = holder;
@@ -86,7 +82,9 @@ __kernel void noneLocalMeans(
             value = 0.0f;
         }
         write_imagef(output,pos,value);
-    } else if(outputDataType == CLK_UNSIGNED_INT8 || outputDataType == CLK_UNSIGNED_INT16) {
+    }
+#elif defined(FAST_OUTPUT0_TYPE_UINT)
+    {
         int holder = 0;
         if(value > -1 && value < 2){
             holder = value * 255;
@@ -95,7 +93,9 @@ __kernel void noneLocalMeans(
         }
         holder = min(max(holder,0),255);
         write_imageui(output, pos, holder);
-    } else {
+    }
+#else
+    {
         int holder = 0;
         if(value > -1 && value < 2){
             holder = value * 255;
@@ -105,6 +105,7 @@ __kernel void noneLocalMeans(
         holder = min(max(holder,0),255);
         write_imagei(output, pos, holder);
     }
+#endif
 }
 #else
 __kernel void noneLocalMeans(
@@ -114,7 +115,6 @@ __kernel void noneLocalMeans(
         __private float sigma2
         ){
     
-    const int dataType = get_image_channel_data_type(input);
     
     //const int4 iD = get_image_dim(input);
     const int4 pos = {get_global_id(0), get_global_id(1), get_global_id(2),0};
@@ -140,13 +140,7 @@ __kernel void noneLocalMeans(
                                 int4 mPos = {mX,mY,mZ,0};
                                 int4 sPos = {l,m,n,0};
                                 
-                                if(dataType == CLK_FLOAT){
-                                    indi = read_imagef(input, sampler,mPos).x - read_imagef(input, sampler, sPos).x;
-                                }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                                    indi = read_imageui(input, sampler,mPos).x - read_imageui(input, sampler, sPos).x;
-                                }else{
-                                    indi = read_imagei(input, sampler,mPos).x - read_imagei(input, sampler, sPos).x;
-                                }
+                                indi = readInput(mPos) - readInput(sPos);
                                 indi = indi * indi;
                                 //indi = fabs(indi*indi);
                                 
@@ -159,13 +153,7 @@ __kernel void noneLocalMeans(
                     }
                     int4 coord = {i,j,k,0};
                     
-                    if(dataType == CLK_FLOAT){
-                        value = read_imagef(input,sampler,coord).x;
-                    }else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16){
-                        value = read_imageui(input,sampler,coord).x;
-                    }else{
-                        value = read_imagei(input,sampler,coord).x;
-                    }
+                    value = readInput(coord);
                     groupTot = K * groupTot;
                     groupTot = native_exp(-groupTot/strength2);
                     normSum += groupTot;
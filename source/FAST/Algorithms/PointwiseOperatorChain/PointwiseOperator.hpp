@@ -0,0 +1,85 @@
+#ifndef FAST_POINTWISE_OPERATOR_HPP_
+#define FAST_POINTWISE_OPERATOR_HPP_
+
+#include "FAST/Data/DataTypes.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fast {
+
+/**
+ * Describes an operation where each pixel of the output image is computed from the same pixel of the input image,
+ * and optionally the same pixel of a second image, called the operand. A chain of such operations can be executed
+ * as one kernel by PointwiseOperatorChain, without creating the intermediate images.
+ */
+struct FAST_EXPORT PointwiseOperator {
+    /**
+     * OpenCL C expression which computes the new value from the float variable value.
+     * {operand} is the value of the operand image, {min} and {max} is the intensity range of the input to this
+     * operator and {p0}, {p1}, .. are the parameters.
+     */
+    std::string expression;
+    /**
+     * Host version of the expression, which is applied in place to count consecutive values. operands is nullptr
+     * if the operator has no operand. Use makePointwiseFunction to create it from a function of a single value.
+     */
+    std::function<void(float* values, const float* operands, int count, float minimum, float maximum)> function;
+    std::vector<float> parameters;
+    /**
+     * If true, the operand image is given on input port 1 of the process object
+     */
+    bool hasOperand = false;
+    /**
+     * If true, {min} and {max} are used in the expression
+     */
+    bool requiresIntensityRange = false;
+    /**
+     * Maps the intensity range of the input to the intensity range of the output. Not set if the range of the
+     * output can't be known without calculating it.
+     */
+    std::function<void(float& minimum, float& maximum)> transformIntensityRange;
+    /**
+     * If false, the output image has the data type outputType, otherwise the data type of the input
+     */
+    bool keepsDataType = true;
+    DataType outputType = TYPE_FLOAT;
+    /**
+     * If true, the output is a Segmentation with one channel, computed from the first channel of the input
+     */
+    bool isSegmentation = false;
+};
+
+/**
+ * Create the host function of a PointwiseOperator from a function of a single value
+ * float(float value, float operand, float minimum, float maximum). The function is inlined in the loop over the
+ * values, so that there is only one indirect call for each block of values.
+ */
+template <class Function>
+std::function<void(float*, const float*, int, float, float)> makePointwiseFunction(Function function) {
+    return [function](float* values, const float* operands, int count, float minimum, float maximum) {
+        if(operands == nullptr) {
+            for(int i = 0; i < count; ++i)
+                values[i] = function(values[i], 0.0f, minimum, maximum);
+        } else {
+            for(int i = 0; i < count; ++i)
+                values[i] = function(values[i], operands[i], minimum, maximum);
+        }
+    };
+}
+
+/**
+ * Interface for process objects which can be described by a PointwiseOperator
+ */
+class FAST_EXPORT PointwiseProcessObject {
+    public:
+        /**
+         * Get the operator with the current parameters of the process object
+         */
+        virtual PointwiseOperator getPointwiseOperator() = 0;
+        virtual ~PointwiseProcessObject() {};
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,311 @@
+#include "PointwiseOperatorChain.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Segmentation.hpp"
+#include "FAST/OpenCLProgram.hpp"
+
+namespace fast {
+
+PointwiseOperatorChain::PointwiseOperatorChain() {
+    createInputPort<Image>(0);
+    createOutputPort<Image>(0);
+}
+
+void PointwiseOperatorChain::addProcessObject(SharedPointer<ProcessObject> object) {
+    PointwiseProcessObject* pointwiseObject = dynamic_cast<PointwiseProcessObject*>(object.get());
+    if(pointwiseObject == nullptr)
+        throw Exception("Process object " + object->getNameOfClass() + " given to PointwiseOperatorChain is not a pointwise process object");
+
+    PointwiseOperator nextOperator = pointwiseObject->getPointwiseOperator();
+    if(!canAppend(mOperators, nextOperator))
+        throw Exception("Process object " + object->getNameOfClass() + " can't be added to the end of the PointwiseOperatorChain");
+
+    int operandInputPort = -1;
+    if(nextOperator.hasOperand) {
+        operandInputPort = mInputPorts.size();
+        createInputPort<Image>(operandInputPort);
+    }
+    mProcessObjects.push_back(object);
+    mOperators.push_back(nextOperator);
+    mOperandInputPorts.push_back(operandInputPort);
+    mIsModified = true;
+}
+
+int PointwiseOperatorChain::getNrOfProcessObjects() const {
+    return mProcessObjects.size();
+}
+
+uint PointwiseOperatorChain::getOperandInputPort(int processObjectNr) const {
+    if(processObjectNr < 0 || processObjectNr >= (int)mOperandInputPorts.size() || mOperandInputPorts[processObjectNr] < 0)
+        throw Exception("Process object " + std::to_string(processObjectNr) + " in PointwiseOperatorChain has no operand");
+    return mOperandInputPorts[processObjectNr];
+}
+
+bool PointwiseOperatorChain::canAppend(const std::vector<PointwiseOperator>& chain, const PointwiseOperator& nextOperator) {
+    // The intensity range of the chain input is calculated. After that, the range is only known if every operator
+    // transforms it, and the values are stored as float. The data type of the chain input is not known here.
+    bool rangeKnown = true;
+    bool isFloat = false;
+    for(const PointwiseOperator& op : chain) {
+        if(op.isSegmentation)
+            return false;
+        if(!op.keepsDataType)
+            isFloat = op.outputType == TYPE_FLOAT;
+        rangeKnown = rangeKnown && isFloat && (bool)op.transformIntensityRange;
+    }
+
+    return !nextOperator.requiresIntensityRange || rangeKnown;
+}
+
+static std::string replaceArguments(std::string expression, int stage, const PointwiseOperator& op) {
+    const std::string stageNr = std::to_string(stage);
+    expression = replace(expression, "{operand}", "(float)operand" + stageNr + "[position]");
+    expression = replace(expression, "{min}", "minimum" + stageNr);
+    expression = replace(expression, "{max}", "maximum" + stageNr);
+    for(int i = 0; i < op.parameters.size(); ++i)
+        expression = replace(expression, "{p" + std::to_string(i) + "}", "parameter" + stageNr + "_" + std::to_string(i));
+    return expression;
+}
+
+std::string PointwiseOperatorChain::generateSourceCode(
+        const std::vector<PointwiseOperator>& operators,
+        const std::vector<DataType>& stageTypes,
+        DataType inputType,
+        const std::vector<DataType>& operandTypes
+        ) const {
+    std::string arguments =
+            "        __global const " + getCTypeAsString(inputType) + "* input,\n";
+    for(int i = 0; i < operators.size(); ++i) {
+        if(operators[i].hasOperand)
+            arguments += "        __global const " + getCTypeAsString(operandTypes[i]) + "* operand" + std::to_string(i) + ",\n";
+    }
+    arguments +=
+            "        __global " + getCTypeAsString(stageTypes.back()) + "* output,\n"
+            "        __private uint inputChannels,\n"
+            "        __private uint outputChannels";
+
+    std::string body;
+    for(int i = 0; i < operators.size(); ++i) {
+        const PointwiseOperator& op = operators[i];
+        const std::string stageNr = std::to_string(i);
+        arguments +=
+                ",\n        __private float minimum" + stageNr +
+                ",\n        __private float maximum" + stageNr;
+        for(int j = 0; j < op.parameters.size(); ++j)
+            arguments += ",\n        __private float parameter" + stageNr + "_" + std::to_string(j);
+
+        body += "        value = " + replaceArguments(op.expression, i, op) + ";\n";
+        // The unfused process object would have stored its output with this data type
+        if(stageTypes[i] != TYPE_FLOAT)
+            body += "        value = (float)((" + getCTypeAsString(stageTypes[i]) + ")value);\n";
+    }
+
+    return
+        "__kernel void pointwiseOperatorChain(\n" + arguments + "\n        ) {\n"
+        "    const uint pixel = get_global_id(0);\n"
+        "    for(uint channel = 0; channel < outputChannels; ++channel) {\n"
+        "        const uint position = pixel*inputChannels + channel;\n"
+        "        float value = input[position];\n" +
+        body +
+        "        output[pixel*outputChannels + channel] = value;\n"
+        "    }\n"
+        "}\n";
+}
+
+// Nr of pixels which are processed together on the host
+static const int hostBlockSize = 1024;
+
+template <class T>
+static void readValues(const T* data, std::size_t start, uint stride, int count, float* values) {
+    for(int i = 0; i < count; ++i)
+        values[i] = (float)data[start + (std::size_t)i*stride];
+}
+
+template <class T>
+static void castValues(float* values, int count) {
+    for(int i = 0; i < count; ++i)
+        values[i] = (float)((T)values[i]);
+}
+
+template <class T>
+static void writeValues(T* data, std::size_t start, uint stride, int count, const float* values) {
+    for(int i = 0; i < count; ++i)
+        data[start + (std::size_t)i*stride] = (T)values[i];
+}
+
+static void readAsFloat(const void* data, DataType type, std::size_t start, uint stride, int count, float* values) {
+    fastDispatchTypeMacro(type, readValues((const FAST_TYPE*)data, start, stride, count, values))
+}
+
+static void castToDataType(float* values, int count, DataType type) {
+    fastDispatchTypeMacro(type, castValues<FAST_TYPE>(values, count))
+}
+
+static void writeFromFloat(void* data, DataType type, std::size_t start, uint stride, int count, const float* values) {
+    fastDispatchTypeMacro(type, writeValues((FAST_TYPE*)data, start, stride, count, values))
+}
+
+bool PointwiseOperatorChain::isModified() const {
+    if(mIsModified)
+        return true;
+    // The parameters of the fused process objects are read when the chain executes
+    for(auto object : mProcessObjects) {
+        if(object->isModified())
+            return true;
+    }
+    return false;
+}
+
+void PointwiseOperatorChain::execute() {
+    if(mProcessObjects.size() == 0)
+        throw Exception("No process objects were added to PointwiseOperatorChain");
+
+    Image::pointer input = getInputData<Image>(0);
+
+    // Get the operators with the current parameters of the process objects
+    std::vector<PointwiseOperator> operators;
+    for(auto object : mProcessObjects) {
+        operators.push_back(dynamic_cast<PointwiseProcessObject*>(object.get())->getPointwiseOperator());
+        object->setModified(false);
+    }
+
+    std::vector<Image::pointer> operands(operators.size());
+    std::vector<DataType> operandTypes(operators.size(), TYPE_FLOAT);
+    for(int i = 0; i < operators.size(); ++i) {
+        if(!operators[i].hasOperand)
+            continue;
+        Image::pointer operand = getInputData<Image>(mOperandInputPorts[i]);
+        if(operand->getSize() != input->getSize() || operand->getNrOfComponents() != input->getNrOfComponents())
+            throw Exception("Size and number of channels of the operand images to PointwiseOperatorChain must be equal to the input image");
+        operands[i] = operand;
+        operandTypes[i] = operand->getDataType();
+    }
+
+    // Data type and intensity range of the output of each operator
+    std::vector<DataType> stageTypes;
+    std::vector<float> minimums(operators.size(), 0), maximums(operators.size(), 0);
+    DataType type = input->getDataType();
+    bool rangeRequired = false;
+    for(const PointwiseOperator& op : operators)
+        rangeRequired = rangeRequired || op.requiresIntensityRange;
+    float minimum = rangeRequired ? input->calculateMinimumIntensity() : 0;
+    float maximum = rangeRequired ? input->calculateMaximumIntensity() : 0;
+    for(int i = 0; i < operators.size(); ++i) {
+        minimums[i] = minimum;
+        maximums[i] = maximum;
+        if(operators[i].transformIntensityRange)
+            operators[i].transformIntensityRange(minimum, maximum);
+        if(!operators[i].keepsDataType)
+            type = operators[i].outputType;
+        stageTypes.push_back(type);
+    }
+
+    Image::pointer output;
+    if(operators.back().isSegmentation) {
+        Segmentation::pointer segmentation = getOutputData<Segmentation>(0);
+        segmentation->createFromImage(input);
+        output = segmentation;
+    } else {
+        output = getOutputData<Image>(0);
+        output->create(input->getSize(), stageTypes.back(), input->getNrOfComponents());
+        output->setSpacing(input->getSpacing());
+        SceneGraph::setParentNode(output, input);
+    }
+
+    const uint inputChannels = input->getNrOfComponents();
+    const uint outputChannels = output->getNrOfComponents();
+    const Vector3ui size = input->getSize();
+    const uint nrOfPixels = size.x()*size.y()*size.z();
+
+    if(getMainDevice()->isHost()) {
+        ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
+        ImageAccess::pointer outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+        std::vector<ImageAccess::pointer> operandAccess;
+        std::vector<const void*> operandData(operators.size(), nullptr);
+        for(int i = 0; i < operators.size(); ++i) {
+            if(operators[i].hasOperand) {
+                operandAccess.push_back(operands[i]->getImageAccess(ACCESS_READ));
+                operandData[i] = operandAccess.back()->get();
+            }
+        }
+        const void* inputData = inputAccess->get();
+        void* outputData = outputAccess->get();
+        const DataType inputType = input->getDataType();
+
+        // Each block of pixels is converted to float once, and each operator is applied to the whole block
+        const int nrOfBlocks = (nrOfPixels + hostBlockSize - 1) / hostBlockSize;
+        #pragma omp parallel
+        {
+            std::vector<float> values(hostBlockSize);
+            std::vector<std::vector<float>> operandValues(operators.size());
+            for(int i = 0; i < operators.size(); ++i) {
+                if(operators[i].hasOperand)
+                    operandValues[i].resize(hostBlockSize);
+            }
+
+            #pragma omp for
+            for(int block = 0; block < nrOfBlocks; ++block) {
+                const uint firstPixel = block*hostBlockSize;
+                const int count = std::min<uint>(hostBlockSize, nrOfPixels - firstPixel);
+                for(uint channel = 0; channel < outputChannels; ++channel) {
+                    const std::size_t inputStart = (std::size_t)firstPixel*inputChannels + channel;
+                    readAsFloat(inputData, inputType, inputStart, inputChannels, count, values.data());
+                    for(int i = 0; i < operators.size(); ++i) {
+                        const float* operand = nullptr;
+                        if(operators[i].hasOperand) {
+                            readAsFloat(operandData[i], operandTypes[i], inputStart, inputChannels, count, operandValues[i].data());
+                            operand = operandValues[i].data();
+                        }
+                        operators[i].function(values.data(), operand, count, minimums[i], maximums[i]);
+                        if(stageTypes[i] != TYPE_FLOAT)
+                            castToDataType(values.data(), count, stageTypes[i]);
+                    }
+                    writeFromFloat(outputData, stageTypes.back(), (std::size_t)firstPixel*outputChannels + channel,
+                            outputChannels, count, values.data());
+                }
+            }
+        }
+    } else {
+        OpenCLDevice::pointer device = getMainDevice();
+
+        // Generate the kernel, the program is only built again if the operators or data types have changed
+        const std::string sourceCode = generateSourceCode(operators, stageTypes, input->getDataType(), operandTypes);
+        if(sourceCode != mSourceCode) {
+            OpenCLProgram::pointer program = OpenCLProgram::New();
+            program->setSourceCode(sourceCode);
+            mOpenCLPrograms[""] = program;
+            mSourceCode = sourceCode;
+        }
+        cl::Program program = getOpenCLProgram(device);
+        cl::Kernel kernel(program, "pointwiseOperatorChain");
+
+        OpenCLBufferAccess::pointer inputAccess = input->getOpenCLBufferAccess(ACCESS_READ, device);
+        std::vector<OpenCLBufferAccess::pointer> operandAccess;
+        int argument = 0;
+        kernel.setArg(argument++, *inputAccess->get());
+        for(int i = 0; i < operators.size(); ++i) {
+            if(operators[i].hasOperand) {
+                operandAccess.push_back(operands[i]->getOpenCLBufferAccess(ACCESS_READ, device));
+                kernel.setArg(argument++, *operandAccess.back()->get());
+            }
+        }
+        OpenCLBufferAccess::pointer outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+        kernel.setArg(argument++, *outputAccess->get());
+        kernel.setArg(argument++, inputChannels);
+        kernel.setArg(argument++, outputChannels);
+        for(int i = 0; i < operators.size(); ++i) {
+            kernel.setArg(argument++, minimums[i]);
+            kernel.setArg(argument++, maximums[i]);
+            for(float parameter : operators[i].parameters)
+                kernel.setArg(argument++, parameter);
+        }
+
+        device->getCommandQueue().enqueueNDRangeKernel(
+                kernel,
+                cl::NullRange,
+                cl::NDRange(nrOfPixels),
+                cl::NullRange
+        );
+    }
+}
+
+} // end namespace fast
@@ -0,0 +1,67 @@
+#ifndef FAST_POINTWISE_OPERATOR_CHAIN_HPP_
+#define FAST_POINTWISE_OPERATOR_CHAIN_HPP_
+
+#include "FAST/ProcessObject.hpp"
+#include "PointwiseOperator.hpp"
+
+namespace fast {
+
+class Image;
+
+/**
+ * Executes a chain of pointwise process objects, such as ScaleImage, ImageInverter, ImageMultiply and
+ * BinaryThresholding, as a single kernel. Each pixel is read once and written once, and no intermediate
+ * images are created.
+ *
+ * The OpenCL kernel and the host loop are generated from the PointwiseOperator of each process object. The
+ * generated program is built once per device and shared by all chains with the same operators and data types.
+ *
+ * Input port 0 is the input of the first process object. The operand of each process object which has one
+ * gets its own input port, see getOperandInputPort.
+ */
+class FAST_EXPORT  PointwiseOperatorChain : public ProcessObject {
+    FAST_OBJECT(PointwiseOperatorChain)
+    public:
+        /**
+         * Add a process object to the end of the chain. The process object must implement PointwiseProcessObject,
+         * and its parameters are read each time the chain executes. The chain executes again when one of its
+         * process objects is modified, e.g. by changing a parameter.
+         * The process object itself is not executed by the chain.
+         * @param object
+         */
+        void addProcessObject(SharedPointer<ProcessObject> object);
+        int getNrOfProcessObjects() const;
+        /**
+         * @param processObjectNr
+         * @return the input port of the chain for the operand of the given process object
+         */
+        uint getOperandInputPort(int processObjectNr) const;
+        /**
+         * Check if an operator can be added to the end of a chain of operators. This is not possible after an
+         * operator which creates a segmentation, or if the operator needs the intensity range of its input
+         * and this range can't be known without creating the intermediate image.
+         * @param chain
+         * @param nextOperator
+         * @return
+         */
+        static bool canAppend(const std::vector<PointwiseOperator>& chain, const PointwiseOperator& nextOperator);
+        bool isModified() const override;
+    private:
+        PointwiseOperatorChain();
+        void execute();
+        std::string generateSourceCode(
+                const std::vector<PointwiseOperator>& operators,
+                const std::vector<DataType>& stageTypes,
+                DataType inputType,
+                const std::vector<DataType>& operandTypes
+        ) const;
+
+        std::vector<SharedPointer<ProcessObject>> mProcessObjects;
+        std::vector<PointwiseOperator> mOperators;
+        std::vector<int> mOperandInputPorts;
+        std::string mSourceCode;
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,121 @@
+#include "FAST/Testing.hpp"
+#include "PointwiseOperatorChain.hpp"
+#include "FAST/Algorithms/ScaleImage/ScaleImage.hpp"
+#include "FAST/Algorithms/ImageInverter/ImageInverter.hpp"
+#include "FAST/Algorithms/ImageMultiply/ImageMultiply.hpp"
+#include "FAST/Algorithms/BinaryThresholding/BinaryThresholding.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Segmentation.hpp"
+
+namespace fast {
+
+static Image::pointer createTestImage(int seed, uchar minimum, uchar maximum) {
+    const uint width = 32, height = 24, depth = 8;
+    std::vector<uchar> data(width*height*depth);
+    srand(seed);
+    for(int i = 0; i < data.size(); ++i)
+        data[i] = minimum + rand() % (maximum - minimum + 1);
+    data[0] = minimum;
+    data[1] = maximum;
+    Image::pointer image = Image::New();
+    image->create(width, height, depth, TYPE_UINT8, 1, data.data());
+    return image;
+}
+
+TEST_CASE("PointwiseOperatorChain gives the same result as the process objects it fuses", "[fast][PointwiseOperatorChain]") {
+    Image::pointer input = createTestImage(0, 0, 100);
+    Image::pointer operand = createTestImage(1, 1, 2);
+
+    // Create the process objects and run them one by one
+    ScaleImage::pointer scale = ScaleImage::New();
+    scale->setLowestValue(0);
+    scale->setHighestValue(10);
+    scale->setInputData(input);
+    ImageInverter::pointer inverter = ImageInverter::New();
+    inverter->setInputConnection(scale->getOutputPort());
+    ImageMultiply::pointer multiply = ImageMultiply::New();
+    multiply->setInputConnection(0, inverter->getOutputPort());
+    multiply->setInputData(1, operand);
+    // Thresholds are between the possible values to avoid differences due to rounding
+    BinaryThresholding::pointer thresholding = BinaryThresholding::New();
+    thresholding->setLowerThreshold(3.05f);
+    thresholding->setUpperThreshold(7.95f);
+    thresholding->setInputConnection(multiply->getOutputPort());
+    DataPort::pointer port = thresholding->getOutputPort();
+    thresholding->update(0);
+    Segmentation::pointer expected = port->getNextFrame();
+
+    std::vector<ExecutionDevice::pointer> devices = {DeviceManager::getInstance()->getDefaultComputationDevice(), Host::getInstance()};
+    for(ExecutionDevice::pointer device : devices) {
+        PointwiseOperatorChain::pointer chain = PointwiseOperatorChain::New();
+        chain->addProcessObject(scale);
+        chain->addProcessObject(inverter);
+        chain->addProcessObject(multiply);
+        chain->addProcessObject(thresholding);
+        CHECK(chain->getNrOfProcessObjects() == 4);
+        chain->setMainDevice(device);
+        chain->setInputData(0, input);
+        chain->setInputData(chain->getOperandInputPort(2), operand);
+        DataPort::pointer chainPort = chain->getOutputPort();
+        chain->update(0);
+        Segmentation::pointer result = chainPort->getNextFrame();
+
+        REQUIRE(result->getSize() == expected->getSize());
+        REQUIRE(result->getDataType() == TYPE_UINT8);
+        ImageAccess::pointer resultAccess = result->getImageAccess(ACCESS_READ);
+        ImageAccess::pointer expectedAccess = expected->getImageAccess(ACCESS_READ);
+        const uchar* resultData = (const uchar*)resultAccess->get();
+        const uchar* expectedData = (const uchar*)expectedAccess->get();
+        int differences = 0;
+        int foreground = 0;
+        const Vector3ui size = result->getSize();
+        for(int i = 0; i < size.x()*size.y()*size.z(); ++i) {
+            if(resultData[i] != expectedData[i])
+                differences++;
+            if(resultData[i] > 0)
+                foreground++;
+        }
+        CHECK(differences == 0);
+        CHECK(foreground > 0);
+    }
+}
+
+TEST_CASE("PointwiseOperatorChain without segmentation keeps float output", "[fast][PointwiseOperatorChain]") {
+    Image::pointer input = createTestImage(2, 10, 50);
+
+    ScaleImage::pointer scale = ScaleImage::New();
+    scale->setLowestValue(-1);
+    scale->setHighestValue(1);
+    ImageInverter::pointer inverter = ImageInverter::New();
+
+    PointwiseOperatorChain::pointer chain = PointwiseOperatorChain::New();
+    chain->addProcessObject(scale);
+    chain->addProcessObject(inverter);
+    chain->setMainDevice(Host::getInstance());
+    chain->setInputData(input);
+    DataPort::pointer port = chain->getOutputPort();
+    chain->update(0);
+    Image::pointer result = port->getNextFrame();
+
+    // Scaled to [-1, 1], and inverted to 2 - value
+    CHECK(result->getDataType() == TYPE_FLOAT);
+    CHECK(result->calculateMinimumIntensity() == Approx(1));
+    CHECK(result->calculateMaximumIntensity() == Approx(3));
+}
+
+TEST_CASE("PointwiseOperatorChain only accepts operators which can be fused", "[fast][PointwiseOperatorChain]") {
+    PointwiseOperatorChain::pointer chain = PointwiseOperatorChain::New();
+    CHECK_THROWS(chain->addProcessObject(PointwiseOperatorChain::New()));
+
+    // The intensity range after a multiplication is not known without calculating it
+    chain->addProcessObject(ImageMultiply::New());
+    CHECK_THROWS(chain->addProcessObject(ScaleImage::New()));
+
+    BinaryThresholding::pointer thresholding = BinaryThresholding::New();
+    thresholding->setLowerThreshold(1);
+    chain->addProcessObject(thresholding);
+    CHECK_THROWS(chain->addProcessObject(ImageMultiply::New()));
+    CHECK_THROWS(chain->getOperandInputPort(1));
+}
+
+}
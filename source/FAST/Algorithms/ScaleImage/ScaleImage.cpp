@@ -9,14 +9,45 @@ ScaleImage::ScaleImage() {
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/ScaleImage/ScaleImage.cl");
     mLow = 0.0f;
     mHigh = 1.0f;
+    createFloatAttribute("low", "Lowest value", "Lowest value of the output", mLow);
+    createFloatAttribute("high", "Highest value", "Highest value of the output", mHigh);
 }
 
 void ScaleImage::setLowestValue(float value) {
     mLow = value;
+    mIsModified = true;
 }
 
 void ScaleImage::setHighestValue(float value) {
     mHigh = value;
+    mIsModified = true;
+}
+
+void ScaleImage::loadAttributes() {
+    setLowestValue(getFloatAttribute("low"));
+    setHighestValue(getFloatAttribute("high"));
+}
+
+PointwiseOperator ScaleImage::getPointwiseOperator() {
+    if(mHigh <= mLow)
+        throw Exception("The high value must be higher than the low value in ScaleImage.");
+
+    const float low = mLow;
+    const float high = mHigh;
+    PointwiseOperator op;
+    op.expression = "((value - {min}) / ({max} - {min}))*({p1} - {p0}) + {p0}";
+    op.function = makePointwiseFunction([low, high](float value, float operand, float minimum, float maximum) {
+        return ((value - minimum) / (maximum - minimum))*(high - low) + low;
+    });
+    op.parameters = {low, high};
+    op.requiresIntensityRange = true;
+    op.transformIntensityRange = [low, high](float& minimum, float& maximum) {
+        minimum = low;
+        maximum = high;
+    };
+    op.keepsDataType = false;
+    op.outputType = TYPE_FLOAT;
+    return op;
 }
 
 void ScaleImage::execute() {
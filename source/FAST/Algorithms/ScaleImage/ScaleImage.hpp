@@ -2,6 +2,7 @@
 #define SCALE_IMAGE_HPP
 
 #include "FAST/ProcessObject.hpp"
+#include "FAST/Algorithms/PointwiseOperatorChain/PointwiseOperator.hpp"
 
 namespace fast {
 
@@ -10,11 +11,13 @@ namespace fast {
  * image to a value between 0 and 1 (default) or other
  * values if set.
  */
-class FAST_EXPORT  ScaleImage : public ProcessObject {
+class FAST_EXPORT  ScaleImage : public ProcessObject, public PointwiseProcessObject {
     FAST_OBJECT(ScaleImage);
     public:
         void setLowestValue(float value);
         void setHighestValue(float value);
+        PointwiseOperator getPointwiseOperator();
+        void loadAttributes() override;
     private:
         ScaleImage();
         void execute();
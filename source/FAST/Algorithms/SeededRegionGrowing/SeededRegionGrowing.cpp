@@ -39,6 +39,8 @@ SeededRegionGrowing::SeededRegionGrowing() {
     createInputPort<Image>(0);
     createOutputPort<Segmentation>(0);
     mDimensionCLCodeCompiledFor = 0;
+    // Keeps OpenCL objects of the main device between executions, so it is not moved by the device scheduler
+    mDeviceSchedulingAllowed = false;
 }
 
 void SeededRegionGrowing::recompileOpenCLCode(Image::pointer input) {
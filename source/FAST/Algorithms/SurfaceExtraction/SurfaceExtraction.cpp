@@ -3,8 +3,10 @@
 #include "FAST/Data/Image.hpp"
 #include "FAST/Data/Mesh.hpp"
 #include "FAST/Utility.hpp"
-#include "FAST/Utility.hpp"
 #include "FAST/SceneGraph.hpp"
+#include "FAST/Algorithms/SurfaceExtraction/MarchingCubesTables.hpp"
+#include <thread>
+#include <numeric>
 #ifdef FAST_MODULE_VISUALIZATION
 #include <QGLFunctions>
 #include "FAST/Visualization/Window.hpp"
@@ -17,6 +19,223 @@ void SurfaceExtraction::setThreshold(float threshold) {
     mIsModified = true;
 }
 
+void SurfaceExtraction::setNormalCalculation(bool calculateNormals) {
+    mCalculateNormals = calculateNormals;
+    mIsModified = true;
+}
+
+// Output of marching cubes on one slab of cubes along the z axis
+struct MarchingCubesSlab {
+    uint zStart;
+    uint zEnd;
+    std::vector<float> coordinates;
+    std::vector<float> normals;
+    std::vector<uint> triangles; // Indices into the vertices of this slab
+    std::vector<uint64_t> vertexEdges; // Edge key of each vertex
+    std::unordered_map<uint64_t, uint> edgeToVertex;
+    std::vector<uint> globalIndex; // Index of each vertex in the merged mesh
+    std::vector<bool> isShared; // True if the vertex is owned by the previous slab
+};
+
+template <class T>
+inline float getVoxel(const T* data, int x, int y, int z, const Vector3i& size, uint nrOfComponents) {
+    x = std::min(std::max(x, 0), size.x()-1);
+    y = std::min(std::max(y, 0), size.y()-1);
+    z = std::min(std::max(z, 0), size.z()-1);
+    return (float)data[((size_t)x + (size_t)y*size.x() + (size_t)z*size.x()*size.y())*nrOfComponents];
+}
+
+template <class T>
+inline Vector3f getGradient(const T* data, int x, int y, int z, const Vector3i& size, uint nrOfComponents) {
+    // Same sign as the OpenCL implementation, pointing from high to low intensities
+    return Vector3f(
+            getVoxel(data, x-1, y, z, size, nrOfComponents) - getVoxel(data, x+1, y, z, size, nrOfComponents),
+            getVoxel(data, x, y-1, z, size, nrOfComponents) - getVoxel(data, x, y+1, z, size, nrOfComponents),
+            getVoxel(data, x, y, z-1, size, nrOfComponents) - getVoxel(data, x, y, z+1, size, nrOfComponents)
+    );
+}
+
+template <class T>
+void extractSlab(const T* data, const Vector3i& size, uint nrOfComponents, Vector3f spacing, float threshold, bool calculateNormals, MarchingCubesSlab& slab) {
+    const uint64_t width = size.x();
+    const uint64_t height = size.y();
+    for(int z = slab.zStart; z < (int)slab.zEnd; ++z) {
+    for(int y = 0; y < size.y()-1; ++y) {
+    for(int x = 0; x < size.x()-1; ++x) {
+        float values[8];
+        uint cubeIndex = 0;
+        for(int corner = 0; corner < 8; ++corner) {
+            const unsigned char* offset = MCCornerOffsets[corner];
+            values[corner] = (float)data[((size_t)(x+offset[0]) + (size_t)(y+offset[1])*width + (size_t)(z+offset[2])*width*height)*nrOfComponents];
+            if(values[corner] > threshold)
+                cubeIndex |= 1 << corner;
+        }
+        if(cubeIndex == 0 || cubeIndex == 255)
+            continue;
+
+        for(int i = 0; i < 16 && MCTriangleTable[cubeIndex][i] != -1; ++i) {
+            const unsigned char* edge = MCEdgeOffsets[MCTriangleTable[cubeIndex][i]];
+            const Vector3i point0(x + edge[0], y + edge[1], z + edge[2]);
+            const Vector3i point1(x + edge[3], y + edge[4], z + edge[5]);
+
+            // An edge is identified by its lowest voxel and its direction
+            int axis = 0;
+            if(point0.y() != point1.y()) {
+                axis = 1;
+            } else if(point0.z() != point1.z()) {
+                axis = 2;
+            }
+            const Vector3i lowest = point0.cwiseMin(point1);
+            const uint64_t key = (lowest.x() + lowest.y()*width + lowest.z()*width*height)*3 + axis;
+
+            auto it = slab.edgeToVertex.find(key);
+            if(it != slab.edgeToVertex.end()) {
+                slab.triangles.push_back(it->second);
+                continue;
+            }
+
+            const float value0 = getVoxel(data, point0.x(), point0.y(), point0.z(), size, nrOfComponents);
+            const float value1 = getVoxel(data, point1.x(), point1.y(), point1.z(), size, nrOfComponents);
+            const float diff = (threshold - value0) / (value1 - value0);
+            const Vector3f position = (point0.cast<float>() + (point1 - point0).cast<float>()*diff).cwiseProduct(spacing);
+            const uint vertexIndex = slab.vertexEdges.size();
+            slab.coordinates.push_back(position.x());
+            slab.coordinates.push_back(position.y());
+            slab.coordinates.push_back(position.z());
+            if(calculateNormals) {
+                const Vector3f gradient0 = getGradient(data, point0.x(), point0.y(), point0.z(), size, nrOfComponents);
+                const Vector3f gradient1 = getGradient(data, point1.x(), point1.y(), point1.z(), size, nrOfComponents);
+                Vector3f normal = gradient0 + (gradient1 - gradient0)*diff;
+                // Use the MeshVertex default normal instead of NaN where the gradient is zero
+                const float length = normal.norm();
+                normal = length > 0 ? Vector3f(normal / length) : Vector3f(1, 0, 0);
+                slab.normals.push_back(normal.x());
+                slab.normals.push_back(normal.y());
+                slab.normals.push_back(normal.z());
+            }
+            slab.vertexEdges.push_back(key);
+            slab.edgeToVertex[key] = vertexIndex;
+            slab.triangles.push_back(vertexIndex);
+        }
+    }}}
+}
+
+template <class T>
+void executeMarchingCubesOnHost(Image::pointer input, std::vector<float>& coordinates, std::vector<float>& normals, std::vector<uint>& triangles, float threshold, bool calculateNormals) {
+    const Vector3i size = input->getSize().cast<int>();
+    const uint nrOfComponents = input->getNrOfComponents();
+    const Vector3f spacing = input->getSpacing();
+    const int nrOfCubesZ = size.z() - 1;
+    if(nrOfCubesZ < 1 || size.x() < 2 || size.y() < 2)
+        return;
+
+    ImageAccess::pointer access = input->getImageAccess(ACCESS_READ);
+    const T* data = (const T*)access->get();
+
+    // Split the volume into slabs along z. Use more slabs than threads for load balancing.
+    const int nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int nrOfSlabs = std::min(nrOfCubesZ, nrOfThreads*4);
+    std::vector<MarchingCubesSlab> slabs(nrOfSlabs);
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        slabs[i].zStart = (uint)((int64_t)nrOfCubesZ*i / nrOfSlabs);
+        slabs[i].zEnd = (uint)((int64_t)nrOfCubesZ*(i+1) / nrOfSlabs);
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        extractSlab(data, size, nrOfComponents, spacing, threshold, calculateNormals, slabs[i]);
+    }
+
+    // Vertices on the x and y edges of the first plane of a slab were also created by the previous slab.
+    // Find these shared vertices, so that each vertex is only stored once in the merged mesh.
+    const uint64_t planeSize = (uint64_t)size.x()*size.y();
+    std::vector<uint> nrOfOwnedVertices(nrOfSlabs, 0);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        MarchingCubesSlab& slab = slabs[i];
+        slab.isShared.resize(slab.vertexEdges.size(), false);
+        uint owned = 0;
+        for(uint j = 0; j < slab.vertexEdges.size(); ++j) {
+            const uint64_t key = slab.vertexEdges[j];
+            if(i > 0 && key % 3 != 2 && (key / 3) / planeSize == slab.zStart) {
+                slab.isShared[j] = true;
+            } else {
+                ++owned;
+            }
+        }
+        nrOfOwnedVertices[i] = owned;
+    }
+
+    std::vector<uint> vertexOffsets(nrOfSlabs, 0);
+    std::vector<uint> triangleOffsets(nrOfSlabs, 0);
+    uint totalVertices = 0;
+    uint totalTriangleIndices = 0;
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        vertexOffsets[i] = totalVertices;
+        triangleOffsets[i] = totalTriangleIndices;
+        totalVertices += nrOfOwnedVertices[i];
+        totalTriangleIndices += slabs[i].triangles.size();
+    }
+
+    coordinates.resize(totalVertices*3);
+    if(calculateNormals)
+        normals.resize(totalVertices*3);
+    triangles.resize(totalTriangleIndices);
+
+    // Copy owned vertices into the merged arrays
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        MarchingCubesSlab& slab = slabs[i];
+        slab.globalIndex.resize(slab.vertexEdges.size());
+        uint counter = vertexOffsets[i];
+        for(uint j = 0; j < slab.vertexEdges.size(); ++j) {
+            if(slab.isShared[j])
+                continue;
+            slab.globalIndex[j] = counter;
+            for(int k = 0; k < 3; ++k) {
+                coordinates[counter*3 + k] = slab.coordinates[j*3 + k];
+                if(calculateNormals)
+                    normals[counter*3 + k] = slab.normals[j*3 + k];
+            }
+            ++counter;
+        }
+    }
+
+    // Resolve shared vertices to the index assigned by the previous slab, and write triangles
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfSlabs; ++i) {
+        MarchingCubesSlab& slab = slabs[i];
+        for(uint j = 0; j < slab.vertexEdges.size(); ++j) {
+            if(!slab.isShared[j])
+                continue;
+            const MarchingCubesSlab& previous = slabs[i-1];
+            slab.globalIndex[j] = previous.globalIndex[previous.edgeToVertex.at(slab.vertexEdges[j])];
+        }
+        for(uint j = 0; j < slab.triangles.size(); ++j) {
+            triangles[triangleOffsets[i] + j] = slab.globalIndex[slab.triangles[j]];
+        }
+    }
+}
+
+void SurfaceExtraction::executeOnHost(Image::pointer input, Mesh::pointer output) {
+    std::vector<float> coordinates;
+    std::vector<float> normals;
+    std::vector<uint> triangles;
+    switch(input->getDataType()) {
+        fastSwitchTypeMacro(executeMarchingCubesOnHost<FAST_TYPE>(input, coordinates, normals, triangles, mThreshold, mCalculateNormals));
+    }
+
+    const uint nrOfTriangles = triangles.size() / 3;
+    output->create(std::move(coordinates), std::move(normals), std::move(triangles));
+    output->setBoundingBox(input->getBoundingBox());
+
+    if(nrOfTriangles == 0) {
+        reportInfo() << "No triangles were extracted. Check isovalue." << Reporter::end();
+        return;
+    }
+    reportInfo() << nrOfTriangles << " nr of triangles were extracted with the SurfaceExtraction algorithm." << reportEnd();
+}
+
 inline unsigned int getRequiredHistogramPyramidSize(Image::pointer input) {
     unsigned int largestSize = fast::max(fast::max(input->getWidth(), input->getHeight()), input->getDepth());
     int i = 1;
@@ -32,6 +251,13 @@ void SurfaceExtraction::execute() {
     if(input->getDimensions() != 3)
         throw Exception("The SurfaceExtraction object only supports 3D images");
 
+    if(getMainDevice()->isHost()) {
+        Mesh::pointer output = getOutputData<Mesh>(0);
+        SceneGraph::setParentNode(output, input);
+        executeOnHost(input, output);
+        return;
+    }
+
     OpenCLDevice::pointer device = getMainDevice();
 #if defined(__APPLE__) || defined(__MACOSX)
     const bool writingTo3DTextures = false;
@@ -311,14 +537,20 @@ void SurfaceExtraction::execute() {
         i += 2;
     }
 
-    VertexBufferObjectAccess::pointer VBOaccess = output->getVertexBufferObjectAccess(ACCESS_READ_WRITE);
-    GLuint* coordinatesVBO = VBOaccess->getCoordinateVBO();
-    GLuint* normalVBO = VBOaccess->getNormalVBO();
+    // Without an OpenGL context, the triangles are read back to host memory instead of being put in a VBO
+#ifdef FAST_MODULE_VISUALIZATION
+    const bool useVBO = !DeviceManager::isHeadless();
+#else
+    const bool useVBO = false;
+#endif
 
     cl::Buffer coordinatesBuffer;
     cl::Buffer normalBuffer;
     std::vector<cl::Memory> v;
-    if(DeviceManager::isGLInteropEnabled()) {
+    if(useVBO && DeviceManager::isGLInteropEnabled()) {
+        VertexBufferObjectAccess::pointer VBOaccess = output->getVertexBufferObjectAccess(ACCESS_READ_WRITE);
+        GLuint* coordinatesVBO = VBOaccess->getCoordinateVBO();
+        GLuint* normalVBO = VBOaccess->getNormalVBO();
         coordinatesBuffer = cl::BufferGL(device->getContext(), CL_MEM_WRITE_ONLY, *coordinatesVBO);
         normalBuffer = cl::BufferGL(device->getContext(), CL_MEM_WRITE_ONLY, *normalVBO);
         v.push_back(coordinatesBuffer);
@@ -349,12 +581,25 @@ void SurfaceExtraction::execute() {
     // Run a NDRange kernel over this buffer which traverses back to the base level
     queue.enqueueNDRangeKernel(traverseHPKernel, cl::NullRange, cl::NDRange(global_work_size), cl::NDRange(64));
 
-    if(DeviceManager::isGLInteropEnabled()) {
+    if(!useVBO) {
+        std::vector<float> coordinates(totalSum*9);
+        std::vector<float> normals(totalSum*9);
+        queue.enqueueReadBuffer(coordinatesBuffer, CL_FALSE, 0, sizeof(float)*totalSum*9, coordinates.data());
+        queue.enqueueReadBuffer(normalBuffer, CL_TRUE, 0, sizeof(float)*totalSum*9, normals.data());
+        // Each triangle is stored as three consecutive vertices
+        std::vector<uint> triangles(totalSum*3);
+        std::iota(triangles.begin(), triangles.end(), 0);
+        output->create(std::move(coordinates), std::move(normals), std::move(triangles));
+        output->setBoundingBox(box);
+    } else if(DeviceManager::isGLInteropEnabled()) {
         queue.enqueueReleaseGLObjects(&v);
         queue.finish();
     } else {
         // Transfer OpenCL buffer data to CPU
 #ifdef FAST_MODULE_VISUALIZATION
+        VertexBufferObjectAccess::pointer VBOaccess = output->getVertexBufferObjectAccess(ACCESS_READ_WRITE);
+        GLuint* coordinatesVBO = VBOaccess->getCoordinateVBO();
+        GLuint* normalVBO = VBOaccess->getNormalVBO();
         QGLFunctions *fun = Window::getMainGLContext()->functions();
         float *data = new float[9 * totalSum];
         queue.enqueueReadBuffer(
@@ -385,8 +630,6 @@ void SurfaceExtraction::execute() {
         glFinish();
 
         delete[] data;
-#else
-        throw Exception("SurfaceExtraction algorithm is disabled since FAST module visualization is disabled");
 #endif
     }
 
@@ -397,6 +640,7 @@ void SurfaceExtraction::execute() {
 
 SurfaceExtraction::SurfaceExtraction() {
     mThreshold = 0.0f;
+    mCalculateNormals = true;
     mHPSize = 0;
     createInputPort<Image>(0);
     createOutputPort<Mesh>(0);
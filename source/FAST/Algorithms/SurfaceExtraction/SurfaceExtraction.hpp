@@ -5,15 +5,25 @@
 
 namespace fast {
 
+class Image;
+class Mesh;
+
 class FAST_EXPORT  SurfaceExtraction : public ProcessObject {
     FAST_OBJECT(SurfaceExtraction)
     public:
         void setThreshold(float threshold);
+        /**
+         * Whether to calculate vertex normals. Only used by the host implementation,
+         * the OpenCL implementation always calculates normals.
+         */
+        void setNormalCalculation(bool calculateNormals);
     private:
         SurfaceExtraction();
         void execute();
+        void executeOnHost(SharedPointer<Image> input, SharedPointer<Mesh> output);
 
         float mThreshold;
+        bool mCalculateNormals;
         unsigned int mHPSize;
         cl::Program program;
         // HP
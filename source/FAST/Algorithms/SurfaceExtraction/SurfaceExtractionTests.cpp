@@ -0,0 +1,69 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/SurfaceExtraction/SurfaceExtraction.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Mesh.hpp"
+#include "FAST/DeviceManager.hpp"
+#include <functional>
+
+namespace fast {
+
+static Image::pointer createVolume(int size, std::function<float(int, int, int)> function) {
+    std::vector<float> data(size*size*size);
+    for(int z = 0; z < size; ++z) {
+        for(int y = 0; y < size; ++y) {
+            for(int x = 0; x < size; ++x) {
+                data[x + y*size + z*size*size] = function(x, y, z);
+            }
+        }
+    }
+    Image::pointer image = Image::New();
+    image->create(size, size, size, TYPE_FLOAT, 1, data.data());
+    return image;
+}
+
+static Mesh::pointer extractSurface(Image::pointer image, float threshold, ExecutionDevice::pointer device) {
+    SurfaceExtraction::pointer extraction = SurfaceExtraction::New();
+    extraction->setInputData(image);
+    extraction->setThreshold(threshold);
+    extraction->setMainDevice(device);
+    DataPort::pointer port = extraction->getOutputPort();
+    extraction->update(0);
+    return port->getNextFrame();
+}
+
+TEST_CASE("SurfaceExtraction on host gives the same nr of triangles as on OpenCL device", "[fast][SurfaceExtraction]") {
+    // Sphere with radius 5 voxels
+    Image::pointer image = createVolume(16, [](int x, int y, int z) {
+        return 5.0f - Vector3f(x - 7.5f, y - 7.5f, z - 7.5f).norm();
+    });
+
+    Mesh::pointer hostMesh = extractSurface(image, 0.0f, Host::getInstance());
+    Mesh::pointer openCLMesh = extractSurface(image, 0.0f, DeviceManager::getInstance()->getDefaultComputationDevice());
+
+    REQUIRE(hostMesh->getNrOfTriangles() > 0);
+    CHECK(hostMesh->getNrOfTriangles() == openCLMesh->getNrOfTriangles());
+    // The OpenCL implementation stores three vertices per triangle, while the host implementation shares vertices
+    CHECK(openCLMesh->getNrOfVertices() == openCLMesh->getNrOfTriangles()*3);
+    CHECK(hostMesh->getNrOfVertices() < hostMesh->getNrOfTriangles()*3);
+}
+
+TEST_CASE("SurfaceExtraction on host gives valid normals where the gradient is zero", "[fast][SurfaceExtraction]") {
+    // Alternating values along x give a zero central difference gradient inside the volume
+    Image::pointer image = createVolume(8, [](int x, int y, int z) {
+        return (float)(x % 2);
+    });
+
+    Mesh::pointer mesh = extractSurface(image, 0.5f, Host::getInstance());
+    REQUIRE(mesh->getNrOfTriangles() > 0);
+
+    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+    const std::vector<float>& normals = access->getNormalArray();
+    REQUIRE(normals.size() == mesh->getNrOfVertices()*3);
+    for(int i = 0; i < mesh->getNrOfVertices(); ++i) {
+        Vector3f normal(normals[i*3], normals[i*3 + 1], normals[i*3 + 2]);
+        REQUIRE(normal.allFinite());
+        CHECK(normal.norm() == Approx(1.0f));
+    }
+}
+
+}
@@ -0,0 +1,302 @@
+#include "TiledImageFilter.hpp"
+#include "FAST/Exception.hpp"
+#include "FAST/SceneGraph.hpp"
+#include <future>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fast {
+
+namespace {
+
+// Writable memory map of a new file of a given size
+class MemoryMappedOutputFile {
+    public:
+        MemoryMappedOutputFile(std::string filename, size_t size) {
+            mData = nullptr;
+            mSize = size;
+#ifdef _WIN32
+            mMapping = NULL;
+            mFile = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+            if(mFile == INVALID_HANDLE_VALUE)
+                throw Exception("Unable to create the file " + filename);
+            mMapping = CreateFileMappingA(mFile, NULL, PAGE_READWRITE, (DWORD)((uint64_t)mSize >> 32), (DWORD)(mSize & 0xFFFFFFFF), NULL);
+            if(mMapping != NULL)
+                mData = (char*)MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, 0);
+            if(mData == nullptr) {
+                close();
+                throw Exception("Unable to memory map the file " + filename);
+            }
+#else
+            mFile = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(mFile == -1)
+                throw Exception("Unable to create the file " + filename);
+            if(ftruncate(mFile, mSize) != 0) {
+                close();
+                throw Exception("Unable to resize the file " + filename);
+            }
+            void* data = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+            if(data == MAP_FAILED) {
+                close();
+                throw Exception("Unable to memory map the file " + filename);
+            }
+            mData = (char*)data;
+#endif
+        }
+        ~MemoryMappedOutputFile() {
+            close();
+        }
+        char* getData() const {
+            return mData;
+        }
+    private:
+        MemoryMappedOutputFile(const MemoryMappedOutputFile&);
+        MemoryMappedOutputFile& operator=(const MemoryMappedOutputFile&);
+        void close() {
+#ifdef _WIN32
+            if(mData != nullptr)
+                UnmapViewOfFile(mData);
+            if(mMapping != NULL)
+                CloseHandle(mMapping);
+            CloseHandle(mFile);
+#else
+            if(mData != nullptr)
+                munmap(mData, mSize);
+            ::close(mFile);
+#endif
+            mData = nullptr;
+        }
+
+        char* mData;
+        size_t mSize;
+#ifdef _WIN32
+        HANDLE mFile;
+        HANDLE mMapping;
+#else
+        int mFile;
+#endif
+};
+
+}
+
+TiledImageFilter::TiledImageFilter() {
+    createInputPort<Image>(0);
+    createOutputPort<Image>(0);
+
+    mHalo = 0;
+    mTileSize = Vector3i::Zero();
+    // The work is done by the filter, which is scheduled itself
+    mDeviceSchedulingAllowed = false;
+}
+
+void TiledImageFilter::setFilter(ProcessObject::pointer filter, int halo) {
+    if(halo < 0)
+        throw Exception("Halo of TiledImageFilter cannot be negative");
+    mFilter = filter;
+    mHalo = halo;
+    mIsModified = true;
+}
+
+void TiledImageFilter::setTileSize(Vector3i size) {
+    if(size.minCoeff() <= 0)
+        throw Exception("Tile size of TiledImageFilter must be larger than 0");
+    mTileSize = size;
+    mIsModified = true;
+}
+
+void TiledImageFilter::setTileSize(int size) {
+    setTileSize(Vector3i(size, size, size));
+}
+
+void TiledImageFilter::setOutputFilename(std::string filename) {
+    mOutputFilename = filename;
+    mIsModified = true;
+}
+
+Vector3i TiledImageFilter::getTileSize() const {
+    return mTileSize;
+}
+
+Vector3i TiledImageFilter::calculateTileSize(Image::pointer input) {
+    // 3 component images are stored with 4 components on the device, and the result is assumed to be float
+    const uint components = input->getNrOfComponents() == 3 ? 4 : input->getNrOfComponents();
+    const double resultPixelSize = sizeof(float)*components;
+    const double bytesPerVoxel = getSizeOfDataType(input->getDataType(), components) + resultPixelSize;
+    double maxVoxels = 512.0*1024*1024/bytesPerVoxel;
+    Vector3i maxBrickSize(2048, 2048, 2048);
+    ExecutionDevice::pointer device = mFilter->getMainDevice();
+    if(!device->isHost()) {
+        OpenCLDevice::pointer clDevice = device;
+        cl::Device clDeviceInfo = clDevice->getDevice();
+        // Two bricks and two results are on the device at the same time, and the filter may use temporary images
+        maxVoxels = clDeviceInfo.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>()/8.0/bytesPerVoxel;
+        maxVoxels = std::min(maxVoxels, clDeviceInfo.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>()/resultPixelSize);
+        maxBrickSize = Vector3i(
+                clDeviceInfo.getInfo<CL_DEVICE_IMAGE3D_MAX_WIDTH>(),
+                clDeviceInfo.getInfo<CL_DEVICE_IMAGE3D_MAX_HEIGHT>(),
+                clDeviceInfo.getInfo<CL_DEVICE_IMAGE3D_MAX_DEPTH>()
+        );
+    }
+    const int brickSize = (int)std::floor(std::cbrt(maxVoxels));
+    Vector3i tileSize;
+    for(int i = 0; i < 3; ++i) {
+        tileSize[i] = std::min(brickSize, maxBrickSize[i]) - 2*mHalo;
+        if(tileSize[i] <= 0)
+            throw Exception("The halo of TiledImageFilter is too large for the memory of the device");
+    }
+    reportInfo() << "TiledImageFilter is using tile size " << tileSize.transpose() << reportEnd();
+    return tileSize;
+}
+
+Image::pointer TiledImageFilter::createBrick(const uchar* inputData, Vector3ui inputSize, uint pixelSize, DataType type,
+        uint nrOfComponents, Vector3i offset, Vector3i size) {
+    std::vector<uchar> data((size_t)size.x()*size.y()*size.z()*pixelSize);
+    const size_t rowSize = (size_t)size.x()*pixelSize;
+    for(int z = 0; z < size.z(); ++z) {
+        for(int y = 0; y < size.y(); ++y) {
+            const size_t inputPosition = ((size_t)(offset.z() + z)*inputSize.y() + offset.y() + y)*inputSize.x() + offset.x();
+            std::memcpy(&data[((size_t)z*size.y() + y)*rowSize], inputData + inputPosition*pixelSize, rowSize);
+        }
+    }
+    Image::pointer brick = Image::New();
+    brick->create(size.x(), size.y(), size.z(), type, nrOfComponents, mFilter->getMainDevice(), data.data());
+    return brick;
+}
+
+void TiledImageFilter::stitch(Image::pointer result, Vector3i brickOffset, Vector3i tileOffset, Vector3i tileSize,
+        uchar* outputData, Vector3ui outputSize) {
+    const uint pixelSize = getSizeOfDataType(result->getDataType(), result->getNrOfComponents());
+    const Vector3ui brickSize = result->getSize();
+    const Vector3i start = tileOffset - brickOffset;
+    ImageAccess::pointer access = result->getImageAccess(ACCESS_READ);
+    const uchar* brickData = (const uchar*)access->get();
+    for(int z = 0; z < tileSize.z(); ++z) {
+        for(int y = 0; y < tileSize.y(); ++y) {
+            const size_t outputPosition = ((size_t)(tileOffset.z() + z)*outputSize.y() + tileOffset.y() + y)*outputSize.x() + tileOffset.x();
+            const size_t brickPosition = ((size_t)(start.z() + z)*brickSize.y() + start.y() + y)*brickSize.x() + start.x();
+            std::memcpy(outputData + outputPosition*pixelSize, brickData + brickPosition*pixelSize, (size_t)tileSize.x()*pixelSize);
+        }
+    }
+}
+
+void TiledImageFilter::createOutput(Image::pointer output, Vector3ui size, DataType type, uint nrOfComponents) {
+    if(mOutputFilename.empty()) {
+        output->create(size, type, nrOfComponents);
+        return;
+    }
+    const size_t bytes = (size_t)size.x()*size.y()*size.z()*getSizeOfDataType(type, nrOfComponents);
+    std::shared_ptr<MemoryMappedOutputFile> file = std::make_shared<MemoryMappedOutputFile>(mOutputFilename, bytes);
+    // The file is unmapped when the image releases its host data
+    output->create(size, type, nrOfComponents, file->getData(), [file](void*) mutable { file.reset(); });
+}
+
+void TiledImageFilter::execute() {
+    if(!mFilter.isValid())
+        throw Exception("No filter given to TiledImageFilter");
+
+    Image::pointer input = getInputData<Image>();
+    if(input->getDimensions() != 3)
+        throw Exception("TiledImageFilter only supports 3D images");
+    Image::pointer output = getOutputData<Image>();
+
+    const Vector3ui size = input->getSize();
+    const Vector3f spacing = input->getSpacing();
+    const DataType type = input->getDataType();
+    const uint nrOfComponents = input->getNrOfComponents();
+    const uint pixelSize = getSizeOfDataType(type, nrOfComponents);
+    const Vector3i tileSize = (mTileSize == Vector3i::Zero() ? calculateTileSize(input) : mTileSize).cwiseMin(size.cast<int>());
+
+    std::vector<Vector3i> tiles;
+    for(int z = 0; z < size.z(); z += tileSize.z()) {
+        for(int y = 0; y < size.y(); y += tileSize.y()) {
+            for(int x = 0; x < size.x(); x += tileSize.x()) {
+                tiles.push_back(Vector3i(x, y, z));
+            }
+        }
+    }
+    // Each tile extended by the halo, clipped to the volume
+    std::vector<Vector3i> brickOffsets;
+    std::vector<Vector3i> brickSizes;
+    for(const Vector3i& tile : tiles) {
+        Vector3i offset = (tile.array() - mHalo).cwiseMax(0);
+        Vector3i end = (tile + tileSize).array() + mHalo;
+        end = end.cwiseMin(size.cast<int>());
+        // A 3D OpenCL image must have more than one slice
+        if(end.z() - offset.z() == 1) {
+            if(offset.z() > 0) {
+                offset.z() -= 1;
+            } else {
+                end.z() += 1;
+            }
+        }
+        brickOffsets.push_back(offset);
+        brickSizes.push_back(end - offset);
+    }
+
+    ImageAccess::pointer inputAccess = input->getImageAccess(ACCESS_READ);
+    const uchar* inputData = (const uchar*)inputAccess->get();
+    ImageAccess::pointer outputAccess;
+    uchar* outputData = nullptr;
+    DataType outputType;
+    uint outputComponents;
+
+    auto prefetch = [=](int i) {
+        return std::async(std::launch::async, [=]() {
+            Image::pointer brick = createBrick(inputData, size, pixelSize, type, nrOfComponents, brickOffsets[i], brickSizes[i]);
+            brick->setSpacing(spacing);
+            return brick;
+        });
+    };
+
+    // The futures are declared after the accesses, so that any running work is finished before the accesses are released
+    DataPort::pointer port = mFilter->getOutputPort();
+    std::future<Image::pointer> nextBrick = prefetch(0);
+    std::future<void> stitching;
+    for(int i = 0; i < tiles.size(); ++i) {
+        Image::pointer brick = nextBrick.get();
+        // Create and transfer the next brick while this brick is processed
+        if(i + 1 < tiles.size())
+            nextBrick = prefetch(i + 1);
+
+        mFilter->setInputData(brick);
+        mFilter->update(0);
+        Image::pointer result = port->getNextFrame();
+        if(result->getSize() != brick->getSize())
+            throw Exception("The filter of TiledImageFilter must return an image of the same size as the input");
+
+        if(outputData == nullptr) {
+            outputType = result->getDataType();
+            outputComponents = result->getNrOfComponents();
+            createOutput(output, size, outputType, outputComponents);
+            outputAccess = output->getImageAccess(ACCESS_READ_WRITE);
+            outputData = (uchar*)outputAccess->get();
+        } else if(result->getDataType() != outputType || result->getNrOfComponents() != outputComponents) {
+            throw Exception("The filter of TiledImageFilter returned images of different types");
+        }
+
+        // Transfer and stitch the result while the next brick is processed
+        if(stitching.valid())
+            stitching.get();
+        const Vector3i tileExtent = tileSize.cwiseMin(size.cast<int>() - tiles[i]);
+        stitching = std::async(std::launch::async, [=]() {
+            stitch(result, brickOffsets[i], tiles[i], tileExtent, outputData, size);
+        });
+    }
+    stitching.get();
+    outputAccess->release();
+    inputAccess->release();
+
+    output->setSpacing(spacing);
+    SceneGraph::setParentNode(output, input);
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef TILED_IMAGE_FILTER_HPP_
+#define TILED_IMAGE_FILTER_HPP_
+
+#include "FAST/ProcessObject.hpp"
+#include "FAST/Data/Image.hpp"
+
+namespace fast {
+
+/**
+ * Applies a filter to a 3D image which is too large to be processed as one OpenCL image.
+ *
+ * The volume is split into tiles, and each tile is extended by a halo which has to be at least the radius of the
+ * filter. Each of these bricks is processed by the filter, and the tile part of the result is stitched into the
+ * output image on the host. The next brick is created and transferred to the device, and the result of the
+ * previous brick is transferred back and stitched, while the filter processes the current brick.
+ *
+ * The output can be stored in a memory mapped file, so that the output doesn't have to fit in memory either.
+ */
+class FAST_EXPORT  TiledImageFilter : public ProcessObject {
+    FAST_OBJECT(TiledImageFilter)
+    public:
+        /**
+         * Set the filter to apply to each brick. The filter must have one image input and one image output of the
+         * same size.
+         * @param filter
+         * @param halo nr of voxels to extend each tile with, must be at least the radius of the filter
+         */
+        void setFilter(ProcessObject::pointer filter, int halo);
+        /**
+         * Set the size of the tiles, not including the halo. If not set, the tile size is chosen so that the bricks
+         * fit in the memory of the device of the filter.
+         * @param size
+         */
+        void setTileSize(Vector3i size);
+        void setTileSize(int size);
+        /**
+         * Store the output in a memory mapped file with this name. The file contains the raw voxel data, and is
+         * written when the output image is freed.
+         * @param filename
+         */
+        void setOutputFilename(std::string filename);
+        Vector3i getTileSize() const;
+    private:
+        TiledImageFilter();
+        void execute() override;
+        /**
+         * Find the tile size to use when the tile size is not set
+         */
+        Vector3i calculateTileSize(Image::pointer input);
+        /**
+         * Create an image of a region of the input data, on the device of the filter
+         */
+        Image::pointer createBrick(const uchar* inputData, Vector3ui inputSize, uint pixelSize, DataType type,
+                uint nrOfComponents, Vector3i offset, Vector3i size);
+        /**
+         * Copy the tile region of a processed brick to the output data
+         */
+        void stitch(Image::pointer result, Vector3i brickOffset, Vector3i tileOffset, Vector3i tileSize,
+                uchar* outputData, Vector3ui outputSize);
+        /**
+         * Create the output image, using a memory mapped file if an output filename is set
+         */
+        void createOutput(Image::pointer output, Vector3ui size, DataType type, uint nrOfComponents);
+
+        ProcessObject::pointer mFilter;
+        int mHalo;
+        Vector3i mTileSize;
+        std::string mOutputFilename;
+};
+
+}
+
+#endif
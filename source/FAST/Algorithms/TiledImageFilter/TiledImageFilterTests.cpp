@@ -0,0 +1,85 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/TiledImageFilter/TiledImageFilter.hpp"
+#include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+namespace fast {
+
+static Image::pointer createRandomVolume() {
+    Image::pointer image = Image::New();
+    image->create(40, 36, 30, TYPE_FLOAT, 1);
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+    float* data = (float*)access->get();
+    for(int i = 0; i < 40*36*30; ++i)
+        data[i] = (float)(rand() % 100);
+    return image;
+}
+
+static void checkEqualToUntiledResult(Image::pointer input, Image::pointer result) {
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMaskSize(5);
+    filter->setInputData(input);
+    DataPort::pointer port = filter->getOutputPort();
+    filter->update(0);
+    Image::pointer truth = port->getNextFrame();
+
+    REQUIRE(result->getSize() == truth->getSize());
+    REQUIRE(result->getDataType() == truth->getDataType());
+    ImageAccess::pointer resultAccess = result->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer truthAccess = truth->getImageAccess(ACCESS_READ);
+    float* resultData = (float*)resultAccess->get();
+    float* truthData = (float*)truthAccess->get();
+    bool equal = true;
+    for(int i = 0; i < 40*36*30; ++i) {
+        if(std::fabs(resultData[i] - truthData[i]) > 0.001f) {
+            equal = false;
+            break;
+        }
+    }
+    CHECK(equal);
+}
+
+TEST_CASE("No filter given to TiledImageFilter throws exception", "[fast][TiledImageFilter]") {
+    TiledImageFilter::pointer tiler = TiledImageFilter::New();
+    tiler->setInputData(createRandomVolume());
+    CHECK_THROWS(tiler->update(0));
+}
+
+TEST_CASE("TiledImageFilter gives same result as filtering the whole volume", "[fast][TiledImageFilter]") {
+    Image::pointer input = createRandomVolume();
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMaskSize(5);
+
+    TiledImageFilter::pointer tiler = TiledImageFilter::New();
+    tiler->setFilter(filter, 2);
+    tiler->setTileSize(Vector3i(16, 16, 13));
+    tiler->setInputData(input);
+    DataPort::pointer port = tiler->getOutputPort();
+    tiler->update(0);
+    Image::pointer result = port->getNextFrame();
+
+    checkEqualToUntiledResult(input, result);
+}
+
+TEST_CASE("TiledImageFilter with memory mapped output", "[fast][TiledImageFilter]") {
+    Image::pointer input = createRandomVolume();
+    GaussianSmoothingFilter::pointer filter = GaussianSmoothingFilter::New();
+    filter->setMaskSize(5);
+
+    TiledImageFilter::pointer tiler = TiledImageFilter::New();
+    tiler->setFilter(filter, 2);
+    tiler->setTileSize(20);
+    tiler->setOutputFilename("TiledImageFilterTest.raw");
+    tiler->setInputData(input);
+    DataPort::pointer port = tiler->getOutputPort();
+    tiler->update(0);
+    Image::pointer result = port->getNextFrame();
+
+    checkEqualToUntiledResult(input, result);
+    result->create(1, 1, TYPE_FLOAT, 1); // Release the memory mapped file
+    std::remove("TiledImageFilterTest.raw");
+}
+
+}
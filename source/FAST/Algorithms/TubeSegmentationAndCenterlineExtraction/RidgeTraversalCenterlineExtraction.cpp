@@ -5,14 +5,17 @@
 #include <queue>
 #include <vector>
 #include <list>
-#include <stack>
 #include <unordered_set>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 using std::unordered_map;
 
 namespace fast {
 
 RidgeTraversalCenterlineExtraction::RidgeTraversalCenterlineExtraction() {
+    mParallelTraversal = true;
     createInputPort<Image>(0);
     createInputPort<Image>(1);
     createInputPort<Image>(2);
@@ -26,6 +29,11 @@ RidgeTraversalCenterlineExtraction::RidgeTraversalCenterlineExtraction() {
     createOutputPort<Segmentation>(1);
 }
 
+void RidgeTraversalCenterlineExtraction::setParallelTraversal(bool parallel) {
+    mParallelTraversal = parallel;
+    mIsModified = true;
+}
+
 typedef struct point {
     float value;
     int x,y,z;
@@ -212,10 +220,32 @@ void doEigen(ImageAccess::pointer& vectorField, Vector3i pos, Vector3ui size, bo
     *e3 = eigenvectors.col(2);
 }
 
-void copyToLineSet(std::stack<CenterlinePoint> points, std::vector<MeshVertex>& vertices, std::vector<MeshLine>& lines, Vector3f spacing) {
-    while(!points.empty()) {
-        CenterlinePoint point = points.top();
-        points.pop();
+// All centerline points stored contiguously, together with the id of the centerline each point belongs to
+typedef struct CenterlinePoints {
+    std::vector<CenterlinePoint> points;
+    std::vector<int> ids;
+} CenterlinePoints;
+
+// Result of traversing the ridges in both directions from one start point
+typedef struct CenterlineTraversal {
+    std::vector<CenterlinePoint> points;
+    std::unordered_set<int> newCenterlines;
+    std::vector<int> checked; // Voxels for which the centerline label was read
+    int distance = 1;
+    int connections = 0;
+    int prevConnection = -1;
+    int secondConnection = -1;
+    float meanTube = 0;
+    bool skipped = false; // Start point was already part of a centerline
+    bool aborted = false; // Traversal ran into a voxel claimed by a start point with higher priority
+} CenterlineTraversal;
+
+void copyToLineSet(const CenterlinePoints& centerlinePoints, const std::list<int>& ids, std::vector<MeshVertex>& vertices, std::vector<MeshLine>& lines, Vector3f spacing) {
+    std::unordered_set<int> idSet(ids.begin(), ids.end());
+    for(uint i = 0; i < centerlinePoints.points.size(); ++i) {
+        if(idSet.count(centerlinePoints.ids[i]) == 0)
+            continue;
+        const CenterlinePoint& point = centerlinePoints.points[i];
         if(point.previousPos.x() != -1) {
             const uint pos = vertices.size();
             vertices.push_back(MeshVertex(point.pos.cast<float>().cwiseProduct(spacing)));
@@ -225,51 +255,20 @@ void copyToLineSet(std::stack<CenterlinePoint> points, std::vector<MeshVertex>&
     }
 }
 
-void extractCenterlines(
-        Image::pointer TDF,
-        Image::pointer vectorField,
-        Image::pointer radius,
-        int* centerlines,
-        unordered_map<int, int>& centerlineDistances,
-        unordered_map<int, std::stack<CenterlinePoint> >& centerlineStacks,
-        std::vector<MeshVertex>& vertices,
-        std::vector<MeshLine>& lines,
-        int maxBelowTlow,
-        bool* useFirstRadius
-    ) {
-    ImageAccess::pointer TDFaccess = TDF->getImageAccess(ACCESS_READ);
-    ImageAccess::pointer vectorFieldAccess = vectorField->getImageAccess(ACCESS_READ);
-    const Vector3ui size = TDF->getSize();
-    const Vector3f spacing = vectorField->getSpacing();
-
-    static int counter = 1;
-    float Thigh = 0.5;
-    int Dmin = 10;//getParam(parameters, "min-distance");
-    float Mlow = 0.1;
-    float Tlow = 0.1;
-    float minMeanTube = maxBelowTlow > 0 ? 0.4 : 0.5;
-    const int totalSize = size.x()*size.y()*size.z();
-
-    Vector3i neighborhood[26];
-    uint i = 0;
-    for(int a = -1; a < 2; a++) {
-        for(int b = -1; b < 2; b++) {
-            for(int c = -1; c < 2; c++) {
-                if(a == 0 && b == 0 && c == 0)
-                    continue;
-                neighborhood[i] = Vector3i(a,b,c);
-                i++;
-            }
-        }
-    }
-
-        // Create queue
-    std::priority_queue<point, std::vector<point>, PointComparison> queue;
+inline bool pointHasHigherPriority(const point& a, const point& b, const Vector3ui& size) {
+    if(a.value != b.value)
+        return a.value > b.value;
+    return LPOS(a.x,a.y,a.z) < LPOS(b.x,b.y,b.z);
+}
 
-    std::cout << "Getting valid start points for centerline extraction.." << std::endl;
+/**
+ * Collect all valid start points sorted by descending TDF value.
+ * Each slice stores its points in its own buffer, and the buffers are sorted and merged in parallel.
+ */
+std::vector<point> collectStartPoints(ImageAccess::pointer& TDFaccess, ImageAccess::pointer& vectorFieldAccess, Vector3ui size, float Thigh, const Vector3i* neighborhood) {
     float* TDFarray = (float*)TDFaccess->get();
-    // Collect all valid start points
-    #pragma omp parallel for
+    std::vector<std::vector<point> > runs(size.z());
+    #pragma omp parallel for schedule(dynamic)
     for(int z = 2; z < size.z()-2; z++) {
         for(int y = 2; y < size.y()-2; y++) {
             for(int x = 2; x < size.x()-2; x++) {
@@ -289,257 +288,417 @@ void extractCenterlines(
 
                 if(valid) {
                     point p;
-                    p.value = TDFaccess->getScalar(Vector3i(x,y,z));
+                    p.value = TDFarray[x + y*size.x() + z*size.x()*size.y()];
                     p.x = x;
                     p.y = y;
                     p.z = z;
-                    #pragma omp critical
-                    queue.push(p);
+                    runs[z].push_back(p);
                 }
             }
         }
+        std::sort(runs[z].begin(), runs[z].end(), [&size](const point& a, const point& b) {
+            return pointHasHigherPriority(a, b, size);
+        });
     }
 
-    std::cout << "Processing " << queue.size() << " valid start points" << std::endl;
-    if(queue.size() == 0) {
-        throw Exception("no valid start points found");
+    // Merge sorted runs pairwise until one remains
+    while(runs.size() > 1) {
+        std::vector<std::vector<point> > merged((runs.size()+1)/2);
+        #pragma omp parallel for
+        for(int i = 0; i < (int)merged.size(); ++i) {
+            if(2*i+1 < (int)runs.size()) {
+                merged[i].resize(runs[2*i].size() + runs[2*i+1].size());
+                std::merge(runs[2*i].begin(), runs[2*i].end(), runs[2*i+1].begin(), runs[2*i+1].end(), merged[i].begin(),
+                    [&size](const point& a, const point& b) {
+                        return pointHasHigherPriority(a, b, size);
+                });
+            } else {
+                merged[i] = std::move(runs[2*i]);
+            }
+        }
+        runs.swap(merged);
+    }
+    if(runs.empty())
+        return std::vector<point>();
+    return std::move(runs[0]);
+}
+
+/**
+ * Mark a voxel as read by the traversal with the given rank. Returns false if a start point with higher
+ * priority (lower rank) in the same batch has already read it.
+ */
+inline bool claimVoxel(std::atomic<int>* claims, int voxel, int rank) {
+    int current = claims[voxel].load(std::memory_order_relaxed);
+    while(current > rank && !claims[voxel].compare_exchange_weak(current, rank, std::memory_order_relaxed)) {
     }
+    return current >= rank;
+}
 
-    while(!queue.empty()) {
-        // Traverse from new start point
-        point p = queue.top();
-        queue.pop();
+/**
+ * Traverse the ridges from a start point. Only reads the centerlines volume, all changes are
+ * applied by commitTraversal. If claims is given, the traversal is aborted as soon as it reads a voxel
+ * already claimed by a start point with higher priority.
+ */
+void traverseRidge(
+        const point& p,
+        const int* centerlines,
+        ImageAccess::pointer& TDFaccess,
+        ImageAccess::pointer& vectorFieldAccess,
+        Vector3ui size,
+        int maxBelowTlow,
+        std::atomic<int>* claims,
+        int rank,
+        CenterlineTraversal& result
+    ) {
+    float Mlow = 0.1;
+    float Tlow = 0.1;
 
-        // Has it been handled before?
-        if(centerlines[LPOS(p.x,p.y,p.z)] == 1)
-            continue;
+    result.checked.push_back(LPOS(p.x,p.y,p.z));
+    if(claims != nullptr && !claimVoxel(claims, LPOS(p.x,p.y,p.z), rank)) {
+        result.aborted = true;
+        return;
+    }
 
-        std::unordered_set<int> newCenterlines;
-        newCenterlines.insert(LPOS(p.x,p.y,p.z));
-        int distance = 1;
-        int connections = 0;
-        int prevConnection = -1;
-        int secondConnection = -1;
-        float meanTube = TDFaccess->getScalar(Vector3i(p.x,p.y,p.z));
-
-        // Create new stack for this centerline
-        std::stack<CenterlinePoint> stack;
-        CenterlinePoint startPoint;
-        startPoint.previousPos = Vector3i(-1, -1, -1);
-        startPoint.pos.x() = p.x;
-        startPoint.pos.y() = p.y;
-        startPoint.pos.z() = p.z;
-
-        stack.push(startPoint);
-
-        // For each direction
-        for(int direction = -1; direction < 3; direction += 2) {
-            Vector3i previous = startPoint.pos;
-            int belowTlow = 0;
-            Vector3i position(p.x,p.y,p.z);
-            Vector3f t_i = getTubeDirection(vectorFieldAccess, position, size, maxBelowTlow > 0)*direction;
-            Vector3f t_i_1 = t_i;
-
-
-            // Traverse
-            while(true) {
-                Vector3i maxPoint(0,0,0);
-
-                // Check for out of bounds
-                if(position.x() < 3 || position.x() > size.x()-3 || position.y() < 3 || position.y() > size.y()-3 || position.z() < 3 || position.z() > size.z()-3)
-                    break;
+    // Has it been handled before?
+    if(centerlines[LPOS(p.x,p.y,p.z)] == 1) {
+        result.skipped = true;
+        return;
+    }
 
-                // Try to find next point from all neighbors
-                for(int a = -1; a < 2; a++) {
-                    for(int b = -1; b < 2; b++) {
-                        for(int c = -1; c < 2; c++) {
-                            Vector3i n(position.x()+a,position.y()+b,position.z()+c);
-                            if((a == 0 && b == 0 && c == 0))
-                                continue;
-
-                            Vector3f dir = (n - position).cast<float>();//.cwiseProduct(spacing);
-                            dir.normalize();
-                            if(dir.dot(t_i) <= 0.1) // Maintain direction
-                                continue;
-
-                            //if(T.radius[POS(n)] >= 1.5f) {
-                            // Is magnitude smaller than previous
-                            if(maxPoint == Vector3i(0,0,0)) {
-                                maxPoint = n;
-                            } else if(1 - squaredMagnitude(vectorFieldAccess, n) > 1 - squaredMagnitude(vectorFieldAccess, maxPoint)) {
-                                maxPoint = n;
-                            }
-                            /*
-                            } else {
-                                if(TDFaccess->getScalar(n)*(1-squaredMagnitude(vectorFieldAccess, n)) > TDFaccess->getScalar(maxPoint)*(1-squaredMagnitude(vectorFieldAccess, maxPoint)))
-                                maxPoint = n;
-                            }
-                            */
+    std::unordered_set<int>& newCenterlines = result.newCenterlines;
+    newCenterlines.insert(LPOS(p.x,p.y,p.z));
+    int& distance = result.distance;
+    int& connections = result.connections;
+    int& prevConnection = result.prevConnection;
+    int& secondConnection = result.secondConnection;
+    float& meanTube = result.meanTube;
+    meanTube = TDFaccess->getScalar(Vector3i(p.x,p.y,p.z));
+
+    // Points of this centerline
+    std::vector<CenterlinePoint>& stack = result.points;
+    CenterlinePoint startPoint;
+    startPoint.previousPos = Vector3i(-1, -1, -1);
+    startPoint.pos.x() = p.x;
+    startPoint.pos.y() = p.y;
+    startPoint.pos.z() = p.z;
+
+    stack.push_back(startPoint);
+
+    // For each direction
+    for(int direction = -1; direction < 3; direction += 2) {
+        Vector3i previous = startPoint.pos;
+        int belowTlow = 0;
+        Vector3i position(p.x,p.y,p.z);
+        Vector3f t_i = getTubeDirection(vectorFieldAccess, position, size, maxBelowTlow > 0)*direction;
+        Vector3f t_i_1 = t_i;
+
+
+        // Traverse
+        while(true) {
+            Vector3i maxPoint(0,0,0);
+
+            // Check for out of bounds
+            if(position.x() < 3 || position.x() > size.x()-3 || position.y() < 3 || position.y() > size.y()-3 || position.z() < 3 || position.z() > size.z()-3)
+                break;
 
+            // Try to find next point from all neighbors
+            for(int a = -1; a < 2; a++) {
+                for(int b = -1; b < 2; b++) {
+                    for(int c = -1; c < 2; c++) {
+                        Vector3i n(position.x()+a,position.y()+b,position.z()+c);
+                        if((a == 0 && b == 0 && c == 0))
+                            continue;
+
+                        Vector3f dir = (n - position).cast<float>();//.cwiseProduct(spacing);
+                        dir.normalize();
+                        if(dir.dot(t_i) <= 0.1) // Maintain direction
+                            continue;
+
+                        //if(T.radius[POS(n)] >= 1.5f) {
+                        // Is magnitude smaller than previous
+                        if(maxPoint == Vector3i(0,0,0)) {
+                            maxPoint = n;
+                        } else if(1 - squaredMagnitude(vectorFieldAccess, n) > 1 - squaredMagnitude(vectorFieldAccess, maxPoint)) {
+                            maxPoint = n;
                         }
+                        /*
+                        } else {
+                            if(TDFaccess->getScalar(n)*(1-squaredMagnitude(vectorFieldAccess, n)) > TDFaccess->getScalar(maxPoint)*(1-squaredMagnitude(vectorFieldAccess, maxPoint)))
+                            maxPoint = n;
+                        }
+                        */
+
                     }
                 }
+            }
 
-                if(maxPoint.x() + maxPoint.y() + maxPoint.z() > 0) {
-                    // New maxpoint found, check it!
-                    if(centerlines[POS(maxPoint)] > 0) {
-                        // Hit an existing centerline
-                        if(prevConnection == -1) {
-                            prevConnection = centerlines[POS(maxPoint)];
+            if(maxPoint.x() + maxPoint.y() + maxPoint.z() > 0) {
+                result.checked.push_back(POS(maxPoint));
+                if(claims != nullptr && !claimVoxel(claims, POS(maxPoint), rank)) {
+                    result.aborted = true;
+                    return;
+                }
+                // New maxpoint found, check it!
+                if(centerlines[POS(maxPoint)] > 0) {
+                    // Hit an existing centerline
+                    if(prevConnection == -1) {
+                        prevConnection = centerlines[POS(maxPoint)];
+                        // Add connection point
+                        CenterlinePoint p;
+                        p.pos = maxPoint;
+                        p.previousPos = previous;
+                        previous = position;
+                        stack.push_back(p);
+                        distance ++;
+                        newCenterlines.insert(POS(maxPoint));
+                        meanTube += TDFaccess->getScalar(maxPoint);
+                    } else {
+                        if(prevConnection == centerlines[POS(maxPoint)]) {
+                            // A loop has occured, reject this centerline
+                            connections = 5;
+                        } else {
+                            secondConnection = centerlines[POS(maxPoint)];
                             // Add connection point
                             CenterlinePoint p;
                             p.pos = maxPoint;
                             p.previousPos = previous;
                             previous = position;
-                            stack.push(p);
+                            stack.push_back(p);
                             distance ++;
                             newCenterlines.insert(POS(maxPoint));
                             meanTube += TDFaccess->getScalar(maxPoint);
-                        } else {
-                            if(prevConnection == centerlines[POS(maxPoint)]) {
-                                // A loop has occured, reject this centerline
-                                connections = 5;
-                            } else {
-                                secondConnection = centerlines[POS(maxPoint)];
-                                // Add connection point
-                                CenterlinePoint p;
-                                p.pos = maxPoint;
-                                p.previousPos = previous;
-                                previous = position;
-                                stack.push(p);
-                                distance ++;
-                                newCenterlines.insert(POS(maxPoint));
-                                meanTube += TDFaccess->getScalar(maxPoint);
-                            }
                         }
-                        break;
-                    } else if(1 - squaredMagnitude(vectorFieldAccess, maxPoint) < Mlow || (belowTlow > maxBelowTlow && TDFaccess->getScalar(maxPoint) < Tlow)) {
-                        // New point is below thresholds
-                        break;
-                    } else if(newCenterlines.count(POS(maxPoint)) > 0) {
-                        // Loop detected!
-                        break;
+                    }
+                    break;
+                } else if(1 - squaredMagnitude(vectorFieldAccess, maxPoint) < Mlow || (belowTlow > maxBelowTlow && TDFaccess->getScalar(maxPoint) < Tlow)) {
+                    // New point is below thresholds
+                    break;
+                } else if(newCenterlines.count(POS(maxPoint)) > 0) {
+                    // Loop detected!
+                    break;
+                } else {
+                    // Point is OK, proceed to add it and continue
+                    if(TDFaccess->getScalar(maxPoint) < Tlow) {
+                        belowTlow++;
                     } else {
-                        // Point is OK, proceed to add it and continue
-                        if(TDFaccess->getScalar(maxPoint) < Tlow) {
-                            belowTlow++;
-                        } else {
-                            belowTlow = 0;
-                        }
+                        belowTlow = 0;
+                    }
 
-                        // Update direction
-                        //float3 e1 = getTubeDirection(T, maxPoint,size.x,size.y,size.z);
-
-                        //TODO: check if all eigenvalues are negative, if so find the egeinvector that best matches
-                        Vector3f lambda, e1, e2, e3;
-                        doEigen(vectorFieldAccess, maxPoint, size, maxBelowTlow > 0, &lambda, &e1, &e2, &e3);
-                        if((lambda.x() < 0 && lambda.y() < 0 && lambda.z() < 0)) {
-                            if(fabs(t_i.dot(e3)) > fabs(t_i.dot(e2))) {
-                                if(fabs(t_i.dot(e3)) > fabs(t_i.dot(e1))) {
-                                    e1 = e3;
-                                }
-                            } else if(fabs(t_i.dot(e2)) > fabs(t_i.dot(e1))) {
-                                e1 = e2;
-                            }
-                        }
+                    // Update direction
+                    //float3 e1 = getTubeDirection(T, maxPoint,size.x,size.y,size.z);
 
-                        float maintain_dir = sign(e1.dot(t_i));
-                        Vector3f vec_sum;
-                        vec_sum.x() = maintain_dir*e1.x() + t_i.x() + t_i_1.x();
-                        vec_sum.y() = maintain_dir*e1.y() + t_i.y() + t_i_1.y();
-                        vec_sum.z() = maintain_dir*e1.z() + t_i.z() + t_i_1.z();
-                        vec_sum.normalize();
-                        t_i_1 = t_i;
-                        t_i = vec_sum;
-
-                        // update position
-                        position = maxPoint;
-                        distance ++;
-                        newCenterlines.insert(POS(maxPoint));
-                        meanTube += TDFaccess->getScalar(maxPoint);
-
-                        // Create centerline point
-                        CenterlinePoint p;
-                        p.pos = position;
-                        p.previousPos = previous;
-                        previous = position;
-                        /*
-                        if(T.radius[POS(p.pos)] > 3.0f) {
-                            p.large = true;
-                        } else {
-                            p.large = false;
+                    //TODO: check if all eigenvalues are negative, if so find the egeinvector that best matches
+                    Vector3f lambda, e1, e2, e3;
+                    doEigen(vectorFieldAccess, maxPoint, size, maxBelowTlow > 0, &lambda, &e1, &e2, &e3);
+                    if((lambda.x() < 0 && lambda.y() < 0 && lambda.z() < 0)) {
+                        if(fabs(t_i.dot(e3)) > fabs(t_i.dot(e2))) {
+                            if(fabs(t_i.dot(e3)) > fabs(t_i.dot(e1))) {
+                                e1 = e3;
+                            }
+                        } else if(fabs(t_i.dot(e2)) > fabs(t_i.dot(e1))) {
+                            e1 = e2;
                         }
-                        */
+                    }
 
-                        // Add point to stack
-                        stack.push(p);
+                    float maintain_dir = sign(e1.dot(t_i));
+                    Vector3f vec_sum;
+                    vec_sum.x() = maintain_dir*e1.x() + t_i.x() + t_i_1.x();
+                    vec_sum.y() = maintain_dir*e1.y() + t_i.y() + t_i_1.y();
+                    vec_sum.z() = maintain_dir*e1.z() + t_i.z() + t_i_1.z();
+                    vec_sum.normalize();
+                    t_i_1 = t_i;
+                    t_i = vec_sum;
+
+                    // update position
+                    position = maxPoint;
+                    distance ++;
+                    newCenterlines.insert(POS(maxPoint));
+                    meanTube += TDFaccess->getScalar(maxPoint);
+
+                    // Create centerline point
+                    CenterlinePoint p;
+                    p.pos = position;
+                    p.previousPos = previous;
+                    previous = position;
+                    /*
+                    if(T.radius[POS(p.pos)] > 3.0f) {
+                        p.large = true;
+                    } else {
+                        p.large = false;
                     }
-                } else {
-                    // No maxpoint found, stop!
-                    break;
+                    */
+
+                    // Add point to centerline
+                    stack.push_back(p);
                 }
+            } else {
+                // No maxpoint found, stop!
+                break;
+            }
 
-            } // End traversal
-        } // End for each direction
+        } // End traversal
+    } // End for each direction
+}
 
-        // Check to see if new traversal can be added
-        std::cout << "Finished. Distance " << distance << " meanTube: " << meanTube/distance << std::endl;
-        if(distance > Dmin && meanTube/distance > minMeanTube && connections < 2) {
-            //std::cout << "Finished. Distance " << distance << " meanTube: " << meanTube/distance << std::endl;
-            //std::cout << "------------------- New centerlines added #" << counter << " -------------------------" << std::endl;
+/**
+ * Add the result of a traversal to the centerlines if it is accepted.
+ * All voxels of the centerlines volume which are changed get the given batch stamp.
+ */
+void commitTraversal(
+        CenterlineTraversal& result,
+        int* centerlines,
+        int* modifiedInBatch,
+        int batch,
+        unordered_map<int, int>& centerlineDistances,
+        CenterlinePoints& centerlinePoints,
+        int maxBelowTlow,
+        bool* useFirstRadius,
+        int totalSize,
+        int& counter
+    ) {
+    if(result.skipped)
+        return;
 
+    const int Dmin = 10;//getParam(parameters, "min-distance");
+    const float minMeanTube = maxBelowTlow > 0 ? 0.4 : 0.5;
+    const int distance = result.distance;
+    const float meanTube = result.meanTube;
+    const int prevConnection = result.prevConnection;
+    const int secondConnection = result.secondConnection;
+
+    // Check to see if new traversal can be added
+    std::cout << "Finished. Distance " << distance << " meanTube: " << meanTube/distance << std::endl;
+    if(distance > Dmin && meanTube/distance > minMeanTube && result.connections < 2) {
+        //std::cout << "Finished. Distance " << distance << " meanTube: " << meanTube/distance << std::endl;
+        //std::cout << "------------------- New centerlines added #" << counter << " -------------------------" << std::endl;
+
+        const int id = prevConnection == -1 ? counter : prevConnection;
+        for(int voxel : result.newCenterlines) {
+            centerlines[voxel] = id;
+            modifiedInBatch[voxel] = batch;
+            if(maxBelowTlow > 0) {
+                useFirstRadius[voxel] = true;
+            }
+        }
+        centerlinePoints.points.insert(centerlinePoints.points.end(), result.points.begin(), result.points.end());
+        centerlinePoints.ids.resize(centerlinePoints.points.size(), id);
+
+        if(prevConnection == -1) {
+            // No connections
+            centerlineDistances[counter] = distance;
+            counter ++;
+        } else {
+            centerlineDistances[prevConnection] += distance;
+            if(secondConnection != -1) {
+                // Two connections, move secondConnection to prevConnection
+                for(uint i = 0; i < centerlinePoints.ids.size(); ++i) {
+                    if(centerlinePoints.ids[i] == secondConnection)
+                        centerlinePoints.ids[i] = prevConnection;
+                }
 
-            std::unordered_set<int>::iterator usit;
-            if(prevConnection == -1) {
-                // No connections
-                for(usit = newCenterlines.begin(); usit != newCenterlines.end(); usit++) {
-                    centerlines[*usit] = counter;
-                    if(maxBelowTlow > 0) {
-                        useFirstRadius[*usit] = true;
+                #pragma omp parallel for
+                for(int i = 0; i < totalSize;i++) {
+                    if(centerlines[i] == secondConnection) {
+                        centerlines[i] = prevConnection;
+                        modifiedInBatch[i] = batch;
                     }
                 }
-                centerlineDistances[counter] = distance;
-                centerlineStacks[counter] = stack;
-                counter ++;
-            } else {
-                // The first connection
-                // TODO connect together in stack
+                centerlineDistances[prevConnection] += centerlineDistances[secondConnection];
+                centerlineDistances.erase(secondConnection);
+            }
+        }
+    } // end if new point can be added
+}
 
-                std::stack<CenterlinePoint> prevConnectionStack = centerlineStacks[prevConnection];
-                while(!stack.empty()) {
-                    prevConnectionStack.push(stack.top());
-                    stack.pop();
-                }
+void extractCenterlines(
+        Image::pointer TDF,
+        Image::pointer vectorField,
+        Image::pointer radius,
+        int* centerlines,
+        unordered_map<int, int>& centerlineDistances,
+        CenterlinePoints& centerlinePoints,
+        int maxBelowTlow,
+        bool* useFirstRadius,
+        bool parallelTraversal
+    ) {
+    ImageAccess::pointer TDFaccess = TDF->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer vectorFieldAccess = vectorField->getImageAccess(ACCESS_READ);
+    const Vector3ui size = TDF->getSize();
+    const Vector3f spacing = vectorField->getSpacing();
 
-                for(usit = newCenterlines.begin(); usit != newCenterlines.end(); usit++) {
-                    centerlines[*usit] = prevConnection;
-                    if(maxBelowTlow > 0) {
-                        useFirstRadius[*usit] = true;
-                    }
-                }
-                centerlineDistances[prevConnection] += distance;
-                if(secondConnection != -1) {
-                    // Two connections, move secondConnection to prevConnection
-                    std::stack<CenterlinePoint> secondConnectionStack = centerlineStacks[secondConnection];
-                    centerlineStacks.erase(secondConnection);
-                    while(!secondConnectionStack.empty()) {
-                        prevConnectionStack.push(secondConnectionStack.top());
-                        secondConnectionStack.pop();
-                    }
+    static int counter = 1;
+    float Thigh = 0.5;
+    const int totalSize = size.x()*size.y()*size.z();
+
+    Vector3i neighborhood[26];
+    uint i = 0;
+    for(int a = -1; a < 2; a++) {
+        for(int b = -1; b < 2; b++) {
+            for(int c = -1; c < 2; c++) {
+                if(a == 0 && b == 0 && c == 0)
+                    continue;
+                neighborhood[i] = Vector3i(a,b,c);
+                i++;
+            }
+        }
+    }
 
-                    #pragma omp parallel for
-                    for(int i = 0; i < totalSize;i++) {
-                        if(centerlines[i] == secondConnection)
-                            centerlines[i] = prevConnection;
+    std::cout << "Getting valid start points for centerline extraction.." << std::endl;
+    std::vector<point> startPoints = collectStartPoints(TDFaccess, vectorFieldAccess, size, Thigh, neighborhood);
+
+    std::cout << "Processing " << startPoints.size() << " valid start points" << std::endl;
+    if(startPoints.size() == 0) {
+        throw Exception("no valid start points found");
+    }
+
+    // Start points are traversed in batches. In parallel mode, all start points of a batch are traversed
+    // concurrently against the centerlines of the previous batches, and then committed in priority order.
+    // A result is only reused if none of the voxels it read were changed by a commit in the same batch,
+    // otherwise it is traversed again. This gives the same centerlines as the serial traversal.
+    const int batchSize = parallelTraversal ? std::max(1u, std::thread::hardware_concurrency())*16 : 1;
+    std::unique_ptr<int[]> modifiedInBatch(new int[totalSize]());
+    std::unique_ptr<std::atomic<int>[]> claims;
+    if(parallelTraversal) {
+        claims.reset(new std::atomic<int>[totalSize]);
+        #pragma omp parallel for
+        for(int i = 0; i < totalSize; ++i)
+            claims[i].store(std::numeric_limits<int>::max(), std::memory_order_relaxed);
+    }
+
+    int batch = 0;
+    for(int batchStart = 0; batchStart < (int)startPoints.size(); batchStart += batchSize) {
+        const int batchEnd = std::min((int)startPoints.size(), batchStart + batchSize);
+        ++batch;
+        std::vector<CenterlineTraversal> results(batchEnd - batchStart);
+        if(parallelTraversal) {
+            #pragma omp parallel for schedule(dynamic)
+            for(int rank = batchStart; rank < batchEnd; ++rank) {
+                traverseRidge(startPoints[rank], centerlines, TDFaccess, vectorFieldAccess, size, maxBelowTlow, claims.get(), rank, results[rank - batchStart]);
+            }
+        }
+
+        for(int rank = batchStart; rank < batchEnd; ++rank) {
+            CenterlineTraversal& result = results[rank - batchStart];
+            bool valid = parallelTraversal && !result.aborted;
+            if(valid) {
+                for(int voxel : result.checked) {
+                    if(modifiedInBatch[voxel] == batch) {
+                        valid = false;
+                        break;
                     }
-                    centerlineDistances[prevConnection] += centerlineDistances[secondConnection];
-                    centerlineDistances.erase(secondConnection);
                 }
-
-                centerlineStacks[prevConnection] = prevConnectionStack;
             }
-        } // end if new point can be added
-    } // End while queue is not empty
+            if(parallelTraversal) {
+                for(int voxel : result.checked)
+                    claims[voxel].store(std::numeric_limits<int>::max(), std::memory_order_relaxed);
+            }
+            if(!valid) {
+                result = CenterlineTraversal();
+                traverseRidge(startPoints[rank], centerlines, TDFaccess, vectorFieldAccess, size, maxBelowTlow, nullptr, rank, result);
+            }
+            commitTraversal(result, centerlines, modifiedInBatch.get(), batch, centerlineDistances, centerlinePoints, maxBelowTlow, useFirstRadius, totalSize, counter);
+        }
+    } // End for each batch
     std::cout << "Finished traversal" << std::endl;
 }
 
@@ -558,8 +717,8 @@ void RidgeTraversalCenterlineExtraction::execute() {
     // Create a map of centerline distances
     unordered_map<int, int> centerlineDistances;
 
-    // Create a map of centerline stacks
-    unordered_map<int, std::stack<CenterlinePoint> > centerlineStacks;
+    // Points of all centerlines
+    CenterlinePoints centerlinePoints;
 
     std::vector<MeshVertex> vertices;
     std::vector<MeshLine> lines;
@@ -570,7 +729,7 @@ void RidgeTraversalCenterlineExtraction::execute() {
     Image::pointer radius = getInputData<Image>(2);
     {
         Image::pointer vectorField = getInputData<Image>(1);
-        extractCenterlines(TDF, vectorField, radius, centerlines, centerlineDistances, centerlineStacks, vertices, lines, 12, useFirstRadius);
+        extractCenterlines(TDF, vectorField, radius, centerlines, centerlineDistances, centerlinePoints, 12, useFirstRadius, mParallelTraversal);
         // TODO do inverse gradient segmentation here?
     }
 
@@ -581,7 +740,7 @@ void RidgeTraversalCenterlineExtraction::execute() {
         Image::pointer TDF = getInputData<Image>(3);
         Image::pointer vectorField = getInputData<Image>(4);
         radius2 = getInputData<Image>(5);
-        extractCenterlines(TDF, vectorField, radius2, centerlines, centerlineDistances, centerlineStacks, vertices, lines, 0, useFirstRadius);
+        extractCenterlines(TDF, vectorField, radius2, centerlines, centerlineDistances, centerlinePoints, 0, useFirstRadius, mParallelTraversal);
 
         // TODO do dilation segmentation here?
     }
@@ -606,16 +765,7 @@ void RidgeTraversalCenterlineExtraction::execute() {
         if(it->second > TreeMin)
             trees.push_back(it->first);
     }
-    std::list<int>::iterator it2;
-    // TODO: if use the method with TreeMin have to add them to centerlineStack also
-    std::stack<CenterlinePoint> centerlineStack = centerlineStacks[max];
-    for(it2 = trees.begin(); it2 != trees.end(); it2++) {
-        copyToLineSet(centerlineStacks[*it2], vertices, lines, TDF->getSpacing());
-        while(!centerlineStacks[*it2].empty()) {
-            centerlineStack.push(centerlineStacks[*it2].top());
-            centerlineStacks[*it2].pop();
-        }
-    }
+    copyToLineSet(centerlinePoints, trees, vertices, lines, TDF->getSpacing());
 
     uchar * returnCenterlines = new uchar[totalSize]();
     ImageAccess::pointer radiusAccess = radius->getImageAccess(ACCESS_READ);
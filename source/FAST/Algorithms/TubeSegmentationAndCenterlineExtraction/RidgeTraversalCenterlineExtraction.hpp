@@ -8,9 +8,16 @@ namespace fast {
 class FAST_EXPORT  RidgeTraversalCenterlineExtraction : public ProcessObject {
     FAST_OBJECT(RidgeTraversalCenterlineExtraction)
     public:
+        /**
+         * Traverse start points concurrently in batches. Gives the same centerlines as the
+         * serial traversal. Enabled by default.
+         */
+        void setParallelTraversal(bool parallel);
     private:
         RidgeTraversalCenterlineExtraction();
         void execute();
+
+        bool mParallelTraversal;
 };
 
 }
@@ -3,8 +3,7 @@
 #include "FAST/Data/Segmentation.hpp"
 #include "FAST/Data/Mesh.hpp"
 #include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
-#include "FAST/Algorithms/GradientVectorFlow/EulerGradientVectorFlow.hpp"
-#include "FAST/Algorithms/GradientVectorFlow/MultigridGradientVectorFlow.hpp"
+#include "FAST/Algorithms/GradientVectorFlow/GradientVectorFlow.hpp"
 #include "RidgeTraversalCenterlineExtraction.hpp"
 #include "InverseGradientSegmentation.hpp"
 #include <stack>
@@ -356,11 +355,11 @@ void TubeSegmentationAndCenterlineExtraction::execute() {
 Image::pointer TubeSegmentationAndCenterlineExtraction::runGradientVectorFlow(Image::pointer vectorField) {
     OpenCLDevice::pointer device = getMainDevice();
     reportInfo() << "Running GVF.." << Reporter::end();
-    MultigridGradientVectorFlow::pointer gvf = MultigridGradientVectorFlow::New();
+    GradientVectorFlow::pointer gvf = GradientVectorFlow::New();
+    gvf->setMainDevice(device);
     gvf->setInputData(vectorField);
     //gvf->set32bitStorageFormat();
     gvf->set16bitStorageFormat();
-    gvf->setIterations(10);
     gvf->setMuConstant(0.199);
     DataPort::pointer port = gvf->getOutputPort();
     gvf->update(0);
@@ -8,6 +8,8 @@ UltrasoundImageEnhancement::UltrasoundImageEnhancement() {
     createInputPort<Image>(0);
 
     createOutputPort<Image>(0);
+    // Keeps OpenCL objects of the main device between executions, so it is not moved by the device scheduler
+    mDeviceSchedulingAllowed = false;
 
     createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/UltrasoundImageEnhancement/UltrasoundImageEnhancement.cl");
 
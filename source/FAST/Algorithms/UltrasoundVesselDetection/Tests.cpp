@@ -1,10 +1,78 @@
 #include "FAST/Testing.hpp"
 #include "UltrasoundVesselDetection.hpp"
-#include "FAST/Streamers/ImageFileStreamer.hpp"
+#include "FAST/Algorithms/NeuralNetwork/ImageClassifier.hpp"
 #include "FAST/Data/Image.hpp"
-#include "FAST/Visualization/SimpleWindow.hpp"
-#include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
-#include "FAST/Visualization/SegmentationRenderer/SegmentationRenderer.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cmath>
 
 using namespace fast;
 
+// Image with a dark circular vessel with a radius of 4 mm on a bright background
+static Image::pointer createVesselImage() {
+    const int size = 200;
+    std::vector<uchar> data(size*size);
+    for(int y = 0; y < size; ++y) {
+        for(int x = 0; x < size; ++x) {
+            const float distance = std::sqrt((float)((x - 100)*(x - 100) + (y - 100)*(y - 100)));
+            data[x + y*size] = distance < 20 ? 10 : 200;
+        }
+    }
+    Image::pointer image = Image::New();
+    image->create(size, size, TYPE_UINT8, 1, data.data());
+    image->setSpacing(Vector3f(0.2f, 0.2f, 1.0f));
+    return image;
+}
+
+// Classifier which gives the label Vessel when the mean of the 8x8 input is large
+static ImageClassifier::pointer createClassifier(std::string filename) {
+    {
+        std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+        file << "FASTNN 1\n"
+                "input input_1 8 8 1\n"
+                "output output_1\n"
+                "flatten\n"
+                "dense 64 2\n"
+                "softmax\n"
+                "weights\n";
+        std::vector<float> weights;
+        for(int i = 0; i < 64; ++i) {
+            weights.push_back(1.0f / 64.0f);
+            weights.push_back(0);
+        }
+        weights.push_back(0);
+        weights.push_back(0);
+        file.write((const char*)weights.data(), weights.size()*sizeof(float));
+    }
+    ImageClassifier::pointer classifier = ImageClassifier::New();
+    classifier->load(filename);
+    std::remove(filename.c_str());
+    classifier->setInputSize(8, 8);
+    classifier->setOutputParameters({"output_1"});
+    classifier->setLabels({"Vessel", "Not vessel"});
+    return classifier;
+}
+
+TEST_CASE("Ultrasound vessel detection applies the scale factor of the classifier", "[fast][UltrasoundVesselDetection]") {
+    Image::pointer image = createVesselImage();
+    ImageClassifier::pointer classifier = createClassifier("ultrasound_vessel_detection_test.fnn");
+
+    // With a scale factor of one the mean intensity of the region is far above the threshold of the network.
+    // With a scale factor of zero the network gives 0.5 for both labels, thus nothing is accepted.
+    for(float scaleFactor : {1.0f, 0.0f}) {
+        classifier->setScaleFactor(scaleFactor);
+        UltrasoundVesselDetection::pointer detection = UltrasoundVesselDetection::New();
+        detection->setInputData(image);
+        detection->setClassifier(classifier);
+        detection->setRegionSize(8);
+        detection->update(0);
+        REQUIRE(detection->getCrossSections().size() > 0);
+        CHECK((detection->getAcceptedCrossSections().size() > 0) == (scaleFactor > 0));
+    }
+}
+
+TEST_CASE("Ultrasound vessel detection with wrong region size throws", "[fast][UltrasoundVesselDetection]") {
+    UltrasoundVesselDetection::pointer detection = UltrasoundVesselDetection::New();
+    CHECK_THROWS(detection->setRegionSize(0));
+    CHECK_THROWS(detection->setMaxCandidatesToClassify(-1));
+}
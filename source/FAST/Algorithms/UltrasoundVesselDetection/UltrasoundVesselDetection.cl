@@ -108,3 +108,56 @@ __kernel void createSegmentation(
     }
     
 }   
+
+float readIntensity(__read_only image2d_t image, int2 pos) {
+    const int dataType = get_image_channel_data_type(image);
+    if(dataType == CLK_FLOAT) {
+        return read_imagef(image, sampler, pos).x;
+    } else if(dataType == CLK_SIGNED_INT8 || dataType == CLK_SIGNED_INT16) {
+        return read_imagei(image, sampler, pos).x;
+    } else {
+        return read_imageui(image, sampler, pos).x;
+    }
+}
+
+/**
+ * Sample all candidate regions into one batch buffer of regionSize x regionSize images.
+ * Each region is a square given as (center x, center y, half size), and is resampled with linear interpolation.
+ * Samples outside the image are zero. Each sample is multiplied with scaleFactor, and each region is flipped
+ * horizontally if horizontalFlip is 1, in the same way as NeuralNetwork preprocesses input images.
+ */
+__kernel void extractRegions(
+        __read_only image2d_t image,
+        __global const float* regions,
+        __global float* output,
+        __private int regionSize,
+        __private float scaleFactor,
+        __private int horizontalFlip
+        ) {
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    const int region = get_global_id(2);
+
+    const float centerX = regions[region*3];
+    const float centerY = regions[region*3 + 1];
+    const float halfSize = regions[region*3 + 2];
+    const float step = 2.0f*halfSize / regionSize;
+
+    // Position in the image of the center of this output pixel
+    const float2 samplePos = {
+            centerX - halfSize + (x + 0.5f)*step - 0.5f,
+            centerY - halfSize + (y + 0.5f)*step - 0.5f
+    };
+    const int2 base = convert_int2(floor(samplePos));
+    const float2 fraction = samplePos - floor(samplePos);
+
+    // Linear filtering is not supported for integer images, so interpolate manually
+    const float value =
+            (1.0f - fraction.x)*(1.0f - fraction.y)*readIntensity(image, base) +
+            fraction.x*(1.0f - fraction.y)*readIntensity(image, base + (int2)(1, 0)) +
+            (1.0f - fraction.x)*fraction.y*readIntensity(image, base + (int2)(0, 1)) +
+            fraction.x*fraction.y*readIntensity(image, base + (int2)(1, 1));
+
+    const int outputX = horizontalFlip == 1 ? regionSize - 1 - x : x;
+    output[outputX + y*regionSize + region*regionSize*regionSize] = value*scaleFactor;
+}
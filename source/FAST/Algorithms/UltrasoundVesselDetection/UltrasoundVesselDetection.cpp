@@ -1,19 +1,17 @@
 #include "FAST/Data/Image.hpp"
 #include "FAST/Data/Segmentation.hpp"
-#include "FAST/Data/PointSet.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Algorithms/GaussianSmoothingFilter/GaussianSmoothingFilter.hpp"
 #include "FAST/Algorithms/ImageGradient/ImageGradient.hpp"
 #include "FAST/Utility.hpp"
 #include "FAST/SceneGraph.hpp"
-#include <queue>
+#include <unordered_map>
 #include "FAST/Algorithms/UltrasoundVesselDetection/UltrasoundVesselDetection.hpp"
-#include "FAST/Algorithms/ImageCropper/ImageCropper.hpp"
 #include "FAST/Algorithms/NeuralNetwork/ImageClassifier.hpp"
 
 namespace fast {
 
-    ProcessObjectPort UltrasoundVesselDetection::getOutputSegmentationPort() {
+    DataPort::pointer UltrasoundVesselDetection::getOutputSegmentationPort() {
         mCreateSegmentation = true;
         return getOutputPort(0);
     }
@@ -21,46 +19,85 @@ namespace fast {
     UltrasoundVesselDetection::UltrasoundVesselDetection() {
         createInputPort<Image>(0);
         createOutputPort<Segmentation>(0);
-        createOutputPort<VesselCrossSection>(1, OUTPUT_STATIC, 0, true);
+        createOutputPort<VesselCrossSection>(1);
         createOpenCLProgram(Config::getKernelSourcePath() + "Algorithms/UltrasoundVesselDetection/UltrasoundVesselDetection.cl");
         mCreateSegmentation = false;
 
-        mClassifier = ImageClassifier::New();
-        //std::string modelFile = "/home/smistad/vessel_detection_model/deploy.prototxt";
-        //std::string trainingFile = "/home/smistad/vessel_detection_model/snapshot_iter_540.caffemodel";
-        //std::string meanFile = "/home/smistad/vessel_detection_model/mean.binaryproto";
-        //std::string modelFile = "/home/smistad/vessel_detection_model2/deploy.prototxt";
-        //std::string trainingFile = "/home/smistad/vessel_detection_model2/snapshot_iter_960.caffemodel";
-        //std::string meanFile = "/home/smistad/vessel_detection_model2/mean.binaryproto";
-        //std::string modelFile = "/home/smistad/vessel_detection_model_gaussian/deploy.prototxt";
-        //std::string trainingFile = "/home/smistad/vessel_detection_model_gaussian/snapshot_iter_960.caffemodel";
-        //std::string meanFile = "/home/smistad/vessel_detection_model_gaussian/mean.binaryproto";
-        //std::string modelFile = "/home/smistad/vessel_detection_model_alex_no_relu/deploy.prototxt";
-        //std::string trainingFile = "/home/smistad/vessel_detection_model_alex_no_relu/snapshot_iter_630.caffemodel";
-        //std::string meanFile = "/home/smistad/vessel_detection_model_alex_no_relu/mean.binaryproto";
-        //std::string modelFile = "/home/smistad/vessel_net/deploy.prototxt";
-        //std::string trainingFile = "/home/smistad/vessel_net/snapshot_iter_7600.caffemodel";
-        //std::string meanFile = "/home/smistad/vessel_net/mean.binaryproto";
-        std::string modelFile = "/home/smistad/vessel_net_1/deploy.prototxt";
-        std::string trainingFile = "/home/smistad/vessel_net_1/snapshot_iter_4550.caffemodel";
-        std::string meanFile = "/home/smistad/vessel_net_1/mean.binaryproto";
-        mClassifier->loadNetworkAndWeights(modelFile, trainingFile);
-        mClassifier->loadBinaryMeanImage(meanFile);
+        mRegionSize = 64;
+        mMaxCandidatesToClassify = 8;
+    }
+
+    void UltrasoundVesselDetection::setClassifier(SharedPointer<ImageClassifier> classifier) {
+        mClassifier = classifier;
+        mIsModified = true;
+    }
+
+    void UltrasoundVesselDetection::setRegionSize(int size) {
+        if(size <= 0)
+            throw Exception("Region size must be larger than zero in UltrasoundVesselDetection");
+        mRegionSize = size;
+        mIsModified = true;
+    }
 
+    void UltrasoundVesselDetection::setMaxCandidatesToClassify(int count) {
+        if(count < 0)
+            throw Exception("Max candidates to classify can't be negative in UltrasoundVesselDetection");
+        mMaxCandidatesToClassify = count;
+        mIsModified = true;
     }
 
     struct Candidate {
         float score;
-        VesselCrossSection::pointer crossSection;
+        Vector2f imageCenter;
+        float majorRadius;
+        float minorRadius;
     };
 
     class CandidateComparison {
     public:
         bool operator() (const Candidate& lhs, const Candidate& rhs) const {
-            return lhs.score < rhs.score;
+            return lhs.score > rhs.score;
         }
     };
 
+    /**
+     * Uniform grid of accepted candidates, used to only test a new candidate against the accepted candidates
+     * in the neighboring cells.
+     */
+    class CandidateGrid {
+    public:
+        explicit CandidateGrid(float cellSize) : mCellSize(cellSize) {}
+        void insert(int index, Vector2f position) {
+            mCells[getKey(getCell(position.x()), getCell(position.y()))].push_back(index);
+        }
+        template <class Function>
+        bool anyNeighbor(Vector2f position, Function function) const {
+            const int cellX = getCell(position.x());
+            const int cellY = getCell(position.y());
+            for(int y = cellY - 1; y <= cellY + 1; ++y) {
+                for(int x = cellX - 1; x <= cellX + 1; ++x) {
+                    auto cell = mCells.find(getKey(x, y));
+                    if(cell == mCells.end())
+                        continue;
+                    for(int index : cell->second) {
+                        if(function(index))
+                            return true;
+                    }
+                }
+            }
+            return false;
+        }
+    private:
+        int getCell(float value) const {
+            return (int)std::floor(value / mCellSize);
+        }
+        static int64_t getKey(int x, int y) {
+            return ((int64_t)x << 32) ^ (int64_t)(uint32_t)y;
+        }
+        float mCellSize;
+        std::unordered_map<int64_t, std::vector<int> > mCells;
+    };
+
     void UltrasoundVesselDetection::execute() {
         Image::pointer input = getInputData<Image>();
         if(input->getDimensions() != 2) {
@@ -78,14 +115,16 @@ namespace fast {
         filter->setInputData(input);
         filter->setMaskSize(5);
         filter->setStandardDeviation(2);
-        filter->update();
-        Image::pointer smoothedImage = filter->getOutputData<Image>();
+        DataPort::pointer smoothedPort = filter->getOutputPort();
+        filter->update(0);
+        Image::pointer smoothedImage = smoothedPort->getNextFrame();
 
-        // Run ImageGradient on input
+        // Run ImageGradient on smoothed image
         ImageGradient::pointer imageGradient = ImageGradient::New();
-        imageGradient->setInputConnection(filter->getOutputPort());
-        imageGradient->update();
-        Image::pointer gradients = imageGradient->getOutputData<Image>();
+        imageGradient->setInputData(smoothedImage);
+        DataPort::pointer gradientPort = imageGradient->getOutputPort();
+        imageGradient->update(0);
+        Image::pointer gradients = gradientPort->getNextFrame();
         OpenCLImageAccess::pointer inputImageAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
         OpenCLImageAccess::pointer imageAccess = smoothedImage->getOpenCLImageAccess(ACCESS_READ, device);
         OpenCLImageAccess::pointer gradientAccess = gradients->getOpenCLImageAccess(ACCESS_READ, device);
@@ -143,7 +182,8 @@ namespace fast {
         transform->setTransform(T);
 
         // Find best ellipses
-        std::priority_queue<Candidate, std::vector<Candidate>, CandidateComparison> candidates;
+        std::vector<Candidate> candidates;
+        float maxMajorRadius = 0;
         int startPosY2 = (startPosY / 4)*4;
         for(int x = 0; x < input->getWidth(); x+=4) {
             for(int y = startPosY2; y < endPosY; y+=4) {
@@ -152,101 +192,103 @@ namespace fast {
                 if(data[i*4] > 1.5) { // If score is higher than a threshold
                     float posY = floor(data[i*4+3]/input->getWidth());
                     float posX = data[i*4+3]-posY*input->getWidth();
-                    Vector3f voxelPosition(posX, posY, 0);
-                    Vector3f position = transform->multiply(voxelPosition);
-                    VesselCrossSection::pointer crossSection = VesselCrossSection::New();
-                    crossSection->create(position, voxelPosition.head(2), data[i*4+1], data[i*4+2]*data[i*4+1]);
                     Candidate candidate;
                     candidate.score = data[i*4];
-                    candidate.crossSection = crossSection;
-                    candidates.push(candidate);
-
+                    candidate.imageCenter = Vector2f(posX, posY);
+                    candidate.majorRadius = data[i*4+1];
+                    candidate.minorRadius = data[i*4+2]*data[i*4+1];
+                    candidates.push_back(candidate);
+                    maxMajorRadius = std::max(maxMajorRadius, candidate.majorRadius);
                 }
             }
         }
-
-        mCrossSections.clear();
-        // Go through all candidates
-        while(!candidates.empty()) {
-            Candidate next = candidates.top();
-            candidates.pop();
-
-            // Check if valid
-            bool invalid = false;
-            VesselCrossSectionAccess::pointer access2 = next.crossSection->getAccess(ACCESS_READ);
-            Vector2f candidateImageCenter = access2->getImageCenterPosition();
-            for(VesselCrossSection::pointer crossSection : mCrossSections) {
-                VesselCrossSectionAccess::pointer access = crossSection->getAccess(ACCESS_READ);
-                Vector2f imageCenter = access->getImageCenterPosition();
-                float majorRadius = access->getMajorRadius() + access->getMajorRadius()*0.5f;
-                float minorRadius = access->getMinorRadius() + access->getMinorRadius()*0.5f;
+        std::sort(candidates.begin(), candidates.end(), CandidateComparison());
+
+        // Go through all candidates, from highest to lowest score, and discard candidates with a center inside
+        // an enlarged previously accepted ellipse. The enlarged radii are at most the grid cell size,
+        // thus only accepted candidates in the neighboring cells have to be checked.
+        std::vector<Candidate> selectedCandidates;
+        CandidateGrid grid(std::max(maxMajorRadius*1.5f, 1.0f));
+        for(const Candidate& candidate : candidates) {
+            bool invalid = grid.anyNeighbor(candidate.imageCenter, [&](int index) {
+                const Candidate& accepted = selectedCandidates[index];
+                float majorRadius = accepted.majorRadius*1.5f;
+                float minorRadius = accepted.minorRadius*1.5f;
+                Vector2f distance = accepted.imageCenter - candidate.imageCenter;
 
                 // Check if candidate center is inside a previous ellipse
-                if(
-                        std::pow(imageCenter.x() - candidateImageCenter.x(), 2.0f) / (majorRadius*majorRadius) +
-                        std::pow(imageCenter.y() - candidateImageCenter.y(), 2.0f) / (minorRadius*minorRadius) < 1){
-                    invalid = true;
-                    break;
-                }
-            }
+                return distance.x()*distance.x() / (majorRadius*majorRadius) +
+                       distance.y()*distance.y() / (minorRadius*minorRadius) < 1;
+            });
             if(!invalid) {
-                mCrossSections.push_back(next.crossSection);
+                grid.insert(selectedCandidates.size(), candidate.imageCenter);
+                selectedCandidates.push_back(candidate);
             }
         }
-        std::cout << mCrossSections.size() << " candidate vessels" << std::endl;
+
+        // Only create cross section objects for the selected candidates
+        mCrossSections.clear();
+        for(const Candidate& candidate : selectedCandidates) {
+            Vector3f voxelPosition(candidate.imageCenter.x(), candidate.imageCenter.y(), 0);
+            Vector3f position = transform->multiply(voxelPosition);
+            VesselCrossSection::pointer crossSection = VesselCrossSection::New();
+            crossSection->create(position, candidate.imageCenter, candidate.majorRadius, candidate.minorRadius);
+            mCrossSections.push_back(crossSection);
+        }
+        reportInfo() << mCrossSections.size() << " candidate vessels" << reportEnd();
         mRuntimeManager->stopRegularTimer("candidate selection");
         mRuntimeManager->startRegularTimer("classifier");
 
-
-        Vector3ui imageSize = input->getSize();
-
-        // Create sub images and send to classifier
-        std::vector<DataObject::pointer> subImages;
-        for(int i = 0; i < std::min((int)mCrossSections.size(), 8); ++i) {
-            VesselCrossSectionAccess::pointer access = mCrossSections[i]->getAccess(ACCESS_READ);
-            Vector2f imageCenter = access->getImageCenterPosition();
-
-            // Radius in pixels
-            const float majorRadius = access->getMajorRadius();
-            const float minorRadius = access->getMinorRadius();
-            const int frameSize = std::max((int)round(majorRadius), 50); // Nr if pixels to include around vessel
-
-            Vector2i offset(
-                    round(imageCenter.x() - majorRadius) - frameSize,
-                    round(imageCenter.y() - majorRadius) - frameSize
+        std::vector<VesselCrossSection::pointer> acceptedVessels;
+        const int nrOfRegions = std::min((int)selectedCandidates.size(), mMaxCandidatesToClassify);
+        if(nrOfRegions > 0) {
+            if(!mClassifier.isValid())
+                throw Exception("No classifier was given to UltrasoundVesselDetection");
+
+            // Square region around each vessel: (center x, center y, half size) in pixels
+            std::vector<float> regions(nrOfRegions*3);
+            for(int i = 0; i < nrOfRegions; ++i) {
+                const Candidate& candidate = selectedCandidates[i];
+                const int frameSize = std::max((int)round(candidate.majorRadius), 50); // Nr if pixels to include around vessel
+                regions[i*3] = candidate.imageCenter.x();
+                regions[i*3 + 1] = candidate.imageCenter.y();
+                regions[i*3 + 2] = candidate.majorRadius + frameSize;
+            }
+            cl::Buffer regionBuffer(
+                    device->getContext(),
+                    CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                    sizeof(float)*regions.size(),
+                    regions.data()
             );
-            int size2 = 2*majorRadius + 2*frameSize;
-            Vector2i size(
-                    size2,
-                    size2
+
+            // Sample all regions into one batch with a single kernel launch. The batch is given to the network as is,
+            // so the scaling and flipping of the classifier is applied here.
+            NetworkTensor batch({nrOfRegions, mRegionSize, mRegionSize, 1});
+            const std::size_t batchBufferSize = sizeof(float)*batch.getSize();
+            cl::Buffer batchBuffer(device->getContext(), CL_MEM_WRITE_ONLY, batchBufferSize);
+            cl::Kernel extractKernel(program, "extractRegions");
+            extractKernel.setArg(0, *inputImageAccess->get2DImage());
+            extractKernel.setArg(1, regionBuffer);
+            extractKernel.setArg(2, batchBuffer);
+            extractKernel.setArg(3, mRegionSize);
+            extractKernel.setArg(4, mClassifier->getScaleFactor());
+            extractKernel.setArg(5, mClassifier->getHorizontalFlipping() ? 1 : 0);
+            device->getCommandQueue().enqueueNDRangeKernel(
+                    extractKernel,
+                    cl::NullRange,
+                    cl::NDRange(mRegionSize, mRegionSize, nrOfRegions),
+                    cl::NullRange
             );
+            device->getCommandQueue().enqueueReadBuffer(batchBuffer, CL_TRUE, 0, batchBufferSize, batch.getData());
 
-            ImageCropper::pointer cropper = ImageCropper::New();
-            cropper->setInputData(input);
-            cropper->allowOutOfBoundsCropping(true);
-            cropper->setOffset(offset);
-            cropper->setSize(size);
-            cropper->update();
-            subImages.push_back(cropper->getOutputData<Image>());
-        }
-        std::vector<VesselCrossSection::pointer> acceptedVessels;
-        if(subImages.size() > 0) {
-            mClassifier->setLabels({"Vessel", "Not vessel"});
-            mClassifier->setInputData(subImages);
-            mClassifier->update();
-
-            std::vector<ImageClassification::pointer> classifierResult = mClassifier->getMultipleOutputData<ImageClassification>(0);
-            int i = 0;
-            for(ImageClassification::pointer data : classifierResult) {
-                ImageClassification::access access = data->getAccess(ACCESS_READ);
+            // Classify all regions with one network execution
+            std::vector<ImageClassification::pointer> classifierResult = mClassifier->classify(batch);
+            for(int i = 0; i < classifierResult.size(); ++i) {
+                ImageClassification::access access = classifierResult[i]->getAccess(ACCESS_READ);
                 std::map<std::string, float> scores = access->getData();
                 if(scores["Vessel"] > 0.9) {
                     acceptedVessels.push_back(mCrossSections.at(i));
-                    //VesselCrossSection::pointer newData = addStaticOutputData<VesselCrossSection>(1);
-                    //VesselCrossSectionAccess::pointer access = mCrossSections[i]->getAccess(ACCESS_READ);
-                    //newData->create(access->getGlobalCenterPosition(), access->getImageCenterPosition(), access->getMajorRadius(), access->getMinorRadius());
                 }
-                ++i;
             }
         }
         mAcceptedCrossSections = acceptedVessels;
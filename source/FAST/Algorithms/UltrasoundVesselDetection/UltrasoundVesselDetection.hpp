@@ -8,17 +8,42 @@ namespace fast {
 
 class ImageClassifier;
 
+/**
+ * Detects vessel cross sections in 2D ultrasound images by ellipse fitting, and accepts or rejects each candidate
+ * with a neural network classifier.
+ *
+ * A region around each candidate is sampled to a fixed size on the GPU, and all regions are classified in one batch.
+ */
 class FAST_EXPORT  UltrasoundVesselDetection : public ProcessObject {
     FAST_OBJECT(UltrasoundVesselDetection)
     public:
-        ProcessObjectPort getOutputSegmentationPort();
+        DataPort::pointer getOutputSegmentationPort();
         std::vector<VesselCrossSection::pointer> getCrossSections();
         std::vector<VesselCrossSection::pointer> getAcceptedCrossSections();
+        /**
+         * Set the classifier used to accept or reject candidates. The network is loaded by the caller, and has to
+         * have the labels "Vessel" and "Not vessel", and an input size equal to the region size.
+         * @param classifier
+         */
+        void setClassifier(SharedPointer<ImageClassifier> classifier);
+        /**
+         * Set the width and height in pixels that the region around each candidate is resampled to
+         * before classification. Default is 64.
+         * @param size
+         */
+        void setRegionSize(int size);
+        /**
+         * Set the max nr of candidates, with the highest scores, to classify per frame. Default is 8.
+         * @param count
+         */
+        void setMaxCandidatesToClassify(int count);
     private:
         UltrasoundVesselDetection();
         void execute();
 
         bool mCreateSegmentation;
+        int mRegionSize;
+        int mMaxCandidatesToClassify;
         std::vector<VesselCrossSection::pointer> mCrossSections;
         std::vector<VesselCrossSection::pointer> mAcceptedCrossSections;
         SharedPointer<ImageClassifier> mClassifier;
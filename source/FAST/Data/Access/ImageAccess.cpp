@@ -1,55 +1,85 @@
 #include "ImageAccess.hpp"
 #include "FAST/Data/Image.hpp"
+#include <cstring>
 
 namespace fast {
 
 ImageAccess::ImageAccess(void* data, Image::pointer image) {
     mData = data;
     mImage = image;
+    mRowPitch = image->getWidth();
+    mSlicePitch = image->getWidth()*image->getHeight();
+}
+
+ImageAccess::ImageAccess(void* data, Image::pointer image, uint rowPitch, uint slicePitch, std::unique_ptr<ImageAccess> parentAccess) {
+    mData = data;
+    mImage = image;
+    mRowPitch = rowPitch;
+    mSlicePitch = slicePitch;
+    mParentAccess = std::move(parentAccess);
 }
 
 void ImageAccess::release() {
 	mImage->accessFinished();
+	mParentAccess.reset();
 }
 
 ImageAccess::~ImageAccess() {
 	release();
 }
 
-// TODO this should return a copy
-void* ImageAccess::get() {
-    return mData;
+bool ImageAccess::isContiguous() const {
+    return mRowPitch == mImage->getWidth() && (mImage->getDepth() == 1 || mSlicePitch == mImage->getWidth()*mImage->getHeight());
 }
 
-template <typename T>
-float getScalarAsFloat(T* data, VectorXi position, Image::pointer image, uchar channel) {
+void* ImageAccess::get() {
+    if(isContiguous())
+        return mData;
+
+    // Strided view, copy each row to a dense array the first time it is requested
+    if(mDenseData.empty()) {
+        const Vector3ui size = mImage->getSize();
+        const size_t rowSize = size.x()*getSizeOfDataType(mImage->getDataType(), mImage->getNrOfComponents());
+        mDenseData.resize(rowSize*size.y()*size.z());
+        const uchar* input = (const uchar*)mData;
+        const size_t rowPitch = mRowPitch*getSizeOfDataType(mImage->getDataType(), mImage->getNrOfComponents());
+        const size_t slicePitch = mSlicePitch*getSizeOfDataType(mImage->getDataType(), mImage->getNrOfComponents());
+        for(uint z = 0; z < size.z(); ++z) {
+            for(uint y = 0; y < size.y(); ++y) {
+                memcpy(&mDenseData[(y + z*size.y())*rowSize], input + y*rowPitch + z*slicePitch, rowSize);
+            }
+        }
+    }
+    return mDenseData.data();
+}
 
-    Vector3ui size = image->getSize();
+uint ImageAccess::getVoxelIndex(VectorXi position, uchar channel) const {
+    Vector3ui size = mImage->getSize();
     if(position.x() < 0 || position.y() < 0 || position.z() < 0 ||
-            position.x() > size.x()-1 || position.y() > size.y()-1 || position.z() > size.z()-1 || channel >= image->getNrOfComponents())
+            position.x() > size.x()-1 || position.y() > size.y()-1 || position.z() > size.z()-1 || channel >= mImage->getNrOfComponents())
         throw OutOfBoundsException();
 
-    T value = data[(position.x() + position.y()*size.x() + position.z()*size.x()*size.y())*image->getNrOfComponents() + channel];
-    float floatValue;
-    if(image->getDataType() == TYPE_SNORM_INT16) {
-        floatValue = std::max(-1.0f, (float)value / 32767.0f);
-    } else if(image->getDataType() == TYPE_UNORM_INT16) {
-        floatValue = (float)value / 65535.0f;
-    } else {
-        floatValue = value;
-    }
+    return position.x() + position.y()*mRowPitch + position.z()*mSlicePitch;
+}
 
-    return floatValue;
+uint ImageAccess::getVoxelIndex(uint position, uchar channel) const {
+    Vector3ui size = mImage->getSize();
+    if(position >= size.x()*size.y()*size.z() || channel >= mImage->getNrOfComponents())
+        throw OutOfBoundsException();
+
+    if(isContiguous())
+        return position;
+
+    const uint x = position % size.x();
+    const uint y = (position / size.x()) % size.y();
+    const uint z = position / (size.x()*size.y());
+    return x + y*mRowPitch + z*mSlicePitch;
 }
 
 template <typename T>
-float getScalarAsFloat(T* data, uint position, Image::pointer image, uchar channel) {
+float getScalarAsFloat(T* data, uint voxel, Image::pointer image, uchar channel) {
 
-    Vector3ui size = image->getSize();
-    if(position >= size.x()*size.y()*size.z())
-        throw OutOfBoundsException();
-
-    T value = data[position*image->getNrOfComponents() + channel];
+    T value = data[voxel*image->getNrOfComponents() + channel];
     float floatValue;
     if(image->getDataType() == TYPE_SNORM_INT16) {
         floatValue = std::max(-1.0f, (float)value / 32767.0f);
@@ -63,31 +93,9 @@ float getScalarAsFloat(T* data, uint position, Image::pointer image, uchar chann
 }
 
 template <typename T>
-void setScalarAsFloat(T* data, VectorXi position, Image::pointer image, float value, uchar channel) {
-
-    Vector3ui size = image->getSize();
-    if(position.x() < 0 || position.y() < 0 || position.z() < 0 ||
-            position.x() > size.x()-1 || position.y() > size.y()-1 || position.z() > size.z()-1 || channel >= image->getNrOfComponents())
-        throw OutOfBoundsException();
-
-    uint address = (position.x() + position.y()*size.x() + position.z()*size.x()*size.y())*image->getNrOfComponents() + channel;
-    if(image->getDataType() == TYPE_SNORM_INT16) {
-        data[address] = value * 32767.0f;;
-    } else if(image->getDataType() == TYPE_UNORM_INT16) {
-        data[address] = value * 65535.0f;;
-    } else {
-        data[address] = value;
-    }
-}
-
-template <typename T>
-void setScalarAsFloat(T* data, uint position, Image::pointer image, float value, uchar channel) {
-
-    Vector3ui size = image->getSize();
-    if(position >= size.x()*size.y()*size.z())
-        throw OutOfBoundsException();
+void setScalarAsFloat(T* data, uint voxel, Image::pointer image, float value, uchar channel) {
 
-    uint address = position*image->getNrOfComponents() + channel;
+    uint address = voxel*image->getNrOfComponents() + channel;
     if(image->getDataType() == TYPE_SNORM_INT16) {
         data[address] = value * 32767.0f;;
     } else if(image->getDataType() == TYPE_UNORM_INT16) {
@@ -101,28 +109,27 @@ float ImageAccess::getScalar(VectorXi position, uchar channel) const {
     if(mImage->getDimensions() == 2)
         position = Vector3i(position.x(), position.y(), 0);
     switch(mImage->getDataType()) {
-        fastSwitchTypeMacro(return getScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, position, mImage, channel))
+        fastSwitchTypeMacro(return getScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, getVoxelIndex(position, channel), mImage, channel))
     }
 }
 
 float ImageAccess::getScalar(uint position, uchar channel) const {
     switch(mImage->getDataType()) {
-        fastSwitchTypeMacro(return getScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, position, mImage, channel))
+        fastSwitchTypeMacro(return getScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, getVoxelIndex(position, channel), mImage, channel))
     }
 }
 
 void ImageAccess::setScalar(VectorXi position, float value, uchar channel) {
-    Vector3i size(mImage->getWidth(), mImage->getHeight(), mImage->getDepth());
     if(mImage->getDimensions() == 2)
         position = Vector3i(position.x(), position.y(), 0);
     switch(mImage->getDataType()) {
-        fastSwitchTypeMacro(setScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, position, mImage, value, channel))
+        fastSwitchTypeMacro(setScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, getVoxelIndex(position, channel), mImage, value, channel))
     }
 }
 
 void ImageAccess::setScalar(uint position, float value, uchar channel) {
     switch(mImage->getDataType()) {
-        fastSwitchTypeMacro(setScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, position, mImage, value, channel))
+        fastSwitchTypeMacro(setScalarAsFloat<FAST_TYPE>((FAST_TYPE*)mData, getVoxelIndex(position, channel), mImage, value, channel))
     }
 }
 
@@ -3,6 +3,7 @@
 
 #include "FAST/SmartPointers.hpp"
 #include "FAST/Data/DataTypes.hpp"
+#include <vector>
 
 namespace fast {
 
@@ -11,6 +12,12 @@ class Image;
 class FAST_EXPORT  ImageAccess {
     public:
         ImageAccess(void* data, SharedPointer<Image> image);
+        // Access to an image view. Data points to the first voxel of the view, and rowPitch and slicePitch is the
+        // distance in voxels between rows and slices in the parent image. The parent access is kept until this
+        // access is released.
+        ImageAccess(void* data, SharedPointer<Image> image, uint rowPitch, uint slicePitch, std::unique_ptr<ImageAccess> parentAccess);
+        // Get pointer to the data. If the image is a view which is not contiguous in memory, this returns a dense
+        // copy of the view.
         void* get();
         float getScalar(uint position, uchar channel = 0) const;
         float getScalar(VectorXi position, uchar channel = 0) const;
@@ -25,7 +32,14 @@ class FAST_EXPORT  ImageAccess {
     private:
 		ImageAccess(const ImageAccess::pointer other);
 		ImageAccess::pointer operator=(const ImageAccess::pointer other);
+        uint getVoxelIndex(VectorXi position, uchar channel) const;
+        uint getVoxelIndex(uint position, uchar channel) const;
+        bool isContiguous() const;
         void* mData;
+        uint mRowPitch;
+        uint mSlicePitch;
+        std::unique_ptr<ImageAccess> mParentAccess;
+        std::vector<uchar> mDenseData;
 
         SharedPointer<Image> mImage;
 };
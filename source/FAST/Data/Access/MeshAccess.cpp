@@ -32,21 +32,29 @@ void MeshAccess::setVertex(uint i, MeshVertex vertex) {
     (*mCoordinates)[i*3] = pos[0];
     (*mCoordinates)[i*3+1] = pos[1];
     (*mCoordinates)[i*3+2] = pos[2];
-    Vector3f normal = vertex.getNormal();
-    (*mNormals)[i*3] = normal[0];
-    (*mNormals)[i*3+1] = normal[1];
-    (*mNormals)[i*3+2] = normal[2];
-    Color color = vertex.getColor();
-    (*mColors)[i*3] = color.getRedValue();
-    (*mColors)[i*3+1] = color.getGreenValue();
-    (*mColors)[i*3+2] = color.getBlueValue();
+    if(!mNormals->empty()) {
+        Vector3f normal = vertex.getNormal();
+        (*mNormals)[i*3] = normal[0];
+        (*mNormals)[i*3+1] = normal[1];
+        (*mNormals)[i*3+2] = normal[2];
+    }
+    if(!mColors->empty()) {
+        Color color = vertex.getColor();
+        (*mColors)[i*3] = color.getRedValue();
+        (*mColors)[i*3+1] = color.getGreenValue();
+        (*mColors)[i*3+2] = color.getBlueValue();
+    }
 }
 
 MeshVertex MeshAccess::getVertex(uint i) {
-    Color color((*mColors)[i*3], (*mColors)[i*3+1], (*mColors)[i*3+2]);
     Vector3f coordinate((*mCoordinates)[i*3], (*mCoordinates)[i*3+1], (*mCoordinates)[i*3+2]);
-    Vector3f normal((*mNormals)[i*3], (*mNormals)[i*3+1], (*mNormals)[i*3+2]);
-    return MeshVertex(coordinate, normal, color);
+    MeshVertex vertex(coordinate);
+    // Meshes created from arrays may lack normals and colors
+    if(!mNormals->empty())
+        vertex.setNormal(Vector3f((*mNormals)[i*3], (*mNormals)[i*3+1], (*mNormals)[i*3+2]));
+    if(!mColors->empty())
+        vertex.setColor(Color((*mColors)[i*3], (*mColors)[i*3+1], (*mColors)[i*3+2]));
+    return vertex;
 }
 
 MeshTriangle MeshAccess::getTriangle(uint i) {
@@ -72,6 +80,7 @@ void MeshAccess::setTriangle(uint i, MeshTriangle triangle) {
 
 std::vector<MeshVertex> MeshAccess::getVertices() {
     std::vector<MeshVertex> vertex;
+    vertex.reserve(mCoordinates->size()/3);
     for(uint i = 0; i < mCoordinates->size()/3; i++) {
         vertex.push_back(getVertex(i));
     }
@@ -80,6 +89,7 @@ std::vector<MeshVertex> MeshAccess::getVertices() {
 
 std::vector<MeshTriangle> MeshAccess::getTriangles() {
     std::vector<MeshTriangle> triangles;
+    triangles.reserve(mTriangles->size()/3);
     for(uint i = 0; i < mTriangles->size()/3; i++) {
         triangles.push_back(getTriangle(i));
     }
@@ -88,24 +98,52 @@ std::vector<MeshTriangle> MeshAccess::getTriangles() {
 
 std::vector<MeshLine> MeshAccess::getLines() {
     std::vector<MeshLine> lines;
+    lines.reserve(mLines->size()/2);
     for(uint i = 0; i < mLines->size()/2; i++) {
         lines.push_back(getLine(i));
     }
     return lines;
 }
 
+const std::vector<float>& MeshAccess::getCoordinateArray() const {
+    return *mCoordinates;
+}
+
+const std::vector<float>& MeshAccess::getNormalArray() const {
+    return *mNormals;
+}
+
+const std::vector<float>& MeshAccess::getColorArray() const {
+    return *mColors;
+}
+
+const std::vector<uint>& MeshAccess::getLineArray() const {
+    return *mLines;
+}
+
+const std::vector<uint>& MeshAccess::getTriangleArray() const {
+    return *mTriangles;
+}
+
 void MeshAccess::addVertex(MeshVertex v) {
-    // Add dummy values
+    // Add dummy values. Meshes created from arrays may lack normals and colors,
+    // thus only extend the arrays which have a value for every vertex.
+    const bool hasNormals = mNormals->size() == mCoordinates->size();
+    const bool hasColors = mColors->size() == mCoordinates->size();
     mCoordinates->push_back(0);
     mCoordinates->push_back(0);
     mCoordinates->push_back(0);
-    mNormals->push_back(0);
-    mNormals->push_back(0);
-    mNormals->push_back(0);
-    mColors->push_back(0);
-    mColors->push_back(0);
-    mColors->push_back(0);
-    setVertex(mCoordinates->size()/3, v);
+    if(hasNormals) {
+        mNormals->push_back(0);
+        mNormals->push_back(0);
+        mNormals->push_back(0);
+    }
+    if(hasColors) {
+        mColors->push_back(0);
+        mColors->push_back(0);
+        mColors->push_back(0);
+    }
+    setVertex(mCoordinates->size()/3 - 1, v);
 }
 
 void MeshAccess::addTriangle(MeshTriangle t) {
@@ -32,6 +32,14 @@ class FAST_EXPORT  MeshAccess {
         std::vector<MeshTriangle> getTriangles();
         std::vector<MeshLine> getLines();
         std::vector<MeshVertex> getVertices();
+        // Direct access to the host arrays, without creating an object per element.
+        // Coordinates and normals are xyz triplets and colors rgb triplets per vertex, lines are pairs and
+        // triangles triplets of vertex indices. Normals and colors may be empty.
+        const std::vector<float>& getCoordinateArray() const;
+        const std::vector<float>& getNormalArray() const;
+        const std::vector<float>& getColorArray() const;
+        const std::vector<uint>& getLineArray() const;
+        const std::vector<uint>& getTriangleArray() const;
         void release();
         ~MeshAccess();
 		typedef UniquePointer<MeshAccess> pointer;
@@ -16,6 +16,13 @@ OpenCLBufferAccess::OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image>
     mImage = image;
 }
 
+OpenCLBufferAccess::OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image, std::unique_ptr<OpenCLBufferAccess> parentAccess) {
+    mBuffer = new cl::Buffer(*buffer);
+    mIsDeleted = false;
+    mImage = image;
+    mParentAccess = std::move(parentAccess);
+}
+
 void OpenCLBufferAccess::release() {
     if(!mIsDeleted) {
         delete mBuffer;
@@ -23,6 +30,7 @@ void OpenCLBufferAccess::release() {
         mIsDeleted = true;
     }
 	mImage->accessFinished();
+	mParentAccess.reset();
 }
 
 OpenCLBufferAccess::~OpenCLBufferAccess() {
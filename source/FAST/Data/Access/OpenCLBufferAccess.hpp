@@ -13,6 +13,8 @@ class FAST_EXPORT  OpenCLBufferAccess {
     public:
         cl::Buffer* get() const;
         OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image);
+        // Access to a sub buffer of an image view. The parent access is kept until this access is released.
+        OpenCLBufferAccess(cl::Buffer* buffer,  SharedPointer<Image> image, std::unique_ptr<OpenCLBufferAccess> parentAccess);
         void release();
         ~OpenCLBufferAccess();
 		typedef UniquePointer<OpenCLBufferAccess> pointer;
@@ -22,6 +24,7 @@ class FAST_EXPORT  OpenCLBufferAccess {
         cl::Buffer* mBuffer;
         bool mIsDeleted;
         SharedPointer<Image> mImage;
+        std::unique_ptr<OpenCLBufferAccess> mParentAccess;
 };
 
 } // end namespace fast
@@ -16,6 +16,27 @@ std::string getCTypeAsString(DataType type) {
     return defines.at(type);
 }
 
+std::string getOpenCLTypeDefines(DataType type, unsigned int nrOfComponents, std::string prefix) {
+    std::string function;
+    switch(type) {
+        case TYPE_FLOAT:
+        case TYPE_UNORM_INT16:
+        case TYPE_SNORM_INT16:
+            // Normalized integers are read as floats
+            function = "FLOAT";
+            break;
+        case TYPE_INT8:
+        case TYPE_INT16:
+            function = "INT";
+            break;
+        default:
+            function = "UINT";
+    }
+    return "-D" + prefix + "TYPE=" + getCTypeAsString(type) +
+           " -D" + prefix + "TYPE_" + function +
+           " -D" + prefix + "CHANNELS=" + std::to_string(nrOfComponents);
+}
+
 cl::ImageFormat getOpenCLImageFormat(OpenCLDevice::pointer device, cl_mem_object_type imageType, DataType type, unsigned int components) {
     cl_channel_order channelOrder;
     cl_channel_type channelType;
@@ -61,8 +61,22 @@ FAST_EXPORT std::string getCTypeAsString(DataType type);
         fastCaseTypeMacro(TYPE_SNORM_INT16, short, call) \
         fastCaseTypeMacro(TYPE_UNORM_INT16, ushort, call) \
 
+// Calls a host implementation which is templated on the data type, with FAST_TYPE set to the C type of the data type.
+// The type is switched on once, instead of for each pixel, and an exception is thrown for an unknown data type.
+#define fastDispatchTypeMacro(type, call) \
+        switch(type) { \
+            fastSwitchTypeMacro(call) \
+            default: \
+                throw Exception("Unsupported data type in " + std::string(__func__)); \
+        }
+
 FAST_EXPORT cl::ImageFormat getOpenCLImageFormat(OpenCLDevice::pointer, cl_mem_object_type imageType, DataType type, unsigned int components);
 
+// Returns OpenCL build options which specialize a kernel for an image of the given data type and nr of components:
+// <prefix>TYPE is the C type, one of <prefix>TYPE_FLOAT, <prefix>TYPE_INT and <prefix>TYPE_UINT is defined to select
+// the read_image/write_image functions, and <prefix>CHANNELS is the nr of components.
+FAST_EXPORT std::string getOpenCLTypeDefines(DataType type, unsigned int nrOfComponents, std::string prefix);
+
 FAST_EXPORT size_t getSizeOfDataType(DataType type, unsigned int nrOfComponents);
 
 FAST_EXPORT float getDefaultIntensityLevel(DataType type);
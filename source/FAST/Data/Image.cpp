@@ -102,8 +102,16 @@ void Image::transferCLImageToHost(OpenCLDevice::pointer device) {
         device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, tempData);
-        mHostData = adaptImageDataToHostData(tempData,CL_RGBA, mWidth*mHeight*mDepth,mType,mComponents);
+        void * hostData = adaptImageDataToHostData(tempData,CL_RGBA, mWidth*mHeight*mDepth,mType,mComponents);
         deleteArray(tempData, mType);
+        if(mHostHasData) {
+            // Keep the existing host data, which may be external memory
+            memcpy(mHostData, hostData, getBufferSize());
+            deleteArray(hostData, mType);
+        } else {
+            mHostData = hostData;
+            mHostHasData = true;
+        }
     } else {
         if(!mHostHasData) {
             // Must allocate memory for host data
@@ -195,6 +203,33 @@ OpenCLBufferAccess::pointer Image::getOpenCLBufferAccess(
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
+    if(type == ACCESS_READ_WRITE) {
+        materializeView();
+        materializeViews();
+    }
+    {
+        std::lock_guard<std::recursive_mutex> viewLock(mViewMutex);
+        if(isView()) {
+            // Contiguous views are accessed as a sub buffer of the parent buffer if the origin is properly aligned
+            const size_t origin = (mViewOffset.x() + mViewOffset.y()*mViewParent->getWidth() +
+                    mViewOffset.z()*mViewParent->getWidth()*mViewParent->getHeight())*getSizeOfDataType(mType, mComponents);
+            const size_t alignment = device->getDevice().getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8;
+            if(isContiguousView() && origin % alignment == 0) {
+                OpenCLBufferAccess::pointer parentAccess = mViewParent->getOpenCLBufferAccess(ACCESS_READ, device);
+                cl_buffer_region region = {origin, getBufferSize()};
+                cl::Buffer subBuffer = parentAccess->get()->createSubBuffer(CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region);
+                {
+                    std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
+                    mDataIsBeingAccessed = true;
+                }
+                OpenCLBufferAccess::pointer accessObject(new OpenCLBufferAccess(&subBuffer, mPtr.lock(), std::move(parentAccess)));
+                return std::move(accessObject);
+            }
+            // Strided views can't be represented as a buffer
+            materializeView();
+        }
+    }
+
     blockIfBeingWrittenTo();
 
     if(type == ACCESS_READ_WRITE) {
@@ -375,6 +410,11 @@ OpenCLImageAccess::pointer Image::getOpenCLImageAccess(
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
+    // Views need a dense copy to be used as an OpenCL image
+    materializeView();
+    if(type == ACCESS_READ_WRITE)
+        materializeViews();
+
     blockIfBeingWrittenTo();
 
     // Check for write access
@@ -409,15 +449,42 @@ Image::Image() {
     mHostHasData = false;
     mHostDataIsUpToDate = false;
     mSpacing = Vector3f(1,1,1);
-    mMaxMinInitialized = false;
-    mAverageInitialized = false;
+    mIntensityStatisticsInitialized = false;
     mIsInitialized = false;
+    mViewOffset = Vector3ui::Zero();
 }
 
 ImageAccess::pointer Image::getImageAccess(accessType type) {
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
+    if(type == ACCESS_READ_WRITE) {
+        materializeView();
+        materializeViews();
+    }
+    {
+        std::lock_guard<std::recursive_mutex> viewLock(mViewMutex);
+        if(isView()) {
+            // Read directly from the host data of the parent
+            ImageAccess::pointer parentAccess = mViewParent->getImageAccess(ACCESS_READ);
+            const Vector3ui parentSize = mViewParent->getSize();
+            uchar* data = (uchar*)parentAccess->get() + (mViewOffset.x() + mViewOffset.y()*parentSize.x() +
+                    mViewOffset.z()*parentSize.x()*parentSize.y())*getSizeOfDataType(mType, mComponents);
+            {
+                std::unique_lock<std::mutex> lock(mDataIsBeingAccessedMutex);
+                mDataIsBeingAccessed = true;
+            }
+            uint rowPitch = parentSize.x();
+            uint slicePitch = parentSize.x()*parentSize.y();
+            if(isContiguousView()) {
+                rowPitch = mWidth;
+                slicePitch = mWidth*mHeight;
+            }
+            ImageAccess::pointer accessObject(new ImageAccess(data, mPtr.lock(), rowPitch, slicePitch, std::move(parentAccess)));
+            return std::move(accessObject);
+        }
+    }
+
     blockIfBeingWrittenTo();
 
     if(type == ACCESS_READ_WRITE) {
@@ -642,14 +709,72 @@ void Image::create(
 	create(width, height, type, nrOfComponents, DeviceManager::getInstance()->getDefaultComputationDevice(), data);
 }
 
+void Image::create(
+        VectorXui size,
+        DataType type,
+        unsigned int nrOfComponents,
+        void* data,
+        std::function<void(void*)> release) {
+
+    if(size.rows() > 2 && size.z() > 1) {
+        // 3D
+        create(size.x(), size.y(), size.z(), type, nrOfComponents, data, release);
+    } else {
+        // 2D
+        create(size.x(), size.y(), type, nrOfComponents, data, release);
+    }
+}
+
+void Image::create(
+        unsigned int width,
+        unsigned int height,
+        DataType type,
+        unsigned int nrOfComponents,
+        void* data,
+        std::function<void(void*)> release) {
+
+    if(data == NULL)
+        throw Exception("External data given to Image::create can not be NULL");
+    create(width, height, type, nrOfComponents);
+    mHostData = data;
+    mHostDataRelease = release ? release : [](void*) {};
+    mHostHasData = true;
+    mHostDataIsUpToDate = true;
+}
+
+void Image::create(
+        unsigned int width,
+        unsigned int height,
+        unsigned int depth,
+        DataType type,
+        unsigned int nrOfComponents,
+        void* data,
+        std::function<void(void*)> release) {
+
+    if(data == NULL)
+        throw Exception("External data given to Image::create can not be NULL");
+    create(width, height, depth, type, nrOfComponents);
+    mHostData = data;
+    mHostDataRelease = release ? release : [](void*) {};
+    mHostHasData = true;
+    mHostDataIsUpToDate = true;
+}
+
 bool Image::isInitialized() const {
     return mIsInitialized;
 }
 
 void Image::free(ExecutionDevice::pointer device) {
+    materializeViews();
     // Delete data on a specific device
     if(device->isHost()) {
-        deleteArray(mHostData, mType);
+        if(mHostDataRelease) {
+            mHostDataRelease(mHostData);
+            mHostDataRelease = nullptr;
+        } else {
+            deleteArray(mHostData, mType);
+        }
+        mHostData = NULL;
         mHostHasData = false;
     } else {
         OpenCLDevice::pointer clDevice = device;
@@ -665,6 +790,11 @@ void Image::free(ExecutionDevice::pointer device) {
 }
 
 void Image::freeAll() {
+    // Views of this image must get storage of their own before the data is deleted
+    materializeViews();
+    // A view only references the storage of its parent
+    mViewParent = Image::pointer();
+
     // Delete OpenCL Images
     std::unordered_map<OpenCLDevice::pointer, cl::Image*>::iterator it;
     for (it = mCLImages.begin(); it != mCLImages.end(); it++) {
@@ -741,184 +871,79 @@ void fast::Image::setSpacing(float x, float y, float z) {
 	setSpacing(Vector3f(x, y, z));
 }
 
-void Image::calculateMaxAndMinIntensity() {
-    // Calculate max and min if image has changed or it is the first time
-    if(!mMaxMinInitialized || mMaxMinTimestamp != getTimestamp()) {
-
-        unsigned int nrOfElements = mWidth*mHeight*mDepth*mComponents;
-        if(mHostHasData && mHostDataIsUpToDate) {
-            // Host data is up to date, calculate min and max on host
-            ImageAccess::pointer access = getImageAccess(ACCESS_READ);
-            void* data = access->get();
-            switch(mType) {
-            case TYPE_FLOAT:
-            case TYPE_SNORM_INT16:
-            case TYPE_UNORM_INT16:
-                getMaxAndMinFromData<float>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_INT8:
-                getMaxAndMinFromData<char>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_UINT8:
-                getMaxAndMinFromData<uchar>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_INT16:
-                getMaxAndMinFromData<short>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_UINT16:
-                getMaxAndMinFromData<ushort>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            }
-        } else {
-            // TODO the logic here can be improved. For instance choose the best device
-            // Find some OpenCL image data or buffer data that is up to date
-            bool found = false;
-            std::unordered_map<OpenCLDevice::pointer, bool>::iterator it;
-            for (it = mCLImagesIsUpToDate.begin(); it != mCLImagesIsUpToDate.end(); it++) {
-                if(it->second == true) {
-                    OpenCLDevice::pointer device = it->first;
-                    if(mDimensions == 2) {
-                        OpenCLImageAccess::pointer access = getOpenCLImageAccess(ACCESS_READ, device);
-                        cl::Image2D* clImage = access->get2DImage();
-                        getMaxAndMinFromOpenCLImage(device, *clImage, mType, &mMinimumIntensity, &mMaximumIntensity);
-                    } else {
-                        if(device->getDevice().getInfo<CL_DEVICE_EXTENSIONS>().find("cl_khr_3d_image_writes") == std::string::npos) {
-                            // Writing to 3D images is not supported on this device
-                            // Copy data to buffer instead and do the max min calculation on the buffer instead
-                            OpenCLBufferAccess::pointer access = getOpenCLBufferAccess(ACCESS_READ, device);
-                            cl::Buffer* buffer = access->get();
-                            getMaxAndMinFromOpenCLBuffer(device, *buffer, nrOfElements, mType, &mMinimumIntensity, &mMaximumIntensity);
-                        } else {
-                            OpenCLImageAccess::pointer access = getOpenCLImageAccess(ACCESS_READ, device);
-                            cl::Image3D* clImage = access->get3DImage();
-                            getMaxAndMinFromOpenCLImage(device, *clImage, mType, &mMinimumIntensity, &mMaximumIntensity);
-                        }
-                    }
-                    found = true;
-                }
-            }
-
-            if(!found) {
-                for (it = mCLBuffersIsUpToDate.begin(); it != mCLBuffersIsUpToDate.end(); it++) {
-                    if(it->second == true) {
-                        OpenCLDevice::pointer device = it->first;
-                        OpenCLBufferAccess::pointer access = getOpenCLBufferAccess(ACCESS_READ, device);
-                        cl::Buffer* buffer = access->get();
-                        getMaxAndMinFromOpenCLBuffer(device, *buffer, nrOfElements, mType, &mMinimumIntensity, &mMaximumIntensity);
-                        found = true;
-                    }
-                }
-            }
-        }
+ReductionEngine::Result Image::calculateIntensityStatisticsAsync(int histogramBins) {
+    if(!isInitialized())
+        throw Exception("Image has not been initialized.");
 
-        // Update timestamp
-        mMaxMinTimestamp = getTimestamp();
-        mMaxMinInitialized = true;
+    // Use the cached statistics if the image has not changed
+    if(mIntensityStatisticsInitialized && mIntensityStatisticsTimestamp == getTimestamp() &&
+            (histogramBins == 0 || mIntensityStatistics.histogram.size() == histogramBins))
+        return ReductionEngine::Result(mIntensityStatistics);
+
+    HistogramOptions histogram;
+    histogram.bins = histogramBins;
+    const uint64_t nrOfElements = (uint64_t)mWidth*mHeight*mDepth*mComponents;
+    if((mHostHasData && mHostDataIsUpToDate) || isView()) {
+        // Host data is up to date, calculate statistics on host
+        ImageAccess::pointer access = getImageAccess(ACCESS_READ);
+        return ReductionEngine::Result(ReductionEngine::reduce(access->get(), nrOfElements, mType, histogram));
     }
-}
-
-float Image::calculateAverageIntensity() {
-     if(!isInitialized())
-        throw Exception("Image has not been initialized.");
 
-    // Calculate max and min if image has changed or it is the first time
-    if(!mAverageInitialized || mAverageIntensityTimestamp != getTimestamp()) {
-        unsigned int nrOfElements = mWidth*mHeight*mDepth;
-        if(mHostHasData && mHostDataIsUpToDate) {
-            reportInfo() << "calculating sum on host" << Reporter::end();
-            // Host data is up to date, calculate min and max on host
-            ImageAccess::pointer access = getImageAccess(ACCESS_READ);
-            void* data = access->get();
-            switch(mType) {
-            case TYPE_FLOAT:
-                mAverageIntensity = getSumFromData<float>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_INT8:
-                mAverageIntensity = getSumFromData<char>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_UINT8:
-                mAverageIntensity = getSumFromData<uchar>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_INT16:
-                mAverageIntensity = getSumFromData<short>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_UINT16:
-                mAverageIntensity = getSumFromData<ushort>(data,nrOfElements) / nrOfElements;
-                break;
-            }
+    // TODO the logic here can be improved. For instance choose the best device
+    // Find some OpenCL image data or buffer data that is up to date. Images are read directly, also in 3D.
+    OpenCLDevice::pointer device;
+    for(auto& upToDate : mCLImagesIsUpToDate) {
+        if(upToDate.second) {
+            device = upToDate.first;
+            break;
+        }
+    }
+    if(device.isValid()) {
+        ReductionEngine::pointer engine = ReductionEngine::getInstance(device);
+        OpenCLImageAccess::pointer access = getOpenCLImageAccess(ACCESS_READ, device);
+        if(mDimensions == 2) {
+            return engine->reduce(*access->get2DImage(), mComponents, mType, histogram);
         } else {
-            reportInfo() << "calculating sum with OpenCL" << Reporter::end();
-            // TODO the logic here can be improved. For instance choose the best device
-            // Find some OpenCL image data or buffer data that is up to date
-            bool found = false;
-            std::unordered_map<OpenCLDevice::pointer, bool>::iterator it;
-            for (it = mCLImagesIsUpToDate.begin(); it != mCLImagesIsUpToDate.end(); it++) {
-                if(it->second == true) {
-                    OpenCLDevice::pointer device = it->first;
-                    float sum;
-                    if(mDimensions == 2) {
-                        OpenCLImageAccess::pointer access = getOpenCLImageAccess(ACCESS_READ, device);
-                        cl::Image2D* clImage = access->get2DImage();
-                        getIntensitySumFromOpenCLImage(device, *clImage, mType, &sum);
-                    } else {
-                        if(!device->isWritingTo3DTexturesSupported()) {
-                            // Writing to 3D images is not supported on this device
-                            // Copy data to buffer instead and do the max min calculation on the buffer instead
-                            OpenCLBufferAccess::pointer access = getOpenCLBufferAccess(ACCESS_READ, device);
-                            cl::Buffer* buffer = access->get();
-                            // TODO
-                            throw Exception("Not implemented yet");
-                            //getMaxAndMinFromOpenCLBuffer(device, *buffer, nrOfElements, mType, &mMinimumIntensity, &mMaximumIntensity);
-                        } else {
-                            OpenCLImageAccess::pointer access = getOpenCLImageAccess(ACCESS_READ, device);
-                            cl::Image3D* clImage = access->get3DImage();
-                            // TODO
-                            throw Exception("Not implemented yet");
-                            //getIntensitySumFromOpenCLImage(device, *clImage, mType, &sum);
-                        }
-                    }
-                    mAverageIntensity = sum / nrOfElements;
-                    found = true;
-                }
-            }
+            return engine->reduce(*access->get3DImage(), mComponents, mType, histogram);
+        }
+    }
 
-            if(!found) {
-                for (it = mCLBuffersIsUpToDate.begin(); it != mCLBuffersIsUpToDate.end(); it++) {
-                    if(it->second == true) {
-                        OpenCLDevice::pointer device = it->first;
-                        OpenCLBufferAccess::pointer access = getOpenCLBufferAccess(ACCESS_READ, device);
-                        cl::Buffer* buffer = access->get();
-                        // TODO
-                            throw Exception("Not implemented yet");
-                        //getMaxAndMinFromOpenCLBuffer(device, *buffer, nrOfElements, mType, &mMinimumIntensity, &mMaximumIntensity);
-                        found = true;
-                    }
-                }
-            }
+    for(auto& upToDate : mCLBuffersIsUpToDate) {
+        if(upToDate.second) {
+            device = upToDate.first;
+            break;
         }
+    }
+    if(device.isValid()) {
+        ReductionEngine::pointer engine = ReductionEngine::getInstance(device);
+        OpenCLBufferAccess::pointer access = getOpenCLBufferAccess(ACCESS_READ, device);
+        return engine->reduce(*access->get(), nrOfElements, mType, histogram);
+    }
+
+    throw Exception("Image has no up to date data to calculate intensity statistics from");
+}
 
-        // Update timestamp
-        mAverageIntensityTimestamp = getTimestamp();
-        mAverageInitialized = true;
+IntensityStatistics Image::calculateIntensityStatistics(int histogramBins) {
+    if(!mIntensityStatisticsInitialized || mIntensityStatisticsTimestamp != getTimestamp() ||
+            (histogramBins > 0 && mIntensityStatistics.histogram.size() != histogramBins)) {
+        mIntensityStatistics = calculateIntensityStatisticsAsync(histogramBins).get();
+        mIntensityStatisticsTimestamp = getTimestamp();
+        mIntensityStatisticsInitialized = true;
     }
 
-    return mAverageIntensity;
+    return mIntensityStatistics;
 }
 
-float Image::calculateMaximumIntensity() {
-    if(!isInitialized())
-        throw Exception("Image has not been initialized.");
-    calculateMaxAndMinIntensity();
+float Image::calculateAverageIntensity() {
+    return calculateIntensityStatistics().getAverage();
+}
 
-    return mMaximumIntensity;
+float Image::calculateMaximumIntensity() {
+    return calculateIntensityStatistics().maximum;
 }
 
 float Image::calculateMinimumIntensity() {
-    if(!isInitialized())
-        throw Exception("Image has not been initialized.");
-    calculateMaxAndMinIntensity();
-
-    return mMinimumIntensity;
+    return calculateIntensityStatistics().minimum;
 }
 
 void Image::createFromImage(
@@ -1013,6 +1038,8 @@ void Image::fill(float value) {
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
 
+    materializeView();
+
 	ExecutionDevice::pointer device;
     bool isOpenCLImage;
     try {
@@ -1100,7 +1127,8 @@ void Image::fill(float value) {
 }
 
 Image::pointer Image::crop(VectorXi offset, VectorXi size, bool allowOutOfBoundsCropping) {
-    Image::pointer newImage = Image::New();
+    if(offset.size() < getDimensions() || size.size() < getDimensions())
+        throw Exception("offset and size vectors given to Image::crop must have at least " + std::to_string(getDimensions()) + " components");
 
     bool needInitialization = false;
     VectorXi newImageSize = size;
@@ -1112,10 +1140,9 @@ Image::pointer Image::crop(VectorXi offset, VectorXi size, bool allowOutOfBounds
     	if(offset.x() < 0 || offset.y() < 0 || (getDimensions() == 3 && offset.z() < 0)) {
     		throw Exception("Out of bounds cropping not allowed, but offset was below 0.");
     	}
-    	// TODO validate size
     } else {
     	// Calculate offsets and sizes
-    	for(int i = 0; i < offset.size(); ++i) {
+    	for(int i = 0; i < getDimensions(); ++i) {
     		if(offset[i] < 0) { // If offset is below zero, copy source offset should be zero
 				copySourceOffset[i] = 0;
 				copyDestinationOffset[i] = -offset[i];
@@ -1130,74 +1157,201 @@ Image::pointer Image::crop(VectorXi offset, VectorXi size, bool allowOutOfBounds
     	}
     }
 
+    // Regions inside the image share the storage of this image
+    if(!needInitialization)
+        return createView(offset, size);
+
+    Image::pointer newImage = Image::New();
+    newImage->create(newImageSize.cast<uint>(), getDataType(), getNrOfComponents());
+    if(getDimensions() == 2) {
+        copyRegion(
+                newImage,
+                Vector3i(copySourceOffset.x(), copySourceOffset.y(), 0),
+                Vector3i(copyDestinationOffset.x(), copyDestinationOffset.y(), 0),
+                Vector3i(copySize.x(), copySize.y(), 1),
+                true
+        );
+    } else {
+        copyRegion(
+                newImage,
+                Vector3i(copySourceOffset.x(), copySourceOffset.y(), copySourceOffset.z()),
+                Vector3i(copyDestinationOffset.x(), copyDestinationOffset.y(), copyDestinationOffset.z()),
+                Vector3i(copySize.x(), copySize.y(), copySize.z()),
+                true
+        );
+    }
+
+    setCropTransformation(newImage, offset);
+
+    return newImage;
+}
+
+Image::pointer Image::createView(VectorXi offset, VectorXi size) {
+    if(!isInitialized())
+        throw Exception("Image has not been initialized.");
+    if(offset.size() < getDimensions() || size.size() < getDimensions())
+        throw Exception("offset and size vectors given to Image::createView must have at least " + std::to_string(getDimensions()) + " components");
+
+    Vector3i viewOffset(offset.x(), offset.y(), getDimensions() == 3 ? offset.z() : 0);
+    Vector3i viewSize(size.x(), size.y(), getDimensions() == 3 ? size.z() : 1);
+    for(int i = 0; i < 3; ++i) {
+        if(viewOffset[i] < 0 || viewSize[i] < 1 || viewOffset[i] + viewSize[i] > (int)getSize()[i])
+            throw Exception("The region given to Image::createView must be inside the image");
+    }
+
+    Image::pointer view = Image::New();
+    if(getDimensions() == 2) {
+        view->create(viewSize.x(), viewSize.y(), mType, mComponents);
+    } else {
+        view->create(viewSize.x(), viewSize.y(), viewSize.z(), mType, mComponents);
+    }
+
+    // A view of a view references the storage of the original image directly
+    Image::pointer parent;
+    {
+        std::lock_guard<std::recursive_mutex> viewLock(mViewMutex);
+        if(isView()) {
+            parent = mViewParent;
+            view->mViewOffset = mViewOffset + viewOffset.cast<uint>();
+        } else {
+            parent = mPtr.lock();
+            view->mViewOffset = viewOffset.cast<uint>();
+        }
+    }
+    view->mViewParent = parent;
+    {
+        std::lock_guard<std::mutex> lock(parent->mViewsMutex);
+        // Remove views which have been deleted
+        std::vector<WeakPointer<Image> > views;
+        for(WeakPointer<Image> existingView : parent->mViews) {
+            if(existingView.lock().isValid())
+                views.push_back(existingView);
+        }
+        views.push_back(view);
+        parent->mViews = views;
+    }
+
+    setCropTransformation(view, offset);
+
+    return view;
+}
+
+bool Image::isView() const {
+    return mViewParent.isValid();
+}
+
+bool Image::isContiguousView() const {
+    const Vector3ui parentSize = mViewParent->getSize();
+    if(mDepth > 1 && (mWidth != parentSize.x() || mHeight != parentSize.y()))
+        return false;
+    return mHeight == 1 || mWidth == parentSize.x();
+}
+
+void Image::materializeView() {
+    std::lock_guard<std::recursive_mutex> viewLock(mViewMutex);
+    if(!isView())
+        return;
+
+    Image::pointer parent = mViewParent;
+    mViewParent = Image::pointer();
+    parent->copyRegion(mPtr.lock(), mViewOffset.cast<int>(), Vector3i::Zero(), getSize().cast<int>(), false);
+}
+
+void Image::materializeViews() {
+    std::vector<WeakPointer<Image> > views;
+    {
+        std::lock_guard<std::mutex> lock(mViewsMutex);
+        views.swap(mViews);
+    }
+    for(WeakPointer<Image> view : views) {
+        Image::pointer image = view.lock();
+        if(image.isValid())
+            image->materializeView();
+    }
+}
+
+void Image::copyRegion(Image::pointer destination, Vector3i sourceOffset, Vector3i destinationOffset, Vector3i size, bool initializeDestination) {
+    {
+        std::lock_guard<std::recursive_mutex> viewLock(mViewMutex);
+        if(isView()) {
+            mViewParent->copyRegion(destination, sourceOffset + mViewOffset.cast<int>(), destinationOffset, size, initializeDestination);
+            return;
+        }
+    }
+    const bool isEmpty = size.x() <= 0 || size.y() <= 0 || size.z() <= 0;
+
     ExecutionDevice::pointer device;
     bool isOpenCLImage;
     findDeviceWithUptodateData(device, isOpenCLImage);
-    // Handle host
+    const size_t pixelSize = getSizeOfDataType(mType, mComponents);
+    const Vector3ui destinationSize = destination->getSize();
     if(device->isHost()) {
-        throw Exception("Not implemented yet");
-    } else {
-        OpenCLDevice::pointer clDevice = device;
-        if(getDimensions() == 2) {
-            if(offset.size() < 2 || size.size() < 2)
-                throw Exception("offset and size vectors given to Image::crop must have at least 2 components");
-            newImage->create(newImageSize.cast<uint>(), getDataType(), getNrOfComponents());
-            if(needInitialization)
-				newImage->fill(0);
-            OpenCLImageAccess::pointer readAccess = this->getOpenCLImageAccess(ACCESS_READ, clDevice);
-            OpenCLImageAccess::pointer writeAccess = newImage->getOpenCLImageAccess(ACCESS_READ_WRITE, clDevice);
-            cl::Image2D* input = readAccess->get2DImage();
-            cl::Image2D* output = writeAccess->get2DImage();
-
-            /*
-            std::cout << "New cropping:" << std::endl;
-            std::cout << offset.transpose() << std::endl;
-            std::cout << size.transpose() << std::endl;
-            std::cout << getSize().transpose() << std::endl;
-            std::cout << newImage->getSize().transpose() << std::endl;
-            std::cout << copySourceOffset.transpose() << std::endl;
-            std::cout << copyDestinationOffset.transpose() << std::endl;
-            std::cout << copySize.transpose() << std::endl;
-            */
-            clDevice->getCommandQueue().enqueueCopyImage(
-                    *input,
-                    *output,
-                    createRegion(copySourceOffset.x(), copySourceOffset.y(), 0),
-                    createRegion(copyDestinationOffset.x(), copyDestinationOffset.y(), 0),
-                    createRegion(copySize.x(), copySize.y(), 1)
-            );
-        } else {
-            if(offset.size() < 3 || size.size() < 3)
-                throw Exception("offset and size vectors given to Image::crop must have at least 3 components");
-            newImage->create(newImageSize.cast<uint>(), getDataType(), getNrOfComponents());
-            if(needInitialization)
-				newImage->fill(0);
-            OpenCLImageAccess::pointer readAccess = this->getOpenCLImageAccess(ACCESS_READ, clDevice);
-            OpenCLImageAccess::pointer writeAccess = newImage->getOpenCLImageAccess(ACCESS_READ_WRITE, clDevice);
-            cl::Image3D* input = readAccess->get3DImage();
-            cl::Image3D* output = writeAccess->get3DImage();
+        ImageAccess::pointer readAccess = getImageAccess(ACCESS_READ);
+        ImageAccess::pointer writeAccess = destination->getImageAccess(ACCESS_READ_WRITE);
+        const uchar* input = (const uchar*)readAccess->get();
+        uchar* output = (uchar*)writeAccess->get();
+        if(initializeDestination)
+            memset(output, 0, destination->getBufferSize());
+        if(isEmpty)
+            return;
 
-            clDevice->getCommandQueue().enqueueCopyImage(
-                    *input,
-                    *output,
-                    createRegion(copySourceOffset.x(), copySourceOffset.y(), 0),
-                    createRegion(copyDestinationOffset.x(), copyDestinationOffset.y(), 0),
-                    createRegion(copySize.x(), copySize.y(), 1)
-            );
+        // Copy one row at a time
+        for(int z = 0; z < size.z(); ++z) {
+            for(int y = 0; y < size.y(); ++y) {
+                const size_t sourceIndex = sourceOffset.x() + (size_t)(sourceOffset.y() + y)*mWidth +
+                        (size_t)(sourceOffset.z() + z)*mWidth*mHeight;
+                const size_t destinationIndex = destinationOffset.x() + (size_t)(destinationOffset.y() + y)*destinationSize.x() +
+                        (size_t)(destinationOffset.z() + z)*destinationSize.x()*destinationSize.y();
+                memcpy(output + destinationIndex*pixelSize, input + sourceIndex*pixelSize, size.x()*pixelSize);
+            }
         }
+    } else if(isOpenCLImage) {
+        OpenCLDevice::pointer clDevice = device;
+        if(initializeDestination)
+            destination->fill(0);
+        if(isEmpty)
+            return;
+        OpenCLImageAccess::pointer readAccess = getOpenCLImageAccess(ACCESS_READ, clDevice);
+        OpenCLImageAccess::pointer writeAccess = destination->getOpenCLImageAccess(ACCESS_READ_WRITE, clDevice);
+        clDevice->getCommandQueue().enqueueCopyImage(
+                *readAccess->get(),
+                *writeAccess->get(),
+                createRegion(sourceOffset.x(), sourceOffset.y(), sourceOffset.z()),
+                createRegion(destinationOffset.x(), destinationOffset.y(), destinationOffset.z()),
+                createRegion(size.x(), size.y(), size.z())
+        );
+    } else {
+        OpenCLDevice::pointer clDevice = device;
+        OpenCLBufferAccess::pointer readAccess = getOpenCLBufferAccess(ACCESS_READ, clDevice);
+        OpenCLBufferAccess::pointer writeAccess = destination->getOpenCLBufferAccess(ACCESS_READ_WRITE, clDevice);
+        cl::CommandQueue queue = clDevice->getCommandQueue();
+        if(initializeDestination)
+            queue.enqueueFillBuffer(*writeAccess->get(), (cl_uchar)0, 0, destination->getBufferSize());
+        if(isEmpty)
+            return;
+        // The x components of the origins and region of a buffer rectangle are in bytes
+        queue.enqueueCopyBufferRect(
+                *readAccess->get(),
+                *writeAccess->get(),
+                createRegion(sourceOffset.x()*pixelSize, sourceOffset.y(), sourceOffset.z()),
+                createRegion(destinationOffset.x()*pixelSize, destinationOffset.y(), destinationOffset.z()),
+                createRegion(size.x()*pixelSize, size.y(), size.z()),
+                mWidth*pixelSize,
+                mWidth*mHeight*pixelSize,
+                destinationSize.x()*pixelSize,
+                destinationSize.x()*destinationSize.y()*pixelSize
+        );
     }
+}
 
+void Image::setCropTransformation(Image::pointer croppedImage, VectorXi offset) {
     // Fix placement and spacing of the new cropped image
     AffineTransformation::pointer T = AffineTransformation::New();
-    newImage->setSpacing(getSpacing());
+    croppedImage->setSpacing(getSpacing());
     // Multiply with spacing here to convert voxel translation to world(mm) translation
     T->getTransform().translation() = getSpacing().cwiseProduct(getDimensions() == 2 ? Vector3f(offset.x(), offset.y(), 0) : Vector3f(offset.x(), offset.y(), offset.z()));
-    newImage->getSceneGraphNode()->setTransformation(T);
-    SceneGraph::setParentNode(newImage, mPtr.lock());
-    reportInfo() << SceneGraph::getAffineTransformationFromData(newImage)->getTransform().matrix() << Reporter::end();
-    reportInfo() << SceneGraph::getAffineTransformationFromData(mPtr.lock())->getTransform().matrix() << Reporter::end();
-
-    return newImage;
+    croppedImage->getSceneGraphNode()->setTransformation(T);
+    SceneGraph::setParentNode(croppedImage, mPtr.lock());
 }
 
 BoundingBox Image::getTransformedBoundingBox() const {
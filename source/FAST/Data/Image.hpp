@@ -8,7 +8,10 @@
 #include "FAST/Data/Access/OpenCLImageAccess.hpp"
 #include "FAST/Data/Access/OpenCLBufferAccess.hpp"
 #include "FAST/Data/Access/ImageAccess.hpp"
+#include "FAST/ReductionEngine.hpp"
 #include <unordered_map>
+#include <mutex>
+#include <functional>
 
 namespace fast {
 
@@ -25,6 +28,13 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         void create(VectorXui size, DataType type, uint nrOfComponents, const void * data);
         void create(uint width, uint height, DataType type, uint nrOfComponents, const void * data);
         void create(uint width, uint height, uint depth, DataType type, uint nrOfComponents, const void * data);
+        // Create an image which uses external host memory as its host data, instead of copying it.
+        // Writes through ImageAccess go directly to this memory. The memory must stay valid until release is called
+        // with it, which happens when the host data of the image is freed, the image is recreated or destroyed.
+        // Release may be empty if the memory is managed elsewhere.
+        void create(VectorXui size, DataType type, uint nrOfComponents, void * data, std::function<void(void*)> release);
+        void create(uint width, uint height, DataType type, uint nrOfComponents, void * data, std::function<void(void*)> release);
+        void create(uint width, uint height, uint depth, DataType type, uint nrOfComponents, void * data, std::function<void(void*)> release);
 
         OpenCLImageAccess::pointer getOpenCLImageAccess(accessType type, OpenCLDevice::pointer);
         OpenCLBufferAccess::pointer getOpenCLBufferAccess(accessType type, OpenCLDevice::pointer);
@@ -36,6 +46,8 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         uint getHeight() const;
         uint getDepth() const;
         Vector3ui getSize() const;
+        // True when the image has been created
+        bool isInitialized() const;
         uchar getDimensions() const;
         DataType getDataType() const;
         uint getNrOfComponents() const;
@@ -46,13 +58,36 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         float calculateMaximumIntensity();
         float calculateMinimumIntensity();
         float calculateAverageIntensity();
+        /**
+         * Calculate min, max, sum and optionally a histogram of all pixels and channels in one pass.
+         * The result is cached until the image is changed.
+         * @param histogramBins nr of histogram bins, 0 means no histogram
+         * @return
+         */
+        IntensityStatistics calculateIntensityStatistics(int histogramBins = 0);
+        /**
+         * Same as calculateIntensityStatistics, but if the image is on an OpenCL device the result can be
+         * retrieved later without blocking the command queue.
+         * @param histogramBins nr of histogram bins, 0 means no histogram
+         * @return
+         */
+        ReductionEngine::Result calculateIntensityStatisticsAsync(int histogramBins = 0);
 
         // Copy image and put contents to specific device
         Image::pointer copy(ExecutionDevice::pointer device);
 
-        // Create a new image which is a cropped version of this image
+        // Create a new image which is a cropped version of this image.
+        // If the region is inside the image, the result is a view of this image (see createView).
         Image::pointer crop(VectorXi offset, VectorXi size, bool allowOutOfBoundsCropping = false);
 
+        // Create a view of a region of this image. The view shares the storage of this image instead of copying it,
+        // and can be read through ImageAccess and OpenCLBufferAccess (as a sub buffer) without copying.
+        // The region is copied to storage of its own when the view is written to, when an OpenCL image of the view
+        // is requested, or before this image is modified.
+        Image::pointer createView(VectorXi offset, VectorXi size);
+        // Returns true if this image is a view which shares the storage of another image
+        bool isView() const;
+
         // Fill entire image with a value
         void fill(float value);
 
@@ -79,9 +114,10 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         void * mHostData;
         bool mHostHasData;
         bool mHostDataIsUpToDate;
+        // Releases the host data if it is external memory, empty if the host data is owned by the image
+        std::function<void(void*)> mHostDataRelease;
 
         void setAllDataToOutOfDate();
-        bool isInitialized() const;
 
         void updateOpenCLImageData(OpenCLDevice::pointer device);
         void transferCLImageFromHost(OpenCLDevice::pointer device);
@@ -105,10 +141,26 @@ class FAST_EXPORT  Image : public SpatialDataObject {
 
         Vector3f mSpacing;
 
-        float mMaximumIntensity, mMinimumIntensity, mAverageIntensity;
-        unsigned long mMaxMinTimestamp, mAverageIntensityTimestamp;
-        bool mMaxMinInitialized, mAverageInitialized;
-        void calculateMaxAndMinIntensity();
+        // Cached result of calculateIntensityStatistics
+        IntensityStatistics mIntensityStatistics;
+        unsigned long mIntensityStatisticsTimestamp;
+        bool mIntensityStatisticsInitialized;
+
+        // Copy a region of this image to another image, on the device where this image has up to date data
+        void copyRegion(Image::pointer destination, Vector3i sourceOffset, Vector3i destinationOffset, Vector3i size, bool initializeDestination);
+        void setCropTransformation(Image::pointer croppedImage, VectorXi offset);
+
+        // Views
+        bool isContiguousView() const;
+        void materializeView();
+        void materializeViews();
+        // Image which owns the storage of this view, and offset of the view in that image
+        Image::pointer mViewParent;
+        Vector3ui mViewOffset;
+        std::recursive_mutex mViewMutex;
+        // Views which currently share the storage of this image
+        std::vector<WeakPointer<Image> > mViews;
+        std::mutex mViewsMutex;
 
         // Declare as friends so they can get access to the accessFinished methods
         friend class ImageAccess;
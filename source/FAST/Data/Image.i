@@ -51,6 +51,99 @@ fast_to_numpy_creator(unsigned short, uint16)
 fast_to_numpy_creator(short, int16)
 fast_to_numpy_creator(float, float)
 
+%inline %{
+/*
+ * Zero copy conversion of an image to a NumPy array. The array uses the host data of the image directly, and
+ * owns an ImageAccess which is released when the array is deleted. The image can not be written to while a read
+ * only array exists, and can not be used at all while a writable array exists.
+ * Shape is (height, width) or (depth, height, width), with an extra last axis if the image has several channels.
+ */
+PyObject* fast_image_to_numpy(fast::SharedPointer<fast::Image> image, bool writable) {
+    int type;
+    switch(image->getDataType()) {
+        case fast::TYPE_FLOAT: type = NPY_FLOAT32; break;
+        case fast::TYPE_UINT8: type = NPY_UINT8; break;
+        case fast::TYPE_INT8: type = NPY_INT8; break;
+        case fast::TYPE_UINT16: case fast::TYPE_UNORM_INT16: type = NPY_UINT16; break;
+        case fast::TYPE_INT16: case fast::TYPE_SNORM_INT16: type = NPY_INT16; break;
+        default:
+            PyErr_SetString(PyExc_TypeError, "Image data type is not supported by fast_image_to_numpy");
+            return NULL;
+    }
+    npy_intp shape[4];
+    int dimensions = 0;
+    if(image->getDimensions() == 3)
+        shape[dimensions++] = image->getDepth();
+    shape[dimensions++] = image->getHeight();
+    shape[dimensions++] = image->getWidth();
+    if(image->getNrOfComponents() > 1)
+        shape[dimensions++] = image->getNrOfComponents();
+
+    fast::ImageAccess::pointer* access = new fast::ImageAccess::pointer(image->getImageAccess(writable ? ACCESS_READ_WRITE : ACCESS_READ));
+    if(!(*access)->isContiguous()) {
+        delete access;
+        PyErr_SetString(PyExc_ValueError, "Image views which are not contiguous can not be converted to NumPy without copying");
+        return NULL;
+    }
+    PyObject* array = PyArray_New(&PyArray_Type, dimensions, shape, type, NULL, (*access)->get(), 0,
+            NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED | (writable ? NPY_ARRAY_WRITEABLE : 0), NULL);
+    if(array == NULL) {
+        delete access;
+        return NULL;
+    }
+    PyObject* owner = PyCapsule_New(access, NULL, [](PyObject* capsule) {
+        delete (fast::ImageAccess::pointer*)PyCapsule_GetPointer(capsule, NULL);
+    });
+    PyArray_SetBaseObject((PyArrayObject*)array, owner);
+    return array;
+}
+
+/*
+ * Zero copy conversion of a NumPy array to an image. The image uses the data of the array as its host data and keeps
+ * a reference to the array until the host data of the image is freed. Arrays which are not C contiguous, aligned or
+ * writable are copied first.
+ * dimensions is 2 or 3. If the array has one axis more than dimensions, the last axis is the channels.
+ */
+PyObject* numpy_to_fast_image(PyObject* object, int dimensions, fast::SharedPointer<fast::Image> image) {
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OF(object, NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED | NPY_ARRAY_WRITEABLE);
+    if(array == NULL)
+        return NULL;
+    fast::DataType type;
+    switch(PyArray_TYPE(array)) {
+        case NPY_FLOAT32: type = fast::TYPE_FLOAT; break;
+        case NPY_UINT8: type = fast::TYPE_UINT8; break;
+        case NPY_INT8: type = fast::TYPE_INT8; break;
+        case NPY_UINT16: type = fast::TYPE_UINT16; break;
+        case NPY_INT16: type = fast::TYPE_INT16; break;
+        default:
+            Py_DECREF(array);
+            PyErr_SetString(PyExc_TypeError, "NumPy array must be float32, uint8, int8, uint16 or int16");
+            return NULL;
+    }
+    const int nrOfAxes = PyArray_NDIM(array);
+    if((dimensions != 2 && dimensions != 3) || (nrOfAxes != dimensions && nrOfAxes != dimensions + 1)) {
+        Py_DECREF(array);
+        PyErr_SetString(PyExc_ValueError, "NumPy array must have 2 or 3 axes, and optionally a last axis with the channels");
+        return NULL;
+    }
+    const npy_intp* shape = PyArray_DIMS(array);
+    const uint nrOfComponents = nrOfAxes > dimensions ? shape[nrOfAxes - 1] : 1;
+    // The image holds a reference to the array, which is given back with the GIL when the image releases the data
+    auto release = [array](void*) {
+        PyGILState_STATE state = PyGILState_Ensure();
+        Py_DECREF(array);
+        PyGILState_Release(state);
+    };
+    if(dimensions == 2) {
+        image->create(shape[1], shape[0], type, nrOfComponents, PyArray_DATA(array), release);
+    } else {
+        image->create(shape[2], shape[1], shape[0], type, nrOfComponents, PyArray_DATA(array), release);
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+%}
+
 namespace fast {
 
 %ignore Object;
@@ -92,6 +185,14 @@ class Image : public SpatialDataObject {
 		Image();
 };
 
+%extend SharedPointer<Image> {
+%pythoncode %{
+def __array__(self, dtype=None):
+    """Read only NumPy array which shares the host data of the image, see fast_image_to_numpy"""
+    array = fast_image_to_numpy(self, False)
+    return array if dtype is None else array.astype(dtype)
+%}
+}
 %template(ImagePtr) SharedPointer<Image>;
 
 }
\ No newline at end of file
@@ -25,56 +25,90 @@
 namespace fast {
 
 void Mesh::create(
-        std::vector<MeshVertex> vertices,
-        std::vector<MeshLine> lines,
-        std::vector<MeshTriangle> triangles
+        const std::vector<MeshVertex>& vertices,
+        const std::vector<MeshLine>& lines,
+        const std::vector<MeshTriangle>& triangles
     ) {
-     if(mIsInitialized) {
-        // Delete old data
-        freeAll();
-    }
     if(vertices.size() == 0) {
-    	create(0, 0, 0, false, false, false);
-    	return;
+        create(0, 0, 0, false, false, false);
+        return;
     }
 
-    mIsInitialized = true;
-    std::vector<Vector3f> positions;
+    std::vector<float> coordinates(vertices.size()*3);
+    std::vector<float> normals(vertices.size()*3);
+    std::vector<float> colors(vertices.size()*3);
     for(int i = 0; i < vertices.size(); i++) {
-    	Vector3f pos = vertices[i].getPosition();
-        positions.push_back(pos);
-        mCoordinates.push_back(pos[0]);
-        mCoordinates.push_back(pos[1]);
-        mCoordinates.push_back(pos[2]);
-        Vector3f normal = vertices[i].getNormal();
-        mNormals.push_back(normal[0]);
-        mNormals.push_back(normal[1]);
-        mNormals.push_back(normal[2]);
-        Color color = vertices[i].getColor();
-        mColors.push_back(color.getRedValue());
-        mColors.push_back(color.getGreenValue());
-        mColors.push_back(color.getBlueValue());
+        const Vector3f pos = vertices[i].getPosition();
+        const Vector3f normal = vertices[i].getNormal();
+        const Color color = vertices[i].getColor();
+        for(int j = 0; j < 3; j++) {
+            coordinates[i*3 + j] = pos[j];
+            normals[i*3 + j] = normal[j];
+        }
+        colors[i*3] = color.getRedValue();
+        colors[i*3 + 1] = color.getGreenValue();
+        colors[i*3 + 2] = color.getBlueValue();
     }
-    for(auto line : lines) {
-        mLines.push_back(line.getEndpoint1());
-        mLines.push_back(line.getEndpoint2());
+    std::vector<uint> lineIndices(lines.size()*2);
+    for(int i = 0; i < lines.size(); i++) {
+        lineIndices[i*2] = lines[i].getEndpoint1();
+        lineIndices[i*2 + 1] = lines[i].getEndpoint2();
     }
-    for(auto triangle : triangles) {
-        mTriangles.push_back(triangle.getEndpoint1());
-        mTriangles.push_back(triangle.getEndpoint2());
-        mTriangles.push_back(triangle.getEndpoint3());
+    std::vector<uint> triangleIndices(triangles.size()*3);
+    for(int i = 0; i < triangles.size(); i++) {
+        triangleIndices[i*3] = triangles[i].getEndpoint1();
+        triangleIndices[i*3 + 1] = triangles[i].getEndpoint2();
+        triangleIndices[i*3 + 2] = triangles[i].getEndpoint3();
+    }
+
+    create(std::move(coordinates), std::move(normals), std::move(colors), std::move(lineIndices), std::move(triangleIndices));
+}
+
+void Mesh::create(
+        std::vector<float>&& coordinates,
+        std::vector<float>&& normals,
+        std::vector<uint>&& triangles
+    ) {
+    create(std::move(coordinates), std::move(normals), std::vector<float>(), std::vector<uint>(), std::move(triangles));
+}
+
+void Mesh::create(
+        std::vector<float>&& coordinates,
+        std::vector<float>&& normals,
+        std::vector<float>&& colors,
+        std::vector<uint>&& lines,
+        std::vector<uint>&& triangles
+    ) {
+    if(mIsInitialized) {
+        // Delete old data
+        freeAll();
     }
+    if(coordinates.size() % 3 != 0 || lines.size() % 2 != 0 || triangles.size() % 3 != 0)
+        throw Exception("Coordinates and triangles given to Mesh::create must be multiples of 3, and lines a multiple of 2");
+    if(!normals.empty() && normals.size() != coordinates.size())
+        throw Exception("Number of normals given to Mesh::create must match the number of coordinates");
+    if(!colors.empty() && colors.size() != coordinates.size())
+        throw Exception("Number of colors given to Mesh::create must match the number of coordinates");
 
-	if(vertices.size() > 0) {
-		mBoundingBox = BoundingBox(positions);
-	} else {
-		mBoundingBox = BoundingBox(Vector3f(0,0,0)); // TODO Fix
-	}
-    mNrOfVertices = vertices.size();
-    mNrOfLines = lines.size();
-    mNrOfTriangles = triangles.size();
-    mUseColorVBO = true;
-    mUseNormalVBO = true;
+    mIsInitialized = true;
+    mNrOfVertices = coordinates.size() / 3;
+    mNrOfLines = lines.size() / 2;
+    mNrOfTriangles = triangles.size() / 3;
+    if(mNrOfVertices > 0) {
+        Eigen::Map<const Eigen::Matrix<float, 3, Eigen::Dynamic> > positions(coordinates.data(), 3, mNrOfVertices);
+        Vector3f minimum = positions.rowwise().minCoeff();
+        Vector3f maximum = positions.rowwise().maxCoeff();
+        mBoundingBox = BoundingBox(minimum, maximum - minimum);
+    } else {
+        mBoundingBox = BoundingBox(Vector3f(0,0,0)); // TODO Fix
+    }
+    mCoordinates = std::move(coordinates);
+    mNormals = std::move(normals);
+    mColors = std::move(colors);
+    mLines = std::move(lines);
+    mTriangles = std::move(triangles);
+    mUseColorVBO = !mColors.empty();
+    mUseNormalVBO = !mNormals.empty();
     mUseEBO = true;
     mHostHasData = true;
     mHostDataIsUpToDate = true;
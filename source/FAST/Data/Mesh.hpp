@@ -21,9 +21,32 @@ class FAST_EXPORT Mesh : public SpatialDataObject {
     FAST_OBJECT(Mesh)
     public:
         void create(
-                std::vector<MeshVertex> vertices,
-                std::vector<MeshLine> lines = {},
-                std::vector<MeshTriangle> triangles = {}
+                const std::vector<MeshVertex>& vertices,
+                const std::vector<MeshLine>& lines = {},
+                const std::vector<MeshTriangle>& triangles = {}
+        );
+        /**
+         * Create a mesh directly from host arrays, avoiding per vertex objects.
+         * Coordinates and normals are stored as xyz triplets and triangles as triplets of vertex indices.
+         * The arrays are moved into the mesh. Normals may be empty.
+         */
+        void create(
+                std::vector<float>&& coordinates,
+                std::vector<float>&& normals,
+                std::vector<uint>&& triangles
+        );
+        /**
+         * Create a mesh directly from host arrays, avoiding per vertex objects.
+         * Coordinates and normals are stored as xyz triplets, colors as rgb triplets, lines as pairs of vertex indices
+         * and triangles as triplets of vertex indices. The arrays are moved into the mesh.
+         * Normals and colors may be empty.
+         */
+        void create(
+                std::vector<float>&& coordinates,
+                std::vector<float>&& normals,
+                std::vector<float>&& colors,
+                std::vector<uint>&& lines,
+                std::vector<uint>&& triangles
         );
         void create(
                 uint nrOfVertices,
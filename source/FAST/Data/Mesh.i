@@ -15,15 +15,15 @@
 %inline %{
 std::vector<float> fast_get_vertex_data(fast::SharedPointer<fast::Mesh> mesh) {
     fast::MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
-    std::vector<fast::MeshVertex> vertices = access->getVertices();
-    std::vector<float> result;
-    for(fast::MeshVertex v : vertices) {
-        result.push_back(v.getPosition().x());
-        result.push_back(v.getPosition().y());
-        result.push_back(v.getPosition().z());
-        result.push_back(v.getNormal().x());
-        result.push_back(v.getNormal().y());
-        result.push_back(v.getNormal().z());
+    const std::vector<float>& coordinates = access->getCoordinateArray();
+    const std::vector<float>& normals = access->getNormalArray();
+    std::vector<float> result(coordinates.size()*2);
+    for(int i = 0; i < coordinates.size()/3; ++i) {
+        for(int j = 0; j < 3; ++j) {
+            result[i*6 + j] = coordinates[i*3 + j];
+            // Meshes without normals get the same default normal as MeshVertex
+            result[i*6 + 3 + j] = normals.empty() ? (j == 0 ? 1.0f : 0.0f) : normals[i*3 + j];
+        }
     }
     return result;
 }
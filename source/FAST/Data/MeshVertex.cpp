@@ -42,19 +42,19 @@ void MeshVertex::setPosition(Vector3f position) {
 	mPosition = position;
 }
 
-int MeshConnection::getEndpoint(uint index) {
+int MeshConnection::getEndpoint(uint index) const {
     return mEndpoints[index];
 }
 
-int MeshConnection::getEndpoint1() {
+int MeshConnection::getEndpoint1() const {
     return mEndpoints[0];
 }
 
-int MeshConnection::getEndpoint2() {
+int MeshConnection::getEndpoint2() const {
     return mEndpoints[1];
 }
 
-Color MeshConnection::getColor() {
+Color MeshConnection::getColor() const {
     return mColor;
 }
 
@@ -76,21 +76,16 @@ void MeshConnection::setColor(Color color) {
 }
 
 MeshLine::MeshLine(uint endpoint1, uint endpoint2, Color color) {
-    mEndpoints = VectorXui::Zero(2);
-    mEndpoints[0] = endpoint1;
-    mEndpoints[1] = endpoint2;
+    mEndpoints = Vector3ui(endpoint1, endpoint2, 0);
     setColor(color);
 }
 
 MeshTriangle::MeshTriangle(uint endpoint1, uint endpoint2, uint endpoint3, Color color) {
-    mEndpoints = VectorXui::Zero(3);
-    mEndpoints[0] = endpoint1;
-    mEndpoints[1] = endpoint2;
-    mEndpoints[2] = endpoint3;
+    mEndpoints = Vector3ui(endpoint1, endpoint2, endpoint3);
     setColor(color);
 }
 
-int MeshTriangle::getEndpoint3() {
+int MeshTriangle::getEndpoint3() const {
     return mEndpoints[2];
 }
 
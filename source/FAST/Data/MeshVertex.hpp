@@ -27,16 +27,17 @@ class FAST_EXPORT  MeshVertex {
 
 class FAST_EXPORT  MeshConnection {
 	public:
-        int getEndpoint(uint index);
-		int getEndpoint1();
-		int getEndpoint2();
-        Color getColor();
+        int getEndpoint(uint index) const;
+		int getEndpoint1() const;
+		int getEndpoint2() const;
+        Color getColor() const;
 		void setEndpoint(int endpointIndex, int vertexIndex);
 		void setEndpoint1(uint index);
 		void setEndpoint2(uint index);
 		void setColor(Color color);
 	protected:
-        VectorXui mEndpoints;
+        // Fixed size to avoid a heap allocation per connection. Lines only use the first two.
+        Vector3ui mEndpoints;
 		Color mColor;
 		MeshConnection() {};
 };
@@ -49,7 +50,7 @@ class FAST_EXPORT  MeshLine : public MeshConnection {
 class FAST_EXPORT  MeshTriangle : public MeshConnection {
 	public:
 		MeshTriangle(uint endpoint1, uint endpoint2, uint endpoint3, Color color = Color::Red());
-		int getEndpoint3();
+		int getEndpoint3() const;
 		void setEndpoint3(uint index);
 };
 
@@ -1483,3 +1483,135 @@ TEST_CASE("createFromImage on 3D image", "[fast][image]") {
 }
 
 
+
+TEST_CASE("createView on 2D image stored on host shares the data of the image", "[fast][image]") {
+    const int width = 32;
+    const int height = 16;
+    std::vector<float> data(width*height);
+    for(int i = 0; i < width*height; ++i)
+        data[i] = i;
+    Image::pointer image = Image::New();
+    image->create(width, height, TYPE_FLOAT, 1, Host::getInstance(), data.data());
+
+    Image::pointer view = image->createView(Vector2i(4, 2), Vector2i(8, 5));
+    CHECK(view->isView());
+    CHECK(view->getWidth() == 8);
+    CHECK(view->getHeight() == 5);
+    CHECK(view->getDimensions() == 2);
+
+    ImageAccess::pointer access = view->getImageAccess(ACCESS_READ);
+    float* viewData = (float*)access->get();
+    for(int y = 0; y < 5; ++y) {
+        for(int x = 0; x < 8; ++x) {
+            CHECK(access->getScalar(Vector2i(x, y)) == Approx(data[x + 4 + (y + 2)*width]));
+            CHECK(viewData[x + y*8] == Approx(data[x + 4 + (y + 2)*width]));
+        }
+    }
+    CHECK_THROWS(access->getScalar(Vector2i(8, 0)));
+}
+
+TEST_CASE("createView with invalid region throws exception", "[fast][image]") {
+    Image::pointer image = Image::New();
+    image->create(32, 16, TYPE_UINT8, 1);
+
+    CHECK_THROWS(image->createView(Vector2i(-1, 0), Vector2i(8, 8)));
+    CHECK_THROWS(image->createView(Vector2i(30, 0), Vector2i(8, 8)));
+    CHECK_THROWS(image->createView(Vector2i(0, 0), Vector2i(0, 8)));
+}
+
+TEST_CASE("Writing to a view does not change the parent image", "[fast][image]") {
+    const int width = 16;
+    const int height = 16;
+    std::vector<uchar> data(width*height, 1);
+    Image::pointer image = Image::New();
+    image->create(width, height, TYPE_UINT8, 1, Host::getInstance(), data.data());
+
+    Image::pointer view = image->createView(Vector2i(2, 2), Vector2i(4, 4));
+    {
+        ImageAccess::pointer access = view->getImageAccess(ACCESS_READ_WRITE);
+        access->setScalar(Vector2i(0, 0), 5);
+    }
+    CHECK_FALSE(view->isView());
+    ImageAccess::pointer viewAccess = view->getImageAccess(ACCESS_READ);
+    CHECK(viewAccess->getScalar(Vector2i(0, 0)) == 5);
+    CHECK(viewAccess->getScalar(Vector2i(1, 1)) == 1);
+    ImageAccess::pointer imageAccess = image->getImageAccess(ACCESS_READ);
+    CHECK(imageAccess->getScalar(Vector2i(2, 2)) == 1);
+}
+
+TEST_CASE("Writing to an image gives existing views a copy of the old data", "[fast][image]") {
+    const int width = 8;
+    const int height = 8;
+    const int depth = 8;
+    std::vector<short> data(width*height*depth, 3);
+    Image::pointer image = Image::New();
+    image->create(width, height, depth, TYPE_INT16, 1, Host::getInstance(), data.data());
+
+    Image::pointer view = image->createView(Vector3i(1, 2, 3), Vector3i(4, 4, 4));
+    CHECK(view->getDimensions() == 3);
+    {
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+        access->setScalar(Vector3i(1, 2, 3), 7);
+    }
+    CHECK_FALSE(view->isView());
+    ImageAccess::pointer access = view->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector3i(0, 0, 0)) == 3);
+}
+
+TEST_CASE("Out of bounds crop of 2D image stored on host pads with zeros", "[fast][image]") {
+    const int width = 8;
+    const int height = 8;
+    std::vector<float> data(width*height, 2.0f);
+    Image::pointer image = Image::New();
+    image->create(width, height, TYPE_FLOAT, 1, Host::getInstance(), data.data());
+
+    Image::pointer cropped = image->crop(Vector2i(-2, 4), Vector2i(6, 6), true);
+    CHECK_FALSE(cropped->isView());
+    CHECK(cropped->getWidth() == 6);
+    CHECK(cropped->getHeight() == 6);
+    ImageAccess::pointer access = cropped->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector2i(0, 0)) == Approx(0));
+    CHECK(access->getScalar(Vector2i(2, 0)) == Approx(2));
+    CHECK(access->getScalar(Vector2i(5, 3)) == Approx(2));
+    CHECK(access->getScalar(Vector2i(5, 4)) == Approx(0));
+}
+
+TEST_CASE("Create image with external data uses the data without copying and releases it", "[fast][image]") {
+    const int width = 4;
+    const int height = 3;
+    const int depth = 2;
+    std::vector<ushort> data(width*height*depth, 5);
+    int released = 0;
+    {
+        Image::pointer image = Image::New();
+        image->create(width, height, depth, TYPE_UINT16, 1, data.data(), [&](void* pointer) {
+            CHECK(pointer == data.data());
+            released++;
+        });
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+            CHECK(access->get() == data.data());
+            access->setScalar(Vector3i(1, 2, 1), 9);
+        }
+        CHECK(data[1 + 2*width + width*height] == 9);
+        CHECK(image->calculateMaximumIntensity() == Approx(9));
+        CHECK(released == 0);
+
+        // Recreating the image releases the external data
+        image->create(width, height, TYPE_UINT16, 1, data.data(), [&](void* pointer) {
+            released++;
+        });
+        CHECK(released == 1);
+        CHECK(image->getDimensions() == 2);
+    }
+    // Destroying the image releases the external data
+    CHECK(released == 2);
+}
+
+TEST_CASE("OpenCL type defines select the read function of the data type", "[fast][image]") {
+    CHECK(getOpenCLTypeDefines(TYPE_FLOAT, 1, "FAST_INPUT0_") == "-DFAST_INPUT0_TYPE=float -DFAST_INPUT0_TYPE_FLOAT -DFAST_INPUT0_CHANNELS=1");
+    CHECK(getOpenCLTypeDefines(TYPE_UINT8, 3, "FAST_OUTPUT0_") == "-DFAST_OUTPUT0_TYPE=uchar -DFAST_OUTPUT0_TYPE_UINT -DFAST_OUTPUT0_CHANNELS=3");
+    CHECK(getOpenCLTypeDefines(TYPE_INT16, 1, "") == "-DTYPE=short -DTYPE_INT -DCHANNELS=1");
+    // Normalized integers are read as floats
+    CHECK(getOpenCLTypeDefines(TYPE_UNORM_INT16, 2, "") == "-DTYPE=ushort -DTYPE_FLOAT -DCHANNELS=2");
+}
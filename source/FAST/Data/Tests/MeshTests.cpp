@@ -0,0 +1,43 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Data/Mesh.hpp"
+
+namespace fast {
+
+TEST_CASE("Add vertex to mesh created from arrays without normals and colors", "[fast][Mesh]") {
+    Mesh::pointer mesh = Mesh::New();
+    mesh->create({0, 0, 0, 1, 0, 0, 0, 1, 0}, {}, {}, {}, {0, 1, 2});
+
+    {
+        MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ_WRITE);
+        access->addVertex(MeshVertex(Vector3f(1, 2, 3)));
+        access->addTriangle(MeshTriangle(1, 2, 3));
+    }
+
+    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+    CHECK(access->getCoordinateArray().size() == 12);
+    CHECK(access->getNormalArray().empty());
+    CHECK(access->getColorArray().empty());
+    CHECK(access->getVertices().size() == 4);
+    CHECK(access->getVertex(3).getPosition().isApprox(Vector3f(1, 2, 3)));
+    CHECK(access->getTriangles().size() == 2);
+}
+
+TEST_CASE("Add vertex to mesh created from arrays with normals", "[fast][Mesh]") {
+    Mesh::pointer mesh = Mesh::New();
+    mesh->create({0, 0, 0, 1, 0, 0, 0, 1, 0}, {0, 0, 1, 0, 0, 1, 0, 0, 1}, {0, 1, 2});
+
+    {
+        MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ_WRITE);
+        access->addVertex(MeshVertex(Vector3f(1, 2, 3), Vector3f(0, 1, 0)));
+    }
+
+    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+    CHECK(access->getCoordinateArray().size() == 12);
+    CHECK(access->getNormalArray().size() == 12);
+    CHECK(access->getColorArray().empty());
+    CHECK(access->getVertex(3).getPosition().isApprox(Vector3f(1, 2, 3)));
+    CHECK(access->getVertex(3).getNormal().isApprox(Vector3f(0, 1, 0)));
+    CHECK(access->getVertex(0).getNormal().isApprox(Vector3f(0, 0, 1)));
+}
+
+}
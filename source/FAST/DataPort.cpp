@@ -2,10 +2,16 @@
 #include <vector>
 #include "DataPort.hpp"
 #include "ProcessObject.hpp"
+#include "FAST/Streamers/Streamer.hpp"
 
 namespace fast {
 
 void DataPort::addFrame(DataObject::pointer object) {
+    const uint64_t frameNr = mFramesProduced++;
+    if(frameNr % mFrameDecimation != 0) {
+        mFramesDropped++;
+        return;
+    }
 
     if(mStreamingMode == STREAMING_MODE_NEWEST_FRAME_ONLY) {
 
@@ -18,19 +24,63 @@ void DataPort::addFrame(DataObject::pointer object) {
                 mFrames[mCurrentTimestep] = object;
             } else {
                 //std::cout << "Adding frame with nr " << mCurrentTimestep + 1 << std::endl;
+                if(mFrames.count(mCurrentTimestep + 1) > 0)
+                    mFramesDropped++; // Overwritten before it was consumed
                 object->setTimestep(mCurrentTimestep+1);
                 mFrames[mCurrentTimestep + 1] = object;
             }
         }
         mFrameConditionVariable.notify_all();
 
+    } else if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData && !usesSemaphores()) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if(getNrOfUnconsumedFrames() >= mMaximumNumberOfFrames) {
+                if(mFrameDropPolicy == FRAME_DROP_POLICY_DROP_NEWEST) {
+                    mFramesDropped++;
+                    return;
+                } else if(mFrameDropPolicy == FRAME_DROP_POLICY_DROP_OLDEST) {
+                    uint64_t oldest = mFrameCounter;
+                    for(auto frame : mFrames) {
+                        if((int64_t)frame.first > mLastConsumedTimestep)
+                            oldest = std::min(oldest, frame.first);
+                    }
+                    dropFrame(oldest);
+                } else {
+                    if(!mGetCalled)
+                        Reporter::error() << "EXECUTION BLOCKED by DataPort from " << mProcessObject->getNameOfClass() << ". Do you have a DataPort object that is not used?" << Reporter::end();
+                    const Clock::time_point start = Clock::now();
+                    while(!mStop && getNrOfUnconsumedFrames() >= mMaximumNumberOfFrames)
+                        mFrameConditionVariable.wait(lock);
+                    addBlockedTime(mProducerBlockedTime, start);
+                }
+            }
+
+            // If stop signal has been set, return
+            if(mStop)
+                return;
+
+            // Add data
+            if(mCurrentTimestep > mFrameCounter)
+                mFrameCounter = mCurrentTimestep;
+            object->setTimestep(mFrameCounter);
+            mFrames[mFrameCounter] = object;
+            mFrameArrivalTimes[mFrameCounter] = Clock::now();
+            mFrameCounter++;
+        }
+        mFrameConditionVariable.notify_all();
+
     } else if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES) {
         if(!mIsStaticData) {
             // If data is not static, use semaphore to check if available space for a new frame
             //std::cout << mProcessObject->getNameOfClass() + " waiting to add " << mCurrentTimestep << " (" << mFrameCounter << ") PROCESS_ALL_FRAMES" << std::endl;
             if(!mGetCalled && mFillCount->getCount() == mMaximumNumberOfFrames)
                 Reporter::error() << "EXECUTION BLOCKED by DataPort from " << mProcessObject->getNameOfClass() << ". Do you have a DataPort object that is not used?" << Reporter::end();
-            mEmptyCount->wait();
+            if(!mEmptyCount->tryWait()) {
+                const Clock::time_point start = Clock::now();
+                mEmptyCount->wait();
+                addBlockedTime(mProducerBlockedTime, start);
+            }
 
             // If stop signal has been set, return
             if(mStop) {
@@ -76,12 +126,14 @@ void DataPort::addFrame(DataObject::pointer object) {
 DataObject::pointer DataPort::getNextFrame() {
     // getNextFrame should **always** return the frame at the current timestep
     DataObject::pointer data;
+    const bool useSemaphores = mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData && usesSemaphores();
     {
         std::unique_lock<std::mutex> lock(mMutex);
         lock.unlock();
 
         // If timestemp frame is not present, block until it is here
-        if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData) {
+        const Clock::time_point start = Clock::now();
+        if(useSemaphores) {
             // Do this using semaphore
             //std::cout << "Waiting to get " << mCurrentTimestep << std::endl;
             mFillCount->wait();
@@ -89,22 +141,35 @@ DataObject::pointer DataPort::getNextFrame() {
         } else {
             lock.lock();
             // Do this using condition variable
-            while(mFrames.count(mCurrentTimestep) == 0) {
+            while(mFrames.count(mCurrentTimestep) == 0 && !mStop) {
                 //std::cout << "Waiting for " << mCurrentTimestep << std::endl;
                 mFrameConditionVariable.wait(lock);
             }
         }
+        addBlockedTime(mConsumerWaitTime, start);
 
         if(mStop) {
             if(mFrames.count(mCurrentTimestep) > 0) {
                 return mFrames.at(mCurrentTimestep);
-            } else {
+            } else if(mFrames.count(mCurrentTimestep - 1) > 0) {
                 return mFrames.at(mCurrentTimestep - 1);
+            } else {
+                throw Exception("DataPort from " + mProcessObject->getNameOfClass() + " was stopped while waiting for data");
+            }
+        }
+
+        if(mFrameDeadline > 0 && mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES) {
+            // Skip frames which have waited too long, as long as there is a newer frame
+            const Clock::time_point now = Clock::now();
+            while(mFrames.count(mCurrentTimestep + 1) > 0 && mFrameArrivalTimes.count(mCurrentTimestep) > 0 &&
+                    std::chrono::duration<float, std::milli>(now - mFrameArrivalTimes.at(mCurrentTimestep)).count() > mFrameDeadline) {
+                dropFrame(mCurrentTimestep);
             }
         }
 
         //std::cout << "Trying to get frame at " << mCurrentTimestep << std::endl;
         data = mFrames.at(mCurrentTimestep);
+        mLastConsumedTimestep = std::max(mLastConsumedTimestep, (int64_t)mCurrentTimestep);
 
         if(mStreamingMode != STREAMING_MODE_STORE_ALL_FRAMES) {
             // Find old frames to delete
@@ -117,20 +182,62 @@ DataObject::pointer DataPort::getNextFrame() {
             // Delete old frames
             for(auto frameNr : framesToDelete) {
                 mFrames.erase(frameNr);
+                mFrameArrivalTimes.erase(frameNr);
             }
         }
 
         lock.unlock();
     }
 
-    if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData)
+    if(useSemaphores) {
         mEmptyCount->signal();
+    } else if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES) {
+        // Producer may be waiting for space in the buffer
+        mFrameConditionVariable.notify_all();
+    }
 
     mGetCalled = true;
+    mFramesConsumed++;
 
     return data;
 }
 
+void DataPort::dropFrame(uint64_t timestep) {
+    mFrames.erase(timestep);
+    mFrameArrivalTimes.erase(timestep);
+    for(uint64_t i = timestep + 1; i < mFrameCounter; ++i) {
+        if(mFrames.count(i) == 0)
+            continue;
+        DataObject::pointer frame = mFrames.at(i);
+        frame->setTimestep(i - 1);
+        mFrames[i - 1] = frame;
+        mFrames.erase(i);
+        if(mFrameArrivalTimes.count(i) > 0) {
+            mFrameArrivalTimes[i - 1] = mFrameArrivalTimes.at(i);
+            mFrameArrivalTimes.erase(i);
+        }
+    }
+    mFrameCounter--;
+    mFramesDropped++;
+}
+
+uint DataPort::getNrOfUnconsumedFrames() const {
+    uint count = 0;
+    for(auto frame : mFrames) {
+        if((int64_t)frame.first > mLastConsumedTimestep)
+            ++count;
+    }
+    return count;
+}
+
+bool DataPort::usesSemaphores() const {
+    return mFrameDropPolicy == FRAME_DROP_POLICY_BLOCK && mFrameDeadline <= 0;
+}
+
+void DataPort::addBlockedTime(std::atomic<uint64_t>& counter, Clock::time_point start) {
+    counter += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
 void DataPort::moveDataToNextTimestep() {
     std::lock_guard<std::mutex> lock(mMutex);
     //std::cout << "Moving data for " << mProcessObject->getNameOfClass() << " at timestep " << mCurrentTimestep << " size: " << mFrames.size() << " first t " << mFrames.begin()->first << std::endl;
@@ -138,6 +245,7 @@ void DataPort::moveDataToNextTimestep() {
         // Only move if frame is not there
         mFrames[mCurrentTimestep] = mFrames.at(mCurrentTimestep - 1);
         mFrames.erase(mCurrentTimestep - 1);
+        mFrameArrivalTimes.erase(mCurrentTimestep - 1);
     }
     //std::cout << "Moving data finished" << std::endl;
     mIsStaticData = true;
@@ -172,11 +280,47 @@ void DataPort::setMaximumNumberOfFrames(uint frames) {
     mEmptyCount = UniquePointer<LightweightSemaphore>(new LightweightSemaphore(mMaximumNumberOfFrames));
 }
 
+void DataPort::setFrameDropPolicy(FrameDropPolicy policy) {
+    if(mFrameCounter > 0)
+        throw Exception("Have to call setFrameDropPolicy before executing pipeline");
+    mFrameDropPolicy = policy;
+}
+
+void DataPort::setFrameDecimation(uint n) {
+    if(n == 0)
+        throw Exception("Frame decimation must be larger than 0");
+    if(n > 1 && dynamic_cast<Streamer*>(mProcessObject.get()) == nullptr)
+        throw Exception("Frame decimation can only be used on output ports of streamers, not " + mProcessObject->getNameOfClass());
+    mFrameDecimation = n;
+}
+
+void DataPort::setFrameDeadline(float milliseconds) {
+    if(mFrameCounter > 0)
+        throw Exception("Have to call setFrameDeadline before executing pipeline");
+    if(milliseconds < 0)
+        throw Exception("Frame deadline can't be negative");
+    mFrameDeadline = milliseconds;
+}
+
+DataPortMetrics DataPort::getMetrics() const {
+    DataPortMetrics metrics;
+    metrics.framesProduced = mFramesProduced;
+    metrics.framesConsumed = mFramesConsumed;
+    metrics.framesDropped = mFramesDropped;
+    metrics.producerBlockedTime = mProducerBlockedTime / 1000.0;
+    metrics.consumerWaitTime = mConsumerWaitTime / 1000.0;
+    return metrics;
+}
+
 void DataPort::stop() {
-    mStop = true;
-    Reporter::info() << "STOPPING in DataPort for PO " << mProcessObject->getNameOfClass() << Reporter::end();
-    if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData) {
-        Reporter::info() << "SIGNALING SEMAPHORES" << Reporter::end();
+    {
+        // Set the flag while holding the mutex, so that a waiting consumer or producer can't miss the notification
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    FAST_REPORT(Reporter::info(), "STOPPING in DataPort for PO " << mProcessObject->getNameOfClass());
+    if(mStreamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES && !mIsStaticData && usesSemaphores()) {
+        FAST_REPORT(Reporter::info(), "SIGNALING SEMAPHORES");
         mFillCount->signal();
         mEmptyCount->signal();
     } else {
@@ -3,6 +3,8 @@
 #include <unordered_map>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include "FAST/Data/DataObject.hpp"
 #include "FAST/Data/DataTypes.hpp"
 #include "FAST/Semaphore.hpp"
@@ -11,6 +13,26 @@ namespace fast {
 
 enum StreamingMode { STREAMING_MODE_NEWEST_FRAME_ONLY, STREAMING_MODE_STORE_ALL_FRAMES, STREAMING_MODE_PROCESS_ALL_FRAMES };
 
+/**
+ * What a DataPort in streaming mode PROCESS_ALL_FRAMES does when a new frame arrives and the buffer is full
+ */
+enum FrameDropPolicy {
+    FRAME_DROP_POLICY_BLOCK, // Block the producer until the consumer has taken a frame (default)
+    FRAME_DROP_POLICY_DROP_OLDEST, // Drop the oldest frame which has not been consumed yet
+    FRAME_DROP_POLICY_DROP_NEWEST // Drop the new frame
+};
+
+/**
+ * Frame counters and blocking times of a DataPort
+ */
+struct DataPortMetrics {
+    uint64_t framesProduced; // Nr of frames added to the port
+    uint64_t framesConsumed; // Nr of frames given to the consumer
+    uint64_t framesDropped; // Nr of frames dropped by the frame drop policy, decimation or deadline
+    double producerBlockedTime; // Total time in milliseconds the producer has been blocked by a full buffer
+    double consumerWaitTime; // Total time in milliseconds the consumer has waited for frames
+};
+
 class ProcessObject;
 
 class FAST_EXPORT DataPort {
@@ -42,6 +64,36 @@ class FAST_EXPORT DataPort {
 
         void setMaximumNumberOfFrames(uint frames);
 
+        /**
+         * Set what to do when the buffer is full in streaming mode PROCESS_ALL_FRAMES.
+         * Dropping frames is meant for ports fed by a streamer, which produces frames in its own thread.
+         * Has to be called before executing the pipeline.
+         * @param policy
+         */
+        void setFrameDropPolicy(FrameDropPolicy policy);
+
+        /**
+         * Only keep every Nth frame added to this port, and drop the rest. Default is 1, which keeps all frames.
+         * Only ports of streamers can be decimated, as other process objects produce exactly the frame of the
+         * timestep the consumer waits for, and the consumer would block forever if that frame was dropped.
+         * @param n
+         */
+        void setFrameDecimation(uint n);
+
+        /**
+         * In streaming mode PROCESS_ALL_FRAMES, drop frames which have been waiting in the port for more than
+         * the given time when the consumer asks for the next frame. The newest frame is never dropped, thus the
+         * consumer always gets a frame. Set to 0 to disable, which is the default.
+         * Has to be called before executing the pipeline.
+         * @param milliseconds
+         */
+        void setFrameDeadline(float milliseconds);
+
+        /**
+         * @return frame counters and blocking times of this port
+         */
+        DataPortMetrics getMetrics() const;
+
         /**
          * This will unblock if this DataPort is currently blocking. Used to stop a pipeline.
          */
@@ -53,6 +105,23 @@ class FAST_EXPORT DataPort {
 
         DataObject::pointer getFrame(uint64_t timestep);
     private:
+        typedef std::chrono::steady_clock Clock;
+
+        /**
+         * Whether the producer consumer model in streaming mode PROCESS_ALL_FRAMES uses the semaphores, or the
+         * mutex and condition variable which are needed to drop frames from the buffer
+         */
+        bool usesSemaphores() const;
+        /**
+         * Number of frames in the buffer which have not been given to the consumer yet. Mutex must be locked.
+         */
+        uint getNrOfUnconsumedFrames() const;
+        /**
+         * Remove a frame and move all later frames one timestep back. Mutex must be locked.
+         */
+        void dropFrame(uint64_t timestep);
+        void addBlockedTime(std::atomic<uint64_t>& counter, Clock::time_point start);
+
         /**
          * The process object which produce data for this port
          */
@@ -73,6 +142,19 @@ class FAST_EXPORT DataPort {
         bool mIsStaticData = false;
         bool mStop = false;
         bool mGetCalled = false;
+
+        FrameDropPolicy mFrameDropPolicy = FRAME_DROP_POLICY_BLOCK;
+        uint mFrameDecimation = 1;
+        float mFrameDeadline = 0;
+        std::unordered_map<uint64_t, Clock::time_point> mFrameArrivalTimes;
+        int64_t mLastConsumedTimestep = -1;
+
+        std::atomic<uint64_t> mFramesProduced{0};
+        std::atomic<uint64_t> mFramesConsumed{0};
+        std::atomic<uint64_t> mFramesDropped{0};
+        // In microseconds
+        std::atomic<uint64_t> mProducerBlockedTime{0};
+        std::atomic<uint64_t> mConsumerWaitTime{0};
 };
 
 }
@@ -1,4 +1,5 @@
 #include "FAST/DeviceManager.hpp"
+#include "FAST/DeviceScheduler.hpp"
 #include "FAST/Exception.hpp"
 #include <algorithm>
 #ifdef FAST_MODULE_VISUALIZATION
@@ -21,6 +22,7 @@
 namespace fast {
 
 bool DeviceManager::mDisableGLInterop = false;
+bool DeviceManager::mHeadless = false;
 DeviceManager* DeviceManager::mInstance = NULL;
 
 inline cl_context_properties* createInteropContextProperties(
@@ -67,7 +69,8 @@ throw Exception("Not able to get sharegroup");
 DeviceManager* DeviceManager::getInstance() {
     if(mInstance == NULL) {
 #ifdef FAST_MODULE_VISUALIZATION
-        Window::initializeQtApp();
+        if(!mHeadless)
+            Window::initializeQtApp();
 #endif
         mInstance = new DeviceManager();
     }
@@ -88,7 +91,8 @@ std::vector<OpenCLDevice::pointer> DeviceManager::getDevices(DeviceCriteria crit
     if(!isGLInteropEnabled()) {
         enableVisualization = false;
 #ifdef FAST_MODULE_VISUALIZATION
-        fast::Window::getMainGLContext(); // Still have to create GL context
+        if(!mHeadless)
+            fast::Window::getMainGLContext(); // Still have to create GL context
 #endif
     }
     if(enableVisualization) {
@@ -219,6 +223,14 @@ ExecutionDevice::pointer DeviceManager::getDefaultVisualizationDevice() {
     return mDefaultVisualizationDevice;
 }
 
+void DeviceManager::setDeviceScheduler(SharedPointer<DeviceScheduler> scheduler) {
+    mDeviceScheduler = scheduler;
+}
+
+SharedPointer<DeviceScheduler> DeviceManager::getDeviceScheduler() {
+    return mDeviceScheduler;
+}
+
 DeviceManager::DeviceManager() {
     Reporter::info() << "Device manager initialize.." << Reporter::end();
     cl::Platform::get(&platforms);
@@ -235,6 +247,10 @@ DeviceManager::DeviceManager() {
     }
 #endif
 
+    // There is no OpenGL context to share data with in headless mode
+    if(mHeadless)
+        mDisableGLInterop = true;
+
     // Set one random device as default device
     setDefaultDevice(getOneOpenCLDevice(true));
 
@@ -249,6 +265,16 @@ bool DeviceManager::isGLInteropEnabled() {
     return !mDisableGLInterop;
 }
 
+void DeviceManager::setHeadless(bool headless) {
+    if(mInstance != NULL)
+        throw Exception("DeviceManager::setHeadless must be called before the DeviceManager instance is created");
+    mHeadless = headless;
+}
+
+bool DeviceManager::isHeadless() {
+    return mHeadless;
+}
+
 OpenCLDevice::pointer DeviceManager::getDevice(
         DeviceCriteria criteria) {
     bool interop = false;
@@ -269,6 +295,8 @@ bool DeviceManager::deviceSatisfiesCriteria(OpenCLDevice::pointer device,
 
 
 bool DeviceManager::deviceHasOpenGLInteropCapability(const cl::Device &device) {
+    if(mHeadless)
+        return false;
     // Get the cl_device_id of the device
     cl_device_id deviceID = device();
     // Get the platform of device
@@ -9,6 +9,8 @@ namespace fast {
 
 typedef std::pair<cl::Platform, std::vector<cl::Device> > PlatformDevices;
 
+class DeviceScheduler;
+
 /**
  * Singleton class for retrieving and setting default execution devices
  */
@@ -47,7 +49,20 @@ class FAST_EXPORT  DeviceManager : public Object {
                 const DeviceCriteria& deviceCriteria,
                std::vector<PlatformDevices> &platformDevices);
     	static bool isGLInteropEnabled();
+        /**
+         * Create the OpenCL devices without starting the Qt application and without an OpenGL context.
+         * Used when running pipelines on machines without a display. Must be called before getInstance.
+         */
+        static void setHeadless(bool headless);
+        static bool isHeadless();
     	void initialize();
+        /**
+         * Let the scheduler assign the process objects to devices. Process objects use the default computation
+         * device if no scheduler is set, which is the default.
+         * @param scheduler
+         */
+        void setDeviceScheduler(SharedPointer<DeviceScheduler> scheduler);
+        SharedPointer<DeviceScheduler> getDeviceScheduler();
     private:
         unsigned long * mGLContext;
     	static DeviceManager* mInstance;
@@ -56,6 +71,7 @@ class FAST_EXPORT  DeviceManager : public Object {
         void operator=(DeviceManager const&); // Don't implement
         ExecutionDevice::pointer mDefaultComputationDevice;
         ExecutionDevice::pointer mDefaultVisualizationDevice;
+        SharedPointer<DeviceScheduler> mDeviceScheduler;
         void sortDevicesAccordingToPreference(
                 int numberOfPlatforms,
                 int maxNumberOfDevices,
@@ -68,6 +84,7 @@ class FAST_EXPORT  DeviceManager : public Object {
 
         std::vector<cl::Platform> platforms;
         static bool mDisableGLInterop;
+        static bool mHeadless;
 };
 
 }
@@ -0,0 +1,194 @@
+#include "FAST/DeviceScheduler.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/ProcessObject.hpp"
+#include "FAST/Exception.hpp"
+#include "FAST/Data/Image.hpp"
+
+namespace fast {
+
+DeviceScheduler::DeviceScheduler() {
+    mMeasurementInterval = 10;
+    mRebalanceThreshold = 0.2f;
+    mTransferBandwidth = 4e9f;
+    mStartTime = std::chrono::steady_clock::now();
+
+    // Use the default computation device, and the other devices
+    DeviceManager* deviceManager = DeviceManager::getInstance();
+    OpenCLDevice::pointer defaultDevice = deviceManager->getDefaultComputationDevice();
+    std::vector<OpenCLDevice::pointer> devices = {defaultDevice};
+    for(OpenCLDevice::pointer device : deviceManager->getAllDevices()) {
+        if(device->getDevice()() != defaultDevice->getDevice()())
+            devices.push_back(device);
+    }
+    setDevices(devices);
+}
+
+void DeviceScheduler::setDevices(std::vector<OpenCLDevice::pointer> devices) {
+    if(devices.empty())
+        throw Exception("The device scheduler needs at least one device");
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDevices = devices;
+    mDeviceAvailableTime = std::vector<double>(mDevices.size(), 0);
+    // The device indices of the measurements are no longer valid
+    mProcessObjects.clear();
+}
+
+void DeviceScheduler::setDeviceCriteria(const DeviceCriteria& criteria) {
+    std::vector<OpenCLDevice::pointer> devices;
+    for(OpenCLDevice::pointer device : getDevices()) {
+        if(DeviceManager::getInstance()->deviceSatisfiesCriteria(device, criteria))
+            devices.push_back(device);
+    }
+    if(devices.empty())
+        throw Exception("None of the devices of the device scheduler satisfy the device criteria");
+    setDevices(devices);
+}
+
+std::vector<OpenCLDevice::pointer> DeviceScheduler::getDevices() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDevices;
+}
+
+void DeviceScheduler::setMeasurementInterval(uint executions) {
+    if(executions == 0)
+        throw Exception("Measurement interval must be at least 1");
+    mMeasurementInterval = executions;
+}
+
+void DeviceScheduler::setRebalanceThreshold(float threshold) {
+    if(threshold < 0)
+        throw Exception("Rebalance threshold cannot be negative");
+    mRebalanceThreshold = threshold;
+}
+
+void DeviceScheduler::setTransferBandwidth(float bytesPerSecond) {
+    if(bytesPerSecond <= 0)
+        throw Exception("Transfer bandwidth must be larger than 0");
+    mTransferBandwidth = bytesPerSecond;
+}
+
+double DeviceScheduler::getEstimatedRuntime(ProcessObject* processObject, OpenCLDevice::pointer device) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(mProcessObjects.count(processObject) == 0)
+        return -1;
+    for(int i = 0; i < mDevices.size(); ++i) {
+        if(mDevices[i] == device) {
+            RuntimeMeasurement::pointer runtime = mProcessObjects[processObject].runtimes->getTiming(std::to_string(i));
+            return runtime->getSamples() > 0 ? runtime->getAverage() : -1;
+        }
+    }
+    return -1;
+}
+
+void DeviceScheduler::removeProcessObject(ProcessObject* processObject) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mProcessObjects.erase(processObject);
+}
+
+double DeviceScheduler::getTimeSinceStart() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStartTime).count();
+}
+
+double DeviceScheduler::getTransferTime(ProcessObject* processObject, OpenCLDevice::pointer device) {
+    double transferTime = 0;
+    for(auto input : processObject->mInputConnections) {
+        ExecutionDevice::pointer parentDevice = input.second->getProcessObject()->getMainDevice();
+        // Data from the host has to be transferred to any device, so it doesn't affect the choice of device
+        if(parentDevice->isHost() || parentDevice.get() == device.get())
+            continue;
+        // Use the size of the previous input data
+        if(processObject->mLastProcessed.count(input.first) == 0)
+            continue;
+        std::shared_ptr<Image> image = std::dynamic_pointer_cast<Image>(processObject->mLastProcessed[input.first].first.getPtr());
+        if(!image)
+            continue;
+        const double bytes = (double)image->getWidth()*image->getHeight()*image->getDepth()*
+                getSizeOfDataType(image->getDataType(), image->getNrOfComponents());
+        // Data is transferred from the other device to the host and then to this device
+        transferTime += 2.0*bytes/mTransferBandwidth*1000.0;
+    }
+    return transferTime;
+}
+
+bool DeviceScheduler::startExecution(ProcessObject* processObject) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ProcessObjectState& state = mProcessObjects[processObject];
+    if(!state.runtimes.isValid()) {
+        state.runtimes = RuntimeMeasurementsManager::New();
+        state.runtimes->enable();
+    }
+
+    const double now = getTimeSinceStart();
+    int selected = -1;
+    int unmeasured = -1;
+    std::vector<double> finishTimes(mDevices.size(), -1);
+    for(int i = 0; i < mDevices.size(); ++i) {
+        if(processObject->mDeviceCriteria.count(0) > 0 &&
+                !DeviceManager::getInstance()->deviceSatisfiesCriteria(mDevices[i], processObject->mDeviceCriteria[0]))
+            continue;
+        RuntimeMeasurement::pointer runtime = state.runtimes->getTiming(std::to_string(i));
+        if(runtime->getSamples() == 0) {
+            // Each device is tried once to measure the runtime
+            if(unmeasured == -1)
+                unmeasured = i;
+            continue;
+        }
+        finishTimes[i] = std::max(now, mDeviceAvailableTime[i]) + getTransferTime(processObject, mDevices[i]) +
+                runtime->getAverage();
+        if(selected == -1 || finishTimes[i] < finishTimes[selected])
+            selected = i;
+    }
+    if(unmeasured != -1) {
+        selected = unmeasured;
+    } else if(selected == -1) {
+        throw Exception("None of the devices of the device scheduler satisfy the device criteria of " +
+                        processObject->getNameOfClass());
+    } else if(state.device >= 0 && finishTimes[state.device] >= 0 &&
+            finishTimes[state.device] <= finishTimes[selected]*(1.0 + mRebalanceThreshold)) {
+        // Only move the process object if it is significantly faster, since the data has to be moved as well
+        selected = state.device;
+    }
+
+    const bool measure = selected != state.device || state.executions % mMeasurementInterval == 0;
+    if(selected != state.device) {
+        reportInfo() << "Device scheduler assigned " << processObject->getNameOfClass() << " to device " <<
+                     mDevices[selected]->getName() << reportEnd();
+        processObject->mDevices[0] = mDevices[selected];
+        state.device = selected;
+    }
+    state.executions++;
+
+    // Assume the device will be busy with this process object for its average runtime
+    RuntimeMeasurement::pointer runtime = state.runtimes->getTiming(std::to_string(selected));
+    mDeviceAvailableTime[selected] = std::max(now, mDeviceAvailableTime[selected]) +
+            (runtime->getSamples() > 0 ? runtime->getAverage() : 0);
+
+    if(measure)
+        state.runtimes->startRegularTimer(std::to_string(selected));
+    return measure;
+}
+
+void DeviceScheduler::finishExecution(ProcessObject* processObject, bool measure) {
+    if(!measure)
+        return;
+    OpenCLDevice::pointer device;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // The devices may have been changed during the execution
+        if(mProcessObjects.count(processObject) == 0 || mProcessObjects[processObject].device < 0)
+            return;
+        device = mDevices[mProcessObjects[processObject].device];
+    }
+    // Wait for the work of this process object to finish to get the actual runtime
+    device->getCommandQueue().finish();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(mProcessObjects.count(processObject) == 0 || mProcessObjects[processObject].device < 0)
+        return;
+    const int deviceIndex = mProcessObjects[processObject].device;
+    mProcessObjects[processObject].runtimes->stopRegularTimer(std::to_string(deviceIndex));
+    // The device is idle now
+    mDeviceAvailableTime[deviceIndex] = getTimeSinceStart();
+}
+
+}
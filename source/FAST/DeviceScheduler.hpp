@@ -0,0 +1,113 @@
+#ifndef DEVICE_SCHEDULER_HPP_
+#define DEVICE_SCHEDULER_HPP_
+
+#include "FAST/Object.hpp"
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/DeviceCriteria.hpp"
+#include "FAST/RuntimeMeasurementManager.hpp"
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+
+namespace fast {
+
+class ProcessObject;
+
+/**
+ * Assigns process objects to OpenCL devices, so that several devices can be used by a pipeline without
+ * setting the device of each process object.
+ *
+ * The scheduler is enabled with DeviceManager::setDeviceScheduler. Each time a process object is executed, it is
+ * assigned to the device where it is estimated to finish first. The estimate is the time until the device has
+ * finished the work already assigned to it, the time to transfer the input data from the devices of the parent
+ * process objects, and the runtime of the process object measured on that device. A process object is first
+ * executed once on each device to measure its runtime, and is measured again at a regular interval so that the
+ * assignment can change with the load of the devices.
+ *
+ * Process objects with a main device set by setMainDevice, or which run on the host, are not scheduled.
+ * Process objects with a main device criteria are only assigned to devices which satisfy it.
+ */
+class FAST_EXPORT  DeviceScheduler : public Object {
+    FAST_OBJECT(DeviceScheduler)
+    public:
+        /**
+         * Set the devices to schedule on. By default the default computation device and all other OpenCL devices
+         * of the same platform are used.
+         * @param devices
+         */
+        void setDevices(std::vector<OpenCLDevice::pointer> devices);
+        /**
+         * Only use the devices which satisfy the criteria
+         * @param criteria
+         */
+        void setDeviceCriteria(const DeviceCriteria& criteria);
+        std::vector<OpenCLDevice::pointer> getDevices();
+        /**
+         * Measure the runtime of a process object every nth execution. Measuring waits for the device to finish.
+         * Default is 10.
+         * @param executions
+         */
+        void setMeasurementInterval(uint executions);
+        /**
+         * A process object is only moved to another device if its estimated finish time is reduced by more than
+         * this fraction. Default is 0.2.
+         * @param threshold
+         */
+        void setRebalanceThreshold(float threshold);
+        /**
+         * Set the bandwidth used to estimate the time of transferring data between two devices through the host.
+         * Default is 4 GB/s.
+         * @param bytesPerSecond
+         */
+        void setTransferBandwidth(float bytesPerSecond);
+        /**
+         * @param processObject
+         * @param device
+         * @return average measured runtime in milliseconds of the process object on the device, or -1 if it has
+         * not been measured
+         */
+        double getEstimatedRuntime(ProcessObject* processObject, OpenCLDevice::pointer device);
+        /**
+         * Remove all measurements of the process object. Called when the process object is destroyed.
+         * @param processObject
+         */
+        void removeProcessObject(ProcessObject* processObject);
+    private:
+        DeviceScheduler();
+        /**
+         * Assign the process object to a device before it is executed
+         * @param processObject
+         * @return true if the runtime of this execution is to be measured
+         */
+        bool startExecution(ProcessObject* processObject);
+        /**
+         * Called after the process object has been executed
+         * @param processObject
+         * @param measure the value returned by startExecution
+         */
+        void finishExecution(ProcessObject* processObject, bool measure);
+        double getTransferTime(ProcessObject* processObject, OpenCLDevice::pointer device);
+        double getTimeSinceStart();
+        friend class ProcessObject;
+
+        struct ProcessObjectState {
+            // Runtime on each device, with the device index as name
+            RuntimeMeasurementsManager::pointer runtimes;
+            uint executions = 0;
+            int device = -1;
+        };
+
+        std::vector<OpenCLDevice::pointer> mDevices;
+        // Estimated time in milliseconds since start when each device has finished the work assigned to it
+        std::vector<double> mDeviceAvailableTime;
+        std::unordered_map<ProcessObject*, ProcessObjectState> mProcessObjects;
+        uint mMeasurementInterval;
+        float mRebalanceThreshold;
+        float mTransferBandwidth;
+        std::chrono::steady_clock::time_point mStartTime;
+        std::mutex mMutex;
+};
+
+}
+
+#endif
@@ -202,6 +202,7 @@ int OpenCLDevice::createProgramFromSource(std::string filename, std::string buil
         cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
         program = buildSources(source, buildOptions);
     }
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
@@ -219,6 +220,7 @@ int OpenCLDevice::createProgramFromSource(std::vector<std::string> filenames, st
     }
 
     cl::Program program = buildSources(sources, buildOptions);
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
@@ -227,11 +229,13 @@ int OpenCLDevice::createProgramFromString(std::string code, std::string buildOpt
     cl::Program::Sources source(1, std::make_pair(code.c_str(), code.length()));
 
     cl::Program program = buildSources(source, buildOptions);
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programs.push_back(program);
     return programs.size()-1;
 }
 
 cl::Program OpenCLDevice::getProgram(unsigned int i) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     return programs[i];
 }
 
@@ -435,6 +439,7 @@ int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::string filename,
         std::string buildOptions) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programNames[programName] = createProgramFromSource(filename,buildOptions);
     return programNames[programName];
 }
@@ -443,6 +448,7 @@ int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::vector<std::string> filenames,
         std::string buildOptions) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programNames[programName] = createProgramFromSource(filenames,buildOptions);
     return programNames[programName];
 }
@@ -451,11 +457,13 @@ int OpenCLDevice::createProgramFromStringWithName(
         std::string programName,
         std::string code,
         std::string buildOptions) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     programNames[programName] = createProgramFromString(code,buildOptions);
     return programNames[programName];
 }
 
 cl::Program OpenCLDevice::getProgram(std::string name) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     if(programNames.count(name) == 0) {
         std::string msg ="Could not find OpenCL program with the name" + name;
         throw Exception(msg.c_str(), __LINE__, __FILE__);
@@ -465,7 +473,29 @@ cl::Program OpenCLDevice::getProgram(std::string name) {
 }
 
 bool OpenCLDevice::hasProgram(std::string name) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
     return programNames.count(name) > 0;
 }
 
+cl::Program OpenCLDevice::getProgramFromSourceWithName(
+        std::string programName,
+        std::string filename,
+        std::string buildOptions) {
+    // Hold the lock while building, so that other threads wait for this build instead of building the same program
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
+    if(programNames.count(programName) == 0)
+        programNames[programName] = createProgramFromSource(filename, buildOptions);
+    return programs[programNames[programName]];
+}
+
+cl::Program OpenCLDevice::getProgramFromStringWithName(
+        std::string programName,
+        std::string code,
+        std::string buildOptions) {
+    std::lock_guard<std::recursive_mutex> lock(mProgramMutex);
+    if(programNames.count(programName) == 0)
+        programNames[programName] = createProgramFromString(code, buildOptions);
+    return programs[programNames[programName]];
+}
+
 } // end namespace fast
@@ -4,6 +4,7 @@
 #include "FAST/Object.hpp"
 #include "FAST/SmartPointers.hpp"
 #include "RuntimeMeasurementManager.hpp"
+#include <mutex>
 
 namespace fast {
 
@@ -80,6 +81,15 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         cl::Program getProgram(unsigned int i);
         cl::Program getProgram(std::string name);
         bool hasProgram(std::string name);
+        /**
+         * Get the program with the given name, and build it from the source file if it doesn't exist.
+         * Safe to call from several threads; the program is built only once for this device.
+         */
+        cl::Program getProgramFromSourceWithName(std::string programName, std::string filename, std::string buildOptions = "");
+        /**
+         * Same as getProgramFromSourceWithName, but with the source code given as a string
+         */
+        cl::Program getProgramFromStringWithName(std::string programName, std::string code, std::string buildOptions = "");
 
         bool isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType);
 
@@ -112,6 +122,8 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         std::vector<cl::CommandQueue> queues;
         std::map<std::string, int> programNames;
         std::vector<cl::Program> programs;
+        // Guards programs and programNames, which are shared by all process objects using this device
+        std::recursive_mutex mProgramMutex;
         std::vector<cl::Device> devices;
         cl::Platform platform;
 
@@ -1,12 +1,12 @@
 #ifndef METAIMAGEEXPORTER_HPP_
 #define METAIMAGEEXPORTER_HPP_
 
-#include "FAST/ProcessObject.hpp"
+#include "FAST/Exporters/FileExporter.hpp"
 #include <string>
 
 namespace fast {
 
-class FAST_EXPORT  MetaImageExporter : public ProcessObject {
+class FAST_EXPORT  MetaImageExporter : public FileExporter {
     FAST_OBJECT(MetaImageExporter)
     public:
         void setFilename(std::string filename);
@@ -22,7 +22,6 @@ class FAST_EXPORT  MetaImageExporter : public ProcessObject {
         MetaImageExporter();
         void execute();
 
-        std::string mFilename;
         std::map<std::string, std::string> mMetaData;
         bool mUseCompression;
 };
@@ -0,0 +1,19 @@
+#include "NullSink.hpp"
+
+namespace fast {
+
+NullSink::NullSink() {
+    createInputPort<DataObject>(0);
+    mNrOfFrames = 0;
+}
+
+uint64_t NullSink::getNrOfFrames() const {
+    return mNrOfFrames;
+}
+
+void NullSink::execute() {
+    getInputData<DataObject>(0);
+    mNrOfFrames++;
+}
+
+}
@@ -0,0 +1,24 @@
+#ifndef NULL_SINK_HPP_
+#define NULL_SINK_HPP_
+
+#include "FAST/ProcessObject.hpp"
+
+namespace fast {
+
+/**
+ * Consumes and discards all data it receives. Used to drive a pipeline without rendering or storing its output.
+ */
+class FAST_EXPORT  NullSink : public ProcessObject {
+    FAST_OBJECT(NullSink)
+    public:
+        uint64_t getNrOfFrames() const;
+    private:
+        NullSink();
+        void execute();
+
+        uint64_t mNrOfFrames;
+};
+
+} // end namespace fast
+
+#endif
@@ -0,0 +1,74 @@
+#include "StatisticsSink.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Data/Mesh.hpp"
+#include <sstream>
+#include <limits>
+
+namespace fast {
+
+StatisticsSink::StatisticsSink() {
+    createInputPort<DataObject>(0);
+    mNrOfFrames = 0;
+    mDataType = "";
+    mNrOfImages = 0;
+    mMinimumIntensity = std::numeric_limits<float>::max();
+    mMaximumIntensity = std::numeric_limits<float>::lowest();
+    mIntensitySum = 0;
+    mNrOfMeshes = 0;
+    mNrOfVertices = 0;
+    mNrOfTriangles = 0;
+}
+
+uint64_t StatisticsSink::getNrOfFrames() const {
+    return mNrOfFrames;
+}
+
+double StatisticsSink::getFramesPerSecond() const {
+    if(mNrOfFrames < 2)
+        return 0;
+    std::chrono::duration<double> duration = mLastFrameTime - mFirstFrameTime;
+    if(duration.count() <= 0)
+        return 0;
+    return (mNrOfFrames - 1) / duration.count();
+}
+
+std::string StatisticsSink::getReport() const {
+    std::stringstream report;
+    report << mNrOfFrames << " frames";
+    if(mNrOfFrames > 0)
+        report << " of " << mDataType << ", " << getFramesPerSecond() << " frames per second";
+    if(mNrOfImages > 0) {
+        report << ", intensity min " << mMinimumIntensity << " max " << mMaximumIntensity <<
+            " mean " << mIntensitySum / mNrOfImages;
+    }
+    if(mNrOfMeshes > 0) {
+        report << ", " << (double)mNrOfVertices / mNrOfMeshes << " vertices and " <<
+            (double)mNrOfTriangles / mNrOfMeshes << " triangles per mesh";
+    }
+    return report.str();
+}
+
+void StatisticsSink::execute() {
+    DataObject::pointer data = getInputData<DataObject>(0);
+
+    mLastFrameTime = std::chrono::high_resolution_clock::now();
+    if(mNrOfFrames == 0)
+        mFirstFrameTime = mLastFrameTime;
+    mNrOfFrames++;
+    mDataType = data->getNameOfClass();
+
+    if(mDataType == Image::getStaticNameOfClass()) {
+        Image::pointer image = data;
+        mMinimumIntensity = std::min(mMinimumIntensity, image->calculateMinimumIntensity());
+        mMaximumIntensity = std::max(mMaximumIntensity, image->calculateMaximumIntensity());
+        mIntensitySum += image->calculateAverageIntensity();
+        mNrOfImages++;
+    } else if(mDataType == Mesh::getStaticNameOfClass()) {
+        Mesh::pointer mesh = data;
+        mNrOfVertices += mesh->getNrOfVertices();
+        mNrOfTriangles += mesh->getNrOfTriangles();
+        mNrOfMeshes++;
+    }
+}
+
+}
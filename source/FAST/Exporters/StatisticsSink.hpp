@@ -0,0 +1,46 @@
+#ifndef STATISTICS_SINK_HPP_
+#define STATISTICS_SINK_HPP_
+
+#include "FAST/ProcessObject.hpp"
+#include <chrono>
+
+namespace fast {
+
+/**
+ * Consumes all data it receives and collects statistics about it: number of frames, frame rate,
+ * intensity range of images and size of meshes.
+ */
+class FAST_EXPORT  StatisticsSink : public ProcessObject {
+    FAST_OBJECT(StatisticsSink)
+    public:
+        uint64_t getNrOfFrames() const;
+        /**
+         * @return average number of frames per second from the first to the last frame
+         */
+        double getFramesPerSecond() const;
+        /**
+         * @return a one line summary of the received data
+         */
+        std::string getReport() const;
+    private:
+        StatisticsSink();
+        void execute();
+
+        uint64_t mNrOfFrames;
+        std::string mDataType;
+        std::chrono::high_resolution_clock::time_point mFirstFrameTime;
+        std::chrono::high_resolution_clock::time_point mLastFrameTime;
+
+        uint64_t mNrOfImages;
+        float mMinimumIntensity;
+        float mMaximumIntensity;
+        double mIntensitySum;
+
+        uint64_t mNrOfMeshes;
+        uint64_t mNrOfVertices;
+        uint64_t mNrOfTriangles;
+};
+
+} // end namespace fast
+
+#endif
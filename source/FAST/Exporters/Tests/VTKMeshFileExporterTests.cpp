@@ -1,6 +1,7 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Exporters/VTKMeshFileExporter.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include "FAST/Importers/VTKMeshFileImporter.hpp"
 
 using namespace fast;
 
@@ -68,3 +69,69 @@ TEST_CASE("Export mesh with triangles", "[fast][VTKMeshFileExporter]") {
 	exporter->setFilename("VTKMeshFileExporter3DTest.vtk");
 	CHECK_NOTHROW(exporter->update(0));
 }
+
+TEST_CASE("Export and import mesh created from arrays", "[fast][VTKMeshFileExporter]") {
+    std::vector<float> coordinates = {0, 0, 0, 10, 0, 0, 0, 10, 0, 0, 0, 10};
+    std::vector<float> colors = {1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1};
+    std::vector<uint> lines = {0, 3};
+    std::vector<uint> triangles = {0, 1, 2, 1, 2, 3};
+    Mesh::pointer mesh = Mesh::New();
+    mesh->create(std::vector<float>(coordinates), std::vector<float>(), std::vector<float>(colors),
+                 std::vector<uint>(lines), std::vector<uint>(triangles));
+    CHECK(mesh->getNrOfVertices() == 4);
+    CHECK(mesh->getNrOfLines() == 1);
+    CHECK(mesh->getNrOfTriangles() == 2);
+
+    VTKMeshFileExporter::pointer exporter = VTKMeshFileExporter::New();
+    exporter->setInputData(mesh);
+    exporter->setWriteColors(true);
+    exporter->setFilename("VTKMeshFileExporterArrayTest.vtk");
+    exporter->update(0);
+
+    VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+    importer->setFilename("VTKMeshFileExporterArrayTest.vtk");
+    DataPort::pointer port = importer->getOutputPort();
+    importer->update(0);
+    Mesh::pointer result = port->getNextFrame();
+
+    MeshAccess::pointer access = result->getMeshAccess(ACCESS_READ);
+    CHECK(access->getCoordinateArray() == coordinates);
+    CHECK(access->getColorArray() == colors);
+    CHECK(access->getNormalArray().empty());
+    CHECK(access->getLineArray() == lines);
+    CHECK(access->getTriangleArray() == triangles);
+}
+
+TEST_CASE("Export and import mesh in binary VTK and native formats", "[fast][VTKMeshFileExporter]") {
+    std::vector<float> coordinates = {0, 0, 0, 10.5f, 0, 0, 0, -10.25f, 0, 0, 0, 1e-3f};
+    std::vector<float> normals = {0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0};
+    std::vector<float> colors = {1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1};
+    std::vector<uint> lines = {0, 3};
+    std::vector<uint> triangles = {0, 1, 2, 1, 2, 3};
+    Mesh::pointer mesh = Mesh::New();
+    mesh->create(std::vector<float>(coordinates), std::vector<float>(normals), std::vector<float>(colors),
+                 std::vector<uint>(lines), std::vector<uint>(triangles));
+
+    for(std::string filename : {"VTKMeshFileExporterBinaryTest.vtk", "VTKMeshFileExporterNativeTest.fmesh"}) {
+        VTKMeshFileExporter::pointer exporter = VTKMeshFileExporter::New();
+        exporter->setInputData(mesh);
+        exporter->setWriteNormals(true);
+        exporter->setWriteColors(true);
+        exporter->setBinary(true);
+        exporter->setFilename(filename);
+        exporter->update(0);
+
+        VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+        importer->setFilename(filename);
+        DataPort::pointer port = importer->getOutputPort();
+        importer->update(0);
+        Mesh::pointer result = port->getNextFrame();
+
+        MeshAccess::pointer access = result->getMeshAccess(ACCESS_READ);
+        CHECK(access->getCoordinateArray() == coordinates);
+        CHECK(access->getNormalArray() == normals);
+        CHECK(access->getColorArray() == colors);
+        CHECK(access->getLineArray() == lines);
+        CHECK(access->getTriangleArray() == triangles);
+    }
+}
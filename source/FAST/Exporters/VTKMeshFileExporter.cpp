@@ -1,15 +1,66 @@
 #include "VTKMeshFileExporter.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include "FAST/Importers/MeshFileFormat.hpp"
 #include <fstream>
+#include <cstdio>
 #include "FAST/SceneGraph.hpp"
 
 namespace fast {
 
+static void formatValue(char* buffer, size_t size, float value) {
+    std::snprintf(buffer, size, "%g", value);
+}
+
+static void formatValue(char* buffer, size_t size, int value) {
+    std::snprintf(buffer, size, "%d", value);
+}
+
+/**
+ * Write values as text with valuesPerLine values on each line.
+ * The lines are formatted in parallel in chunks, which are then written in order.
+ */
+template <class T>
+static void writeAscii(std::ofstream& file, const std::vector<T>& values, int valuesPerLine) {
+    const int nrOfLines = values.size() / valuesPerLine;
+    const int linesPerChunk = 16384;
+    const int nrOfChunks = (nrOfLines + linesPerChunk - 1) / linesPerChunk;
+    std::vector<std::string> chunks(nrOfChunks);
+    #pragma omp parallel for
+    for(int chunk = 0; chunk < nrOfChunks; ++chunk) {
+        std::string& text = chunks[chunk];
+        text.reserve(linesPerChunk*valuesPerLine*8);
+        char buffer[32];
+        const int end = std::min(nrOfLines, (chunk + 1)*linesPerChunk);
+        for(int line = chunk*linesPerChunk; line < end; ++line) {
+            for(int i = 0; i < valuesPerLine; ++i) {
+                formatValue(buffer, sizeof(buffer), values[line*valuesPerLine + i]);
+                text += buffer;
+                text += i == valuesPerLine - 1 ? '\n' : ' ';
+            }
+        }
+    }
+    for(const std::string& text : chunks)
+        file.write(text.data(), text.size());
+}
+
+// Write 32 bit values in the given byte order
+template <class T>
+static void writeBinary(std::ofstream& file, const std::vector<T>& values, bool bigEndian) {
+    static_assert(sizeof(T) == 4, "Only 32 bit values can be written");
+    if(bigEndian == isLittleEndianHost()) {
+        std::vector<T> swapped = values;
+        swapByteOrder(swapped.data(), swapped.size(), sizeof(T));
+        file.write((const char*)swapped.data(), swapped.size()*sizeof(T));
+    } else {
+        file.write((const char*)values.data(), values.size()*sizeof(T));
+    }
+}
 
 VTKMeshFileExporter::VTKMeshFileExporter() {
     createInputPort<Mesh>(0);
     mWriteNormals = false;
     mWriteColors = false;
+    mBinary = false;
 }
 
 void VTKMeshFileExporter::setWriteNormals(bool writeNormals) {
@@ -20,6 +71,10 @@ void VTKMeshFileExporter::setWriteColors(bool writeColors)  {
     mWriteColors = writeColors;
 }
 
+void VTKMeshFileExporter::setBinary(bool binary) {
+    mBinary = binary;
+}
+
 void VTKMeshFileExporter::execute() {
     if(mFilename == "")
         throw Exception("No filename given to the VTKMeshFileExporter");
@@ -29,73 +84,153 @@ void VTKMeshFileExporter::execute() {
     // Get transformation
     AffineTransformation::pointer transform = SceneGraph::getAffineTransformationFromData(mesh);
 
-    std::ofstream file(mFilename.c_str());
+    const bool nativeFormat = mFilename.size() >= 6 && mFilename.substr(mFilename.size() - 6) == ".fmesh";
+    std::ofstream file;
+    if(nativeFormat || mBinary) {
+        file.open(mFilename.c_str(), std::ios::out | std::ios::binary);
+    } else {
+        file.open(mFilename.c_str());
+    }
 
     if(!file.is_open())
         throw Exception("Unable to open the file " + mFilename);
 
+    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
+    const std::vector<float>& coordinates = access->getCoordinateArray();
+    const std::vector<float>& normals = access->getNormalArray();
+    const std::vector<float>& colors = access->getColorArray();
+    const std::vector<uint>& lines = access->getLineArray();
+    const std::vector<uint>& triangles = access->getTriangleArray();
+    const int nrOfVertices = coordinates.size() / 3;
+    const Affine3f& T = transform->getTransform();
+
+    // Apply the transformation to the vertices
+    std::vector<float> positions(nrOfVertices*3);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfVertices; i++) {
+        const Vector3f position = T*Vector3f(coordinates[i*3], coordinates[i*3 + 1], coordinates[i*3 + 2]);
+        positions[i*3] = position.x();
+        positions[i*3 + 1] = position.y();
+        positions[i*3 + 2] = position.z();
+    }
+
+    // Meshes without normals or colors are written with the MeshVertex defaults
+    std::vector<float> outputNormals;
+    if(mWriteNormals) {
+        outputNormals.resize(nrOfVertices*3);
+        #pragma omp parallel for
+        for(int i = 0; i < nrOfVertices; i++) {
+            Vector3f normal(1, 0, 0);
+            if(!normals.empty())
+                normal = Vector3f(normals[i*3], normals[i*3 + 1], normals[i*3 + 2]);
+
+            normal = T.linear() * normal; // Transform the normal
+
+            // Normalize it
+            float length = normal.norm();
+            if(length == 0) { // prevent NaN situations
+                normal = Vector3f(0, 1, 0);
+            } else {
+                normal.normalize();
+            }
+            outputNormals[i*3] = normal.x();
+            outputNormals[i*3 + 1] = normal.y();
+            outputNormals[i*3 + 2] = normal.z();
+        }
+    }
+
+    std::vector<float> outputColors;
+    if(mWriteColors) {
+        if(colors.empty()) {
+            const Color defaultColor = Color::Green();
+            outputColors.resize(nrOfVertices*3);
+            for(int i = 0; i < nrOfVertices; i++) {
+                outputColors[i*3] = defaultColor.getRedValue();
+                outputColors[i*3 + 1] = defaultColor.getGreenValue();
+                outputColors[i*3 + 2] = defaultColor.getBlueValue();
+            }
+        } else {
+            outputColors = colors;
+        }
+    }
+
+    if(nativeFormat) {
+        NativeMeshFileHeader header;
+        std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+        header.version = MESH_FILE_VERSION;
+        header.nrOfVertices = nrOfVertices;
+        header.nrOfLines = lines.size() / 2;
+        header.nrOfTriangles = triangles.size() / 3;
+        header.flags = (mWriteNormals ? MESH_FILE_HAS_NORMALS : 0) | (mWriteColors ? MESH_FILE_HAS_COLORS : 0);
+        if(!isLittleEndianHost())
+            swapByteOrder(&header.version, 5, sizeof(uint32_t));
+        file.write((const char*)&header, sizeof(header));
+        writeBinary(file, positions, false);
+        writeBinary(file, outputNormals, false);
+        writeBinary(file, outputColors, false);
+        writeBinary(file, lines, false);
+        writeBinary(file, triangles, false);
+        file.close();
+        return;
+    }
+
     // Write header
     file << "# vtk DataFile Version 3.0\n"
-            "vtk output\n"
-            "ASCII\n"
+            "vtk output\n" <<
+            (mBinary ? "BINARY\n" : "ASCII\n") <<
             "DATASET POLYDATA\n";
 
+    // Write the arrays as text, or as big endian binary data followed by a newline
+    auto writeFloats = [this, &file](const std::vector<float>& values) {
+        if(mBinary) {
+            writeBinary(file, values, true);
+            file << "\n";
+        } else {
+            writeAscii(file, values, 3);
+        }
+    };
+    auto writeCells = [this, &file](const std::vector<uint>& indices, int pointsPerCell) {
+        // Each cell is the number of points followed by the point indices
+        const int nrOfCells = indices.size() / pointsPerCell;
+        std::vector<int> cells(nrOfCells*(pointsPerCell + 1));
+        for(int i = 0; i < nrOfCells; i++) {
+            cells[i*(pointsPerCell + 1)] = pointsPerCell;
+            for(int j = 0; j < pointsPerCell; j++)
+                cells[i*(pointsPerCell + 1) + j + 1] = indices[i*pointsPerCell + j];
+        }
+        if(mBinary) {
+            writeBinary(file, cells, true);
+            file << "\n";
+        } else {
+            writeAscii(file, cells, pointsPerCell + 1);
+        }
+    };
+
     // Write vertices
-    MeshAccess::pointer access = mesh->getMeshAccess(ACCESS_READ);
-    std::vector<MeshVertex> vertices = access->getVertices();
-    file << "POINTS " << vertices.size() << " float\n";
-    for(int i = 0; i < vertices.size(); i++) {
-        MeshVertex vertex = vertices[i];
-        vertex.getPosition() = (transform->getTransform().matrix()*vertex.getPosition().homogeneous()).head(3);
-        file << vertex.getPosition().x() << " " << vertex.getPosition().y() << " " << vertex.getPosition().z() << "\n";
-    }
+    file << "POINTS " << nrOfVertices << " float\n";
+    writeFloats(positions);
 
     if(mesh->getNrOfTriangles() > 0) {
-        std::vector<MeshTriangle> triangles = access->getTriangles();
         // Write triangles
         file << "POLYGONS " << mesh->getNrOfTriangles() << " " << mesh->getNrOfTriangles() * 4 << "\n";
-        for(MeshTriangle triangle : triangles) {
-            file << "3 " << triangle.getEndpoint1() << " " << triangle.getEndpoint2() << " " << triangle.getEndpoint3()
-                 << "\n";
-        }
+        writeCells(triangles, 3);
     }
     if(mesh->getNrOfLines() > 0) {
     	// Write lines
-		std::vector<MeshLine> lines = access->getLines();
         file << "LINES " << mesh->getNrOfLines() << " " << mesh->getNrOfLines() * 3 << "\n";
-        for(MeshLine line : lines) {
-            file << "2 " << line.getEndpoint1() << " " << line.getEndpoint2() << "\n";
-        }
+        writeCells(lines, 2);
     }
 
     if(mWriteNormals) {
-        file << "POINT_DATA " << vertices.size() << "\n";
+        file << "POINT_DATA " << nrOfVertices << "\n";
         file << "NORMALS Normals float\n";
-        for(int i = 0; i < vertices.size(); i++) {
-            MeshVertex vertex = vertices[i];
-            VectorXf normal = vertex.getNormal();
-
-            normal = transform->getTransform().linear() * normal; // Transform the normal
-
-            // Normalize it
-            float length = normal.norm();
-            if(length == 0) { // prevent NaN situations
-                file << "0 1 0\n";
-            } else {
-                normal.normalize();
-                file << normal.x() << " " << normal.y() << " " << normal.z() << "\n";
-            }
-        }
+        writeFloats(outputNormals);
     }
 
     if(mWriteColors) {
-        file << "POINT_DATA " << vertices.size() << "\n";
+        file << "POINT_DATA " << nrOfVertices << "\n";
         file << "VECTORS vertex_colors float\n";
-        for(int i = 0; i < vertices.size(); i++) {
-            MeshVertex vertex = vertices[i];
-            Color color = vertex.getColor();
-            file << color.getRedValue() << " " << color.getGreenValue() << " " << color.getBlueValue() << "\n";
-        }
+        writeFloats(outputColors);
     }
 
     file.close();
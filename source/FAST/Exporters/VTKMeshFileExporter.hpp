@@ -5,17 +5,26 @@
 
 namespace fast {
 
+/**
+ * Writes a mesh to a file.
+ *
+ * Writes legacy VTK polydata files, in ASCII format by default or in (big endian) BINARY format if setBinary(true)
+ * is used. If the filename ends with .fmesh, the native FAST binary mesh format is written instead, which
+ * VTKMeshFileImporter can read without any parsing.
+ */
 class FAST_EXPORT  VTKMeshFileExporter : public FileExporter {
     FAST_OBJECT(VTKMeshFileExporter);
     public:
         void setWriteNormals(bool writeNormals);
         void setWriteColors(bool writeColors);
+        void setBinary(bool binary);
     private:
         VTKMeshFileExporter();
         void execute();
 
         bool mWriteNormals;
         bool mWriteColors;
+        bool mBinary;
 };
 
 }
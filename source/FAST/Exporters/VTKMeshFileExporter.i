@@ -8,6 +8,9 @@ class VTKMeshFileExporter : public ProcessObject {
     public:
     	static SharedPointer<VTKMeshFileExporter> New();
         void setFilename(std::string filename);
+        void setWriteNormals(bool writeNormals);
+        void setWriteColors(bool writeColors);
+        void setBinary(bool binary);
     private:
         VTKMeshFileExporter();
 };
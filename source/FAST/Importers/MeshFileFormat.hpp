@@ -0,0 +1,50 @@
+#ifndef MESH_FILE_FORMAT_HPP
+#define MESH_FILE_FORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace fast {
+
+/**
+ * Header of the native FAST binary mesh format (.fmesh), which VTKMeshFileImporter reads and
+ * VTKMeshFileExporter writes.
+ *
+ * The header is followed by the arrays of the mesh, in this order and without padding:
+ * coordinates (3 x float per vertex), normals (3 x float per vertex, if MESH_FILE_HAS_NORMALS),
+ * colors (3 x float per vertex, if MESH_FILE_HAS_COLORS), lines (2 x uint32 per line) and
+ * triangles (3 x uint32 per triangle). Everything is little endian, so that the arrays can be copied
+ * directly from a memory mapped file.
+ */
+struct NativeMeshFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nrOfVertices;
+    uint32_t nrOfLines;
+    uint32_t nrOfTriangles;
+    uint32_t flags;
+};
+
+static const char MESH_FILE_MAGIC[8] = {'F', 'A', 'S', 'T', 'M', 'E', 'S', 'H'};
+static const uint32_t MESH_FILE_VERSION = 1;
+static const uint32_t MESH_FILE_HAS_NORMALS = 1;
+static const uint32_t MESH_FILE_HAS_COLORS = 2;
+
+inline bool isLittleEndianHost() {
+    const uint16_t value = 1;
+    uint8_t firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
+
+// Reverse the byte order of count values of the given size, in place
+inline void swapByteOrder(void* data, size_t count, size_t valueSize) {
+    char* bytes = (char*)data;
+    for(size_t i = 0; i < count; ++i)
+        std::reverse(bytes + i*valueSize, bytes + (i + 1)*valueSize);
+}
+
+} // end namespace fast
+
+#endif
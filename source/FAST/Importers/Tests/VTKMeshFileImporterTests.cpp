@@ -1,6 +1,9 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Importers/VTKMeshFileImporter.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include "FAST/Importers/MeshFileFormat.hpp"
+#include <fstream>
+#include <cstdio>
 
 namespace fast {
 
@@ -27,4 +30,58 @@ TEST_CASE("Importer VTK surface from file", "[fast][VTKMeshFileImporter]") {
     CHECK(surface->getNrOfVertices() == 386);
 }
 
+static void writeNativeMeshFile(std::string filename, std::vector<float> coordinates, std::vector<uint32_t> lines, std::vector<uint32_t> triangles) {
+    NativeMeshFileHeader header;
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+    header.version = MESH_FILE_VERSION;
+    header.nrOfVertices = coordinates.size()/3;
+    header.nrOfLines = lines.size()/2;
+    header.nrOfTriangles = triangles.size()/3;
+    header.flags = 0;
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)coordinates.data(), coordinates.size()*sizeof(float));
+    file.write((const char*)lines.data(), lines.size()*sizeof(uint32_t));
+    file.write((const char*)triangles.data(), triangles.size()*sizeof(uint32_t));
+}
+
+static void importMesh(std::string filename) {
+    VTKMeshFileImporter::pointer importer = VTKMeshFileImporter::New();
+    importer->setFilename(filename);
+    DataPort::pointer port = importer->getOutputPort();
+    importer->update(0);
+}
+
+TEST_CASE("Import native mesh file with vertex indices out of range throws exception", "[fast][VTKMeshFileImporter]") {
+    const std::string filename = "VTKMeshFileImporterIndexTest.fmesh";
+    const std::vector<float> coordinates = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+
+    writeNativeMeshFile(filename, coordinates, {0, 2}, {0, 1, 2});
+    CHECK_NOTHROW(importMesh(filename));
+
+    writeNativeMeshFile(filename, coordinates, {}, {0, 1, 3});
+    CHECK_THROWS(importMesh(filename));
+
+    writeNativeMeshFile(filename, coordinates, {0, 100}, {0, 1, 2});
+    CHECK_THROWS(importMesh(filename));
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Import VTK file with vertex indices out of range throws exception", "[fast][VTKMeshFileImporter]") {
+    const std::string filename = "VTKMeshFileImporterIndexTest.vtk";
+    {
+        std::ofstream file(filename.c_str());
+        file << "# vtk DataFile Version 3.0\n"
+                "vtk output\n"
+                "ASCII\n"
+                "DATASET POLYDATA\n"
+                "POINTS 3 float\n"
+                "0 0 0 1 0 0 0 1 0\n"
+                "POLYGONS 1 4\n"
+                "3 0 1 -1\n";
+    }
+    CHECK_THROWS(importMesh(filename));
+    std::remove(filename.c_str());
+}
+
 } // end namespace fast
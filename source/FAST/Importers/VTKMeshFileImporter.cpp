@@ -1,202 +1,586 @@
 #include "FAST/Utility.hpp"
-#include <fstream>
 #include "VTKMeshFileImporter.hpp"
+#include "MeshFileFormat.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace fast {
 
-void VTKMeshFileImporter::setFilename(std::string filename) {
-    mFilename = filename;
-    mIsModified = true;
-}
+namespace {
+
+// Read only memory map of an entire file
+class MemoryMappedFile {
+    public:
+        explicit MemoryMappedFile(std::string filename) {
+            mData = nullptr;
+            mSize = 0;
+#ifdef _WIN32
+            mMapping = NULL;
+            mFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if(mFile == INVALID_HANDLE_VALUE)
+                throw FileNotFoundException(filename);
+            LARGE_INTEGER size;
+            GetFileSizeEx(mFile, &size);
+            mSize = size.QuadPart;
+            if(mSize > 0) {
+                mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+                if(mMapping != NULL)
+                    mData = (const char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+                if(mData == nullptr) {
+                    close();
+                    throw Exception("Unable to memory map the file " + filename);
+                }
+            }
+#else
+            mFile = open(filename.c_str(), O_RDONLY);
+            if(mFile == -1)
+                throw FileNotFoundException(filename);
+            struct stat status;
+            fstat(mFile, &status);
+            mSize = status.st_size;
+            if(mSize > 0) {
+                void* data = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+                if(data == MAP_FAILED) {
+                    close();
+                    throw Exception("Unable to memory map the file " + filename);
+                }
+                mData = (const char*)data;
+                // The file is parsed from start to end
+                madvise(data, mSize, MADV_SEQUENTIAL);
+            }
+#endif
+        }
+        ~MemoryMappedFile() {
+            close();
+        }
+        const char* getData() const {
+            return mData;
+        }
+        size_t getSize() const {
+            return mSize;
+        }
+    private:
+        MemoryMappedFile(const MemoryMappedFile&);
+        MemoryMappedFile& operator=(const MemoryMappedFile&);
+        void close() {
+#ifdef _WIN32
+            if(mData != nullptr)
+                UnmapViewOfFile(mData);
+            if(mMapping != NULL)
+                CloseHandle(mMapping);
+            CloseHandle(mFile);
+#else
+            if(mData != nullptr)
+                munmap((void*)mData, mSize);
+            ::close(mFile);
+#endif
+            mData = nullptr;
+        }
 
-VTKMeshFileImporter::VTKMeshFileImporter() {
-    mFilename = "";
-    mIsModified = true;
-    createOutputPort<Mesh>(0);
-    mFunctions["POINTS"] = std::bind(&VTKMeshFileImporter::processPoints, this, std::placeholders::_1, std::placeholders::_2);
-    mFunctions["NORMALS"] = std::bind(&VTKMeshFileImporter::processNormals, this, std::placeholders::_1, std::placeholders::_2);
-    mFunctions["LINES"] = std::bind(&VTKMeshFileImporter::processLines, this, std::placeholders::_1, std::placeholders::_2);
-    mFunctions["POLYGONS"] = std::bind(&VTKMeshFileImporter::processTriangles, this, std::placeholders::_1, std::placeholders::_2);
-    mFunctions["VECTORS"] = std::bind(&VTKMeshFileImporter::processVectors, this, std::placeholders::_1, std::placeholders::_2);
+        const char* mData;
+        size_t mSize;
+#ifdef _WIN32
+        HANDLE mFile;
+        HANDLE mMapping;
+#else
+        int mFile;
+#endif
+};
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
 }
 
-void VTKMeshFileImporter::processLines(std::ifstream& file, std::string& line) {
-    while(getline(file, line)) {
-        trim(line);
-        if(line.size() == 0)
-            break;
+// Parse a number which doesn't fit the fast path below (e.g. nan or inf) using the C library
+bool parseValueSlow(const char* begin, const char* end, double& value) {
+    char buffer[64];
+    const size_t length = end - begin;
+    if(length >= sizeof(buffer))
+        return false;
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    char* parsedEnd;
+    value = std::strtod(buffer, &parsedEnd);
+    return parsedEnd == buffer + length;
+}
 
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
+bool parseValue(const char* begin, const char* end, float& value) {
+    static const double powersOf10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = begin;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    // Accumulate up to 19 significant digits in an integer, and keep track of the decimal exponent
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    while(p < end && *p >= '0' && *p <= '9') {
+        if(digits < 19) {
+            mantissa = mantissa*10 + (*p - '0');
+            if(mantissa > 0)
+                ++digits;
+        } else {
+            ++exponent;
         }
-
-        std::vector<std::string> tokens = split(line);
-        if(tokens.size() != 3) {
-            throw Exception("Error while reading lines in VTKMeshFileImporter. Check format.");
+        hasDigits = true;
+        ++p;
+    }
+    if(p < end && *p == '.') {
+        ++p;
+        while(p < end && *p >= '0' && *p <= '9') {
+            if(digits < 19) {
+                mantissa = mantissa*10 + (*p - '0');
+                if(mantissa > 0)
+                    ++digits;
+                --exponent;
+            }
+            hasDigits = true;
+            ++p;
         }
+    }
+    if(hasDigits && p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        int explicitExponent = 0;
+        bool hasExponentDigits = false;
+        while(p < end && *p >= '0' && *p <= '9') {
+            explicitExponent = std::min(explicitExponent*10 + (*p - '0'), 10000);
+            hasExponentDigits = true;
+            ++p;
+        }
+        if(!hasExponentDigits)
+            hasDigits = false;
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if(!hasDigits || p != end) {
+        double slowValue;
+        if(!parseValueSlow(begin, end, slowValue))
+            return false;
+        value = (float)slowValue;
+        return true;
+    }
 
-        MeshLine line(std::stoi(tokens[1]), std::stoi(tokens[2]));
-
-        mLines.push_back(line);
+    double result = (double)mantissa;
+    if(exponent < 0) {
+        result = -exponent <= 22 ? result / powersOf10[-exponent] : result * std::pow(10.0, exponent);
+    } else if(exponent > 0) {
+        result = exponent <= 22 ? result * powersOf10[exponent] : result * std::pow(10.0, exponent);
     }
+    value = (float)(negative ? -result : result);
+    return true;
 }
 
-void VTKMeshFileImporter::processTriangles(std::ifstream& file, std::string& line) {
-    while(getline(file, line)) {
-        trim(line);
-        if(line.size() == 0)
-            break;
+bool parseValue(const char* begin, const char* end, int& value) {
+    const char* p = begin;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if(p == end)
+        return false;
+    long long result = 0;
+    while(p < end && *p >= '0' && *p <= '9') {
+        result = result*10 + (*p - '0');
+        ++p;
+    }
+    value = (int)(negative ? -result : result);
+    return p == end;
+}
 
-        if(!isdigit(line[0])) {
-            // Has reached end
-            break;
-        }
+// Returns the start of the first line in [position, end) which doesn't start with a number
+const char* findEndOfNumbers(const char* position, const char* end) {
+    while(position < end) {
+        const char* lineStart = position;
+        while(lineStart < end && (*lineStart == ' ' || *lineStart == '\t' || *lineStart == '\r'))
+            ++lineStart;
+        if(lineStart < end && *lineStart != '\n' &&
+                !(std::isdigit(*lineStart) || *lineStart == '-' || *lineStart == '+' || *lineStart == '.'))
+            return position;
+        const char* newline = (const char*)std::memchr(lineStart, '\n', end - lineStart);
+        if(newline == nullptr)
+            return end;
+        position = newline + 1;
+    }
+    return end;
+}
 
-        std::vector<std::string> tokens = split(line);
+/**
+ * Parse all whitespace separated numbers in [begin, end).
+ * The text is split in chunks at whitespace, and the chunks are parsed in parallel: first the tokens in each chunk
+ * are counted to find where the values of each chunk start in the output, then the values are parsed.
+ */
+template <class T>
+std::vector<T> parseNumbers(const char* begin, const char* end) {
+    const size_t chunkSize = 1 << 20;
+    const int nrOfChunks = std::max<size_t>(1, (end - begin) / chunkSize);
+    std::vector<const char*> boundaries(nrOfChunks + 1);
+    boundaries[0] = begin;
+    boundaries[nrOfChunks] = end;
+    for(int i = 1; i < nrOfChunks; ++i) {
+        const char* boundary = begin + i*chunkSize;
+        while(boundary < end && !isWhitespace(*boundary))
+            ++boundary;
+        boundaries[i] = std::max(boundary, boundaries[i-1]);
+    }
 
-        if(std::stoi(tokens[0]) != 3) {
-            throw Exception(
-                    "The VTKMeshFileImporter currently only supports reading files with triangles. Encountered a non-triangle. Aborting.");
+    std::vector<size_t> offsets(nrOfChunks + 1, 0);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfChunks; ++i) {
+        size_t count = 0;
+        const char* p = boundaries[i];
+        while(p < boundaries[i+1]) {
+            while(p < boundaries[i+1] && isWhitespace(*p))
+                ++p;
+            if(p == boundaries[i+1])
+                break;
+            ++count;
+            while(p < boundaries[i+1] && !isWhitespace(*p))
+                ++p;
         }
-        if(tokens.size() != 4) {
-            throw Exception("Error while reading triangles in VTKMeshFileImporter. Check format.");
+        offsets[i+1] = count;
+    }
+    for(int i = 0; i < nrOfChunks; ++i)
+        offsets[i+1] += offsets[i];
+
+    std::vector<T> values(offsets[nrOfChunks]);
+    bool valid = true;
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfChunks; ++i) {
+        size_t index = offsets[i];
+        const char* p = boundaries[i];
+        while(p < boundaries[i+1]) {
+            while(p < boundaries[i+1] && isWhitespace(*p))
+                ++p;
+            if(p == boundaries[i+1])
+                break;
+            const char* tokenStart = p;
+            while(p < boundaries[i+1] && !isWhitespace(*p))
+                ++p;
+            if(!parseValue(tokenStart, p, values[index]))
+                valid = false;
+            ++index;
         }
+    }
+    if(!valid)
+        throw Exception("Invalid number encountered in VTK file");
 
-        MeshTriangle triangle(
-                std::stoi(tokens[1]),
-                std::stoi(tokens[2]),
-                std::stoi(tokens[3])
-        );
+    return values;
+}
 
-        mTriangles.push_back(triangle);
-    }
+} // end anonymous namespace
+
+static std::string readLine(const char*& position, const char* end) {
+    const char* newline = (const char*)std::memchr(position, '\n', end - position);
+    if(newline == nullptr)
+        newline = end;
+    std::string line(position, newline);
+    position = newline == end ? end : newline + 1;
+    trim(line);
+    return line;
 }
 
-void VTKMeshFileImporter::processNormals(std::ifstream& file, std::string& line) {
-    std::vector<std::string> tokens = split(line);
-    //if(std::stoi(tokens.at(1)) != mVertices.size()) {
-    //    throw Exception("Number of normals must be equal to number of points", __LINE__, __FILE__);
-    //}
-    uint counter = 0;
-    while(getline(file, line)) {
-        trim(line);
-        if(line.size() == 0)
-            break;
+/**
+ * Read count values of a VTK data block at the cursor. In ASCII files the block ends at the first line which
+ * doesn't start with a number, in binary files it is count big endian values of the given type.
+ */
+template <class T>
+static std::vector<T> readValues(const char*& position, const char* end, bool binary, size_t count, std::string type) {
+    if(!binary) {
+        const char* blockEnd = findEndOfNumbers(position, end);
+        std::vector<T> values = parseNumbers<T>(position, blockEnd);
+        position = blockEnd;
+        if(values.size() < count)
+            throw Exception("Expected " + std::to_string(count) + " values in VTK file, but found only " + std::to_string(values.size()));
+        values.resize(count);
+        return values;
+    }
 
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    size_t valueSize;
+    if(type == "float" || type == "int" || type == "unsigned_int") {
+        valueSize = 4;
+    } else if(type == "double" || type == "vtkidtype" || type == "long" || type == "unsigned_long") {
+        valueSize = 8;
+    } else {
+        throw Exception("Unsupported data type " + type + " in binary VTK file");
+    }
+    if((size_t)(end - position) < count*valueSize)
+        throw Exception("Unexpected end of binary VTK file");
+
+    std::vector<char> bytes(position, position + count*valueSize);
+    position += count*valueSize;
+    // Binary legacy VTK files are big endian
+    if(isLittleEndianHost())
+        swapByteOrder(bytes.data(), count, valueSize);
+    std::vector<T> values(count);
+    for(size_t i = 0; i < count; ++i) {
+        const char* value = &bytes[i*valueSize];
+        if(type == "float") {
+            float v;
+            std::memcpy(&v, value, 4);
+            values[i] = (T)v;
+        } else if(type == "double") {
+            double v;
+            std::memcpy(&v, value, 8);
+            values[i] = (T)v;
+        } else if(valueSize == 4) {
+            int32_t v;
+            std::memcpy(&v, value, 4);
+            values[i] = (T)v;
+        } else {
+            int64_t v;
+            std::memcpy(&v, value, 8);
+            values[i] = (T)v;
         }
+    }
+    return values;
+}
+
+void VTKMeshFileImporter::setFilename(std::string filename) {
+    mFilename = filename;
+    mIsModified = true;
+}
+
+VTKMeshFileImporter::VTKMeshFileImporter() {
+    mFilename = "";
+    mIsModified = true;
+    createOutputPort<Mesh>(0);
+    mFunctions["POINTS"] = std::bind(&VTKMeshFileImporter::processPoints, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["NORMALS"] = std::bind(&VTKMeshFileImporter::processNormals, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["LINES"] = std::bind(&VTKMeshFileImporter::processLines, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["POLYGONS"] = std::bind(&VTKMeshFileImporter::processTriangles, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["VECTORS"] = std::bind(&VTKMeshFileImporter::processVectors, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["SCALARS"] = std::bind(&VTKMeshFileImporter::processScalars, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["POINT_DATA"] = std::bind(&VTKMeshFileImporter::processPointData, this, std::placeholders::_1, std::placeholders::_2);
+    mFunctions["CELL_DATA"] = std::bind(&VTKMeshFileImporter::processCellData, this, std::placeholders::_1, std::placeholders::_2);
+}
 
-        std::vector<std::string> tokens = split(line);
+void VTKMeshFileImporter::processPoints(Cursor& cursor, const Header& header) {
+    if(header.size() < 3)
+        throw Exception("Error while reading points in VTKMeshFileImporter. Check format.");
+    const size_t nrOfPoints = std::stoul(header[1]);
+    mCoordinates = readValues<float>(cursor.position, cursor.end, cursor.binary, nrOfPoints*3, header[2]);
+}
 
-        for(int i = 0; i < tokens.size(); i += 3) {
-            Vector3f v;
-            v(0) = std::stof(tokens[i]);
-            v(1) = std::stof(tokens[i+1]);
-            v(2) = std::stof(tokens[i+2]);
-            mVertices.at(counter).setNormal(v);
-            ++counter;
+// Connectivity of cells is stored as the number of points followed by the point indices, for each cell
+void VTKMeshFileImporter::processLines(Cursor& cursor, const Header& header) {
+    if(header.size() < 3)
+        throw Exception("Error while reading lines in VTKMeshFileImporter. Check format.");
+    const size_t size = std::stoul(header[2]);
+    std::vector<int> cells = readValues<int>(cursor.position, cursor.end, cursor.binary, size, "int");
+    size_t i = 0;
+    while(i < cells.size()) {
+        const int nrOfPoints = cells[i];
+        if(nrOfPoints < 2 || i + nrOfPoints >= cells.size())
+            throw Exception("Error while reading lines in VTKMeshFileImporter. Check format.");
+        // Poly lines are split into line segments
+        for(int j = 1; j < nrOfPoints; ++j) {
+            mLines.push_back(cells[i + j]);
+            mLines.push_back(cells[i + j + 1]);
         }
+        i += nrOfPoints + 1;
     }
 }
 
-void VTKMeshFileImporter::processVectors(std::ifstream& file, std::string& line) {
-    std::vector<std::string> tokens = split(line);
-    std::string name = tokens[1];
-    if(name != "vertex_colors") {
-        reportWarning() << "Unknown VECTORS data with name " << name << " in file " << mFilename << reportEnd();
+void VTKMeshFileImporter::processTriangles(Cursor& cursor, const Header& header) {
+    if(header.size() < 3)
+        throw Exception("Error while reading triangles in VTKMeshFileImporter. Check format.");
+    const size_t nrOfPolygons = std::stoul(header[1]);
+    const size_t size = std::stoul(header[2]);
+    if(size != nrOfPolygons*4) {
+        throw Exception(
+                "The VTKMeshFileImporter currently only supports reading files with triangles. Encountered a non-triangle. Aborting.");
     }
-    //if(std::stoi(tokens.at(1)) != mVertices.size()) {
-    //    throw Exception("Number of normals must be equal to number of points", __LINE__, __FILE__);
-    //}
-    uint counter = 0;
-    while(getline(file, line)) {
-        trim(line);
-        if(line.size() == 0)
-            break;
-
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
-        }
+    std::vector<int> cells = readValues<int>(cursor.position, cursor.end, cursor.binary, size, "int");
+    mTriangles.resize(nrOfPolygons*3);
+    bool onlyTriangles = true;
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfPolygons; ++i) {
+        if(cells[i*4] != 3)
+            onlyTriangles = false;
+        mTriangles[i*3] = cells[i*4 + 1];
+        mTriangles[i*3 + 1] = cells[i*4 + 2];
+        mTriangles[i*3 + 2] = cells[i*4 + 3];
+    }
+    if(!onlyTriangles) {
+        throw Exception(
+                "The VTKMeshFileImporter currently only supports reading files with triangles. Encountered a non-triangle. Aborting.");
+    }
+}
 
-        if(name == "vertex_colors") {
-            std::vector<std::string> tokens = split(line);
-            for(int i = 0; i < tokens.size(); i += 3) {
-                float red = std::stof(tokens[i]);
-                float green = std::stof(tokens[i + 1]);
-                float blue = std::stof(tokens[i + 2]);
-                mVertices.at(counter).setColor(Color(red, green, blue));
-                ++counter;
-            }
-        }
+void VTKMeshFileImporter::processNormals(Cursor& cursor, const Header& header) {
+    if(header.size() < 3)
+        throw Exception("Error while reading normals in VTKMeshFileImporter. Check format.");
+    std::vector<float> normals = readValues<float>(cursor.position, cursor.end, cursor.binary, mAttributeCount*3, header[2]);
+    if(!mCellData)
+        mNormals = std::move(normals);
+}
+
+void VTKMeshFileImporter::processVectors(Cursor& cursor, const Header& header) {
+    if(header.size() < 3)
+        throw Exception("Error while reading vectors in VTKMeshFileImporter. Check format.");
+    std::string name = header[1];
+    std::vector<float> vectors = readValues<float>(cursor.position, cursor.end, cursor.binary, mAttributeCount*3, header[2]);
+    if(name == "vertex_colors" && !mCellData) {
+        mColors = std::move(vectors);
+    } else {
+        reportWarning() << "Unknown VECTORS data with name " << name << " in file " << mFilename << reportEnd();
     }
 }
 
-void VTKMeshFileImporter::processPoints(std::ifstream& file, std::string& line) {
-    while(getline(file, line)) {
-        trim(line);
-        if(line.size() == 0)
-            break;
+void VTKMeshFileImporter::processScalars(Cursor& cursor, const Header& header) {
+    // Scalars are not used, but they have to be skipped in binary files
+    if(header.size() < 3)
+        throw Exception("Error while reading scalars in VTKMeshFileImporter. Check format.");
+    const size_t nrOfComponents = header.size() > 3 ? std::stoul(header[3]) : 1;
+    std::string lookupTable = readLine(cursor.position, cursor.end);
+    if(lookupTable.substr(0, 12) != "LOOKUP_TABLE")
+        throw Exception("Expected LOOKUP_TABLE after SCALARS in VTK file");
+    readValues<float>(cursor.position, cursor.end, cursor.binary, mAttributeCount*nrOfComponents, header[2]);
+}
 
-        if(!(isdigit(line[0]) || line[0] == '-')) {
-            // Has reached end
-            break;
-        }
+void VTKMeshFileImporter::processPointData(Cursor& cursor, const Header& header) {
+    mAttributeCount = header.size() > 1 ? std::stoul(header[1]) : mCoordinates.size() / 3;
+    mCellData = false;
+}
 
-        std::vector<std::string> tokens = split(line);
+void VTKMeshFileImporter::processCellData(Cursor& cursor, const Header& header) {
+    mAttributeCount = header.size() > 1 ? std::stoul(header[1]) : 0;
+    mCellData = true;
+}
 
-        for(int i = 0; i < tokens.size(); i += 3) {
-            Vector3f v;
-            v(0) = std::stof(tokens[i]);
-            v(1) = std::stof(tokens[i+1]);
-            v(2) = std::stof(tokens[i+2]);
-            mVertices.push_back(MeshVertex(v));
-        }
+void VTKMeshFileImporter::readNativeFormat(const char* data, size_t size) {
+    NativeMeshFileHeader header;
+    if(size < sizeof(header))
+        throw Exception("Unexpected end of mesh file " + mFilename);
+    std::memcpy(&header, data, sizeof(header));
+    const bool swap = !isLittleEndianHost();
+    if(swap)
+        swapByteOrder(&header.version, 5, sizeof(uint32_t));
+    if(header.version != MESH_FILE_VERSION)
+        throw Exception("Unsupported version " + std::to_string(header.version) + " of mesh file " + mFilename);
+
+    const bool hasNormals = (header.flags & MESH_FILE_HAS_NORMALS) != 0;
+    const bool hasColors = (header.flags & MESH_FILE_HAS_COLORS) != 0;
+    const size_t vertexArraySize = (size_t)header.nrOfVertices*3;
+    const size_t expectedSize = sizeof(header) + sizeof(float)*vertexArraySize*(1 + hasNormals + hasColors) +
+            sizeof(uint32_t)*((size_t)header.nrOfLines*2 + (size_t)header.nrOfTriangles*3);
+    if(size < expectedSize)
+        throw Exception("Unexpected end of mesh file " + mFilename);
+
+    // The arrays are stored back to back, and are copied from the mapped file in one go
+    const char* position = data + sizeof(header);
+    auto readArray = [&position, swap](void* destination, size_t bytes) {
+        std::memcpy(destination, position, bytes);
+        if(swap)
+            swapByteOrder(destination, bytes / 4, 4);
+        position += bytes;
+    };
+    mCoordinates.resize(vertexArraySize);
+    readArray(mCoordinates.data(), sizeof(float)*vertexArraySize);
+    if(hasNormals) {
+        mNormals.resize(vertexArraySize);
+        readArray(mNormals.data(), sizeof(float)*vertexArraySize);
+    }
+    if(hasColors) {
+        mColors.resize(vertexArraySize);
+        readArray(mColors.data(), sizeof(float)*vertexArraySize);
     }
+    mLines.resize((size_t)header.nrOfLines*2);
+    readArray(mLines.data(), sizeof(uint32_t)*mLines.size());
+    mTriangles.resize((size_t)header.nrOfTriangles*3);
+    readArray(mTriangles.data(), sizeof(uint32_t)*mTriangles.size());
 }
 
 void VTKMeshFileImporter::execute() {
-    getReporter().setReportMethod(Reporter::COUT);
     if(mFilename == "")
         throw Exception("No filename given to the VTKMeshFileImporter");
 
-    // Try to open file and check that it exists
-    std::ifstream file(mFilename.c_str());
-    std::string line;
-    if(!file.is_open()) {
-        throw FileNotFoundException(mFilename);
-    }
+    // Map the file into memory and check that it exists
+    MemoryMappedFile file(mFilename);
     Mesh::pointer output = getOutputData<Mesh>(0);
-
-    getline(file, line);
-    while(!file.eof()) {
-        trim(line);
-        if(line.size() == 0 || line[0] == '#') {
-            // Skip empty lines and comments
-            getline(file, line);
-            continue;
+    mCoordinates.clear();
+    mNormals.clear();
+    mColors.clear();
+    mLines.clear();
+    mTriangles.clear();
+    mAttributeCount = 0;
+    mCellData = false;
+
+    if(file.getSize() >= sizeof(MESH_FILE_MAGIC) && std::memcmp(file.getData(), MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) == 0) {
+        readNativeFormat(file.getData(), file.getSize());
+    } else {
+        Cursor cursor;
+        cursor.position = file.getData();
+        cursor.end = file.getData() + file.getSize();
+        cursor.binary = false;
+
+        // Header: version line, title and file format
+        readLine(cursor.position, cursor.end);
+        readLine(cursor.position, cursor.end);
+        std::string format = readLine(cursor.position, cursor.end);
+        if(format == "BINARY") {
+            cursor.binary = true;
+        } else if(format != "ASCII") {
+            throw Exception("Unknown format " + format + " in VTK file " + mFilename);
         }
-        std::string key = line.substr(0, line.find(" "));
-        if(mFunctions.count(key) > 0) {
-            mFunctions[key](file, line);
-        } else {
-            // Line not recognized, ignore..
-            getline(file, line);
+
+        while(cursor.position < cursor.end) {
+            std::string line = readLine(cursor.position, cursor.end);
+            if(line.size() == 0 || line[0] == '#') {
+                // Skip empty lines and comments
+                continue;
+            }
+            Header header = split(line);
+            if(mFunctions.count(header[0]) > 0) {
+                mFunctions[header[0]](cursor, header);
+            } else if(cursor.binary && !(header[0] == "DATASET" || header[0] == "VERTICES")) {
+                // Unknown data in binary files can't be skipped line by line
+                throw Exception("Unsupported section " + header[0] + " in binary VTK file " + mFilename);
+            }
+            // Other lines are not recognized, ignore..
         }
     }
 
-    if(mVertices.size() == 0) {
+    if(mCoordinates.size() == 0) {
         throw Exception("No points found in file " + mFilename);
     }
 
-    output->create(mVertices, mLines, mTriangles);
-    reportInfo() << "MESH IMPORTED: vertices " << mVertices.size() << " lines " << mLines.size() << " triangles " << mTriangles.size() << Reporter::end();
+    // The indices are used directly by the mesh accesses and renderers, thus they must refer to existing vertices
+    const size_t nrOfVertices = mCoordinates.size()/3;
+    for(uint index : mLines) {
+        if(index >= nrOfVertices)
+            throw Exception("Line with vertex index " + std::to_string(index) + " out of range in file " + mFilename);
+    }
+    for(uint index : mTriangles) {
+        if(index >= nrOfVertices)
+            throw Exception("Triangle with vertex index " + std::to_string(index) + " out of range in file " + mFilename);
+    }
+
+    reportInfo() << "MESH IMPORTED: vertices " << mCoordinates.size()/3 << " lines " << mLines.size()/2 << " triangles " << mTriangles.size()/3 << Reporter::end();
+    output->create(std::move(mCoordinates), std::move(mNormals), std::move(mColors), std::move(mLines), std::move(mTriangles));
 }
 
 } // end namespace fast
-
-
@@ -4,10 +4,18 @@
 #include "Importer.hpp"
 #include <string>
 #include <map>
-#include <FAST/Data/MeshVertex.hpp>
+#include <vector>
+#include <functional>
 
 namespace fast {
 
+/**
+ * Reads meshes (points, lines, triangles, normals and vertex colors) from files.
+ *
+ * Supports legacy VTK polydata files in both ASCII and (big endian) BINARY format, and the native FAST mesh
+ * format (.fmesh) written by VTKMeshFileExporter. The file is memory mapped, and ASCII numbers are parsed
+ * in parallel.
+ */
 class FAST_EXPORT  VTKMeshFileImporter : public Importer {
     FAST_OBJECT(VTKMeshFileImporter)
     public:
@@ -16,17 +24,35 @@ class FAST_EXPORT  VTKMeshFileImporter : public Importer {
         VTKMeshFileImporter();
         void execute();
 
-        void processPoints(std::ifstream& file, std::string& line);
-        void processLines(std::ifstream& file, std::string& line);
-        void processTriangles(std::ifstream& file, std::string& line);
-        void processNormals(std::ifstream& file, std::string& line);
-        void processVectors(std::ifstream& file, std::string& line);
+        // Current position in the file while parsing
+        struct Cursor {
+            const char* position;
+            const char* end;
+            bool binary;
+        };
+        typedef std::vector<std::string> Header;
+
+        void processPoints(Cursor& cursor, const Header& header);
+        void processLines(Cursor& cursor, const Header& header);
+        void processTriangles(Cursor& cursor, const Header& header);
+        void processNormals(Cursor& cursor, const Header& header);
+        void processVectors(Cursor& cursor, const Header& header);
+        void processScalars(Cursor& cursor, const Header& header);
+        void processPointData(Cursor& cursor, const Header& header);
+        void processCellData(Cursor& cursor, const Header& header);
+        void readNativeFormat(const char* data, size_t size);
 
         std::string mFilename;
-        std::vector<MeshVertex> mVertices;
-        std::vector<MeshLine> mLines;
-        std::vector<MeshTriangle> mTriangles;
-        std::map<std::string, std::function<void(std::ifstream&, std::string&)>> mFunctions;
+        // Mesh arrays which are filled while parsing, and then moved to the output mesh
+        std::vector<float> mCoordinates;
+        std::vector<float> mNormals;
+        std::vector<float> mColors;
+        std::vector<uint> mLines;
+        std::vector<uint> mTriangles;
+        // Number of values in the current POINT_DATA or CELL_DATA section, and whether it is cell data
+        size_t mAttributeCount;
+        bool mCellData;
+        std::map<std::string, std::function<void(Cursor&, const Header&)>> mFunctions;
 };
 
 } // end namespace fast
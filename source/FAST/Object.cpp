@@ -16,19 +16,22 @@
 
 namespace fast {
 
-Reporter& Object::reportError() {
-    mReporter.setType(Reporter::ERROR);
-    return mReporter;
+Reporter Object::reportError() {
+    Reporter reporter(mReporter);
+    reporter.setType(Reporter::ERROR);
+    return reporter;
 }
 
-Reporter& Object::reportWarning() {
-    mReporter.setType(Reporter::WARNING);
-    return mReporter;
+Reporter Object::reportWarning() {
+    Reporter reporter(mReporter);
+    reporter.setType(Reporter::WARNING);
+    return reporter;
 }
 
-Reporter& Object::reportInfo() {
-    mReporter.setType(Reporter::INFO);
-    return mReporter;
+Reporter Object::reportInfo() {
+    Reporter reporter(mReporter);
+    reporter.setType(Reporter::INFO);
+    return reporter;
 }
 
 Reporter& Object::getReporter() {
@@ -15,9 +15,13 @@ class FAST_EXPORT  Object {
         Reporter& getReporter();
     protected:
         WeakPointer<Object> mPtr;
-        Reporter& reportError();
-        Reporter& reportWarning();
-        Reporter& reportInfo();
+        /**
+         * Each call returns a new reporter with the report methods of this object, so that several threads can
+         * report messages for the same object at the same time.
+         */
+        Reporter reportError();
+        Reporter reportWarning();
+        Reporter reportInfo();
         ReporterEnd reportEnd() const;
     private:
         Reporter mReporter;
@@ -19,10 +19,20 @@ std::string OpenCLProgram::getSourceFilename() const {
     return mSourceFilename;
 }
 
+void OpenCLProgram::setSourceCode(std::string code) {
+    mSourceCode = code;
+    mSourceFilename = "";
+    mOpenCLPrograms.clear();
+}
+
+std::string OpenCLProgram::getSourceCode() const {
+    return mSourceCode;
+}
+
 cl::Program OpenCLProgram::build(SharedPointer<OpenCLDevice> device,
         std::string buildOptions) {
-    if(mSourceFilename == "")
-        throw Exception("No source filename was given to OpenCLProgram. Therefore build operation is not possible.");
+    if(mSourceFilename == "" && mSourceCode == "")
+        throw Exception("No source filename or code was given to OpenCLProgram. Therefore build operation is not possible.");
 
     // Add fast_3d_image_writes flag if it is supported
     if(device->isWritingTo3DTexturesSupported()) {
@@ -34,16 +44,23 @@ cl::Program OpenCLProgram::build(SharedPointer<OpenCLDevice> device,
     if(buildExists(device, buildOptions))
         return mOpenCLPrograms[device][buildOptions];
 
-    std::string programName = mSourceFilename + buildOptions;
-    // Only create program if it doesn't exist for this device from before
-    if(!device->hasProgram(programName))
-        device->createProgramFromSourceWithName(programName, mSourceFilename, buildOptions);
-    return device->getProgram(programName);
+    // Programs are stored in the device, so that all process objects using the same source file and
+    // build options share one build, also when several pipeline instances are created at the same time
+    cl::Program program;
+    if(mSourceCode != "") {
+        // Generated code is identified by the code itself
+        program = device->getProgramFromStringWithName(mSourceCode + buildOptions, mSourceCode, buildOptions);
+    } else {
+        program = device->getProgramFromSourceWithName(mSourceFilename + buildOptions, mSourceFilename, buildOptions);
+    }
+    mOpenCLPrograms[device][buildOptions] = program;
+    return program;
 }
 
 OpenCLProgram::OpenCLProgram() {
     mName = "";
     mSourceFilename = "";
+    mSourceCode = "";
 }
 
 bool OpenCLProgram::buildExists(SharedPointer<OpenCLDevice> device,
@@ -22,6 +22,13 @@ class FAST_EXPORT  OpenCLProgram : public Object {
         std::string getName() const;
         void setSourceFilename(std::string filename);
         std::string getSourceFilename() const;
+        /**
+         * Set the source code of the program directly, for kernels which are generated at runtime.
+         * Replaces the source filename.
+         * @param code
+         */
+        void setSourceCode(std::string code);
+        std::string getSourceCode() const;
         cl::Program build(SharedPointer<OpenCLDevice>, std::string buildOptions = "");
     protected:
         OpenCLProgram();
@@ -30,6 +37,7 @@ class FAST_EXPORT  OpenCLProgram : public Object {
 
         std::string mName;
         std::string mSourceFilename;
+        std::string mSourceCode;
         std::unordered_map<SharedPointer<OpenCLDevice>, std::map<std::string, cl::Program> > mOpenCLPrograms;
 };
 
@@ -1,13 +1,14 @@
 #include "Pipeline.hpp"
 #include "FAST/Config.hpp"
 #include "ProcessObject.hpp"
-#include <QDirIterator>
 #include <fstream>
-#include <QLabel>
-#include <QVBoxLayout>
-#include <QLineEdit>
-#include <QCheckBox>
+#include "ProcessObjectRegistry.hpp"
 #include "ProcessObjectList.hpp"
+#include "FAST/Algorithms/PointwiseOperatorChain/PointwiseOperatorChain.hpp"
+#ifdef FAST_MODULE_VISUALIZATION
+#include "FAST/Visualization/Renderer.hpp"
+#include <QDirIterator>
+#endif
 
 namespace fast {
 
@@ -82,23 +83,7 @@ void Pipeline::parseProcessObject(
 
         inputFound = true;
 
-
-        if(isRenderer) {
-            SharedPointer<Renderer> renderer = object;
-            // TODO fix text renderer no supprt addInput
-            if(inputID == "PipelineInput") {
-                mInputProcessObjects[objectID] = 0;
-            } else {
-                renderer->addInputConnection(mProcessObjects.at(inputID)->getOutputPort(outputPortID));
-                //renderer->setInputConnection(0, mProcessObjects.at(inputID)->getOutputPort(outputPortID));
-            }
-        } else {
-            if(inputID == "PipelineInput") {
-                mInputProcessObjects[objectID] = inputPortID;
-            } else {
-                object->setInputConnection(inputPortID, mProcessObjects.at(inputID)->getOutputPort(outputPortID));
-            }
-        }
+        mConnections.push_back({objectID, (uint)inputPortID, inputID, (uint)outputPortID});
         std::getline(file, line);
     }
 
@@ -113,7 +98,41 @@ void Pipeline::parseProcessObject(
     }
 }
 
-int Pipeline::parsePipelineFile() {
+void Pipeline::skipRenderer(std::string objectID, std::ifstream& file) {
+    // Skip the attributes of the renderer, but remember its inputs so that it can be replaced by sinks
+    std::vector<std::pair<std::string, uint>> inputs;
+    std::string line = "";
+    std::getline(file, line);
+    while(!file.eof()) {
+        trim(line);
+        if(line == "")
+            break;
+
+        std::vector<std::string> tokens = split(line);
+        if(tokens[0] == "Input") {
+            if(tokens.size() < 3)
+                throw Exception("Expecting at least 3 items on input line when parsing renderer " + objectID + " but got " + line);
+            std::string inputID = tokens[2];
+            if(inputID != "PipelineInput" && mProcessObjects.count(inputID) == 0)
+                throw Exception("Input with id " + inputID + " was not found before " + objectID);
+            uint outputPortID = 0;
+            if(tokens.size() == 4)
+                outputPortID = std::stoi(tokens[3]);
+            inputs.push_back(std::make_pair(inputID, outputPortID));
+        } else if(tokens[0] != "Attribute") {
+            break;
+        }
+        std::getline(file, line);
+    }
+
+    if(inputs.size() == 0)
+        throw Exception("No inputs were found for renderer " + objectID);
+
+    mSkippedRenderers[objectID] = inputs;
+    mSkippedRendererIDs.push_back(objectID);
+}
+
+int Pipeline::parsePipelineFile(bool createRenderers) {
     // Parse file again, retrieve process objects, set attributes and create the pipeline
     std::ifstream file(mFilename);
     std::string line = "";
@@ -122,6 +141,13 @@ int Pipeline::parsePipelineFile() {
     mProcessObjects.clear();
     mInputProcessObjects.clear();
     mRenderers.clear();
+    mConnectedProcessObjects.clear();
+    mSkippedRenderers.clear();
+    mSkippedRendererIDs.clear();
+    mRendererSinks.clear();
+    mConnections.clear();
+    mFusedProcessObjects.clear();
+    mFusedIDs.clear();
 
     // Retrieve all POs and renderers
     while(!file.eof()) {
@@ -149,17 +175,178 @@ int Pipeline::parsePipelineFile() {
             }
             std::string id = tokens[1];
             std::string object = tokens[2];
-            parseProcessObject(object, id, file, true);
+            if(createRenderers) {
+#ifdef FAST_MODULE_VISUALIZATION
+                parseProcessObject(object, id, file, true);
+#else
+                throw Exception("Renderers in the pipeline file " + mFilename + " require the FAST visualization module");
+#endif
+            } else {
+                skipRenderer(id, file);
+            }
         }
 
         std::getline(file, line);
     }
 
-    if(mRenderers.size() == 0)
+    if(createRenderers && mRenderers.size() == 0)
         throw Exception("No renderers were found when parsing pipeline file " + mFilename);
 
+    if(mFusePointwiseOperators)
+        fusePointwiseOperators();
+    connectProcessObjects();
+
     return mInputProcessObjects.size();
 }
+
+void Pipeline::connectProcessObjects() {
+    std::unordered_set<std::string> renderers(mRenderers.begin(), mRenderers.end());
+    for(const Connection& connection : mConnections) {
+        SharedPointer<ProcessObject> object = getExecutedProcessObject(connection.objectID);
+        if(renderers.count(connection.objectID) > 0) {
+#ifdef FAST_MODULE_VISUALIZATION
+            SharedPointer<Renderer> renderer = object;
+            // TODO fix text renderer no supprt addInput
+            if(connection.inputID == "PipelineInput") {
+                mInputProcessObjects[connection.objectID] = 0;
+            } else {
+                renderer->addInputConnection(getExecutedProcessObject(connection.inputID)->getOutputPort(connection.outputPortID));
+            }
+#endif
+        } else {
+            if(connection.inputID == "PipelineInput") {
+                mInputProcessObjects[connection.objectID] = connection.inputPortID;
+            } else {
+                object->setInputConnection(connection.inputPortID, getExecutedProcessObject(connection.inputID)->getOutputPort(connection.outputPortID));
+                mConnectedProcessObjects.insert(connection.inputID);
+            }
+        }
+    }
+}
+
+static PointwiseProcessObject* getPointwiseProcessObject(SharedPointer<ProcessObject> object) {
+    return dynamic_cast<PointwiseProcessObject*>(object.get());
+}
+
+void Pipeline::fusePointwiseOperators() {
+    // Count how many times the output of each process object is used, also by skipped renderers
+    std::unordered_map<std::string, int> consumers;
+    for(const Connection& connection : mConnections)
+        consumers[connection.inputID]++;
+    for(auto renderer : mSkippedRenderers) {
+        for(auto input : renderer.second)
+            consumers[input.first]++;
+    }
+
+    // Input connections of each process object, in the order of the pipeline file
+    std::vector<std::string> objectIDs;
+    std::unordered_map<std::string, std::unordered_map<uint, Connection>> inputs;
+    for(const Connection& connection : mConnections) {
+        if(inputs.count(connection.objectID) == 0)
+            objectIDs.push_back(connection.objectID);
+        inputs[connection.objectID][connection.inputPortID] = connection;
+    }
+
+    // Grow chains in file order. A process object is added to the chain of its input if the input is the last
+    // process object of that chain and nothing else uses its output.
+    std::unordered_set<std::string> renderers(mRenderers.begin(), mRenderers.end());
+    std::vector<std::vector<std::string>> chains;
+    std::vector<std::vector<PointwiseOperator>> chainOperators;
+    std::vector<bool> chainUsesPipelineInput;
+    std::unordered_map<std::string, int> chainOfObject;
+    for(const std::string& objectID : objectIDs) {
+        SharedPointer<ProcessObject> object = mProcessObjects.at(objectID);
+        PointwiseProcessObject* pointwiseObject = getPointwiseProcessObject(object);
+        if(renderers.count(objectID) > 0 || pointwiseObject == nullptr || inputs[objectID].count(0) == 0)
+            continue;
+        PointwiseOperator op;
+        try {
+            op = pointwiseObject->getPointwiseOperator();
+        } catch(Exception &e) {
+            // Not configured correctly, leave the error to when the process object is executed
+            continue;
+        }
+        const Connection& input = inputs[objectID].at(0);
+        bool operandIsPipelineInput = op.hasOperand && inputs[objectID].count(1) > 0 && inputs[objectID].at(1).inputID == "PipelineInput";
+
+        if(chainOfObject.count(input.inputID) > 0) {
+            const int chainNr = chainOfObject.at(input.inputID);
+            // A pipeline input can only be connected to one input port of each process object
+            if(chains[chainNr].back() == input.inputID && consumers[input.inputID] == 1 && input.outputPortID == 0 &&
+                    PointwiseOperatorChain::canAppend(chainOperators[chainNr], op) &&
+                    !(operandIsPipelineInput && chainUsesPipelineInput[chainNr])) {
+                chains[chainNr].push_back(objectID);
+                chainOperators[chainNr].push_back(op);
+                chainUsesPipelineInput[chainNr] = chainUsesPipelineInput[chainNr] || operandIsPipelineInput;
+                chainOfObject[objectID] = chainNr;
+                continue;
+            }
+        }
+        // Start a new chain
+        if(operandIsPipelineInput && input.inputID == "PipelineInput")
+            continue;
+        chainOfObject[objectID] = chains.size();
+        chains.push_back({objectID});
+        chainOperators.push_back({op});
+        chainUsesPipelineInput.push_back(input.inputID == "PipelineInput" || operandIsPipelineInput);
+    }
+
+    for(const std::vector<std::string>& chain : chains) {
+        if(chain.size() < 2)
+            continue;
+
+        PointwiseOperatorChain::pointer fused = PointwiseOperatorChain::New();
+        std::unordered_set<std::string> fusedIDs(chain.begin(), chain.end());
+        std::vector<Connection> fusedConnections;
+        for(int i = 0; i < chain.size(); ++i) {
+            fused->addProcessObject(mProcessObjects.at(chain[i]));
+            if(i == 0) {
+                Connection input = inputs[chain[i]].at(0);
+                input.objectID = chain.back();
+                fusedConnections.push_back(input);
+            }
+            if(inputs[chain[i]].count(1) > 0 && getPointwiseProcessObject(mProcessObjects.at(chain[i]))->getPointwiseOperator().hasOperand) {
+                Connection operand = inputs[chain[i]].at(1);
+                operand.objectID = chain.back();
+                operand.inputPortID = fused->getOperandInputPort(i);
+                fusedConnections.push_back(operand);
+            }
+        }
+        fused->setMainDevice(mProcessObjects.at(chain.back())->getMainDevice());
+
+        // Replace the connections of the process objects in the chain with the connections of the fused chain
+        std::vector<Connection> connections;
+        for(const Connection& connection : mConnections) {
+            if(fusedIDs.count(connection.objectID) > 0) {
+                connections.insert(connections.end(), fusedConnections.begin(), fusedConnections.end());
+                fusedConnections.clear();
+            } else {
+                connections.push_back(connection);
+            }
+        }
+        mConnections = connections;
+
+        // The chain gets the ID of its last process object, so that the rest of the pipeline uses its output.
+        // The original process objects are kept, so that their attributes can still be changed.
+        mFusedIDs.insert(chain.begin(), chain.end());
+        mFusedProcessObjects[chain.back()] = fused;
+        Reporter::info() << "Fused " << chain.size() << " pointwise process objects ending with " << chain.back() << " in pipeline " << mFilename << Reporter::end();
+    }
+}
+
+void Pipeline::setFusePointwiseOperators(bool fuse) {
+    mFusePointwiseOperators = fuse;
+}
+
+std::unordered_map<std::string, SharedPointer<ProcessObject>> Pipeline::getFusedProcessObjects() const {
+    return mFusedProcessObjects;
+}
+
+SharedPointer<ProcessObject> Pipeline::getExecutedProcessObject(std::string objectID) {
+    if(mFusedProcessObjects.count(objectID) > 0)
+        return mFusedProcessObjects.at(objectID);
+    return mProcessObjects.at(objectID);
+}
 std::vector<SharedPointer<Renderer>> Pipeline::setup(std::vector<DataPort::pointer> inputPorts) {
     Reporter::info() << "Setting up pipeline.." << Reporter::end();
     if(mProcessObjects.size() == 0)
@@ -172,21 +359,70 @@ std::vector<SharedPointer<Renderer>> Pipeline::setup(std::vector<DataPort::point
     // Set input process object port to all needed
     int counter = 0;
     for(std::pair<std::string, uint> inputPort : mInputProcessObjects) {
-        mProcessObjects[inputPort.first]->setInputConnection(inputPort.second, inputPorts[counter]);
+        getExecutedProcessObject(inputPort.first)->setInputConnection(inputPort.second, inputPorts[counter]);
         counter++;
     }
 
     // Get renderers
     std::vector<SharedPointer<Renderer>> renderers;
+#ifdef FAST_MODULE_VISUALIZATION
     for(auto renderer : mRenderers) {
         renderers.push_back(mProcessObjects[renderer]);
     }
+#endif
 
     Reporter::info() << "Finished setting up pipeline." << Reporter::end();
 
     return renderers;
 }
 
+std::vector<SharedPointer<ProcessObject>> Pipeline::getSinks() {
+    std::unordered_set<std::string> renderers(mRenderers.begin(), mRenderers.end());
+    std::vector<SharedPointer<ProcessObject>> sinks;
+    for(auto object : mProcessObjects) {
+        if(renderers.count(object.first) > 0 || mConnectedProcessObjects.count(object.first) > 0)
+            continue;
+        // Fused process objects are executed by their chain
+        if(mFusedProcessObjects.count(object.first) > 0) {
+            sinks.push_back(mFusedProcessObjects.at(object.first));
+        } else if(mFusedIDs.count(object.first) == 0) {
+            sinks.push_back(object.second);
+        }
+    }
+    for(auto rendererSinks : mRendererSinks)
+        sinks.insert(sinks.end(), rendererSinks.second.begin(), rendererSinks.second.end());
+    return sinks;
+}
+
+std::vector<std::string> Pipeline::getSkippedRenderers() const {
+    return mSkippedRendererIDs;
+}
+
+std::vector<SharedPointer<ProcessObject>> Pipeline::replaceRenderer(
+        std::string rendererID,
+        std::function<SharedPointer<ProcessObject>(uint inputNr)> createSink
+    ) {
+    if(mSkippedRenderers.count(rendererID) == 0)
+        throw Exception("No skipped renderer with the id " + rendererID + " in pipeline " + mFilename);
+
+    // Remove the previous sinks first, so that their data ports are released
+    mRendererSinks.erase(rendererID);
+    std::vector<SharedPointer<ProcessObject>> sinks;
+    const std::vector<std::pair<std::string, uint>>& inputs = mSkippedRenderers.at(rendererID);
+    for(uint inputNr = 0; inputNr < inputs.size(); ++inputNr) {
+        const std::string inputID = inputs[inputNr].first;
+        if(inputID == "PipelineInput")
+            throw Exception("Renderer " + rendererID + " uses the pipeline input directly, and can't be replaced by a sink");
+        SharedPointer<ProcessObject> sink = createSink(inputNr);
+        sink->setInputConnection(0, getExecutedProcessObject(inputID)->getOutputPort(inputs[inputNr].second));
+        mConnectedProcessObjects.insert(inputID);
+        sinks.push_back(sink);
+    }
+    mRendererSinks[rendererID] = sinks;
+
+    return sinks;
+}
+
 std::string Pipeline::getName() const {
     return mName;
 }
@@ -199,6 +435,7 @@ std::string Pipeline::getFilename() const {
     return mFilename;
 }
 
+#ifdef FAST_MODULE_VISUALIZATION
 std::vector<Pipeline> getAvailablePipelines() {
     std::vector<Pipeline> pipelines;
     std::string path = Config::getPipelinePath();
@@ -244,6 +481,7 @@ std::vector<Pipeline> getAvailablePipelines() {
     }
     return pipelines;
 }
+#endif
 
 std::unordered_map<std::string, SharedPointer<ProcessObject>> Pipeline::getProcessObjects() {
     if(mProcessObjects.size() == 0)
@@ -252,69 +490,4 @@ std::unordered_map<std::string, SharedPointer<ProcessObject>> Pipeline::getProce
     return mProcessObjects;
 }
 
-
-PipelineWidget::PipelineWidget(Pipeline pipeline, QWidget* parent) : QToolBox(parent) {
-    auto processObjects = pipeline.getProcessObjects();
-    for(auto object : processObjects) {
-        ProcessObjectWidget* widget = new ProcessObjectWidget(object.second, this);
-        addItem(widget, (object.first + " - " + object.second->getNameOfClass()).c_str());
-    }
-    setCurrentIndex(processObjects.size()-1);
-
-    setStyleSheet(
-            "QToolBox::tab {\n"
-            "    background: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1,\n"
-            "                                stop: 0 #689fb6, stop: 1.0 #6d93a7);\n"
-            "    border: 1px solid #004d5b;\n"
-            "    border-radius: 2px;\n"
-            "    color: white;\n"
-            "}\n"
-            "\n"
-            "QToolBox::tab:selected { \n"
-            "    background: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1,\n"
-            "                                stop: 0 #2e8eb6, stop: 1.0 #4084a7);\n"
-            "}"
-    );
 }
-
-ProcessObjectWidget::ProcessObjectWidget(SharedPointer<ProcessObject> po, QWidget *parent) : QWidget(parent) {
-    QVBoxLayout* layout = new QVBoxLayout(this);
-    auto attributes = po->getAttributes();
-    for(auto attr : attributes) {
-        std::string id = attr.first;
-        std::shared_ptr<Attribute> attribute = attr.second;
-
-        QLabel* label = new QLabel(this);
-        label->setText(attribute->getName().c_str());
-        layout->addWidget(label);
-
-        if(attribute->getType() == ATTRIBUTE_TYPE_STRING) {
-            QLineEdit *textBox = new QLineEdit(this);
-            std::shared_ptr<AttributeValueString> stringAttribute = std::dynamic_pointer_cast<AttributeValueString>(
-                    attribute->getValue());
-            textBox->setText(stringAttribute->get().c_str());
-            layout->addWidget(textBox);
-        } else if(attribute->getType() == ATTRIBUTE_TYPE_FLOAT) {
-            QLineEdit *textBox = new QLineEdit(this);
-            std::shared_ptr<AttributeValueFloat> stringAttribute = std::dynamic_pointer_cast<AttributeValueFloat>(
-                    attribute->getValue());
-            textBox->setText(std::to_string(stringAttribute->get()).c_str());
-            layout->addWidget(textBox);
-        } else if(attribute->getType() == ATTRIBUTE_TYPE_INTEGER) {
-            QLineEdit *textBox = new QLineEdit(this);
-            std::shared_ptr<AttributeValueInteger> stringAttribute = std::dynamic_pointer_cast<AttributeValueInteger>(
-                    attribute->getValue());
-            textBox->setText(std::to_string(stringAttribute->get()).c_str());
-            layout->addWidget(textBox);
-        } else if(attribute->getType() == ATTRIBUTE_TYPE_BOOLEAN) {
-            QCheckBox *checkBox = new QCheckBox(this);
-            std::shared_ptr<AttributeValueBoolean> stringAttribute = std::dynamic_pointer_cast<AttributeValueBoolean>(
-                    attribute->getValue());
-            checkBox->setChecked(stringAttribute->get());
-            layout->addWidget(checkBox);
-        }
-    }
-    setLayout(layout);
-}
-
-}
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <string>
 #include <vector>
-#include <QToolBox>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <FAST/SmartPointers.hpp>
@@ -23,9 +23,45 @@ class FAST_EXPORT  Pipeline {
         std::string getFilename() const;
         /**
          * Parse the pipeline file
+         * @param createRenderers if false, renderers in the file are skipped, which is used when
+         *      executing the pipeline without a view
          * @return number of inputs required
          */
-        int parsePipelineFile();
+        int parsePipelineFile(bool createRenderers = true);
+        /**
+         * Get the process objects which are not input to any other process object in the pipeline.
+         * Calling update on these executes the entire pipeline, except the renderers.
+         */
+        std::vector<SharedPointer<ProcessObject>> getSinks();
+        /**
+         * Get the IDs of the renderers which were skipped when parsing the pipeline file
+         */
+        std::vector<std::string> getSkippedRenderers() const;
+        /**
+         * Replace a skipped renderer with sinks, for instance exporters or a StatisticsSink.
+         * One sink is created for each input of the renderer, and input port 0 of the sink is connected to
+         * the data the renderer would have drawn. Replacing a renderer again removes its previous sinks.
+         * @param rendererID
+         * @param createSink function which creates the sink for the given input number of the renderer
+         * @return the sinks
+         */
+        std::vector<SharedPointer<ProcessObject>> replaceRenderer(
+                std::string rendererID,
+                std::function<SharedPointer<ProcessObject>(uint inputNr)> createSink
+        );
+        /**
+         * If true, chains of pointwise process objects, such as ScaleImage, ImageInverter, ImageMultiply and
+         * BinaryThresholding, are executed by a PointwiseOperatorChain when parsing the pipeline file. The rest of
+         * the pipeline uses the output of the chain instead of the last process object in the chain.
+         * getProcessObjects still returns the original process objects, and changing their attributes changes
+         * the chain. The fused process objects are not connected and should not be updated. Default is false.
+         * @param fuse
+         */
+        void setFusePointwiseOperators(bool fuse);
+        /**
+         * @return the PointwiseOperatorChain of each fused chain, with the ID of the last process object in the chain
+         */
+        std::unordered_map<std::string, SharedPointer<ProcessObject>> getFusedProcessObjects() const;
 
     private:
         std::string mName;
@@ -37,6 +73,36 @@ class FAST_EXPORT  Pipeline {
          */
         std::unordered_map<std::string, uint> mInputProcessObjects;
         std::vector<std::string> mRenderers;
+        /**
+         * IDs of process objects which are used as input by other process objects
+         */
+        std::unordered_set<std::string> mConnectedProcessObjects;
+        /**
+         * Inputs (process object ID and output port) of each skipped renderer
+         */
+        std::unordered_map<std::string, std::vector<std::pair<std::string, uint>>> mSkippedRenderers;
+        std::vector<std::string> mSkippedRendererIDs;
+        std::unordered_map<std::string, std::vector<SharedPointer<ProcessObject>>> mRendererSinks;
+        bool mFusePointwiseOperators = false;
+        /**
+         * PointwiseOperatorChain of each fused chain, with the ID of the last process object in the chain
+         */
+        std::unordered_map<std::string, SharedPointer<ProcessObject>> mFusedProcessObjects;
+        /**
+         * IDs of all process objects which are executed by a PointwiseOperatorChain
+         */
+        std::unordered_set<std::string> mFusedIDs;
+
+        /**
+         * Input connections in the pipeline file, which are connected after all process objects are parsed
+         */
+        struct Connection {
+            std::string objectID;
+            uint inputPortID;
+            std::string inputID;
+            uint outputPortID;
+        };
+        std::vector<Connection> mConnections;
 
         void parseProcessObject(
             std::string objectName,
@@ -44,24 +110,23 @@ class FAST_EXPORT  Pipeline {
             std::ifstream& file,
             bool isRenderer = false
         );
+        void skipRenderer(std::string objectID, std::ifstream& file);
+        void fusePointwiseOperators();
+        /**
+         * Get the process object which produces the output of the given ID when the pipeline executes, which is
+         * the PointwiseOperatorChain if the ID is the end of a fused chain
+         */
+        SharedPointer<ProcessObject> getExecutedProcessObject(std::string objectID);
+        void connectProcessObjects();
 };
 
+#ifdef FAST_MODULE_VISUALIZATION
 /**
  * Retrieve a list of all pipelines stored in .fpl files in the specified pipeline directory
  * @return
  */
 FAST_EXPORT std::vector<Pipeline> getAvailablePipelines();
-
-class FAST_EXPORT  PipelineWidget : public QToolBox {
-    public:
-        PipelineWidget(Pipeline pipeline, QWidget* parent = nullptr);
-
-};
-
-class FAST_EXPORT  ProcessObjectWidget : public QWidget {
-    public:
-        ProcessObjectWidget(SharedPointer<ProcessObject> po, QWidget* parent = nullptr);
-};
+#endif
 
 } // end namespace fast
 
@@ -0,0 +1,185 @@
+#include "PipelineBatchRunner.hpp"
+#include "FAST/Pipeline.hpp"
+#include "FAST/Streamers/Streamer.hpp"
+#include <thread>
+#include <chrono>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace fast {
+
+PipelineBatchRunner::PipelineBatchRunner() {
+    mNrOfInstances = std::max<int>(1, std::thread::hardware_concurrency());
+    mResetBetweenRecordings = false;
+    mNextRecording = 0;
+}
+
+void PipelineBatchRunner::setPipelineFilename(std::string filename) {
+    mFilename = filename;
+}
+
+void PipelineBatchRunner::setStreamerFactory(StreamerFactory factory) {
+    mStreamerFactory = factory;
+}
+
+void PipelineBatchRunner::setRecordings(std::vector<std::string> recordings) {
+    mRecordings = recordings;
+}
+
+void PipelineBatchRunner::addRecording(std::string recording) {
+    mRecordings.push_back(recording);
+}
+
+void PipelineBatchRunner::setNrOfInstances(int instances) {
+    if(instances <= 0)
+        throw Exception("Nr of instances must be > 0 in PipelineBatchRunner");
+    mNrOfInstances = instances;
+}
+
+void PipelineBatchRunner::setDevices(std::vector<OpenCLDevice::pointer> devices) {
+    mDevices = devices;
+}
+
+void PipelineBatchRunner::setRecordingStartedCallback(RecordingCallback callback) {
+    mRecordingStartedCallback = callback;
+}
+
+void PipelineBatchRunner::setRecordingFinishedCallback(RecordingCallback callback) {
+    mRecordingFinishedCallback = callback;
+}
+
+void PipelineBatchRunner::setResetBetweenRecordings(bool reset) {
+    mResetBetweenRecordings = reset;
+}
+
+uint64_t PipelineBatchRunner::processRecording(
+        Streamer::pointer streamer,
+        std::vector<DataPort::pointer> inputs,
+        std::vector<ProcessObject::pointer> sinks,
+        uint64_t& timestep
+        ) {
+    // The first update starts the streamer
+    bool started = false;
+    while(true) {
+        // Check if the streamer is done before checking the ports, since the streamer adds its last frame before
+        // it reports that it has reached the end
+        const bool reachedEnd = streamer->hasReachedEnd();
+        bool framesAvailable = true;
+        for(auto input : inputs) {
+            const DataPortMetrics metrics = input->getMetrics();
+            if(metrics.framesConsumed + metrics.framesDropped >= metrics.framesProduced)
+                framesAvailable = false;
+        }
+        if(started && !framesAvailable) {
+            if(reachedEnd)
+                break;
+            // Streamers may set the end flag some time after adding their last frame. Updating the sinks now
+            // would block forever in the data port if no more frames arrive, so wait and check again.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        for(auto sink : sinks)
+            sink->update(timestep, STREAMING_MODE_PROCESS_ALL_FRAMES);
+        // Timesteps are never reused by an instance, not even for the next recording
+        ++timestep;
+        started = true;
+    }
+
+    return inputs[0]->getMetrics().framesConsumed;
+}
+
+void PipelineBatchRunner::runInstance(int instanceNr) {
+#ifdef _OPENMP
+    // Divide the cores between the instances, to avoid oversubscription
+    omp_set_num_threads(std::max(1, omp_get_num_procs() / mNrOfInstances));
+#endif
+
+    Pipeline pipeline("Instance " + std::to_string(instanceNr), "", mFilename);
+    bool parsed = false;
+    int nrOfInputs = 0;
+    uint64_t timestep = 0;
+    while(true) {
+        const int recordingNr = mNextRecording++;
+        if(recordingNr >= (int)mRecordings.size())
+            break;
+        const std::string recording = mRecordings[recordingNr];
+
+        try {
+            if(!parsed || mResetBetweenRecordings) {
+                nrOfInputs = pipeline.parsePipelineFile(false);
+                if(mDevices.size() > 0) {
+                    OpenCLDevice::pointer device = mDevices[instanceNr % mDevices.size()];
+                    for(auto object : pipeline.getProcessObjects())
+                        object.second->setMainDevice(device);
+                }
+                parsed = true;
+            }
+
+            Streamer::pointer streamer = mStreamerFactory(recording);
+            std::vector<DataPort::pointer> inputs;
+            for(int i = 0; i < nrOfInputs; ++i)
+                inputs.push_back(streamer->getOutputPort());
+            pipeline.setup(inputs);
+            if(mRecordingStartedCallback)
+                mRecordingStartedCallback(recording, pipeline);
+
+            const uint64_t frames = processRecording(streamer, inputs, pipeline.getSinks(), timestep);
+            if(mRecordingFinishedCallback)
+                mRecordingFinishedCallback(recording, pipeline);
+
+            std::lock_guard<std::mutex> lock(mStatisticsMutex);
+            mStatistics.recordingsProcessed++;
+            mStatistics.framesProcessed += frames;
+        } catch(Exception &e) {
+            reportError() << "Processing of recording " << recording << " failed: " << e.what() << reportEnd();
+            // The state of the instance is unknown after an error, so create it again for the next recording
+            parsed = false;
+            std::lock_guard<std::mutex> lock(mStatisticsMutex);
+            mStatistics.recordingsFailed++;
+            mStatistics.failedRecordings.push_back(recording);
+        }
+    }
+}
+
+BatchRunStatistics PipelineBatchRunner::run() {
+    if(mFilename == "")
+        throw Exception("No pipeline filename given to PipelineBatchRunner");
+    if(!mStreamerFactory)
+        throw Exception("No streamer factory given to PipelineBatchRunner");
+
+    // Parse the file once here, so that errors in the file are reported before any threads are started.
+    // This also creates the DeviceManager instance, which is not thread safe, in this thread.
+    {
+        Pipeline pipeline("", "", mFilename);
+        if(pipeline.parsePipelineFile(false) == 0)
+            throw Exception("The pipeline " + mFilename + " has no PipelineInput, and can't be used in PipelineBatchRunner");
+    }
+
+    mNextRecording = 0;
+    mStatistics = BatchRunStatistics();
+    mStatistics.recordingsProcessed = 0;
+    mStatistics.recordingsFailed = 0;
+    mStatistics.framesProcessed = 0;
+
+    const int nrOfInstances = std::min<int>(mNrOfInstances, mRecordings.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for(int i = 0; i < nrOfInstances; ++i)
+        threads.push_back(std::thread(&PipelineBatchRunner::runInstance, this, i));
+    for(auto&& thread : threads)
+        thread.join();
+    std::chrono::duration<double> runtime = std::chrono::high_resolution_clock::now() - start;
+
+    mStatistics.runtime = runtime.count();
+    mStatistics.framesPerSecond = mStatistics.runtime > 0 ? mStatistics.framesProcessed / mStatistics.runtime : 0;
+    mStatistics.recordingsPerSecond = mStatistics.runtime > 0 ? mStatistics.recordingsProcessed / mStatistics.runtime : 0;
+    reportInfo() << "Processed " << mStatistics.recordingsProcessed << " recordings (" << mStatistics.recordingsFailed <<
+        " failed) with " << mStatistics.framesProcessed << " frames in " << mStatistics.runtime << " seconds using " <<
+        nrOfInstances << " pipeline instances: " << mStatistics.framesPerSecond << " frames per second" << reportEnd();
+
+    return mStatistics;
+}
+
+} // end namespace fast
@@ -0,0 +1,116 @@
+#ifndef FAST_PIPELINE_BATCH_RUNNER_HPP_
+#define FAST_PIPELINE_BATCH_RUNNER_HPP_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include "FAST/Object.hpp"
+#include "FAST/SmartPointers.hpp"
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/DataPort.hpp"
+
+namespace fast {
+
+class Pipeline;
+class ProcessObject;
+class Streamer;
+
+/**
+ * Aggregate results of PipelineBatchRunner::run
+ */
+struct BatchRunStatistics {
+    int recordingsProcessed; // Nr of recordings processed without errors
+    int recordingsFailed; // Nr of recordings which caused an exception
+    uint64_t framesProcessed; // Nr of frames processed in all recordings
+    double runtime; // Total runtime in seconds
+    double framesPerSecond;
+    double recordingsPerSecond;
+    std::vector<std::string> failedRecordings;
+};
+
+/**
+ * Run one pipeline (.fpl) file over many recordings in a single process.
+ *
+ * The pipeline file is instantiated once per worker thread, and each instance processes one recording at a time
+ * from a shared queue. The renderers in the pipeline file are skipped, and each frame is pulled through the
+ * pipeline by updating its sinks (see Pipeline::getSinks). Renderers can be replaced by exporters or other sinks
+ * with Pipeline::replaceRenderer in the recording started callback.
+ * OpenCL programs are built only once per device and shared by all instances. Instances are distributed
+ * round-robin over the devices given with setDevices, and the OpenMP threads are divided between the instances.
+ *
+ * Each recording is given as a string, which the streamer factory turns into a streamer. All inputs of
+ * the pipeline are connected to output port 0 of this streamer.
+ */
+class FAST_EXPORT  PipelineBatchRunner : public Object {
+    FAST_OBJECT(PipelineBatchRunner)
+    public:
+        typedef std::function<SharedPointer<Streamer>(std::string recording)> StreamerFactory;
+        typedef std::function<void(std::string recording, Pipeline& pipeline)> RecordingCallback;
+
+        void setPipelineFilename(std::string filename);
+        void setStreamerFactory(StreamerFactory factory);
+        void setRecordings(std::vector<std::string> recordings);
+        void addRecording(std::string recording);
+        /**
+         * Set the number of pipeline instances, which are run in parallel. Default is the number of hardware threads.
+         * @param instances
+         */
+        void setNrOfInstances(int instances);
+        /**
+         * Set the devices to distribute the pipeline instances over. By default all process objects
+         * use the default computation device.
+         * @param devices
+         */
+        void setDevices(std::vector<OpenCLDevice::pointer> devices);
+        /**
+         * Set a function which is called before a recording is processed, for instance to set the filename
+         * of exporters in the pipeline. The callback is called from the worker threads.
+         * @param callback
+         */
+        void setRecordingStartedCallback(RecordingCallback callback);
+        /**
+         * Set a function which is called after a recording has been processed without errors, for instance to
+         * collect results from sinks in the pipeline. The callback is called from the worker threads.
+         * @param callback
+         */
+        void setRecordingFinishedCallback(RecordingCallback callback);
+        /**
+         * If true, the pipeline file is parsed again before each recording, so that no state in the
+         * process objects is kept from the previous recording. Default is false.
+         * @param reset
+         */
+        void setResetBetweenRecordings(bool reset);
+        /**
+         * Process all recordings and block until done
+         * @return statistics of the run
+         */
+        BatchRunStatistics run();
+    private:
+        PipelineBatchRunner();
+        void runInstance(int instanceNr);
+        uint64_t processRecording(
+                SharedPointer<Streamer> streamer,
+                std::vector<DataPort::pointer> inputs,
+                std::vector<SharedPointer<ProcessObject>> sinks,
+                uint64_t& timestep
+        );
+
+        std::string mFilename;
+        StreamerFactory mStreamerFactory;
+        RecordingCallback mRecordingStartedCallback;
+        RecordingCallback mRecordingFinishedCallback;
+        std::vector<std::string> mRecordings;
+        std::vector<OpenCLDevice::pointer> mDevices;
+        int mNrOfInstances;
+        bool mResetBetweenRecordings;
+
+        std::atomic<int> mNextRecording;
+        std::mutex mStatisticsMutex;
+        BatchRunStatistics mStatistics;
+};
+
+} // end namespace fast
+
+#endif
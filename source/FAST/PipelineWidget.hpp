@@ -0,0 +1,22 @@
+#ifndef FAST_PIPELINE_WIDGET_HPP_
+#define FAST_PIPELINE_WIDGET_HPP_
+
+#include <QToolBox>
+#include <FAST/Pipeline.hpp>
+
+namespace fast {
+
+class FAST_EXPORT  PipelineWidget : public QToolBox {
+    public:
+        PipelineWidget(Pipeline pipeline, QWidget* parent = nullptr);
+
+};
+
+class FAST_EXPORT  ProcessObjectWidget : public QWidget {
+    public:
+        ProcessObjectWidget(SharedPointer<ProcessObject> po, QWidget* parent = nullptr);
+};
+
+} // end namespace fast
+
+#endif
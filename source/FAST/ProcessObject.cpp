@@ -1,8 +1,11 @@
 #include "FAST/ProcessObject.hpp"
 #include "FAST/Exception.hpp"
 #include "FAST/OpenCLProgram.hpp"
+#include "FAST/DeviceScheduler.hpp"
 #include "FAST/Streamers/Streamer.hpp"
+#include "FAST/Data/Image.hpp"
 #include <unordered_set>
+#include <map>
 
 
 namespace fast {
@@ -75,20 +78,25 @@ void ProcessObject::update(uint64_t timestep, StreamingMode streamingMode) {
     }
 
     // If this object is modified, or any parents has new data for this PO: Call execute
-    if(mIsModified || (newInputData && mLastTimestepExecuted != timestep)) {
+    const bool modified = isModified();
+    if(modified || (newInputData && mLastTimestepExecuted != timestep)) {
         this->mRuntimeManager->startRegularTimer("execute");
         // set isModified to false before executing to avoid recursive update calls
-        reportInfo() << "EXECUTING " << getNameOfClass() << " because " << reportEnd();
-        if(mIsModified) {
-            reportInfo() << "PO is modified." << reportEnd();
-        } else if(newInputData) {
-            reportInfo() << "has new input data." << reportEnd();
-        }
+        FAST_REPORT(reportInfo(), "EXECUTING " << getNameOfClass() << " because " <<
+                (modified ? "PO is modified." : "has new input data."));
         mIsModified = false;
+        // Let the device scheduler assign this object to a device, if it is enabled
+        DeviceScheduler::pointer scheduler = DeviceManager::getInstance()->getDeviceScheduler();
+        const bool scheduled = scheduler.isValid() && mDeviceSchedulingAllowed && !getMainDevice()->isHost();
+        bool measure = false;
+        if(scheduled)
+            measure = scheduler->startExecution(this);
         preExecute();
         execute();
         postExecute();
         mLastTimestepExecuted = timestep;
+        if(scheduled)
+            scheduler->finishExecution(this, measure);
         if(this->mRuntimeManager->isEnabled())
             this->waitToFinish();
         this->mRuntimeManager->stopRegularTimer("execute");
@@ -134,6 +142,7 @@ void ProcessObject::setInputConnection(DataPort::pointer port) {
 
 void ProcessObject::addOutputData(uint portID, DataObject::pointer data) {
     validateOutputPortExists(portID);
+    mLastOutputData[portID] = data;
 
     // Add it to all output connections, if any connections exist
     if(mOutputConnections.count(portID) > 0) {
@@ -258,6 +267,9 @@ ExecutionDevice::pointer ProcessObject::getMainDevice() const {
 
 void ProcessObject::setDevice(uint deviceNumber,
         ExecutionDevice::pointer device) {
+    // The main device has been chosen explicitly, it should not be changed by the device scheduler
+    if(deviceNumber == 0)
+        mDeviceSchedulingAllowed = false;
     if(mDeviceCriteria.count(deviceNumber) > 0) {
         if(!DeviceManager::getInstance()->deviceSatisfiesCriteria(device, mDeviceCriteria[deviceNumber]))
             throw Exception("Tried to set device which does not satisfy device criteria");
@@ -301,10 +313,45 @@ cl::Program ProcessObject::getOpenCLProgram(
     }
 
     OpenCLProgram::pointer program = mOpenCLPrograms[name];
+    const std::string typeDefines = mImageTypeDefinesEnabled ? getImageTypeDefines() : "";
+    if(!typeDefines.empty()) {
+        if(!buildOptions.empty())
+            buildOptions += " ";
+        buildOptions += typeDefines;
+    }
     return program->build(device, buildOptions);
 }
 
+std::string ProcessObject::getImageTypeDefines() {
+    // The ports are sorted, so that the same images give the same build options
+    std::map<std::string, std::shared_ptr<Image>> images;
+    for(auto& input : mLastProcessed) {
+        std::shared_ptr<Image> image = std::dynamic_pointer_cast<Image>(input.second.first.getPtr());
+        if(image && image->isInitialized())
+            images["FAST_INPUT" + std::to_string(input.first) + "_"] = image;
+    }
+    for(auto& output : mLastOutputData) {
+        std::shared_ptr<Image> image = std::dynamic_pointer_cast<Image>(output.second.getPtr().lock());
+        // Output images which have not been created yet have no type
+        if(image && image->isInitialized())
+            images["FAST_OUTPUT" + std::to_string(output.first) + "_"] = image;
+    }
+
+    std::string defines;
+    for(auto& image : images) {
+        if(!defines.empty())
+            defines += " ";
+        defines += getOpenCLTypeDefines(image.second->getDataType(), image.second->getNrOfComponents(), image.first);
+    }
+    return defines;
+}
+
 ProcessObject::~ProcessObject() {
+    if(DeviceManager::hasInstance()) {
+        DeviceScheduler::pointer scheduler = DeviceManager::getInstance()->getDeviceScheduler();
+        if(scheduler.isValid())
+            scheduler->removeProcessObject(this);
+    }
 }
 
 void ProcessObject::setAttributes(std::vector<std::shared_ptr<Attribute>> attributes) {
@@ -485,4 +532,8 @@ void ProcessObject::setModified(bool modified) {
 
 }
 
+bool ProcessObject::isModified() const {
+    return mIsModified;
+}
+
 } // namespace fast
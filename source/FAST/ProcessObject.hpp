@@ -67,11 +67,21 @@ class FAST_EXPORT  ProcessObject : public virtual Object {
         void stopPipeline();
 
         void setModified(bool modified);
+        /**
+         * @return true if this object has to execute again in the next update, even if there is no new input data
+         */
+        virtual bool isModified() const;
     protected:
         ProcessObject();
         // Flag to indicate whether the object has been modified
         // and should be executed again
         bool mIsModified;
+        // Whether the device scheduler, if enabled, may assign this object to a device. Disabled when the main
+        // device is set explicitly, and by objects which keep OpenCL objects of a device between executions.
+        bool mDeviceSchedulingAllowed = true;
+        // Whether getOpenCLProgram adds the type defines of the input and output images to the build options.
+        // Disabled by objects which get programs outside of execute, such as renderers in the rendering thread.
+        bool mImageTypeDefinesEnabled = true;
 
         // Used to avoid duplicate executes for same timestep
         uint64_t mLastTimestepExecuted = std::numeric_limits<uint64_t>::max();
@@ -100,6 +110,18 @@ class FAST_EXPORT  ProcessObject : public virtual Object {
         RuntimeMeasurementsManager::pointer mRuntimeManager;
 
         void createOpenCLProgram(std::string sourceFilename, std::string name = "");
+        /**
+         * Get an OpenCL program built for the device. The program is specialized for the data type and nr of
+         * components of the current input images and the created output images, by adding the defines of
+         * getOpenCLTypeDefines to the build options with the prefix FAST_INPUT<port id>_ and FAST_OUTPUT<port id>_.
+         * A program is built once for each combination of build options.
+         * The images are the ones of the last execute, so with the type defines enabled this must be called from
+         * the thread which executes this process object.
+         * @param device
+         * @param name
+         * @param buildOptions
+         * @return program
+         */
         cl::Program getOpenCLProgram(
                 SharedPointer<OpenCLDevice> device,
                 std::string name = "",
@@ -133,7 +155,13 @@ class FAST_EXPORT  ProcessObject : public virtual Object {
         std::unordered_set<uint> mOutputPorts;
         // <port id, timestep>, register the last timestep of data which this PO executed with
         std::unordered_map<uint, std::pair<DataObject::pointer, uint64_t>> mLastProcessed;
+        // The last data object created for each output port
+        std::unordered_map<uint, WeakPointer<DataObject>> mLastOutputData;
 
+        /**
+         * @return build options specializing OpenCL programs for the current input and output images
+         */
+        std::string getImageTypeDefines();
         void validateInputPortExists(uint portID);
         void validateOutputPortExists(uint portID);
 
@@ -143,6 +171,7 @@ class FAST_EXPORT  ProcessObject : public virtual Object {
 
         std::unordered_map<std::string, std::shared_ptr<Attribute>> mAttributes;
 
+        friend class DeviceScheduler;
 };
 
 
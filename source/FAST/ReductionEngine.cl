@@ -0,0 +1,204 @@
+#define NORMALIZE(value) (value)
+#ifdef TYPE_FLOAT
+#define TYPE float4
+#define BUFFER_TYPE float
+#define READ_IMAGE read_imagef
+#elif TYPE_SNORM_INT16
+#define TYPE float4
+#define BUFFER_TYPE short
+#define READ_IMAGE read_imagef
+#undef NORMALIZE
+#define NORMALIZE(value) max((value) / 32767.0f, -1.0f)
+#elif TYPE_UNORM_INT16
+#define TYPE float4
+#define BUFFER_TYPE ushort
+#define READ_IMAGE read_imagef
+#undef NORMALIZE
+#define NORMALIZE(value) ((value) / 65535.0f)
+#elif TYPE_UINT8
+#define TYPE uint4
+#define BUFFER_TYPE uchar
+#define READ_IMAGE read_imageui
+#elif TYPE_INT8
+#define TYPE int4
+#define BUFFER_TYPE char
+#define READ_IMAGE read_imagei
+#elif TYPE_UINT16
+#define TYPE uint4
+#define BUFFER_TYPE ushort
+#define READ_IMAGE read_imageui
+#else
+#define TYPE int4
+#define BUFFER_TYPE short
+#define READ_IMAGE read_imagei
+#endif
+
+__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
+
+/*
+ * Each work-item accumulates min, max and sum of the values it reads, and adds them to a histogram in local memory.
+ * The work-group then reduces these in local memory, and writes one partial result per group:
+ * min, max and sum to partialResults, and the histogram to partialHistograms. The partial results are combined on
+ * the host, since there are only a few hundred groups.
+ */
+
+typedef struct {
+    float minimum;
+    float maximum;
+    float sum;
+    int bins;
+    float histogramMinimum;
+    float histogramScale;
+} Accumulator;
+
+Accumulator initialize(
+        __local uint* histogram,
+        int bins,
+        float histogramMinimum,
+        float histogramMaximum,
+        __global const float* rangeResults,
+        int rangeGroups
+        ) {
+    Accumulator accumulator;
+    accumulator.minimum = INFINITY;
+    accumulator.maximum = -INFINITY;
+    accumulator.sum = 0.0f;
+    accumulator.bins = bins;
+    if(rangeGroups > 0) {
+        // The histogram range is the min and max from a previous reduction, which is still on the device
+        histogramMinimum = INFINITY;
+        histogramMaximum = -INFINITY;
+        for(int i = 0; i < rangeGroups; ++i) {
+            histogramMinimum = min(histogramMinimum, rangeResults[i*3]);
+            histogramMaximum = max(histogramMaximum, rangeResults[i*3 + 1]);
+        }
+    }
+    accumulator.histogramMinimum = histogramMinimum;
+    accumulator.histogramScale = histogramMaximum > histogramMinimum ? bins / (histogramMaximum - histogramMinimum) : 0.0f;
+
+    for(int i = get_local_id(0); i < bins; i += get_local_size(0))
+        histogram[i] = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return accumulator;
+}
+
+void accumulate(Accumulator* accumulator, __local uint* histogram, float value) {
+    accumulator->minimum = min(accumulator->minimum, value);
+    accumulator->maximum = max(accumulator->maximum, value);
+    accumulator->sum += value;
+    if(accumulator->bins > 0) {
+        const int bin = clamp((int)((value - accumulator->histogramMinimum)*accumulator->histogramScale), 0, accumulator->bins - 1);
+        atomic_inc(&histogram[bin]);
+    }
+}
+
+void writeResults(
+        Accumulator accumulator,
+        __local float* scratch,
+        __local uint* histogram,
+        __global float* partialResults,
+        __global uint* partialHistograms
+        ) {
+    const int id = get_local_id(0);
+    const int size = get_local_size(0);
+    scratch[id] = accumulator.minimum;
+    scratch[size + id] = accumulator.maximum;
+    scratch[2*size + id] = accumulator.sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for(int offset = size / 2; offset > 0; offset = offset / 2) {
+        if(id < offset) {
+            scratch[id] = min(scratch[id], scratch[id + offset]);
+            scratch[size + id] = max(scratch[size + id], scratch[size + id + offset]);
+            scratch[2*size + id] += scratch[2*size + id + offset];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    const int group = get_group_id(0);
+    if(id == 0) {
+        partialResults[group*3] = scratch[0];
+        partialResults[group*3 + 1] = scratch[size];
+        partialResults[group*3 + 2] = scratch[2*size];
+    }
+    for(int i = id; i < accumulator.bins; i += size)
+        partialHistograms[group*accumulator.bins + i] = histogram[i];
+}
+
+__kernel void reduceBuffer(
+        __global const BUFFER_TYPE* buffer,
+        __private uint length,
+        __global float* partialResults,
+        __global uint* partialHistograms,
+        __local float* scratch,
+        __local uint* histogram,
+        __private int bins,
+        __private float histogramMinimum,
+        __private float histogramMaximum,
+        __global const float* rangeResults,
+        __private int rangeGroups
+        ) {
+    Accumulator accumulator = initialize(histogram, bins, histogramMinimum, histogramMaximum, rangeResults, rangeGroups);
+    for(uint i = get_global_id(0); i < length; i += get_global_size(0))
+        accumulate(&accumulator, histogram, NORMALIZE((float)buffer[i]));
+    barrier(CLK_LOCAL_MEM_FENCE);
+    writeResults(accumulator, scratch, histogram, partialResults, partialHistograms);
+}
+
+void accumulateChannels(Accumulator* accumulator, __local uint* histogram, float4 value, int channels) {
+    accumulate(accumulator, histogram, value.x);
+    if(channels > 1)
+        accumulate(accumulator, histogram, value.y);
+    if(channels > 2)
+        accumulate(accumulator, histogram, value.z);
+    if(channels > 3)
+        accumulate(accumulator, histogram, value.w);
+}
+
+__kernel void reduceImage2D(
+        __read_only image2d_t image,
+        __private int channels,
+        __global float* partialResults,
+        __global uint* partialHistograms,
+        __local float* scratch,
+        __local uint* histogram,
+        __private int bins,
+        __private float histogramMinimum,
+        __private float histogramMaximum,
+        __global const float* rangeResults,
+        __private int rangeGroups
+        ) {
+    Accumulator accumulator = initialize(histogram, bins, histogramMinimum, histogramMaximum, rangeResults, rangeGroups);
+    const uint width = get_image_width(image);
+    const uint length = width*get_image_height(image);
+    for(uint i = get_global_id(0); i < length; i += get_global_size(0)) {
+        const int2 position = {i % width, i / width};
+        accumulateChannels(&accumulator, histogram, convert_float4(READ_IMAGE(image, sampler, position)), channels);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    writeResults(accumulator, scratch, histogram, partialResults, partialHistograms);
+}
+
+__kernel void reduceImage3D(
+        __read_only image3d_t image,
+        __private int channels,
+        __global float* partialResults,
+        __global uint* partialHistograms,
+        __local float* scratch,
+        __local uint* histogram,
+        __private int bins,
+        __private float histogramMinimum,
+        __private float histogramMaximum,
+        __global const float* rangeResults,
+        __private int rangeGroups
+        ) {
+    Accumulator accumulator = initialize(histogram, bins, histogramMinimum, histogramMaximum, rangeResults, rangeGroups);
+    const uint width = get_image_width(image);
+    const uint height = get_image_height(image);
+    const uint length = width*height*get_image_depth(image);
+    for(uint i = get_global_id(0); i < length; i += get_global_size(0)) {
+        const int4 position = {i % width, (i / width) % height, i / (width*height), 0};
+        accumulateChannels(&accumulator, histogram, convert_float4(READ_IMAGE(image, sampler, position)), channels);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    writeResults(accumulator, scratch, histogram, partialResults, partialHistograms);
+}
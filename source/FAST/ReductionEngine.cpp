@@ -0,0 +1,436 @@
+#include "FAST/ReductionEngine.hpp"
+#include "FAST/Config.hpp"
+#include "FAST/Exception.hpp"
+#include <limits>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+namespace fast {
+
+float IntensityStatistics::getAverage() const {
+    if(count == 0)
+        throw Exception("No values were used to calculate the average intensity");
+    return (float)(sum / count);
+}
+
+float IntensityStatistics::getPercentile(float percentage) const {
+    if(histogram.empty())
+        throw Exception("A histogram is needed to calculate percentiles");
+    if(percentage < 0 || percentage > 100)
+        throw Exception("Percentage given to getPercentile must be between 0 and 100");
+
+    const double target = count*percentage/100.0;
+    const float binWidth = (histogramMaximum - histogramMinimum) / histogram.size();
+    uint64_t accumulated = 0;
+    for(int i = 0; i < histogram.size(); ++i) {
+        if(histogram[i] > 0 && accumulated + histogram[i] >= target) {
+            const float fraction = (float)((target - accumulated) / histogram[i]);
+            return std::min(std::max(histogramMinimum + (i + fraction)*binWidth, minimum), maximum);
+        }
+        accumulated += histogram[i];
+    }
+    return maximum;
+}
+
+/**
+ * Persistent buffers for the partial results of one reduction on a device. A slot is in use as long as
+ * a Result refers to it.
+ */
+struct ReductionEngine::Scratch {
+    int groups = 0;
+    int bins = 0;
+    cl::Buffer rangeResults;
+    cl::Buffer partialResults;
+    cl::Buffer partialHistograms;
+    std::vector<float> results;
+    std::vector<uint> histograms;
+    std::vector<cl::Event> events;
+};
+
+static const int maxBins = 4096;
+
+ReductionEngine::Result::Result() {
+    mGroups = 0;
+    mCount = 0;
+    mFinished = false;
+}
+
+ReductionEngine::Result::Result(IntensityStatistics statistics) {
+    mGroups = 0;
+    mCount = statistics.count;
+    mFinished = true;
+    mStatistics = statistics;
+}
+
+ReductionEngine::Result::Result(std::shared_ptr<Scratch> scratch, int groups, HistogramOptions histogram, uint64_t count) {
+    mScratch = scratch;
+    mGroups = groups;
+    mHistogram = histogram;
+    mCount = count;
+    mFinished = false;
+}
+
+bool ReductionEngine::Result::isReady() const {
+    if(mFinished)
+        return true;
+    if(!mScratch)
+        return false;
+    for(const cl::Event& event : mScratch->events) {
+        if(event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE)
+            return false;
+    }
+    return true;
+}
+
+IntensityStatistics ReductionEngine::Result::get() {
+    if(mFinished)
+        return mStatistics;
+    if(!mScratch)
+        throw Exception("Trying to get the result of a reduction which was never started");
+
+    cl::Event::waitForEvents(mScratch->events);
+
+    IntensityStatistics statistics;
+    statistics.minimum = std::numeric_limits<float>::max();
+    statistics.maximum = std::numeric_limits<float>::lowest();
+    statistics.count = mCount;
+    for(int i = 0; i < mGroups; ++i) {
+        statistics.minimum = std::min(statistics.minimum, mScratch->results[i*3]);
+        statistics.maximum = std::max(statistics.maximum, mScratch->results[i*3 + 1]);
+        statistics.sum += mScratch->results[i*3 + 2];
+    }
+    if(mHistogram.bins > 0) {
+        statistics.histogram.resize(mHistogram.bins, 0);
+        for(int i = 0; i < mGroups; ++i) {
+            for(int j = 0; j < mHistogram.bins; ++j)
+                statistics.histogram[j] += mScratch->histograms[i*mHistogram.bins + j];
+        }
+        if(mHistogram.minimum < mHistogram.maximum) {
+            statistics.histogramMinimum = mHistogram.minimum;
+            statistics.histogramMaximum = mHistogram.maximum;
+        } else {
+            // The range was calculated on the device in a first pass
+            statistics.histogramMinimum = statistics.minimum;
+            statistics.histogramMaximum = statistics.maximum;
+        }
+    }
+
+    mStatistics = statistics;
+    mFinished = true;
+    mScratch.reset(); // The scratch buffers can now be used by other reductions
+    return mStatistics;
+}
+
+/**
+ * Get the histogram range of a data type if it is known without looking at the data
+ */
+static bool getDataTypeRange(DataType type, float* minimum, float* maximum) {
+    switch(type) {
+        case TYPE_UINT8:
+            *minimum = 0;
+            *maximum = 256;
+            return true;
+        case TYPE_INT8:
+            *minimum = -128;
+            *maximum = 128;
+            return true;
+        case TYPE_SNORM_INT16:
+            *minimum = -1;
+            *maximum = 1;
+            return true;
+        case TYPE_UNORM_INT16:
+            *minimum = 0;
+            *maximum = 1;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static HistogramOptions resolveHistogramRange(HistogramOptions histogram, DataType type) {
+    if(histogram.bins < 0 || histogram.bins > maxBins)
+        throw Exception("Nr of histogram bins must be between 0 and " + std::to_string(maxBins));
+    if(histogram.bins > 0 && histogram.minimum >= histogram.maximum)
+        getDataTypeRange(type, &histogram.minimum, &histogram.maximum);
+    return histogram;
+}
+
+static std::string getTypeDefine(DataType type) {
+    switch(type) {
+        case TYPE_FLOAT:
+            return "TYPE_FLOAT";
+        case TYPE_UINT8:
+            return "TYPE_UINT8";
+        case TYPE_INT8:
+            return "TYPE_INT8";
+        case TYPE_UINT16:
+            return "TYPE_UINT16";
+        case TYPE_INT16:
+            return "TYPE_INT16";
+        case TYPE_SNORM_INT16:
+            return "TYPE_SNORM_INT16";
+        case TYPE_UNORM_INT16:
+            return "TYPE_UNORM_INT16";
+    }
+    throw Exception("Unsupported data type in ReductionEngine");
+}
+
+ReductionEngine::pointer ReductionEngine::getInstance(OpenCLDevice::pointer device) {
+    static std::mutex instancesMutex;
+    static std::unordered_map<OpenCLDevice::pointer, ReductionEngine::pointer> instances;
+    std::lock_guard<std::mutex> lock(instancesMutex);
+    if(instances.count(device) == 0) {
+        ReductionEngine::pointer engine = ReductionEngine::New();
+        engine->mDevice = device;
+        // A few groups per compute unit is enough to hide latency, and keeps the partial results small
+        const int computeUnits = device->getDevice().getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+        engine->mGroups = std::min(std::max(computeUnits*4, 1), 256);
+        instances[device] = engine;
+    }
+    return instances[device];
+}
+
+ReductionEngine::ReductionEngine() {
+    mGroups = 1;
+    mGroupSize = 256;
+}
+
+cl::Kernel ReductionEngine::getKernel(std::string kernelName, DataType type) {
+    const std::string define = getTypeDefine(type);
+    const std::string key = kernelName + define;
+    if(mKernels.count(key) == 0) {
+        cl::Program program = mDevice->getProgramFromSourceWithName(
+                "ReductionEngine" + define,
+                Config::getKernelSourcePath() + "ReductionEngine.cl",
+                "-D" + define
+        );
+        mKernels[key] = cl::Kernel(program, kernelName.c_str());
+    }
+    return mKernels[key];
+}
+
+std::shared_ptr<ReductionEngine::Scratch> ReductionEngine::getScratch(int bins) {
+    std::shared_ptr<Scratch> scratch;
+    for(auto& candidate : mScratch) {
+        if(candidate.use_count() == 1) {
+            scratch = candidate;
+            break;
+        }
+    }
+    if(!scratch) {
+        scratch = std::make_shared<Scratch>();
+        mScratch.push_back(scratch);
+    } else {
+        // A result may have been discarded while the read back was still running
+        cl::Event::waitForEvents(scratch->events);
+    }
+    scratch->events.clear();
+
+    // Buffers are only reallocated when a reduction needs more space than before
+    const int histogramSize = std::max(bins, 1);
+    if(scratch->groups < mGroups) {
+        scratch->rangeResults = cl::Buffer(mDevice->getContext(), CL_MEM_READ_WRITE, mGroups*3*sizeof(float));
+        scratch->partialResults = cl::Buffer(mDevice->getContext(), CL_MEM_READ_WRITE, mGroups*3*sizeof(float));
+        scratch->results.resize(mGroups*3);
+    }
+    if(scratch->groups < mGroups || scratch->bins < histogramSize) {
+        scratch->bins = std::max(scratch->bins, histogramSize);
+        scratch->partialHistograms = cl::Buffer(mDevice->getContext(), CL_MEM_READ_WRITE, mGroups*scratch->bins*sizeof(uint));
+        scratch->histograms.resize(mGroups*scratch->bins);
+    }
+    scratch->groups = std::max(scratch->groups, mGroups);
+    return scratch;
+}
+
+ReductionEngine::Result ReductionEngine::reduce(cl::Buffer buffer, uint64_t size, DataType type, HistogramOptions histogram) {
+    return reduce("reduceBuffer", buffer, size, 1, type, histogram);
+}
+
+ReductionEngine::Result ReductionEngine::reduce(cl::Image2D image, uint nrOfComponents, DataType type, HistogramOptions histogram) {
+    const uint64_t size = (uint64_t)image.getImageInfo<CL_IMAGE_WIDTH>()*image.getImageInfo<CL_IMAGE_HEIGHT>();
+    return reduce("reduceImage2D", image, size, nrOfComponents, type, histogram);
+}
+
+ReductionEngine::Result ReductionEngine::reduce(cl::Image3D image, uint nrOfComponents, DataType type, HistogramOptions histogram) {
+    const uint64_t size = (uint64_t)image.getImageInfo<CL_IMAGE_WIDTH>()*image.getImageInfo<CL_IMAGE_HEIGHT>()*
+            image.getImageInfo<CL_IMAGE_DEPTH>();
+    return reduce("reduceImage3D", image, size, nrOfComponents, type, histogram);
+}
+
+ReductionEngine::Result ReductionEngine::reduce(
+        std::string kernelName,
+        const cl::Memory& data,
+        uint64_t size,
+        uint nrOfComponents,
+        DataType type,
+        HistogramOptions histogram
+        ) {
+    if(size == 0)
+        throw Exception("Trying to reduce an empty image or buffer");
+    if(size > std::numeric_limits<uint>::max())
+        throw Exception("Image or buffer is too large for ReductionEngine");
+    histogram = resolveHistogramRange(histogram, type);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    cl::Kernel kernel = getKernel(kernelName, type);
+    std::shared_ptr<Scratch> scratch = getScratch(histogram.bins);
+
+    // The tree reduction in local memory needs a power of two group size
+    const int maxGroupSize = std::min(
+            (int)kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(mDevice->getDevice()),
+            mGroupSize
+    );
+    int groupSize = 1;
+    while(groupSize*2 <= maxGroupSize)
+        groupSize *= 2;
+    const int groups = (int)std::min<uint64_t>(mGroups, (size + groupSize - 1) / groupSize);
+
+    const bool rangeFromData = histogram.bins > 0 && histogram.minimum >= histogram.maximum;
+    cl::CommandQueue queue = mDevice->getCommandQueue();
+    auto run = [&](cl::Buffer& results, int bins, int rangeGroups) {
+        int argument = 0;
+        kernel.setArg(argument++, data);
+        if(kernelName == "reduceBuffer") {
+            kernel.setArg(argument++, (uint)size);
+        } else {
+            kernel.setArg(argument++, (int)nrOfComponents);
+        }
+        kernel.setArg(argument++, results);
+        kernel.setArg(argument++, scratch->partialHistograms);
+        kernel.setArg(argument++, cl::Local(3*groupSize*sizeof(float)));
+        kernel.setArg(argument++, cl::Local(std::max(bins, 1)*sizeof(uint)));
+        kernel.setArg(argument++, bins);
+        kernel.setArg(argument++, histogram.minimum);
+        kernel.setArg(argument++, histogram.maximum);
+        kernel.setArg(argument++, scratch->rangeResults);
+        kernel.setArg(argument++, rangeGroups);
+        queue.enqueueNDRangeKernel(
+                kernel,
+                cl::NullRange,
+                cl::NDRange(groups*groupSize),
+                cl::NDRange(groupSize)
+        );
+    };
+
+    if(rangeFromData) {
+        // First pass finds the range of the histogram, the second pass reads it from the device
+        run(scratch->rangeResults, 0, 0);
+        run(scratch->partialResults, histogram.bins, groups);
+    } else {
+        run(scratch->partialResults, histogram.bins, 0);
+    }
+
+    // Read back the partial results without blocking, Result::get waits for them
+    cl::Event resultsEvent;
+    queue.enqueueReadBuffer(scratch->partialResults, CL_FALSE, 0, groups*3*sizeof(float), scratch->results.data(), NULL, &resultsEvent);
+    scratch->events.push_back(resultsEvent);
+    if(histogram.bins > 0) {
+        cl::Event histogramsEvent;
+        queue.enqueueReadBuffer(scratch->partialHistograms, CL_FALSE, 0, groups*histogram.bins*sizeof(uint), scratch->histograms.data(), NULL, &histogramsEvent);
+        scratch->events.push_back(histogramsEvent);
+    }
+    queue.flush();
+
+    return Result(scratch, groups, histogram, size*nrOfComponents);
+}
+
+template <class T>
+static IntensityStatistics reduceData(const T* data, uint64_t size, float scale, float lowest, HistogramOptions histogram) {
+    // Each block is reduced with several independent accumulators, so that the inner loop can be vectorized
+    const int64_t blockSize = 1 << 16;
+    const int64_t nrOfBlocks = (size + blockSize - 1) / blockSize;
+    const int lanes = 8;
+    std::vector<float> blockMinimum(nrOfBlocks), blockMaximum(nrOfBlocks);
+    std::vector<double> blockSum(nrOfBlocks);
+
+    #pragma omp parallel for
+    for(int64_t block = 0; block < nrOfBlocks; ++block) {
+        const T* blockData = data + block*blockSize;
+        const int64_t blockLength = std::min<int64_t>(blockSize, size - block*blockSize);
+        float minimum[lanes], maximum[lanes], sum[lanes];
+        for(int lane = 0; lane < lanes; ++lane) {
+            minimum[lane] = std::numeric_limits<float>::max();
+            maximum[lane] = std::numeric_limits<float>::lowest();
+            sum[lane] = 0;
+        }
+        const int64_t vectorLength = blockLength - blockLength % lanes;
+        for(int64_t i = 0; i < vectorLength; i += lanes) {
+            for(int lane = 0; lane < lanes; ++lane) {
+                const float value = std::max((float)blockData[i + lane]*scale, lowest);
+                minimum[lane] = std::min(minimum[lane], value);
+                maximum[lane] = std::max(maximum[lane], value);
+                sum[lane] += value;
+            }
+        }
+        for(int64_t i = vectorLength; i < blockLength; ++i) {
+            const float value = std::max((float)blockData[i]*scale, lowest);
+            minimum[0] = std::min(minimum[0], value);
+            maximum[0] = std::max(maximum[0], value);
+            sum[0] += value;
+        }
+        blockMinimum[block] = *std::min_element(minimum, minimum + lanes);
+        blockMaximum[block] = *std::max_element(maximum, maximum + lanes);
+        double total = 0;
+        for(int lane = 0; lane < lanes; ++lane)
+            total += sum[lane];
+        blockSum[block] = total;
+    }
+
+    IntensityStatistics statistics;
+    statistics.minimum = *std::min_element(blockMinimum.begin(), blockMinimum.end());
+    statistics.maximum = *std::max_element(blockMaximum.begin(), blockMaximum.end());
+    for(double sum : blockSum)
+        statistics.sum += sum;
+    statistics.count = size;
+
+    if(histogram.bins > 0) {
+        if(histogram.minimum >= histogram.maximum) {
+            histogram.minimum = statistics.minimum;
+            histogram.maximum = statistics.maximum;
+        }
+        statistics.histogramMinimum = histogram.minimum;
+        statistics.histogramMaximum = histogram.maximum;
+        statistics.histogram.resize(histogram.bins, 0);
+        const float histogramScale = histogram.maximum > histogram.minimum ? histogram.bins / (histogram.maximum - histogram.minimum) : 0.0f;
+
+        #pragma omp parallel
+        {
+            std::vector<uint64_t> threadHistogram(histogram.bins, 0);
+            #pragma omp for
+            for(int64_t i = 0; i < (int64_t)size; ++i) {
+                const float value = std::max((float)data[i]*scale, lowest);
+                const int bin = std::min(std::max((int)((value - histogram.minimum)*histogramScale), 0), histogram.bins - 1);
+                threadHistogram[bin]++;
+            }
+            #pragma omp critical
+            {
+                for(int i = 0; i < histogram.bins; ++i)
+                    statistics.histogram[i] += threadHistogram[i];
+            }
+        }
+    }
+
+    return statistics;
+}
+
+IntensityStatistics ReductionEngine::reduce(const void* data, uint64_t size, DataType type, HistogramOptions histogram) {
+    if(size == 0)
+        throw Exception("Trying to reduce an empty image or buffer");
+    histogram = resolveHistogramRange(histogram, type);
+
+    // Normalized types are converted to float the same way as OpenCL does when reading an image
+    const float noLimit = std::numeric_limits<float>::lowest();
+    switch(type) {
+        fastCaseTypeMacro(TYPE_FLOAT, float, return reduceData((const FAST_TYPE*)data, size, 1.0f, noLimit, histogram))
+        fastCaseTypeMacro(TYPE_INT8, char, return reduceData((const FAST_TYPE*)data, size, 1.0f, noLimit, histogram))
+        fastCaseTypeMacro(TYPE_UINT8, uchar, return reduceData((const FAST_TYPE*)data, size, 1.0f, noLimit, histogram))
+        fastCaseTypeMacro(TYPE_INT16, short, return reduceData((const FAST_TYPE*)data, size, 1.0f, noLimit, histogram))
+        fastCaseTypeMacro(TYPE_UINT16, ushort, return reduceData((const FAST_TYPE*)data, size, 1.0f, noLimit, histogram))
+        fastCaseTypeMacro(TYPE_SNORM_INT16, short, return reduceData((const FAST_TYPE*)data, size, 1.0f/32767.0f, -1.0f, histogram))
+        fastCaseTypeMacro(TYPE_UNORM_INT16, ushort, return reduceData((const FAST_TYPE*)data, size, 1.0f/65535.0f, noLimit, histogram))
+    }
+    throw Exception("Unsupported data type in ReductionEngine");
+}
+
+} // end namespace fast
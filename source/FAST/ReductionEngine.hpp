@@ -0,0 +1,127 @@
+#ifndef FAST_REDUCTION_ENGINE_HPP_
+#define FAST_REDUCTION_ENGINE_HPP_
+
+#include "FAST/Object.hpp"
+#include "FAST/ExecutionDevice.hpp"
+#include "FAST/Data/DataTypes.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fast {
+
+/**
+ * Intensity statistics of all pixels and channels of an image
+ */
+struct FAST_EXPORT IntensityStatistics {
+    float minimum = 0;
+    float maximum = 0;
+    double sum = 0;
+    /**
+     * Nr of values, which is the nr of pixels times the nr of channels
+     */
+    uint64_t count = 0;
+    /**
+     * Histogram of the values, empty if no histogram was requested.
+     * Bin i covers [histogramMinimum + i*binWidth, histogramMinimum + (i+1)*binWidth), values outside of the range
+     * are counted in the first and last bin.
+     */
+    std::vector<uint64_t> histogram;
+    float histogramMinimum = 0;
+    float histogramMaximum = 0;
+
+    float getAverage() const;
+    /**
+     * Get the value below which the given percentage of the values are. The value is estimated from the histogram
+     * by linear interpolation within the bin, and is exact for 8 bit images with the default histogram.
+     * @param percentage between 0 and 100
+     */
+    float getPercentile(float percentage) const;
+};
+
+/**
+ * Histogram options of a reduction. If bins is 0, no histogram is calculated.
+ * If the range is not set (minimum >= maximum), 8 bit images use the range of the data type with one bin per value.
+ * For other data types, the range is the min and max of the image, which requires a second pass over the data.
+ */
+struct FAST_EXPORT HistogramOptions {
+    int bins = 0;
+    float minimum = 0;
+    float maximum = 0;
+};
+
+/**
+ * Calculates the min, max, sum and histogram of an image, OpenCL buffer or host array in one pass.
+ *
+ * There is one engine for each OpenCL device. It keeps the built kernels and the scratch buffers for
+ * the partial results between calls, so that statistics can be calculated every frame or iteration without
+ * allocating memory or building programs. Reductions on a device are asynchronous: reduce returns a Result
+ * immediately, and the partial results are read back without blocking the command queue. Result::get waits for
+ * them and combines the partial results on the host.
+ *
+ * The host implementation splits the data into blocks which are processed in parallel with OpenMP, with
+ * several independent accumulators in the inner loop so that the compiler can vectorize it.
+ */
+class FAST_EXPORT  ReductionEngine : public Object {
+    FAST_OBJECT(ReductionEngine)
+    public:
+        struct Scratch;
+        /**
+         * Result of a reduction which may still be running on the device
+         */
+        class FAST_EXPORT Result {
+            public:
+                Result();
+                explicit Result(IntensityStatistics statistics);
+                Result(std::shared_ptr<Scratch> scratch, int groups, HistogramOptions histogram, uint64_t count);
+                /**
+                 * @return true if get will return without waiting for the device
+                 */
+                bool isReady() const;
+                /**
+                 * Wait for the reduction to finish and get the statistics
+                 */
+                IntensityStatistics get();
+            private:
+                std::shared_ptr<Scratch> mScratch;
+                int mGroups;
+                HistogramOptions mHistogram;
+                uint64_t mCount;
+                bool mFinished;
+                IntensityStatistics mStatistics;
+        };
+
+        /**
+         * Get the reduction engine of a device. The engine is created the first time.
+         * @param device
+         */
+        static ReductionEngine::pointer getInstance(OpenCLDevice::pointer device);
+
+        Result reduce(cl::Buffer buffer, uint64_t size, DataType type, HistogramOptions histogram = HistogramOptions());
+        Result reduce(cl::Image2D image, uint nrOfComponents, DataType type, HistogramOptions histogram = HistogramOptions());
+        Result reduce(cl::Image3D image, uint nrOfComponents, DataType type, HistogramOptions histogram = HistogramOptions());
+        /**
+         * Calculate the statistics of a host array
+         * @param data
+         * @param size nr of values in the array, which is the nr of pixels times the nr of channels for images
+         * @param type
+         * @param histogram
+         */
+        static IntensityStatistics reduce(const void* data, uint64_t size, DataType type, HistogramOptions histogram = HistogramOptions());
+    private:
+        ReductionEngine();
+        Result reduce(std::string kernelName, const cl::Memory& data, uint64_t size, uint nrOfComponents, DataType type, HistogramOptions histogram);
+        cl::Kernel getKernel(std::string kernelName, DataType type);
+        std::shared_ptr<Scratch> getScratch(int bins);
+
+        OpenCLDevice::pointer mDevice;
+        std::mutex mMutex;
+        std::map<std::string, cl::Kernel> mKernels;
+        std::vector<std::shared_ptr<Scratch>> mScratch;
+        int mGroups;
+        int mGroupSize;
+};
+
+} // end namespace fast
+
+#endif
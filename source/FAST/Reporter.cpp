@@ -1,31 +1,154 @@
 #include "Reporter.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
 
 namespace fast {
 
 // Initialize report methods for each type
-std::map<Reporter::Type, Reporter::Method> Reporter::mGlobalReporterMethods =
+std::atomic<int> Reporter::mGlobalReporterMethods[3] =
 #ifdef FAST_DEBUG
 {
-        {INFO, COUT},
-        {WARNING, COUT},
-        {ERROR, COUT}
+        {COUT}, // INFO
+        {COUT}, // WARNING
+        {COUT}  // ERROR
 };
 #else
 {
-        {INFO, NONE},
-        {WARNING, COUT},
-        {ERROR, COUT}
+        {NONE}, // INFO
+        {COUT}, // WARNING
+        {COUT}  // ERROR
 };
 #endif
 
+/**
+ * Writes LOG messages in a background thread, so that the thread reporting a message only has to
+ * put it in a queue.
+ */
+class LogSink {
+    public:
+        static LogSink& getInstance() {
+            static LogSink sink;
+            return sink;
+        }
+        void push(std::string message) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if(!mThread.joinable())
+                mThread = std::thread(&LogSink::run, this);
+            mQueue.push_back(std::move(message));
+            mCondition.notify_one();
+        }
+        void setFilename(std::string filename) {
+            flush();
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFilename = filename;
+            mFileChanged = true;
+        }
+        void flush() {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFlushed.wait(lock, [this] { return mQueue.empty() && !mWriting; });
+        }
+        ~LogSink() {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mStop = true;
+                mCondition.notify_one();
+            }
+            if(mThread.joinable())
+                mThread.join();
+        }
+    private:
+        LogSink() : mStop(false), mWriting(false), mFileChanged(false) {};
+        void run() {
+            std::ofstream file;
+            std::deque<std::string> messages;
+            while(true) {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mWriting = false;
+                    mFlushed.notify_all();
+                    mCondition.wait(lock, [this] { return mStop || !mQueue.empty(); });
+                    if(mQueue.empty())
+                        break;
+                    messages.swap(mQueue);
+                    mWriting = true;
+                    if(mFileChanged) {
+                        file.close();
+                        file.open(mFilename.c_str(), std::ios::app);
+                        mFileChanged = false;
+                    }
+                }
+                std::ostream& stream = file.is_open() ? (std::ostream&)file : std::cerr;
+                for(const std::string& message : messages)
+                    stream << message << "\n";
+                stream.flush();
+                messages.clear();
+            }
+        }
+
+        std::thread mThread;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::condition_variable mFlushed;
+        std::deque<std::string> mQueue;
+        std::string mFilename;
+        bool mStop;
+        bool mWriting;
+        bool mFileChanged;
+};
+
+/**
+ * Message buffers of a thread. Messages are nested when a message is reported while formatting another message,
+ * thus the buffers are used as a stack.
+ */
+struct MessageBuffers {
+    std::vector<std::unique_ptr<std::ostringstream> > buffers;
+    int depth = 0;
+};
+
+static MessageBuffers& getMessageBuffers() {
+    static thread_local MessageBuffers buffers;
+    return buffers;
+}
+
 Reporter::Reporter(Type type) {
     mType = type;
     mFirst = true;
+    mBufferIndex = -1;
+    for(int i = 0; i < 3; ++i)
+        mLocalReporterMethods[i] = -1;
 }
 
-Reporter::Reporter() {
-    mType = INFO;
+Reporter::Reporter() : Reporter(INFO) {
+}
+
+Reporter::Reporter(const Reporter& other) {
+    mType = other.mType;
     mFirst = true;
+    mBufferIndex = -1;
+    for(int i = 0; i < 3; ++i)
+        mLocalReporterMethods[i] = other.mLocalReporterMethods[i];
+}
+
+Reporter& Reporter::operator=(const Reporter& other) {
+    if(this != &other) {
+        releaseBuffer();
+        mType = other.mType;
+        mFirst = true;
+        for(int i = 0; i < 3; ++i)
+            mLocalReporterMethods[i] = other.mLocalReporterMethods[i];
+    }
+    return *this;
+}
+
+Reporter::~Reporter() {
+    // A message which was not ended, e.g. because an exception was thrown while formatting it
+    releaseBuffer();
 }
 
 void Reporter::setType(Type type) {
@@ -44,12 +167,49 @@ Reporter Reporter::error() {
     return Reporter(ERROR);
 }
 
+std::ostringstream& Reporter::acquireBuffer() {
+    MessageBuffers& buffers = getMessageBuffers();
+    mBufferIndex = buffers.depth;
+    buffers.depth++;
+    if(mBufferIndex == (int)buffers.buffers.size())
+        buffers.buffers.emplace_back(new std::ostringstream());
+    std::ostringstream& buffer = *buffers.buffers[mBufferIndex];
+    buffer.str("");
+    return buffer;
+}
+
+std::ostringstream& Reporter::getBuffer() {
+    if(mBufferIndex < 0)
+        return acquireBuffer();
+    return *getMessageBuffers().buffers[mBufferIndex];
+}
+
+void Reporter::releaseBuffer() {
+    if(mBufferIndex < 0)
+        return;
+    MessageBuffers& buffers = getMessageBuffers();
+    if(buffers.depth > mBufferIndex)
+        buffers.depth = mBufferIndex;
+    mBufferIndex = -1;
+}
+
 void Reporter::processEnd() {
+    if(mFirst)
+        return; // Nothing was reported
     mFirst = true;
-    if(getMethod(mType) == COUT) {
-        std::cout << std::endl;
-    } else if(getMethod(mType) == LOG) {
-        // Not implemented yet
+    const std::string text = getBuffer().str();
+    releaseBuffer();
+    const Method method = getMethod(mType);
+    if(method == COUT) {
+        static std::mutex coutMutex;
+        std::lock_guard<std::mutex> lock(coutMutex);
+        std::cout << text << std::endl;
+    } else if(method == LOG) {
+        const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        std::ostringstream message;
+        message << time << " " << std::this_thread::get_id() << " " << text;
+        LogSink::getInstance().push(message.str());
     }
 }
 
@@ -73,19 +233,29 @@ void Reporter::setGlobalReportMethod(Type type, Method method)  {
     mGlobalReporterMethods[type] = method;
 }
 
+void Reporter::setLogFilename(std::string filename) {
+    LogSink::getInstance().setFilename(filename);
+}
+
+void Reporter::flushLog() {
+    LogSink::getInstance().flush();
+}
+
 Reporter::Method Reporter::getMethod(Type type) const {
-    Method reportMethod;
     // If a local report method is given for the type, use that, if not use the global
-    if(mLocalReporterMethods.count(type) > 0) {
-        reportMethod = mLocalReporterMethods.at(type);
-    } else {
-        reportMethod = mGlobalReporterMethods.at(type);
-    }
-    return reportMethod;
+    if(mLocalReporterMethods[type] >= 0)
+        return (Method)mLocalReporterMethods[type];
+    return (Method)mGlobalReporterMethods[type].load(std::memory_order_relaxed);
+}
+
+template <>
+Reporter& operator<<(Reporter& report, const ReporterEnd& end) {
+    report.processEnd();
+    return report;
 }
 
 template <>
-Reporter operator<<(Reporter report, const ReporterEnd& end) {
+Reporter& operator<<(Reporter&& report, const ReporterEnd& end) {
     report.processEnd();
     return report;
 }
@@ -1,12 +1,23 @@
 #ifndef REPORT_HPP_
 #define REPORT_HPP_
 
-#include <map>
+#include <atomic>
+#include <sstream>
 #include <iostream>
 #include "FASTExport.hpp"
 
 #undef ERROR // undefine some windows garbage
 
+/**
+ * Report a message only if the type of the reporter is enabled. When it is disabled, this is a single branch
+ * and the message is not evaluated at all, which is what should be used on per frame paths:
+ *
+ * FAST_REPORT(reportInfo(), "Processing frame " << frameNr);
+ * FAST_REPORT(Reporter::info(), "Stopping " << getNameOfClass());
+ */
+#define FAST_REPORT(reporter, message) \
+    if(!(reporter).isEnabled()) {} else (reporter) << message << fast::Reporter::end()
+
 namespace fast {
 
 // Use to signal end of report line
@@ -21,61 +32,112 @@ class FAST_EXPORT  Reporter {
         static Reporter warning();
         static Reporter error();
         enum Type {INFO, WARNING, ERROR};
+        /**
+         * COUT writes each message to standard out when it is ended.
+         * LOG hands each message to a background thread which writes it with a timestamp and thread id to
+         * the file given to setLogFilename, or to standard error if no file is given.
+         */
         enum Method {NONE, COUT, LOG};
         void setType(Type);
         Reporter(Type type);
         Reporter();
+        /**
+         * Copies the type and report methods. A message which is being formatted is not copied.
+         */
+        Reporter(const Reporter& other);
+        Reporter& operator=(const Reporter& other);
+        ~Reporter();
         template <class T>
         void process(const T& content);
         void processEnd();
+        /**
+         * @return true if messages of the current type of this reporter are reported
+         */
+        bool isEnabled() const;
+        bool isEnabled(Type type) const;
         void setReportMethod(Method method);
         void setReportMethod(Type type, Method method);
         static void setGlobalReportMethod(Method method);
         static void setGlobalReportMethod(Type type, Method method);
+        /**
+         * Set the file which messages with the LOG method are appended to
+         * @param filename
+         */
+        static void setLogFilename(std::string filename);
+        /**
+         * Wait until all LOG messages have been written
+         */
+        static void flushLog();
     private:
         Method getMethod(Type) const;
+        /**
+         * Take the next free message buffer of the thread, and clear it
+         */
+        std::ostringstream& acquireBuffer();
+        std::ostringstream& getBuffer();
+        /**
+         * Give the buffer of the current message, and any buffers of nested messages which were not ended, back
+         */
+        void releaseBuffer();
         Type mType;
-        static std::map<Type, Method> mGlobalReporterMethods;
-        // The local report methods override the global, if they are defined
-        std::map<Type, Method> mLocalReporterMethods;
+        // Method of each type, stored as int since std::atomic of enums is not supported by all compilers
+        static std::atomic<int> mGlobalReporterMethods[3];
+        // The local report methods override the global, if they are defined (not -1)
+        signed char mLocalReporterMethods[3];
 
         // Variable to keep track of first <<
         bool mFirst;
+        // Index of the thread's message buffer used by the current message, -1 if no message is being formatted
+        int mBufferIndex;
 };
 
+inline bool Reporter::isEnabled(Type type) const {
+    const int local = mLocalReporterMethods[type];
+    return (local < 0 ? mGlobalReporterMethods[type].load(std::memory_order_relaxed) : local) != NONE;
+}
+
+inline bool Reporter::isEnabled() const {
+    return isEnabled(mType);
+}
+
 template <class T>
 void Reporter::process(const T& content) {
-    Method reportMethod = getMethod(mType);
+    if(!isEnabled())
+        return;
 
+    // Each message is formatted in its own buffer, and written in one piece when it ends. Messages reported while
+    // another message is formatted, e.g. by a function called in the message, get the next buffer of the thread.
     if(mFirst) {
-        // Write prefix first
-        if(reportMethod == COUT) {
-            if(mType == INFO) {
-                std::cout << "INFO: ";
-            } else if(mType == WARNING) {
-                std::cout << "WARNING: ";
-            } else if(mType == ERROR) {
-                std::cout << "ERROR: ";
-            }
+        std::ostringstream& buffer = acquireBuffer();
+        if(mType == INFO) {
+            buffer << "INFO: ";
+        } else if(mType == WARNING) {
+            buffer << "WARNING: ";
+        } else if(mType == ERROR) {
+            buffer << "ERROR: ";
         }
         mFirst = false;
     }
+    getBuffer() << content;
+}
 
-    if(reportMethod == COUT) {
-        std::cout << content;
-    } else if(reportMethod == LOG) {
-        // Not implemented yet
-    }
+template <class T>
+Reporter& operator<<(Reporter& report, const T& content) {
+    report.process(content);
+    return report;
 }
 
 template <class T>
-Reporter operator<<(Reporter report, const T& content) {
+Reporter& operator<<(Reporter&& report, const T& content) {
     report.process(content);
     return report;
 }
 
 template <>
-FAST_EXPORT Reporter operator<<(Reporter report, const ReporterEnd& end);
+FAST_EXPORT Reporter& operator<<(Reporter& report, const ReporterEnd& end);
+
+template <>
+FAST_EXPORT Reporter& operator<<(Reporter&& report, const ReporterEnd& end);
 
 } // end namespace fast
 
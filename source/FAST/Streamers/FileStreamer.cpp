@@ -137,7 +137,7 @@ void FileStreamer::producerStream() {
         }
         std::string filename = getFilename(i, currentSequence);
         try {
-            reportInfo() << "Filestreamer reading " << filename << reportEnd();
+            FAST_REPORT(reportInfo(), "Filestreamer reading " << filename);
             DataObject::pointer dataFrame = getDataFrame(filename);
             // Set and use timestamp if available
             if(mTimestampFilename != "") {
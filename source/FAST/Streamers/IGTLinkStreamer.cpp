@@ -193,7 +193,7 @@ void IGTLinkStreamer::producerStream() {
         headerMsg->GetTimeStamp(ts);
 
         std::string deviceName = headerMsg->GetDeviceName();
-        reportInfo() << "Device name: " << deviceName << Reporter::end();
+        FAST_REPORT(reportInfo(), "Device name: " << deviceName);
         bool ignore = false;
         if(mOutputPortDeviceNames.count(deviceName) == 0) {
             if(mOutputPortDeviceNames.count("") > 0 && strcmp(headerMsg->GetDeviceType(), "IMAGE") == 0) {
@@ -207,7 +207,7 @@ void IGTLinkStreamer::producerStream() {
         }
 
         unsigned long timestamp = round(ts->GetTimeStamp()*1000); // convert to milliseconds
-        reportInfo() << "TIMESTAMP converted: " << timestamp << reportEnd();
+        FAST_REPORT(reportInfo(), "TIMESTAMP converted: " << timestamp);
         if(strcmp(headerMsg->GetDeviceType(), "TRANSFORM") == 0 && !ignore) {
             mTransformStreamNames.insert(headerMsg->GetDeviceName());
             mStreamDescriptions[headerMsg->GetDeviceName()] = "Transform";
@@ -235,7 +235,7 @@ void IGTLinkStreamer::producerStream() {
                 for(int j = 0; j < 4; j++) {
                     fastMatrix(i,j) = matrix[i][j];
                 }}
-                reportInfo() << fastMatrix << Reporter::end();
+                FAST_REPORT(reportInfo(), fastMatrix);
 
                 try {
                     AffineTransformation::pointer T = AffineTransformation::New();
@@ -260,7 +260,7 @@ void IGTLinkStreamer::producerStream() {
                 mInFreezeMode = false;
             }
             statusMessageCounter = 0;
-            reportInfo() << "Receiving IMAGE data type from device " << headerMsg->GetDeviceName() << Reporter::end();
+            FAST_REPORT(reportInfo(), "Receiving IMAGE data type from device " << headerMsg->GetDeviceName());
 
             // Create a message buffer to receive transform data
             igtl::ImageMessage::Pointer imgMsg;
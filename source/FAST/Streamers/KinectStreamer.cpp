@@ -4,6 +4,7 @@
 #include <libfreenect2/registration.h>
 #include "FAST/Data/Image.hpp"
 #include "FAST/Data/Mesh.hpp"
+#include "FAST/Algorithms/DepthImageToPointCloud/DepthImageToPointCloud.hpp"
 
 namespace fast {
 
@@ -21,6 +22,8 @@ KinectStreamer::KinectStreamer() {
     mStreamIsStarted = false;
     mIsModified = true;
     mPointCloudFilterEnabled = false;
+    mPointCloudOutput = true;
+    mDepthIntrinsics = Vector4f::Zero();
     registration = NULL;
 }
 
@@ -28,6 +31,15 @@ void KinectStreamer::setPointCloudFiltering(bool enabled) {
     mPointCloudFilterEnabled = enabled;
 }
 
+void KinectStreamer::setPointCloudOutput(bool enabled) {
+    mPointCloudOutput = enabled;
+}
+
+Vector4f KinectStreamer::getDepthIntrinsics() const {
+    std::lock_guard<std::mutex> lock(mFirstFrameMutex);
+    return mDepthIntrinsics;
+}
+
 void KinectStreamer::execute() {
     if(!mStreamIsStarted) {
         // Check that first frame exists before starting streamer
@@ -109,6 +121,17 @@ void KinectStreamer::producerStream() {
                                                                               dev->getColorCameraParams());
     libfreenect2::Frame undistorted(512, 424, 4), registered(512, 424, 4);
 
+    // libfreenect2 back-projects pixel centers, thus the principal point is shifted half a pixel
+    libfreenect2::Freenect2Device::IrCameraParams parameters = dev->getIrCameraParams();
+    const Vector4f intrinsics(parameters.fx, parameters.fy, parameters.cx - 0.5f, parameters.cy - 0.5f);
+    {
+        std::lock_guard<std::mutex> lock(mFirstFrameMutex);
+        mDepthIntrinsics = intrinsics;
+    }
+    DepthImageToPointCloud::pointer pointCloudConverter = DepthImageToPointCloud::New();
+    pointCloudConverter->setIntrinsics(intrinsics[0], intrinsics[1], intrinsics[2], intrinsics[3]);
+    DataPort::pointer pointCloudPort = pointCloudConverter->getOutputPort();
+
     while(true) {
         {
             // Check if stop signal is sent
@@ -148,55 +171,20 @@ void KinectStreamer::producerStream() {
         }
         rgbImage->create(512, 424, TYPE_UINT8, 4, rgb_data);
 
-        // Create point cloud
-        std::vector<MeshVertex> points;
-        for(int r=0; r<424; ++r) {
-            for(int c = 0; c < 512; ++c) {
-                float x, y, z, color;
-                registration->getPointXYZRGB(&undistorted, &registered, r, c, x, y, z, color);
-                if(z < mMinRange || z > mMaxRange) {
-                    continue;
-                }
-                if(!std::isnan(x)) {
-                    // for each valid neigbhor; is the depth similar
-                    if(mPointCloudFilterEnabled) {
-                        int invalidNeighbors = 0;
-                        const int size = 1;
-                        for(int a = -size; a <= size; ++a) {
-                            for(int b = -size; b <= size; ++b) {
-                                if(r + a < 0 || r + a >= 424 || c + b < 0 || c + b >= 512)
-                                    continue;
-                                float x2, y2, z2, color2;
-                                registration->getPointXYZRGB(&undistorted, &registered, r + a, c + b, x2, y2, z2,
-                                                             color2);
-                                if(std::isnan(x2))
-                                    invalidNeighbors++;
-                                if(fabs(z - z2) * 1000 > 10)
-                                    invalidNeighbors++;
-
-                            }
-                        }
-                        if (invalidNeighbors > 0)
-                            continue;
-                    }
-
-                    // Decode color channels
-                    const uint8_t *p = reinterpret_cast<uint8_t*>(&color);
-                    uint8_t red = p[0];
-                    uint8_t green = p[1];
-                    uint8_t blue = p[2];
-                    MeshVertex point(Vector3f(x*1000, y*1000, z*1000));
-                    point.setColor(Color(red/255.0f, green/255.0f, blue/255.0f));
-                    points.push_back(point);
-                }
-            }
-        }
-        Mesh::pointer cloud = Mesh::New();
-        cloud->create(points);
-
         addOutputData(0, rgbImage);
         addOutputData(1, depthImage);
-        addOutputData(2, cloud);
+
+        if(mPointCloudOutput) {
+            // Create point cloud
+            pointCloudConverter->setEdgeFiltering(mPointCloudFilterEnabled);
+            pointCloudConverter->setMinRange(mMinRange*1000);
+            pointCloudConverter->setMaxRange(mMaxRange*1000);
+            pointCloudConverter->setInputData(0, depthImage);
+            pointCloudConverter->setInputData(1, rgbImage);
+            pointCloudConverter->update(0);
+            Mesh::pointer cloud = pointCloudPort->getNextFrame();
+            addOutputData(2, cloud);
+        }
         if(!mFirstFrameIsInserted) {
             {
                 std::lock_guard<std::mutex> lock(mFirstFrameMutex);
@@ -23,13 +23,27 @@ class MeshVertex;
  *
  * Output port 0: Registered RGB image
  * Output port 1: Registered depth image
- * Output port 2: Registered point cloud
+ * Output port 2: Registered point cloud, created with DepthImageToPointCloud
+ *
+ * To create the point cloud outside of the acquisition thread, disable the point cloud output and connect
+ * port 0 and 1 to a DepthImageToPointCloud with the intrinsics from getDepthIntrinsics.
  */
 class FAST_EXPORT KinectStreamer : public Streamer {
     FAST_OBJECT(KinectStreamer);
     public:
         void producerStream();
         void setPointCloudFiltering(bool enabled);
+        /**
+         * Enable or disable creating the point cloud on output port 2. Default is enabled.
+         * @param enabled
+         */
+        void setPointCloudOutput(bool enabled);
+        /**
+         * Intrinsics of the registered depth image as (fx, fy, cx, cy) in pixels, for use with
+         * DepthImageToPointCloud. Only available after the stream has started.
+         * @return
+         */
+        Vector4f getDepthIntrinsics() const;
         /**
          * Set maximum range in meters. All points above this range will be dropped.
          * @param range
@@ -61,11 +75,13 @@ class FAST_EXPORT KinectStreamer : public Streamer {
         bool mHasReachedEnd;
         bool mStop;
         bool mPointCloudFilterEnabled;
+        bool mPointCloudOutput;
+        Vector4f mDepthIntrinsics; // Written by the streamer thread, guarded by mFirstFrameMutex
         float mMaxRange = std::numeric_limits<float>::max(), mMinRange = 0;
         uint mNrOfFrames;
 
         std::thread* mThread;
-        std::mutex mFirstFrameMutex;
+        mutable std::mutex mFirstFrameMutex;
         std::mutex mStopMutex;
         std::condition_variable mFirstFrameCondition;
         libfreenect2::Registration* registration;
@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include "FAST/DeviceScheduler.hpp"
+#include "FAST/ProcessObject.hpp"
+#include <thread>
+
+namespace fast {
+
+// Process object which is slower on one of the devices
+class DeviceDependentProcessObject : public ProcessObject {
+    FAST_OBJECT(DeviceDependentProcessObject)
+    public:
+        void setSlowDevice(ExecutionDevice::pointer device) {
+            mSlowDevice = device;
+        }
+        void setIsModified() { mIsModified = true; };
+        std::vector<ExecutionDevice::pointer> getDevicesUsed() { return mDevicesUsed; };
+    private:
+        DeviceDependentProcessObject() {
+        }
+        void execute() {
+            ExecutionDevice::pointer device = getMainDevice();
+            mDevicesUsed.push_back(device);
+            std::this_thread::sleep_for(std::chrono::milliseconds(device == mSlowDevice ? 20 : 2));
+        }
+        ExecutionDevice::pointer mSlowDevice;
+        std::vector<ExecutionDevice::pointer> mDevicesUsed;
+};
+
+static DeviceScheduler::pointer createScheduler() {
+    // Two devices, which may be the same physical device
+    OpenCLDevice::pointer device = DeviceManager::getInstance()->getDefaultComputationDevice();
+    std::vector<OpenCLDevice::pointer> devices = {device, OpenCLDevice::pointer(new OpenCLDevice({device->getDevice()}))};
+    DeviceScheduler::pointer scheduler = DeviceScheduler::New();
+    scheduler->setDevices(devices);
+    return scheduler;
+}
+
+TEST_CASE("Device scheduler measures all devices and assigns process object to the fastest", "[fast][DeviceScheduler]") {
+    DeviceScheduler::pointer scheduler = createScheduler();
+    std::vector<OpenCLDevice::pointer> devices = scheduler->getDevices();
+    DeviceManager::getInstance()->setDeviceScheduler(scheduler);
+
+    DeviceDependentProcessObject::pointer po = DeviceDependentProcessObject::New();
+    po->setSlowDevice(devices[0]);
+    for(int i = 0; i < 20; ++i) {
+        po->setIsModified();
+        po->update(i);
+    }
+    DeviceManager::getInstance()->setDeviceScheduler(DeviceScheduler::pointer());
+
+    std::vector<ExecutionDevice::pointer> devicesUsed = po->getDevicesUsed();
+    REQUIRE(devicesUsed.size() == 20);
+    // Each device is tried once, and then the fast device is used
+    CHECK(devicesUsed[0] == devices[0]);
+    CHECK(devicesUsed[1] == devices[1]);
+    for(int i = 2; i < 20; ++i)
+        CHECK(devicesUsed[i] == devices[1]);
+    CHECK(scheduler->getEstimatedRuntime(po.get(), devices[0]) > scheduler->getEstimatedRuntime(po.get(), devices[1]));
+}
+
+TEST_CASE("Device scheduler does not move process object with main device set", "[fast][DeviceScheduler]") {
+    DeviceScheduler::pointer scheduler = createScheduler();
+    std::vector<OpenCLDevice::pointer> devices = scheduler->getDevices();
+    DeviceManager::getInstance()->setDeviceScheduler(scheduler);
+
+    DeviceDependentProcessObject::pointer po = DeviceDependentProcessObject::New();
+    po->setSlowDevice(devices[0]);
+    po->setMainDevice(devices[0]);
+    for(int i = 0; i < 5; ++i) {
+        po->setIsModified();
+        po->update(i);
+    }
+    DeviceManager::getInstance()->setDeviceScheduler(DeviceScheduler::pointer());
+
+    for(ExecutionDevice::pointer device : po->getDevicesUsed())
+        CHECK(device == devices[0]);
+    CHECK(scheduler->getEstimatedRuntime(po.get(), devices[0]) == -1);
+}
+
+}
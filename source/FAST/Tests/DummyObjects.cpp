@@ -13,6 +13,10 @@ void DummyStreamer::setTotalFrames(uint frames) {
 
 }
 
+void DummyStreamer::setEndDelay(uint milliseconds) {
+    mEndDelay = milliseconds;
+}
+
 DummyStreamer::DummyStreamer() {
     createOutputPort<DummyDataObject>(0);
     mIsModified = true;
@@ -41,17 +45,24 @@ void DummyStreamer::produce() {
         {
             std::unique_lock<std::mutex> lock(mFramesGeneratedMutex);
             mFramesGenerated++;
+            if(mFramesGenerated == mFramesToGenerate && mEndDelay == 0)
+                mReachedEnd = true;
         }
         if(i == 0)
             mFirstFrameConditionVariable.notify_one();
         std::this_thread::sleep_for(std::chrono::milliseconds(mSleepTime));
     }
+    if(mEndDelay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(mEndDelay));
+        std::unique_lock<std::mutex> lock(mFramesGeneratedMutex);
+        mReachedEnd = true;
+    }
     mRunning = false;
 }
 
 bool DummyStreamer::hasReachedEnd() {
     std::unique_lock<std::mutex> lock(mFramesGeneratedMutex);
-    return mFramesToGenerate == mFramesGenerated;
+    return mReachedEnd;
 }
 
 uint DummyStreamer::getFramesToGenerate() {
@@ -77,6 +77,10 @@ class DummyStreamer : public Streamer {
     public:
         void setSleepTime(uint milliseconds);
         void setTotalFrames(uint frames);
+        /**
+         * Wait this long after the last frame before reporting that the end has been reached
+         */
+        void setEndDelay(uint milliseconds);
         void produce();
         bool hasReachedEnd();
         uint getFramesToGenerate();
@@ -88,6 +92,8 @@ class DummyStreamer : public Streamer {
         uint mSleepTime = 1;
         uint mFramesToGenerate = 20;
         uint mFramesGenerated = 0;
+        uint mEndDelay = 0;
+        bool mReachedEnd = false;
 
         std::thread* mThread = nullptr;
         bool mRunning = false;
@@ -0,0 +1,247 @@
+#include "catch.hpp"
+#include "DummyObjects.hpp"
+#include "FAST/Pipeline.hpp"
+#include "FAST/PipelineBatchRunner.hpp"
+#include "FAST/ProcessObjectRegistry.hpp"
+#include "FAST/Algorithms/BinaryThresholding/BinaryThresholding.hpp"
+#include "FAST/Data/Segmentation.hpp"
+#include "FAST/Exporters/StatisticsSink.hpp"
+#include <fstream>
+
+using namespace fast;
+
+static void writePipelineFile(std::string filename) {
+    std::ofstream file(filename.c_str());
+    file <<
+        "PipelineName \"Batch test\"\n"
+        "PipelineDescription \"Two dummy process objects\"\n"
+        "\n"
+        "ProcessObject first DummyProcessObject\n"
+        "Input 0 PipelineInput\n"
+        "\n"
+        "ProcessObject second DummyProcessObject\n"
+        "Input 0 first 0\n"
+        "\n"
+        "Renderer renderer ImageRenderer\n"
+        "Attribute window 255\n"
+        "Input 0 second 0\n";
+}
+
+TEST_CASE("Pipeline without renderers has the last process object as sink", "[Pipeline][fast]") {
+    ProcessObjectRegistry::registerPO("DummyProcessObject", FAST_REGISTER_DERIVED(DummyProcessObject));
+    const std::string filename = "pipeline_sinks_test.fpl";
+    writePipelineFile(filename);
+
+    Pipeline pipeline("", "", filename);
+    CHECK(pipeline.parsePipelineFile(false) == 1);
+    CHECK(pipeline.getProcessObjects().size() == 2);
+    std::vector<ProcessObject::pointer> sinks = pipeline.getSinks();
+    REQUIRE(sinks.size() == 1);
+    CHECK(sinks[0] == pipeline.getProcessObjects()["second"]);
+}
+
+TEST_CASE("Skipped renderer can be replaced by a sink", "[Pipeline][fast]") {
+    ProcessObjectRegistry::registerPO("DummyProcessObject", FAST_REGISTER_DERIVED(DummyProcessObject));
+    const std::string filename = "pipeline_replace_renderer_test.fpl";
+    writePipelineFile(filename);
+
+    Pipeline pipeline("", "", filename);
+    pipeline.parsePipelineFile(false);
+    REQUIRE(pipeline.getSkippedRenderers().size() == 1);
+    CHECK(pipeline.getSkippedRenderers()[0] == "renderer");
+
+    StatisticsSink::pointer statistics;
+    std::vector<ProcessObject::pointer> sinks = pipeline.replaceRenderer("renderer", [&](uint inputNr) -> ProcessObject::pointer {
+        statistics = StatisticsSink::New();
+        return statistics;
+    });
+    REQUIRE(sinks.size() == 1);
+    REQUIRE(pipeline.getSinks().size() == 1);
+    CHECK(pipeline.getSinks()[0] == sinks[0]);
+
+    const int frames = 10;
+    DummyStreamer::pointer streamer = DummyStreamer::New();
+    streamer->setSleepTime(1);
+    streamer->setTotalFrames(frames);
+    pipeline.setup({streamer->getOutputPort()});
+    for(int timestep = 0; timestep < frames; ++timestep)
+        statistics->update(timestep, STREAMING_MODE_PROCESS_ALL_FRAMES);
+    CHECK(statistics->getNrOfFrames() == frames);
+    CHECK_THROWS(pipeline.replaceRenderer("first", [](uint inputNr) -> ProcessObject::pointer { return StatisticsSink::New(); }));
+}
+
+TEST_CASE("PipelineBatchRunner processes all frames of all recordings", "[Pipeline][PipelineBatchRunner][fast]") {
+    ProcessObjectRegistry::registerPO("DummyProcessObject", FAST_REGISTER_DERIVED(DummyProcessObject));
+    const std::string filename = "pipeline_batch_runner_test.fpl";
+    writePipelineFile(filename);
+
+    const int recordings = 8;
+    const int framesPerRecording = 10;
+    PipelineBatchRunner::pointer runner = PipelineBatchRunner::New();
+    runner->setPipelineFilename(filename);
+    runner->setNrOfInstances(3);
+    for(int i = 0; i < recordings; ++i)
+        runner->addRecording("recording" + std::to_string(i));
+    runner->setStreamerFactory([=](std::string recording) -> Streamer::pointer {
+        DummyStreamer::pointer streamer = DummyStreamer::New();
+        streamer->setSleepTime(1);
+        streamer->setTotalFrames(framesPerRecording);
+        return streamer;
+    });
+
+    BatchRunStatistics statistics = runner->run();
+    CHECK(statistics.recordingsProcessed == recordings);
+    CHECK(statistics.recordingsFailed == 0);
+    CHECK(statistics.framesProcessed == recordings*framesPerRecording);
+    CHECK(statistics.framesPerSecond > 0);
+}
+
+TEST_CASE("PipelineBatchRunner finishes when the streamer reports the end after its last frame", "[Pipeline][PipelineBatchRunner][fast]") {
+    ProcessObjectRegistry::registerPO("DummyProcessObject", FAST_REGISTER_DERIVED(DummyProcessObject));
+    const std::string filename = "pipeline_batch_runner_end_test.fpl";
+    writePipelineFile(filename);
+
+    const int recordings = 3;
+    const int framesPerRecording = 5;
+    PipelineBatchRunner::pointer runner = PipelineBatchRunner::New();
+    runner->setPipelineFilename(filename);
+    runner->setNrOfInstances(2);
+    for(int i = 0; i < recordings; ++i)
+        runner->addRecording("recording" + std::to_string(i));
+    runner->setStreamerFactory([=](std::string recording) -> Streamer::pointer {
+        DummyStreamer::pointer streamer = DummyStreamer::New();
+        streamer->setSleepTime(1);
+        streamer->setTotalFrames(framesPerRecording);
+        // Like the file streamers, which look for the next file before they set the end flag
+        streamer->setEndDelay(100);
+        return streamer;
+    });
+
+    BatchRunStatistics statistics = runner->run();
+    CHECK(statistics.recordingsProcessed == recordings);
+    CHECK(statistics.recordingsFailed == 0);
+    CHECK(statistics.framesProcessed == recordings*framesPerRecording);
+}
+
+TEST_CASE("Pipeline fuses chains of pointwise process objects", "[Pipeline][PointwiseOperatorChain][fast]") {
+    const std::string filename = "pipeline_fusion_test.fpl";
+    {
+        std::ofstream file(filename.c_str());
+        file <<
+            "PipelineName \"Fusion test\"\n"
+            "PipelineDescription \"Pointwise process objects\"\n"
+            "\n"
+            "ProcessObject scale ScaleImage\n"
+            "Attribute high 10\n"
+            "Input 0 PipelineInput\n"
+            "\n"
+            "ProcessObject invert ImageInverter\n"
+            "Input 0 scale 0\n"
+            "\n"
+            "ProcessObject threshold BinaryThresholding\n"
+            "Attribute lower-threshold 5\n"
+            "Input 0 invert 0\n"
+            "\n"
+            "Renderer renderer SegmentationRenderer\n"
+            "Input 0 threshold 0\n";
+    }
+
+    Pipeline pipeline("", "", filename);
+    pipeline.setFusePointwiseOperators(true);
+    CHECK(pipeline.parsePipelineFile(false) == 1);
+    // The original process objects are kept
+    std::unordered_map<std::string, ProcessObject::pointer> objects = pipeline.getProcessObjects();
+    CHECK(objects.size() == 3);
+    REQUIRE(objects.count("threshold") == 1);
+    CHECK(objects["threshold"]->getNameOfClass() == "BinaryThresholding");
+    std::unordered_map<std::string, ProcessObject::pointer> fused = pipeline.getFusedProcessObjects();
+    REQUIRE(fused.size() == 1);
+    REQUIRE(fused.count("threshold") == 1);
+    CHECK(fused["threshold"]->getNameOfClass() == "PointwiseOperatorChain");
+    REQUIRE(pipeline.getSinks().size() == 1);
+    CHECK(pipeline.getSinks()[0] == fused["threshold"]);
+
+    // Fusion is off by default
+    Pipeline unfusedPipeline("", "", filename);
+    CHECK(unfusedPipeline.parsePipelineFile(false) == 1);
+    CHECK(unfusedPipeline.getProcessObjects().size() == 3);
+    CHECK(unfusedPipeline.getFusedProcessObjects().size() == 0);
+}
+
+class StaticImageSource : public ProcessObject {
+    FAST_OBJECT(StaticImageSource)
+    public:
+        void setImage(Image::pointer image) {
+            mImage = image;
+            mIsModified = true;
+        }
+    private:
+        StaticImageSource() {
+            createOutputPort<Image>(0);
+        }
+        void execute() {
+            addOutputData(0, mImage);
+        }
+        Image::pointer mImage;
+};
+
+static int countForeground(Segmentation::pointer segmentation) {
+    ImageAccess::pointer access = segmentation->getImageAccess(ACCESS_READ);
+    const uchar* data = (const uchar*)access->get();
+    const Vector3ui size = segmentation->getSize();
+    int foreground = 0;
+    for(int i = 0; i < size.x()*size.y()*size.z(); ++i) {
+        if(data[i] > 0)
+            foreground++;
+    }
+    return foreground;
+}
+
+TEST_CASE("Changing an attribute of a fused process object updates the output of the chain", "[Pipeline][PointwiseOperatorChain][fast]") {
+    const std::string filename = "pipeline_fusion_modified_test.fpl";
+    {
+        std::ofstream file(filename.c_str());
+        file <<
+            "PipelineName \"Fusion test\"\n"
+            "PipelineDescription \"Pointwise process objects\"\n"
+            "\n"
+            "ProcessObject scale ScaleImage\n"
+            "Attribute high 10\n"
+            "Input 0 PipelineInput\n"
+            "\n"
+            "ProcessObject invert ImageInverter\n"
+            "Input 0 scale 0\n"
+            "\n"
+            "ProcessObject threshold BinaryThresholding\n"
+            "Attribute lower-threshold 5.2\n"
+            "Input 0 invert 0\n";
+    }
+
+    // Pixel values 0 to 15 are scaled to [0, 10] and inverted to 10 - value*2/3
+    std::vector<uchar> data(16);
+    for(int i = 0; i < 16; ++i)
+        data[i] = i;
+    Image::pointer image = Image::New();
+    image->create(4, 4, TYPE_UINT8, 1, data.data());
+    StaticImageSource::pointer source = StaticImageSource::New();
+    source->setImage(image);
+
+    Pipeline pipeline("", "", filename);
+    pipeline.setFusePointwiseOperators(true);
+    pipeline.parsePipelineFile(false);
+    REQUIRE(pipeline.getFusedProcessObjects().size() == 1);
+    pipeline.setup({source->getOutputPort()});
+    REQUIRE(pipeline.getSinks().size() == 1);
+    ProcessObject::pointer chain = pipeline.getSinks()[0];
+    DataPort::pointer port = chain->getOutputPort();
+
+    chain->update(0);
+    // 10 - value*2/3 >= 5.2 for the values 0 to 7
+    CHECK(countForeground(port->getNextFrame()) == 8);
+
+    BinaryThresholding::pointer threshold = pipeline.getProcessObjects().at("threshold");
+    threshold->setLowerThreshold(8.2f);
+    chain->update(1);
+    // 10 - value*2/3 >= 8.2 for the values 0 to 2
+    CHECK(countForeground(port->getNextFrame()) == 3);
+}
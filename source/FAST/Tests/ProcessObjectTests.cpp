@@ -48,6 +48,85 @@ TEST_CASE("Two step pipeline with stream", "[two_step][process_all_frames][Proce
     CHECK(timestep == 20);
 }
 
+TEST_CASE("Stream with frame drop policy DROP_OLDEST", "[process_all_frames][ProcessObject][fast]") {
+    DummyStreamer::pointer streamer = DummyStreamer::New();
+    streamer->setSleepTime(1);
+    streamer->setTotalFrames(20);
+
+    DataPort::pointer port = streamer->getOutputPort();
+    port->setMaximumNumberOfFrames(2);
+    port->setFrameDropPolicy(FRAME_DROP_POLICY_DROP_OLDEST);
+
+    // Slow consumer, the newest frame is never dropped
+    int timestep = 0;
+    int previousID = -1;
+    while(previousID != 19) {
+        streamer->update(timestep, STREAMING_MODE_PROCESS_ALL_FRAMES);
+        DummyDataObject::pointer image = port->getNextFrame();
+        CHECK(image->getID() > previousID);
+        previousID = image->getID();
+        timestep++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    DataPortMetrics metrics = port->getMetrics();
+    CHECK(metrics.framesProduced == 20);
+    CHECK(metrics.framesConsumed == timestep);
+    CHECK(metrics.framesDropped == 20 - timestep);
+    CHECK(metrics.framesDropped > 0);
+    CHECK(metrics.producerBlockedTime == 0);
+}
+
+TEST_CASE("Stopping a DataPort with frame drop policy wakes a consumer waiting for the first frame", "[process_all_frames][ProcessObject][fast]") {
+    DummyStreamer::pointer streamer = DummyStreamer::New();
+    DataPort::pointer port = streamer->getOutputPort();
+    port->setFrameDropPolicy(FRAME_DROP_POLICY_DROP_OLDEST);
+
+    // No frames are ever added to the port
+    std::thread stopThread([port]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        port->stop();
+    });
+    CHECK_THROWS(port->getNextFrame());
+    stopThread.join();
+}
+
+TEST_CASE("Stream with frame decimation", "[process_all_frames][ProcessObject][fast]") {
+    DummyStreamer::pointer streamer = DummyStreamer::New();
+    streamer->setSleepTime(1);
+    streamer->setTotalFrames(20);
+
+    DataPort::pointer port = streamer->getOutputPort();
+    port->setFrameDecimation(5);
+
+    for(int timestep = 0; timestep < 4; ++timestep) {
+        streamer->update(timestep, STREAMING_MODE_PROCESS_ALL_FRAMES);
+        DummyDataObject::pointer image = port->getNextFrame();
+        CHECK(image->getID() == timestep*5);
+    }
+    CHECK(port->getMetrics().framesConsumed == 4);
+}
+
+TEST_CASE("Frame decimation is not allowed for process objects which are not streamers", "[process_all_frames][ProcessObject][fast]") {
+    DummyStreamer::pointer streamer = DummyStreamer::New();
+    streamer->setSleepTime(1);
+    streamer->setTotalFrames(5);
+
+    DummyProcessObject::pointer po = DummyProcessObject::New();
+    po->setInputConnection(streamer->getOutputPort());
+
+    DataPort::pointer port = po->getOutputPort();
+    CHECK_THROWS(port->setFrameDecimation(2));
+    CHECK_NOTHROW(port->setFrameDecimation(1));
+
+    // The consumer gets the frame of every timestep
+    for(int timestep = 0; timestep < 5; ++timestep) {
+        po->update(timestep, STREAMING_MODE_PROCESS_ALL_FRAMES);
+        DummyDataObject::pointer image = port->getNextFrame();
+        CHECK(image->getID() == timestep);
+    }
+    CHECK(port->getMetrics().framesDropped == 0);
+}
+
 TEST_CASE("Simple pipeline with stream, NEWEST_FRAME_ONLY", "[ProcessObject][fast]") {
     DummyStreamer::pointer streamer = DummyStreamer::New();
     streamer->setSleepTime(100);
@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "FAST/ReductionEngine.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/Data/Image.hpp"
+
+using namespace fast;
+
+static std::vector<uchar> createRandomData(int size) {
+    std::vector<uchar> data(size);
+    srand(0);
+    for(int i = 0; i < size; ++i)
+        data[i] = rand() % 200 + 20;
+    return data;
+}
+
+TEST_CASE("ReductionEngine on host calculates min, max, sum and histogram", "[fast][ReductionEngine]") {
+    std::vector<uchar> data = createRandomData(100001);
+    float minimum = 255, maximum = 0;
+    double sum = 0;
+    std::vector<uint64_t> histogram(256, 0);
+    for(uchar value : data) {
+        minimum = std::min(minimum, (float)value);
+        maximum = std::max(maximum, (float)value);
+        sum += value;
+        histogram[value]++;
+    }
+
+    HistogramOptions options;
+    options.bins = 256;
+    IntensityStatistics statistics = ReductionEngine::reduce(data.data(), data.size(), TYPE_UINT8, options);
+    CHECK(statistics.minimum == minimum);
+    CHECK(statistics.maximum == maximum);
+    CHECK(statistics.sum == sum);
+    CHECK(statistics.count == data.size());
+    CHECK(statistics.histogram == histogram);
+    CHECK(statistics.getPercentile(0) == Approx(minimum));
+    CHECK(statistics.getPercentile(100) == Approx(maximum));
+    CHECK_THROWS(ReductionEngine::reduce(data.data(), 0, TYPE_UINT8));
+}
+
+TEST_CASE("ReductionEngine gives the same result on OpenCL device as on host", "[fast][ReductionEngine]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance()->getDefaultComputationDevice();
+    std::vector<uchar> data = createRandomData(64*48*2);
+    HistogramOptions options;
+    options.bins = 64;
+    options.minimum = 0;
+    options.maximum = 256;
+    IntensityStatistics expected = ReductionEngine::reduce(data.data(), data.size(), TYPE_UINT8, options);
+
+    Image::pointer image = Image::New();
+    image->create(64, 48, TYPE_UINT8, 2, device, data.data());
+    ReductionEngine::pointer engine = ReductionEngine::getInstance(device);
+    {
+        OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
+        ReductionEngine::Result result = engine->reduce(*access->get2DImage(), 2, TYPE_UINT8, options);
+        IntensityStatistics statistics = result.get();
+        CHECK(result.isReady());
+        CHECK(statistics.minimum == expected.minimum);
+        CHECK(statistics.maximum == expected.maximum);
+        CHECK(statistics.sum == Approx(expected.sum));
+        CHECK(statistics.count == expected.count);
+        CHECK(statistics.histogram == expected.histogram);
+    }
+    {
+        // Range of the histogram is calculated on the device
+        options.minimum = options.maximum = 0;
+        OpenCLBufferAccess::pointer access = image->getOpenCLBufferAccess(ACCESS_READ, device);
+        IntensityStatistics statistics = engine->reduce(*access->get(), data.size(), TYPE_UINT8, options).get();
+        CHECK(statistics.minimum == expected.minimum);
+        CHECK(statistics.maximum == expected.maximum);
+        CHECK(statistics.histogramMinimum == 0);
+        CHECK(statistics.histogramMaximum == 256);
+    }
+}
+
+TEST_CASE("Image intensity statistics of 3D image on OpenCL device", "[fast][ReductionEngine]") {
+    OpenCLDevice::pointer device = DeviceManager::getInstance()->getDefaultComputationDevice();
+    std::vector<float> data(32*20*11);
+    for(int i = 0; i < data.size(); ++i)
+        data[i] = (float)(i % 101) - 50.0f;
+    Image::pointer image = Image::New();
+    image->create(32, 20, 11, TYPE_FLOAT, 1, device, data.data());
+
+    IntensityStatistics statistics = image->calculateIntensityStatistics(100);
+    CHECK(statistics.minimum == -50);
+    CHECK(statistics.maximum == 50);
+    CHECK(statistics.histogramMinimum == -50);
+    CHECK(statistics.histogramMaximum == 50);
+    CHECK(statistics.histogram.size() == 100);
+    CHECK(image->calculateMinimumIntensity() == -50);
+    CHECK(image->calculateMaximumIntensity() == 50);
+    IntensityStatistics expected = ReductionEngine::reduce(data.data(), data.size(), TYPE_FLOAT);
+    CHECK(image->calculateAverageIntensity() == Approx(expected.getAverage()));
+}
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+#include "FAST/Reporter.hpp"
+#include "FAST/Object.hpp"
+#include <thread>
+#include <fstream>
+
+using namespace fast;
+
+static int countEvaluations(int* evaluations) {
+    (*evaluations)++;
+    return *evaluations;
+}
+
+TEST_CASE("FAST_REPORT does not evaluate the message when the type is disabled", "[fast][Reporter]") {
+    Reporter reporter(Reporter::INFO);
+    reporter.setReportMethod(Reporter::INFO, Reporter::NONE);
+    int evaluations = 0;
+    CHECK(!reporter.isEnabled());
+    FAST_REPORT(reporter, "Evaluation " << countEvaluations(&evaluations));
+    CHECK(evaluations == 0);
+
+    reporter.setReportMethod(Reporter::INFO, Reporter::COUT);
+    CHECK(reporter.isEnabled());
+    FAST_REPORT(reporter, "Evaluation " << countEvaluations(&evaluations));
+    CHECK(evaluations == 1);
+}
+
+static std::string reportAndReturn(Reporter& reporter, std::string text) {
+    FAST_REPORT(reporter, "Nested message " << text);
+    return text;
+}
+
+TEST_CASE("Reporting a message while formatting another message keeps both messages", "[fast][Reporter]") {
+    const std::string filename = "reporter_nested_test.log";
+    std::remove(filename.c_str());
+    Reporter::setLogFilename(filename);
+
+    Reporter outer(Reporter::WARNING);
+    outer.setReportMethod(Reporter::LOG);
+    Reporter inner(Reporter::INFO);
+    inner.setReportMethod(Reporter::LOG);
+    FAST_REPORT(outer, "Outer message " << reportAndReturn(inner, "a") << " " << reportAndReturn(inner, "b"));
+    Reporter::flushLog();
+
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::getline(file, line);
+    CHECK(line.find("INFO: Nested message a") != std::string::npos);
+    std::getline(file, line);
+    CHECK(line.find("INFO: Nested message b") != std::string::npos);
+    std::getline(file, line);
+    CHECK(line.find("WARNING: Outer message a b") != std::string::npos);
+    file.close();
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Reporter with LOG method writes messages to log file", "[fast][Reporter]") {
+    const std::string filename = "reporter_test.log";
+    std::remove(filename.c_str());
+    Reporter::setLogFilename(filename);
+
+    Reporter reporter(Reporter::WARNING);
+    reporter.setReportMethod(Reporter::LOG);
+    reporter << "First message " << 1 << Reporter::end();
+    FAST_REPORT(reporter, "Second message " << 2);
+    Reporter::flushLog();
+
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::getline(file, line);
+    CHECK(line.find("WARNING: First message 1") != std::string::npos);
+    std::getline(file, line);
+    CHECK(line.find("WARNING: Second message 2") != std::string::npos);
+}
+
+class ReportingObject : public Object {
+    public:
+        void report(int thread, int i) {
+            FAST_REPORT(reportInfo(), "Thread " << thread << " message " << i << " end");
+        }
+};
+
+TEST_CASE("Two threads reporting for the same object at the same time get complete messages", "[fast][Reporter]") {
+    const std::string filename = "reporter_threads_test.log";
+    std::remove(filename.c_str());
+    Reporter::setLogFilename(filename);
+
+    ReportingObject object;
+    object.getReporter().setReportMethod(Reporter::LOG);
+    const int messages = 500;
+    std::thread first([&object]() {
+        for(int i = 0; i < messages; ++i)
+            object.report(0, i);
+    });
+    std::thread second([&object]() {
+        for(int i = 0; i < messages; ++i)
+            object.report(1, i);
+    });
+    first.join();
+    second.join();
+    Reporter::flushLog();
+
+    std::ifstream file(filename.c_str());
+    std::string line;
+    int lines = 0;
+    int completeLines = 0;
+    while(std::getline(file, line)) {
+        ++lines;
+        const std::size_t start = line.find("INFO: Thread ");
+        if(start != std::string::npos && line.find("INFO: ", start + 1) == std::string::npos &&
+                line.size() >= 4 && line.compare(line.size() - 4, 4, " end") == 0)
+            ++completeLines;
+    }
+    CHECK(lines == 2*messages);
+    CHECK(completeLines == 2*messages);
+    file.close();
+    std::remove(filename.c_str());
+}
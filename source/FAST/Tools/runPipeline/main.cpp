@@ -0,0 +1,181 @@
+#include "FAST/Pipeline.hpp"
+#include "FAST/PipelineBatchRunner.hpp"
+#include "FAST/DeviceManager.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Streamers/ImageFileStreamer.hpp"
+#include "FAST/Streamers/ManualImageStreamer.hpp"
+#include "FAST/Importers/ImageFileImporter.hpp"
+#include "FAST/Exporters/NullSink.hpp"
+#include "FAST/Exporters/StatisticsSink.hpp"
+#include "FAST/Exporters/StreamExporter.hpp"
+#include "FAST/Exporters/MetaImageExporter.hpp"
+#include "FAST/Exporters/VTKMeshFileExporter.hpp"
+#include <iostream>
+#include <mutex>
+
+using namespace fast;
+
+static void printUsage(std::string program) {
+    std::cout << "usage: " << program << " pipeline.fpl input [input ...] [options]\n"
+        "\n"
+        "Runs a pipeline file without a window or OpenGL context. Each input is an image file, or a\n"
+        "filename format such as /path/to/stream/image_#.mhd for a stream of images. Several inputs are\n"
+        "processed in parallel by separate instances of the pipeline.\n"
+        "\n"
+        "The renderers of the pipeline are replaced by sinks:\n"
+        "  --sink <renderer id>=null                      Discard the data\n"
+        "  --sink <renderer id>=statistics                Print statistics of the data (default)\n"
+        "  --sink <renderer id>=export:<filename format>  Export each frame to a .mhd, .vtk or .fmesh file.\n"
+        "      # is replaced by the frame number, @ by the input number and $ by the renderer input number\n"
+        "\n"
+        "Other options:\n"
+        "  --instances <n>  Nr of pipeline instances to run in parallel (default: nr of hardware threads)\n"
+        "  --reset          Create the pipeline again for each input\n"
+        "  --verbose        Print info messages from FAST\n";
+}
+
+static Streamer::pointer createStreamer(std::string input) {
+    if(input.find("#") != std::string::npos) {
+        ImageFileStreamer::pointer streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(input);
+        return streamer;
+    }
+
+    // A single image is streamed as one frame
+    ImageFileImporter::pointer importer = ImageFileImporter::New();
+    importer->setFilename(input);
+    DataPort::pointer port = importer->getOutputPort();
+    importer->update(0);
+    Image::pointer image = port->getNextFrame();
+    ManualImageStreamer::pointer streamer = ManualImageStreamer::New();
+    streamer->addImage(image);
+    return streamer;
+}
+
+static ProcessObject::pointer createExporter(std::string filenameFormat) {
+    SharedPointer<FileExporter> exporter;
+    const std::string extension = filenameFormat.substr(filenameFormat.rfind(".") + 1);
+    if(extension == "vtk" || extension == "fmesh") {
+        exporter = VTKMeshFileExporter::New();
+    } else if(extension == "mhd") {
+        exporter = MetaImageExporter::New();
+    } else {
+        throw Exception("No exporter found for the file extension " + extension);
+    }
+    if(filenameFormat.find("#") == std::string::npos)
+        throw Exception("Export filename format must contain #, which is replaced by the frame number");
+
+    StreamExporter::pointer streamExporter = StreamExporter::New();
+    streamExporter->setExporter(exporter);
+    streamExporter->setFilenameFormat(filenameFormat);
+    return streamExporter;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    if(arguments.size() < 2 || arguments[0] == "--help") {
+        printUsage(argv[0]);
+        return arguments.size() > 0 && arguments[0] == "--help" ? 0 : 1;
+    }
+
+    std::vector<std::string> inputs;
+    std::unordered_map<std::string, std::string> sinks;
+    int instances = 0;
+    bool reset = false;
+    bool verbose = false;
+    const std::string pipelineFilename = arguments[0];
+    for(int i = 1; i < arguments.size(); ++i) {
+        const std::string argument = arguments[i];
+        if(argument == "--sink" && i + 1 < arguments.size()) {
+            const std::string sink = arguments[++i];
+            const std::size_t separator = sink.find("=");
+            if(separator == std::string::npos) {
+                std::cout << "Invalid sink " << sink << ", expected <renderer id>=<sink>" << std::endl;
+                return 1;
+            }
+            sinks[sink.substr(0, separator)] = sink.substr(separator + 1);
+        } else if(argument == "--instances" && i + 1 < arguments.size()) {
+            instances = std::stoi(arguments[++i]);
+        } else if(argument == "--reset") {
+            reset = true;
+        } else if(argument == "--verbose") {
+            verbose = true;
+        } else if(argument.substr(0, 2) == "--") {
+            std::cout << "Unknown option " << argument << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(argument);
+        }
+    }
+    if(inputs.size() == 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Reporter::setGlobalReportMethod(Reporter::INFO, verbose ? Reporter::COUT : Reporter::NONE);
+    DeviceManager::setHeadless(true);
+
+    std::unordered_map<std::string, int> inputNumbers;
+    for(int i = 0; i < inputs.size(); ++i)
+        inputNumbers[inputs[i]] = i;
+
+    // Statistics sinks of the inputs which are being processed, and the reports of the finished inputs
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<std::pair<std::string, StatisticsSink::pointer>>> statisticsSinks;
+    std::vector<std::string> reports;
+
+    try {
+        PipelineBatchRunner::pointer runner = PipelineBatchRunner::New();
+        runner->setPipelineFilename(pipelineFilename);
+        runner->setRecordings(inputs);
+        runner->setStreamerFactory(createStreamer);
+        runner->setResetBetweenRecordings(reset);
+        if(instances > 0)
+            runner->setNrOfInstances(instances);
+
+        runner->setRecordingStartedCallback([&](std::string input, Pipeline& pipeline) {
+            for(std::string rendererID : pipeline.getSkippedRenderers()) {
+                const std::string sink = sinks.count(rendererID) > 0 ? sinks.at(rendererID) : "statistics";
+                pipeline.replaceRenderer(rendererID, [&](uint inputNr) -> ProcessObject::pointer {
+                    if(sink == "null")
+                        return NullSink::New();
+                    if(sink == "statistics") {
+                        StatisticsSink::pointer statistics = StatisticsSink::New();
+                        std::lock_guard<std::mutex> lock(mutex);
+                        statisticsSinks[input].push_back(std::make_pair(rendererID + " " + std::to_string(inputNr), statistics));
+                        return statistics;
+                    }
+                    if(sink.substr(0, 7) == "export:") {
+                        std::string filenameFormat = sink.substr(7);
+                        filenameFormat = replace(filenameFormat, "@", std::to_string(inputNumbers.at(input)));
+                        filenameFormat = replace(filenameFormat, "$", std::to_string(inputNr));
+                        return createExporter(filenameFormat);
+                    }
+                    throw Exception("Unknown sink " + sink + " for renderer " + rendererID);
+                });
+            }
+        });
+        runner->setRecordingFinishedCallback([&](std::string input, Pipeline& pipeline) {
+            // Release the sinks here, the pipeline replaces them for the next input
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto sink : statisticsSinks[input])
+                reports.push_back(input + " " + sink.first + ": " + sink.second->getReport());
+            statisticsSinks.erase(input);
+        });
+
+        BatchRunStatistics statistics = runner->run();
+
+        for(std::string report : reports)
+            std::cout << report << std::endl;
+        for(std::string input : statistics.failedRecordings)
+            std::cout << "Failed: " << input << std::endl;
+        std::cout << "Processed " << statistics.recordingsProcessed << " of " << inputs.size() << " inputs with " <<
+            statistics.framesProcessed << " frames in " << statistics.runtime << " seconds (" <<
+            statistics.framesPerSecond << " frames per second)" << std::endl;
+        return statistics.recordingsFailed > 0 ? 1 : 0;
+    } catch(Exception &e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
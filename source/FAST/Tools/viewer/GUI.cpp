@@ -1,4 +1,5 @@
 #include "GUI.hpp"
+#include "FAST/PipelineWidget.hpp"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
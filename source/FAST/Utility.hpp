@@ -61,27 +61,12 @@ T sign(T value) {
 
 FAST_EXPORT unsigned int getPowerOfTwoSize(unsigned int size);
 FAST_EXPORT void* allocateDataArray(unsigned int voxels, DataType type, unsigned int nrOfComponents);
-template <class T>
-float getSumFromOpenCLImageResult(void* voidData, unsigned int size, unsigned int nrOfComponents) {
-    T* data = (T*)voidData;
-    float sum = 0.0f;
-    for(unsigned int i = 0; i < size*nrOfComponents; i += nrOfComponents) {
-        sum += data[i];
-    }
-    return sum;
-}
-
-FAST_EXPORT void getMaxAndMinFromOpenCLImage(OpenCLDevice::pointer device, cl::Image2D image, DataType type, float* min, float* max);
-FAST_EXPORT void getMaxAndMinFromOpenCLImage(OpenCLDevice::pointer device, cl::Image3D image, DataType type, float* min, float* max);
-FAST_EXPORT void getMaxAndMinFromOpenCLBuffer(OpenCLDevice::pointer device, cl::Buffer buffer, unsigned int size, DataType type, float* min, float* max);
-FAST_EXPORT void getIntensitySumFromOpenCLImage(OpenCLDevice::pointer device, cl::Image2D image, DataType type, float* sum);
-
 template <class T>
 void getMaxAndMinFromData(void* voidData, unsigned int nrOfElements, float* min, float* max) {
     T* data = (T*)voidData;
 
     *min = std::numeric_limits<float>::max();
-    *max = std::numeric_limits<float>::min();
+    *max = std::numeric_limits<float>::lowest();
     for(unsigned int i = 0; i < nrOfElements; i++) {
         if((float)data[i] < *min) {
             *min = (float)data[i];
@@ -16,17 +16,23 @@ BoundingBoxRenderer::BoundingBoxRenderer() {
 }
 
 void BoundingBoxRenderer::execute() {
-    std::lock_guard<std::mutex> lock(mMutex);
+    if(mStop) {
+        return;
+    }
 
+    // Hand the bounding box of each input over to the rendering thread
     for(uint i = 0; i < getNrOfInputConnections(); ++i) {
         SpatialDataObject::pointer data = getInputData<SpatialDataObject>(i);
-        mBoxesToRender[i] = data->getTransformedBoundingBox();
+        mLatestBoxes[i] = data->getTransformedBoundingBox();
     }
+    mBoxBuffer.publish(mLatestBoxes);
 }
 
-void BoundingBoxRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
-    std::lock_guard<std::mutex> lock(mMutex);
+void BoundingBoxRenderer::preDraw() {
+    mBoxBuffer.consume(mBoxesToRender);
+}
 
+void BoundingBoxRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
     // Draw each bounding box
     std::unordered_map<uint, BoundingBox>::iterator it;
     glBegin(GL_LINES);
@@ -13,9 +13,14 @@ class FAST_EXPORT  BoundingBoxRenderer : public Renderer {
     private:
         BoundingBoxRenderer();
         void execute();
+        void preDraw() override;
         void draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D);
         BoundingBox getBoundingBox();
 
+        // Only used in execute
+        std::unordered_map<uint, BoundingBox> mLatestBoxes;
+        TripleBuffer<std::unordered_map<uint, BoundingBox>> mBoxBuffer;
+        // Only used in the rendering thread
         std::unordered_map<uint, BoundingBox> mBoxesToRender;
 };
 
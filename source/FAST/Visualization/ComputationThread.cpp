@@ -47,20 +47,14 @@ void ComputationThread::run() {
             emit timestepIncreased();
         }
         //std::cout << "TIMESTEP: " << mTimestep << std::endl;
-        // Update renderers' input before lock mutexes. This will ensure that renderering can happen while computing
         for(View* view : mViews) {
             view->updateRenderersInput(mTimestep, mStreamingMode);
         }
-        // Lock mutex of all renderers before update renderers. This will ensure that rendering is synchronized.
-        for(View* view : mViews) {
-            //view->lockRenderers();
-        }
+        // Hand the new data over to the renderers. This never waits for the views to paint, the views
+        // will draw the latest data they have received at their own framerate.
         for(View* view : mViews) {
             view->updateRenderers(mTimestep, mStreamingMode);
         }
-        for(View* view : mViews) {
-            //view->unlockRenderers();
-        }
         std::unique_lock<std::mutex> lock(mUpdateThreadMutex); // this locks the mutex
         if(mUpdateThreadIsStopped) {
             // Move GL context back to main thread
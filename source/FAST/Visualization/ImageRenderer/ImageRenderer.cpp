@@ -63,6 +63,11 @@ void ImageRenderer::loadAttributes() {
 void ImageRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
     std::lock_guard<std::mutex> lock(mMutex);
 
+    createTextures();
+    drawTextures(perspectiveMatrix, viewingMatrix, mode2D);
+}
+
+void ImageRenderer::createTextures() {
     for(auto it : mDataToRender) {
         Image::pointer input = it.second;
         uint inputNr = it.first;
@@ -180,9 +185,6 @@ void ImageRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, boo
         mTexturesToRender[inputNr] = textureID;
         mImageUsed[inputNr] = input;
     }
-
-    drawTextures(perspectiveMatrix, viewingMatrix, mode2D);
-
 }
 
 void ImageRenderer::drawTextures(Matrix4f &perspectiveMatrix, Matrix4f &viewingMatrix, bool mode2D) {
@@ -28,6 +28,10 @@ class FAST_EXPORT  ImageRenderer : public Renderer {
         float mWindow;
         float mLevel;
 
+        /**
+         * Create textures of the images to render which have changed. Must be called in the rendering thread.
+         */
+        void createTextures();
         void drawTextures(Matrix4f &perspectiveMatrix, Matrix4f &viewingMatrix, bool mode2D);
 };
 
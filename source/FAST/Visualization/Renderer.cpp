@@ -6,6 +6,10 @@
 namespace fast {
 
 Renderer::Renderer() {
+    // Renderers must use the device which shares the OpenGL context
+    mDeviceSchedulingAllowed = false;
+    // Programs are built in the rendering thread, while the input data is updated in the computation thread
+    mImageTypeDefinesEnabled = false;
 }
 
 
@@ -23,45 +27,34 @@ uint Renderer::addInputConnection(DataPort::pointer port) {
     return nr;
 }
 
-void Renderer::lock() {
-    mMutex.lock();
-}
-
-void Renderer::unlock() {
-    mMutex.unlock();
-}
-
 void Renderer::stopPipeline() {
     mStop = true;
-    mHasRendered = true;
-    mRenderedCV.notify_one();
     ProcessObject::stopPipeline();
 }
 
+void Renderer::preDraw() {
+    mInputBuffer.consume(mDataToRender);
+}
+
 void Renderer::postDraw() {
-    mHasRendered = true;
-    mRenderedCV.notify_one();
 }
 
 void Renderer::execute() {
-    std::unique_lock<std::mutex> lock(mMutex);
     if(mStop) {
         return;
     }
 
-    // Check if current images has not been rendered, if not wait
-    while(!mHasRendered) {
-        mRenderedCV.wait(lock);
-    }
-    // This simply gets the input data for each connection and puts it into a data structure
+    // This simply gets the input data for each connection and hands it over to the rendering thread.
+    // If the previous data has not been rendered yet, it is replaced.
+    bool hasNewData = false;
     for(uint inputNr = 0; inputNr < getNrOfInputConnections(); inputNr++) {
         if(hasNewInputData(inputNr)) {
-            SpatialDataObject::pointer input = getInputData<SpatialDataObject>(inputNr);
-
-            mHasRendered = false;
-            mDataToRender[inputNr] = input;
+            mLatestInputData[inputNr] = getInputData<SpatialDataObject>(inputNr);
+            hasNewData = true;
         }
     }
+    if(hasNewData)
+        mInputBuffer.publish(mLatestInputData);
 }
 
 BoundingBox Renderer::getBoundingBox(bool transform) {
@@ -226,7 +219,6 @@ int Renderer::getShaderUniformLocation(std::string name, std::string shaderProgr
 
 void Renderer::reset() {
     mStop = false;
-    mHasRendered = false;
 }
 
 }
@@ -5,7 +5,9 @@
 #include "FAST/ProcessObject.hpp"
 #include "FAST/Data/BoundingBox.hpp"
 #include "FAST/Data/SpatialDataObject.hpp"
+#include "TripleBuffer.hpp"
 #include <mutex>
+#include <atomic>
 #include <QOpenGLFunctions_3_3_Core>
 
 
@@ -17,6 +19,10 @@ class BoundingBox;
 class FAST_EXPORT  Renderer : public ProcessObject, protected QOpenGLFunctions_3_3_Core {
     public:
         typedef SharedPointer<Renderer> pointer;
+        /**
+         * Take the latest input data handed over by execute. Called in the rendering thread before draw.
+         */
+        virtual void preDraw();
         virtual void draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) = 0;
         virtual void postDraw();
         /**
@@ -64,25 +70,24 @@ class FAST_EXPORT  Renderer : public ProcessObject, protected QOpenGLFunctions_3
         void setShaderUniform(std::string name, int value, std::string shaderProgramName = "default");
         int getShaderUniformLocation(std::string name, std::string shaderProgramName = "default");
 
-        // Locking mechanisms to ensure thread safe synchronized rendering
-        bool mHasRendered = true;
-        bool mStop = false;
-        std::condition_variable_any mRenderedCV;
+        // Protects the renderer settings from being changed while they are used
         std::mutex mMutex;
+        std::atomic<bool> mStop = {false};
 
         /**
-         * This holds the current data to render for each input connection
+         * This holds the current data to render for each input connection. Only used in the rendering thread.
          */
         std::unordered_map<uint, SpatialDataObject::pointer> mDataToRender;
-
         /**
-         * This will lock the renderer mutex. Used by the compute thread.
+         * Hands the latest data of each input connection over from execute to the rendering thread, so that
+         * the computation thread never has to wait for the data to be rendered, and rendering never has to wait
+         * for the computation.
          */
-        void lock();
+        TripleBuffer<std::unordered_map<uint, SpatialDataObject::pointer>> mInputBuffer;
         /**
-         * This will unlock the renderer mutex. Used by the compute thread.
+         * The latest data of each input connection. Only used in execute.
          */
-        void unlock();
+        std::unordered_map<uint, SpatialDataObject::pointer> mLatestInputData;
         friend class View;
     private:
 
@@ -0,0 +1,78 @@
+__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP | CLK_FILTER_NEAREST;
+
+float4 readVoxelAsFloat(__read_only image3d_t volume, int4 pos) {
+    int dataType = get_image_channel_data_type(volume);
+    if(dataType == CLK_FLOAT) {
+        return read_imagef(volume, sampler, pos);
+    } else if(dataType == CLK_SIGNED_INT8 || dataType == CLK_SIGNED_INT16) {
+        return convert_float4(read_imagei(volume, sampler, pos));
+    } else {
+        return convert_float4(read_imageui(volume, sampler, pos));
+    }
+}
+
+/*
+ * Apply level and window to an orthogonal slice of the volume and write it to the texture.
+ * The slice has the same orientation as the output of ImageSlicer, and the texture is flipped like in ImageRenderer.
+ */
+void renderSlice(
+        __read_only image3d_t volume,
+        __write_only image2d_t texture,
+        int slicePlane,
+        int slice,
+        float level,
+        float window
+        ) {
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if(x >= get_image_width(texture) || y >= get_image_height(texture))
+        return;
+
+    int4 pos;
+    if(slicePlane == 0) {
+        pos = (int4)(slice,x,y,0);
+    } else if(slicePlane == 1) {
+        pos = (int4)(x,slice,y,0);
+    } else {
+        pos = (int4)(x,y,slice,0);
+    }
+
+    float4 value = readVoxelAsFloat(volume, pos);
+    if(get_image_channel_order(volume) == CLK_R) {
+        value.y = value.x;
+        value.z = value.x;
+    }
+
+    value = (value - level + window/2) / window;
+    value = clamp(value, 0.0f, 1.0f);
+    value.w = 1.0f;
+    write_imagef(texture, (int2)(x,get_image_height(texture) - y - 1), value);
+}
+
+/*
+ * Render up to three orthogonal slices of the same volume in one launch. The third dimension of the global size
+ * is the nr of slices, and the first two must cover the largest slice.
+ */
+__kernel void renderOrthogonalSlicesToTextures(
+        __read_only image3d_t volume,
+        __write_only image2d_t texture0,
+        __write_only image2d_t texture1,
+        __write_only image2d_t texture2,
+        __private int slicePlane0,
+        __private int slice0,
+        __private int slicePlane1,
+        __private int slice1,
+        __private int slicePlane2,
+        __private int slice2,
+        __private float level,
+        __private float window
+        ) {
+    const int i = get_global_id(2);
+    if(i == 0) {
+        renderSlice(volume, texture0, slicePlane0, slice0, level, window);
+    } else if(i == 1) {
+        renderSlice(volume, texture1, slicePlane1, slice1, level, window);
+    } else {
+        renderSlice(volume, texture2, slicePlane2, slice2, level, window);
+    }
+}
@@ -11,48 +11,191 @@ namespace fast {
 
 
 void SliceRenderer::execute() {
-    std::unique_lock<std::mutex> lock(mMutex);
     if(mStop) {
         return;
     }
 
-    // Check if current images has not been rendered, if not wait
-    while(!mHasRendered) {
-        mRenderedCV.wait(lock);
-    }
-    // This simply gets the input data for each connection and puts it into a data structure
+    std::lock_guard<std::mutex> lock(mMutex);
     for(uint inputNr = 0; inputNr < getNrOfInputConnections(); inputNr++) {
         if(hasNewInputData(inputNr)) {
-            SpatialDataObject::pointer input = getInputData<SpatialDataObject>(inputNr);
-
-            // Get slicer and execute it on new input data
-            ImageSlicer::pointer slicer;
-            if(mSlicers.count(inputNr) == 0) {
-                slicer = ImageSlicer::New();
-                slicer->setOrthogonalSlicePlane(PLANE_X);
-            } else {
-                slicer = mSlicers.at(inputNr);
-            }
-            slicer->setInputData(input);
+            mVolumes[inputNr] = getInputData<Image>(inputNr);
+            mModifiedSlices.insert(inputNr);
+        }
+    }
+
+    // Only slice the ports where the volume or the slice plane has changed
+    bool hasNewSlices = false;
+    for(uint inputNr : mModifiedSlices) {
+        if(mVolumes.count(inputNr) == 0)
+            continue;
+        Image::pointer volume = mVolumes[inputNr];
+        if(volume->getDimensions() != 3)
+            throw Exception("The SliceRenderer only supports 3D images");
+
+        Slice& slice = mLatestSlices[inputNr];
+        slice.volume = volume;
+        if(mOrthogonalSlicePlanes.count(inputNr) > 0) {
+            // Only the size and transformation of the slice is needed here, it is rendered directly from the volume
+            slice.image = Image::New();
+            slice.plane = mOrthogonalSlicePlanes[inputNr];
+            slice.sliceNr = ImageSlicer::createOrthogonalSlice(volume, slice.image,
+                    slice.plane, mOrthogonalSliceNrs[inputNr]);
+        } else {
+            ImageSlicer::pointer slicer = mSlicers.at(inputNr);
+            slicer->setInputData(volume);
             DataPort::pointer port = slicer->getOutputPort();
             slicer->update(0);
+            slice.image = port->getNextFrame();
+            slice.sliceNr = -1;
+        }
+        hasNewSlices = true;
+    }
+    mModifiedSlices.clear();
+    if(hasNewSlices)
+        mSliceBuffer.publish(mLatestSlices);
+}
+
+void SliceRenderer::preDraw() {
+    if(!mSliceBuffer.consume(mSlices))
+        return;
+    for(auto& it : mSlices)
+        mDataToRender[it.first] = it.second.image;
+}
+
+void SliceRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
+    // The slices are only changed by preDraw, so the mutex is not needed here. This ensures that rendering
+    // never waits for the slicing in execute.
+    renderOrthogonalSlices();
+    createTextures();
+    drawTextures(perspectiveMatrix, viewingMatrix, mode2D);
+}
+
+void SliceRenderer::renderOrthogonalSlices() {
+    // Orthogonal slices which have not been rendered to their texture yet
+    std::vector<uint> slicesToRender;
+    for(auto& it : mSlices) {
+        const uint inputNr = it.first;
+        if(it.second.sliceNr >= 0 && (mImageUsed.count(inputNr) == 0 || !(mImageUsed[inputNr] == it.second.image)))
+            slicesToRender.push_back(inputNr);
+    }
+    if(slicesToRender.empty())
+        return;
+
+    OpenCLDevice::pointer device = getMainDevice();
+    cl::CommandQueue queue = device->getCommandQueue();
+    cl::Kernel kernel(getOpenCLProgram(device, "slices"), "renderOrthogonalSlicesToTextures");
+
+    // Group the slices by volume, so that up to three slices of the same volume are rendered in one launch
+    std::unordered_map<Image*, std::vector<uint>> slicesOfVolume;
+    for(uint inputNr : slicesToRender)
+        slicesOfVolume[mSlices[inputNr].volume.get()].push_back(inputNr);
+
+    // The accesses must be kept until the kernels have finished
+    std::vector<OpenCLImageAccess::pointer> accesses;
+    for(auto& group : slicesOfVolume) {
+        const std::vector<uint>& inputNrs = group.second;
+        Image::pointer volume = mSlices[inputNrs[0]].volume;
+
+        // If mWindow/mLevel is equal to -1 use default level/window values
+        float window = mWindow;
+        float level = mLevel;
+        if(window == -1) {
+            window = getDefaultIntensityWindow(volume->getDataType());
+        }
+        if(level == -1) {
+            level = getDefaultIntensityLevel(volume->getDataType());
+        }
 
-            mHasRendered = false;
-            mDataToRender[inputNr] = port->getNextFrame();
+        accesses.push_back(volume->getOpenCLImageAccess(ACCESS_READ, device));
+        kernel.setArg(0, *accesses.back()->get3DImage());
+        kernel.setArg(10, level);
+        kernel.setArg(11, window);
+        for(int start = 0; start < inputNrs.size(); start += 3) {
+            const int count = std::min((int)inputNrs.size() - start, 3);
+            uint maxWidth = 0;
+            uint maxHeight = 0;
+            for(int i = 0; i < 3; i++) {
+                // Arguments of unused slices are set to the last slice, they are not written to
+                const uint inputNr = inputNrs[start + std::min(i, count - 1)];
+                Image::pointer slice = mSlices[inputNr].image;
+                // Reuse the image from the previous frame if the size is the same
+                if(mSliceImages.count(inputNr) == 0 ||
+                        mSliceImages[inputNr].getImageInfo<CL_IMAGE_WIDTH>() != slice->getWidth() ||
+                        mSliceImages[inputNr].getImageInfo<CL_IMAGE_HEIGHT>() != slice->getHeight()) {
+                    mSliceImages[inputNr] = cl::Image2D(
+                            device->getContext(),
+                            CL_MEM_READ_WRITE,
+                            cl::ImageFormat(CL_RGBA, CL_FLOAT),
+                            slice->getWidth(), slice->getHeight()
+                    );
+                }
+                kernel.setArg(1 + i, mSliceImages[inputNr]);
+                kernel.setArg(4 + i*2, (int)mSlices[inputNr].plane);
+                kernel.setArg(5 + i*2, mSlices[inputNr].sliceNr);
+                maxWidth = std::max(maxWidth, slice->getWidth());
+                maxHeight = std::max(maxHeight, slice->getHeight());
+            }
+            queue.enqueueNDRangeKernel(
+                    kernel,
+                    cl::NullRange,
+                    cl::NDRange(maxWidth, maxHeight, count),
+                    cl::NullRange
+            );
         }
     }
+
+    // Copy the slices to the OpenGL textures
+    for(uint inputNr : slicesToRender) {
+        Image::pointer slice = mSlices[inputNr].image;
+        const uint width = slice->getWidth();
+        const uint height = slice->getHeight();
+        mTextureData.resize(width*height*4);
+        queue.enqueueReadImage(
+                mSliceImages[inputNr],
+                CL_TRUE,
+                createOrigoRegion(),
+                createRegion(width, height, 1),
+                0, 0,
+                mTextureData.data()
+        );
+
+        if(mTexturesToRender.count(inputNr) > 0 &&
+                mImageUsed[inputNr]->getWidth() == width && mImageUsed[inputNr]->getHeight() == height) {
+            // Update the existing texture
+            glBindTexture(GL_TEXTURE_2D, mTexturesToRender[inputNr]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, mTextureData.data());
+        } else {
+            if(mTexturesToRender.count(inputNr) > 0) {
+                // Delete old texture
+                glDeleteTextures(1, &mTexturesToRender[inputNr]);
+                mTexturesToRender.erase(inputNr);
+                glDeleteVertexArrays(1, &mVAO[inputNr]);
+                mVAO.erase(inputNr);
+            }
+            GLuint textureID;
+            glGenTextures(1, &textureID);
+            glBindTexture(GL_TEXTURE_2D, textureID);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, mTextureData.data());
+            mTexturesToRender[inputNr] = textureID;
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        mImageUsed[inputNr] = slice;
+    }
 }
 
 
 SliceRenderer::SliceRenderer() {
     createInputPort<Image>(0, false);
+    createOpenCLProgram(Config::getKernelSourcePath() + "/Visualization/SliceRenderer/SliceRenderer.cl", "slices");
     mIsModified = true;
 }
 
 uint SliceRenderer::addInputConnection(DataPort::pointer port, PlaneType orthogonalSlicePlane, int sliceNr) {
     uint portID = Renderer::addInputConnection(port);
-    mSlicers[portID] = ImageSlicer::New();
-    mSlicers[portID]->setOrthogonalSlicePlane(orthogonalSlicePlane, sliceNr);
+    mOrthogonalSlicePlanes[portID] = orthogonalSlicePlane;
+    mOrthogonalSliceNrs[portID] = sliceNr;
     return portID;
 }
 
@@ -70,18 +213,31 @@ uint SliceRenderer::addInputConnection(DataPort::pointer port, SharedPointer<Ima
 }
 
 void SliceRenderer::setOrthogonalSlicePlane(uint portID, PlaneType orthogonalSlicePlane, int sliceNr) {
-    mSlicers.at(portID)->setOrthogonalSlicePlane(orthogonalSlicePlane, sliceNr);
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(portID >= getNrOfInputConnections())
+        throw Exception("Port " + std::to_string(portID) + " does not exist in SliceRenderer");
+    mSlicers.erase(portID);
+    mOrthogonalSlicePlanes[portID] = orthogonalSlicePlane;
+    mOrthogonalSliceNrs[portID] = sliceNr;
+    mModifiedSlices.insert(portID);
+    mIsModified = true;
 }
 
 void SliceRenderer::setArbitrarySlicePlane(uint portID, Plane slicePlane) {
-    mSlicers.at(portID)->setArbitrarySlicePlane(slicePlane);
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(portID >= getNrOfInputConnections())
+        throw Exception("Port " + std::to_string(portID) + " does not exist in SliceRenderer");
+    if(mSlicers.count(portID) == 0)
+        mSlicers[portID] = ImageSlicer::New();
+    mSlicers[portID]->setArbitrarySlicePlane(slicePlane);
+    mOrthogonalSlicePlanes.erase(portID);
+    mOrthogonalSliceNrs.erase(portID);
+    mModifiedSlices.insert(portID);
+    mIsModified = true;
 }
 
 uint SliceRenderer::addInputConnection(DataPort::pointer port) {
-    uint portID =  Renderer::addInputConnection(port);
-    mSlicers[portID] = ImageSlicer::New();
-    mSlicers[portID]->setOrthogonalSlicePlane(PLANE_X);
-    return portID;
+    return addInputConnection(port, PLANE_X);
 }
 
 
@@ -5,11 +5,20 @@
 #include <FAST/Visualization/ImageRenderer/ImageRenderer.hpp>
 #include "FAST/Visualization/Renderer.hpp"
 #include "FAST/Data/Image.hpp"
+#include <unordered_set>
 
 namespace fast {
 
 class ImageSlicer;
 
+/**
+ * Renders slices of 3D images.
+ *
+ * Orthogonal slices are rendered directly from the volume to the texture, without creating a 2D image. Slices of
+ * the same volume are rendered in one kernel launch, and a slice is only rendered again when the volume or the
+ * slice plane changes, so that scrolling through the slices of a volume only requires one small kernel launch.
+ * Arbitrary slices and slices using a supplied slicer are extracted with an ImageSlicer for each port.
+ */
 class FAST_EXPORT  SliceRenderer : public ImageRenderer {
     FAST_OBJECT(SliceRenderer)
     public:
@@ -41,8 +50,41 @@ class FAST_EXPORT  SliceRenderer : public ImageRenderer {
     private:
         SliceRenderer();
         void execute() override;
+        void preDraw() override;
+        void draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) override;
+        /**
+         * Render the orthogonal slices which have changed to their textures
+         */
+        void renderOrthogonalSlices();
+
+        // Slice of a port, and for orthogonal slices the volume, plane and slice nr to render it from
+        struct Slice {
+            Image::pointer image;
+            Image::pointer volume;
+            PlaneType plane;
+            // -1 if the slice is not orthogonal
+            int sliceNr;
+        };
 
+        // The members below are used by execute, and protected by the mutex
         std::unordered_map<uint, SharedPointer<ImageSlicer>> mSlicers;
+        // Plane and slice nr of each port with orthogonal slicing
+        std::unordered_map<uint, PlaneType> mOrthogonalSlicePlanes;
+        std::unordered_map<uint, int> mOrthogonalSliceNrs;
+        // Current volume of each port
+        std::unordered_map<uint, Image::pointer> mVolumes;
+        // Ports which have to be sliced again, because the volume or the slice plane has changed
+        std::unordered_set<uint> mModifiedSlices;
+        std::unordered_map<uint, Slice> mLatestSlices;
+
+        // Hands the slices over to the rendering thread
+        TripleBuffer<std::unordered_map<uint, Slice>> mSliceBuffer;
+
+        // The members below are only used in the rendering thread
+        std::unordered_map<uint, Slice> mSlices;
+        // OpenCL images the orthogonal slices are rendered to, kept between frames
+        std::unordered_map<uint, cl::Image2D> mSliceImages;
+        std::vector<float> mTextureData;
 };
 
 }
@@ -126,3 +126,19 @@ TEST_CASE("Setting slice nr in SliceRenderer too high should not throw exception
         window->start();
     );
 }
+
+TEST_CASE("SliceRenderer with three orthogonal slices of the same volume", "[fast][SliceRenderer][visual]") {
+    ImageFileStreamer::pointer mhdStreamer = ImageFileStreamer::New();
+    mhdStreamer->setFilenameFormat(Config::getTestDataPath()+"US/Ball/US-3Dt_#.mhd");
+    CHECK_NOTHROW(
+        SliceRenderer::pointer renderer = SliceRenderer::New();
+        renderer->addInputConnection(mhdStreamer->getOutputPort(), PLANE_X);
+        renderer->addInputConnection(mhdStreamer->getOutputPort(), PLANE_Y);
+        uint portID = renderer->addInputConnection(mhdStreamer->getOutputPort(), PLANE_Z);
+        renderer->setOrthogonalSlicePlane(portID, PLANE_Z, 10);
+        SimpleWindow::pointer window = SimpleWindow::New();
+        window->addRenderer(renderer);
+        window->setTimeout(1000);
+        window->start();
+    );
+}
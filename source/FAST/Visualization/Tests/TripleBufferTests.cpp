@@ -0,0 +1,56 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Visualization/TripleBuffer.hpp"
+#include <thread>
+
+using namespace fast;
+
+TEST_CASE("TripleBuffer gives the consumer the latest published value", "[fast][TripleBuffer]") {
+    TripleBuffer<int> buffer;
+    int value = -1;
+    CHECK(buffer.hasNewValue() == false);
+    CHECK(buffer.consume(value) == false);
+    CHECK(value == -1);
+
+    buffer.publish(1);
+    CHECK(buffer.hasNewValue() == true);
+    CHECK(buffer.consume(value) == true);
+    CHECK(value == 1);
+    CHECK(buffer.consume(value) == false);
+    CHECK(value == 1);
+
+    // Values which are not consumed are replaced
+    buffer.publish(2);
+    buffer.publish(3);
+    buffer.publish(4);
+    CHECK(buffer.consume(value) == true);
+    CHECK(value == 4);
+    CHECK(buffer.consume(value) == false);
+}
+
+TEST_CASE("TripleBuffer with producer and consumer in different threads", "[fast][TripleBuffer]") {
+    TripleBuffer<std::vector<int>> buffer;
+    const int nrOfValues = 100000;
+    std::thread producer([&buffer, nrOfValues]() {
+        for(int i = 1; i <= nrOfValues; ++i)
+            buffer.publish(std::vector<int>(4, i));
+    });
+
+    // The consumer must never see a partially written value, and the values must be increasing
+    std::vector<int> value(4, 0);
+    int previous = 0;
+    bool valid = true;
+    while(previous < nrOfValues) {
+        if(buffer.consume(value)) {
+            for(int element : value) {
+                if(element != value[0])
+                    valid = false;
+            }
+            if(value[0] <= previous)
+                valid = false;
+            previous = value[0];
+        }
+    }
+    producer.join();
+    CHECK(valid);
+    CHECK(previous == nrOfValues);
+}
@@ -29,24 +29,24 @@ void TextRenderer::setView(View* view) {
 }
 
 void TextRenderer::execute() {
-    std::unique_lock<std::mutex> lock(mMutex);
     if(mStop) {
         return;
     }
 
-    // Check if current images has not been rendered, if not wait
-    while(!mHasRendered) {
-        mRenderedCV.wait(lock);
-    }
-    // This simply gets the input data for each connection and puts it into a data structure
+    // This simply gets the input data for each connection and hands it over to the rendering thread
+    bool hasNewData = false;
     for(uint inputNr = 0; inputNr < getNrOfInputConnections(); inputNr++) {
         if(hasNewInputData(inputNr)) {
-            DataObject::pointer input = getInputData<DataObject>(inputNr);
-
-            mHasRendered = false;
-            mDataToRender[inputNr] = input;
+            mLatestTexts[inputNr] = getInputData<DataObject>(inputNr);
+            hasNewData = true;
         }
     }
+    if(hasNewData)
+        mTextBuffer.publish(mLatestTexts);
+}
+
+void TextRenderer::preDraw() {
+    mTextBuffer.consume(mDataToRender);
 }
 
 void TextRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
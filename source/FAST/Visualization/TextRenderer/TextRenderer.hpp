@@ -33,6 +33,7 @@ class FAST_EXPORT  TextRenderer : public Renderer {
         void setFontSize(uint fontSize);
         void setColor(Color color);
         void setStyle(TextStyleType);
+        void preDraw() override;
         void draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) override;
         void loadAttributes();
     private:
@@ -45,6 +46,8 @@ class FAST_EXPORT  TextRenderer : public Renderer {
         std::unordered_map<uint, Text::pointer> mTextUsed;
         std::unordered_map<uint, uint> mVAO;
         std::unordered_map<uint, DataObject::pointer> mDataToRender;
+        TripleBuffer<std::unordered_map<uint, DataObject::pointer>> mTextBuffer;
+        std::unordered_map<uint, DataObject::pointer> mLatestTexts;
 
         Color mColor;
         uint mFontSize;
@@ -0,0 +1,62 @@
+#ifndef TRIPLE_BUFFER_HPP_
+#define TRIPLE_BUFFER_HPP_
+
+#include <atomic>
+
+namespace fast {
+
+/**
+ * Lock free handoff of the latest value from one producer thread to one consumer thread.
+ *
+ * The producer writes to a back buffer and publishes it by swapping it with the latest buffer, and the consumer
+ * takes the latest buffer by swapping it with its front buffer. Neither side ever waits for the other. If the
+ * producer publishes several values before the consumer takes one, only the last is seen by the consumer.
+ */
+template <class T>
+class TripleBuffer {
+    public:
+        TripleBuffer() : mLatest(1), mBack(0), mFront(2) {};
+        /**
+         * Publish a value. Only to be called by the producer thread.
+         * @param value
+         */
+        void publish(const T& value) {
+            mBuffers[mBack] = value;
+            mBack = mLatest.exchange(mBack | NEW_VALUE) & INDEX_MASK;
+        }
+        /**
+         * Take the latest published value, if there is a new one. Only to be called by the consumer thread.
+         * @param value is set to the latest value if there is a new one, otherwise it is not changed
+         * @return true if there was a new value
+         */
+        bool consume(T& value) {
+            if(!hasNewValue())
+                return false;
+            mFront = mLatest.exchange(mFront) & INDEX_MASK;
+            value = mBuffers[mFront];
+            // Release the references held by the front buffer
+            mBuffers[mFront] = T();
+            return true;
+        }
+        /**
+         * @return true if a value has been published which the consumer has not taken yet
+         */
+        bool hasNewValue() const {
+            return (mLatest.load() & NEW_VALUE) != 0;
+        }
+    private:
+        static const int INDEX_MASK = 3;
+        static const int NEW_VALUE = 4;
+
+        T mBuffers[3];
+        // Index of the latest buffer, and whether it has been published after the last consume
+        std::atomic<int> mLatest;
+        // Only used by the producer
+        int mBack;
+        // Only used by the consumer
+        int mFront;
+};
+
+}
+
+#endif
@@ -78,10 +78,13 @@ View::View() {
     mAutoUpdateCamera = false;
 
     mFramerate = 60;
-    // Set up a timer that will call update on this object at a regular interval
+    // Set up a timer that will call update on this object at a regular interval.
+    // The renderers always draw the latest data they have received, so the painting is paced by this timer only,
+    // and never by the computation thread.
     timer = new QTimer(this);
-    timer->start(1000/mFramerate); // in milliseconds
+    timer->setTimerType(Qt::PreciseTimer);
     timer->setSingleShot(false);
+    timer->start(getFrameInterval(mFramerate)); // in milliseconds
     connect(timer,SIGNAL(timeout()),this,SLOT(update()));
 
 	NonVolumesTurn=true;
@@ -156,9 +159,12 @@ void View::setMaximumFramerate(unsigned int framerate) {
         throw Exception("Framerate cannot be 0.");
 
     mFramerate = framerate;
-    timer->stop();
-    timer->start(1000/mFramerate); // in milliseconds
-    timer->setSingleShot(false);
+    timer->start(getFrameInterval(mFramerate)); // in milliseconds
+}
+
+int View::getFrameInterval(unsigned int framerate) {
+    // Round up, so that the framerate never exceeds the maximum
+    return (1000 + framerate - 1) / framerate;
 }
 
 void View::execute() {
@@ -198,15 +204,6 @@ void View::updateRenderers(uint64_t timestep, StreamingMode mode) {
     }
 }
 
-void View::lockRenderers() {
-    for(Renderer::pointer renderer : mNonVolumeRenderers) {
-        renderer->lock();
-    }
-    for(Renderer::pointer renderer : mVolumeRenderers) {
-        renderer->lock();
-    }
-}
-
 void View::stopRenderers() {
     for(Renderer::pointer renderer : mNonVolumeRenderers) {
         renderer->stopPipeline();
@@ -216,15 +213,6 @@ void View::stopRenderers() {
     }
 }
 
-void View::unlockRenderers() {
-    for(Renderer::pointer renderer : mNonVolumeRenderers) {
-        renderer->unlock();
-    }
-    for(Renderer::pointer renderer : mVolumeRenderers) {
-        renderer->unlock();
-    }
-}
-
 void View::getMinMaxFromBoundingBoxes(bool transform, Vector3f& min, Vector3f& max) {
     // Get bounding boxes of all objects
     BoundingBox box = mNonVolumeRenderers[0]->getBoundingBox(transform);
@@ -490,8 +478,10 @@ void View::initializeGL() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     // Update all renderes, so that getBoundingBox works
-    for(unsigned int i = 0; i < mNonVolumeRenderers.size(); i++)
+    for(unsigned int i = 0; i < mNonVolumeRenderers.size(); i++) {
         mNonVolumeRenderers[i]->update(0, mStreamingMode);
+        mNonVolumeRenderers[i]->preDraw();
+    }
     if(mNonVolumeRenderers.size() == 0)
         return;
     if(mIsIn2DMode) {
@@ -522,6 +512,11 @@ void View::paintGL() {
     glClearColor(mBackgroundColor.getRedValue(), mBackgroundColor.getGreenValue(), mBackgroundColor.getBlueValue(), 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // Take the latest data of each renderer. The computation thread may replace it while drawing,
+    // which will be drawn in the next frame.
+    for(auto renderer : getRenderers())
+        renderer->preDraw();
+
     if(mAutoUpdateCamera) {
         // If bounding box has changed, recalculate camera
         Vector3f min, max;
@@ -555,7 +550,7 @@ void View::paintGL() {
         mRuntimeManager->stopRegularTimer("draw");
     }
 
-    glFinish();
+    // No glFinish here, the buffer swap will wait for the drawing to finish if needed
 	mRuntimeManager->stopRegularTimer("paint");
 }
 
@@ -70,6 +70,10 @@ class FAST_EXPORT  View : public QGLWidget, public ProcessObject {
 		Matrix4f mPerspectiveMatrix;
 
         void execute();
+        /**
+         * @return the nr of milliseconds between each paint for the given framerate
+         */
+        static int getFrameInterval(unsigned int framerate);
         QTimer* timer;
         unsigned int mFramerate;
        
@@ -103,8 +107,6 @@ class FAST_EXPORT  View : public QGLWidget, public ProcessObject {
         void resizeGL(int width, int height);
 		void updateRenderersInput(uint64_t timestep, StreamingMode mode);
 		void updateRenderers(uint64_t timestep, StreamingMode mode);
-		void lockRenderers();
-		void unlockRenderers();
 		void stopRenderers();
 		void resetRenderers();
 
@@ -0,0 +1,361 @@
+/*
+ * Copyright 1993-2010 NVIDIA Corporation.  All rights reserved.
+ *
+ * Please refer to the NVIDIA end user license agreement (EULA) associated
+ * with this source code for terms and conditions that govern your use of
+ * this software. Any use, reproduction, disclosure, or distribution of
+ * this software and related documentation outside the terms of the EULA
+ * is strictly prohibited.
+ *
+ */
+
+/*
+ * Ray caster for up to 5 volumes. The following must be defined when building the program:
+ * numberOfVolumes: the nr of volumes
+ * VOLUME_TYPE0 .. VOLUME_TYPE4: how each volume is read, 0 float, 1 unsigned integer and 2 signed integer
+ * CELL_SIZE: size in voxels of the macro cells of the occupancy grids
+ * Optional:
+ * INCLUDE_GEOMETRY: blend with the color and depth textures of the rendered geometry
+ * EMPTY_SPACE_SKIPPING: skip macro cells which are empty in all volumes
+ *
+ * Each ray is marched from front to back, which gives the same result as compositing from back to front, but allows
+ * the ray to stop when it is opaque.
+ */
+
+#define maxSteps 400
+#define tstep 0.5f
+#define FAR_AWAY 1e30f
+
+const sampler_t geometrySampler =		CLK_NORMALIZED_COORDS_FALSE |
+										CLK_ADDRESS_CLAMP_TO_EDGE   |
+										CLK_FILTER_NEAREST;
+
+const sampler_t transferFuncSampler =	CLK_NORMALIZED_COORDS_TRUE	|
+										CLK_ADDRESS_CLAMP_TO_EDGE	|
+										CLK_FILTER_LINEAR;
+
+const sampler_t volumeSampler =			CLK_NORMALIZED_COORDS_FALSE	|
+										CLK_ADDRESS_CLAMP_TO_EDGE	|
+										CLK_FILTER_LINEAR;
+
+#define READ_SAMPLE(type, volume, pos) ((type) == 0 ? read_imagef(volume, volumeSampler, pos).x : \
+		(type) == 1 ? (float)read_imageui(volume, volumeSampler, pos).x : (float)read_imagei(volume, volumeSampler, pos).x)
+
+//Assuming that box minimum always starts from zero
+int intersectBox(float4 r_o, float4 r_d, float4 boxmax, float *tnear, float *tfar)
+{
+    // compute intersection of ray with all six bbox planes
+    float4 invR = (float4)(1.0f,1.0f,1.0f,1.0f) / r_d;
+    float4 tbot = invR * -r_o;
+    float4 ttop = invR * (boxmax - r_o);
+
+    // re-order intersections to find smallest and largest on each axis
+    float4 tmin = min(ttop, tbot);
+    float4 tmax = max(ttop, tbot);
+
+    // find the largest tmin and the smallest tmax
+    float largest_tmin = max(max(tmin.x, tmin.y), max(tmin.x, tmin.z));
+    float smallest_tmax = min(min(tmax.x, tmax.y), min(tmax.x, tmax.z));
+
+	*tnear = largest_tmin;
+	*tfar = smallest_tmax;
+
+	return smallest_tmax > largest_tmin;
+}
+
+uint rgbaFloatToInt(float4 rgba)
+{
+    rgba.x = clamp(rgba.x,0.0f,1.0f);
+    rgba.y = clamp(rgba.y,0.0f,1.0f);
+    rgba.z = clamp(rgba.z,0.0f,1.0f);
+    rgba.w = clamp(rgba.w,0.0f,1.0f);
+    return ((uint)(rgba.w*255.0f)<<24) | ((uint)(rgba.z*255.0f)<<16) | ((uint)(rgba.y*255.0f)<<8) | (uint)(rgba.x*255.0f);
+}
+
+void composite(
+		float4* color,
+		float* opacity,
+		float sample,
+		__read_only image2d_t transferFunc,
+		__read_only image2d_t opacityFunc,
+		float colorFuncMin,
+		float colorFuncDef,
+		float opacityFuncMin,
+		float opacityFuncDef,
+		float density
+		) {
+	// lookup in transfer function texture, with the sample made between 0.0 and 1.0
+	float4 col = read_imagef(transferFunc, transferFuncSampler, (float2)((sample - colorFuncMin) / colorFuncDef, 0.5f));
+	const float alpha = read_imagef(opacityFunc, transferFuncSampler, (float2)((sample - opacityFuncMin) / opacityFuncDef, 0.5f)).w;
+	col.w = alpha;
+	const float a = alpha*density;
+	*color += (1.0f - *opacity)*a*col;
+	*opacity += (1.0f - *opacity)*a;
+}
+
+// Distance along the ray from t to where it leaves the macro cell which contains pos
+float distanceToCellExit(float4 pos, float4 dir) {
+	const float4 cellMin = floor(pos / (float)CELL_SIZE)*(float)CELL_SIZE;
+	const float4 cellMax = cellMin + (float)CELL_SIZE;
+	// Avoid division by zero, the exit along axes the ray is parallel to becomes very far away instead
+	dir = select(dir, (float4)(1e-6f), isless(fabs(dir), (float4)(1e-6f)));
+	const float4 exit = (select(cellMin, cellMax, isgreater(dir, (float4)(0.0f))) - pos) / dir;
+	return max(min(min(exit.x, exit.y), exit.z), 0.0f);
+}
+
+bool isCellOccupied(float4 pos, __global const uchar* occupancy, __constant int* gridSize) {
+	const int x = clamp((int)(pos.x / (float)CELL_SIZE), 0, gridSize[0] - 1);
+	const int y = clamp((int)(pos.y / (float)CELL_SIZE), 0, gridSize[1] - 1);
+	const int z = clamp((int)(pos.z / (float)CELL_SIZE), 0, gridSize[2] - 1);
+	return occupancy[x + (y + z*gridSize[1])*gridSize[0]] > 0;
+}
+
+#define VOLUME_ARGUMENTS(i) \
+		,__read_only image3d_t volume##i \
+		,__read_only image2d_t transferFunc##i \
+		,__read_only image2d_t opacityFunc##i \
+		,__global const uchar* occupancy##i
+
+// Composite the sample of volume i at t, if t is inside the volume
+#define SAMPLE_VOLUME(i) \
+	if(t >= volumeNear[i] && t <= volumeFar[i]) { \
+		const float4 pos = eyeRay_o[i] + eyeRay_d[i]*t; \
+		const float sample = READ_SAMPLE(VOLUME_TYPE##i, volume##i, pos); \
+		composite(&color, &opacity, sample, transferFunc##i, opacityFunc##i, \
+				colorFuncMins[i], colorFuncDefs[i], opacityFuncMins[i], opacityFuncDefs[i], density); \
+	}
+
+// Find how far the ray can skip from t: to the exit of the macro cell of volume i if it is empty, or to the
+// entry of volume i if the ray has not reached it yet
+#define FIND_EMPTY_SPACE(i) \
+	if(t < volumeNear[i]) { \
+		skipTo = min(skipTo, volumeNear[i]); \
+	} else if(t <= volumeFar[i]) { \
+		const float4 pos = eyeRay_o[i] + eyeRay_d[i]*t; \
+		if(isCellOccupied(pos, occupancy##i, &gridSizes[i*4])) { \
+			empty = false; \
+		} else { \
+			skipTo = min(skipTo, t + distanceToCellExit(pos, eyeRay_d[i])); \
+		} \
+	}
+
+float4 castRay(
+		uint x, uint y,
+		uint imageW, uint imageH,
+		float density,
+		float zNear, float zFar,
+		float top, float right,
+		float maxDepth,
+		__constant float* invViewMatrix,
+		__constant float* boxMaxs,
+		__constant float* opacityFuncDefs,
+		__constant float* opacityFuncMins,
+		__constant float* colorFuncDefs,
+		__constant float* colorFuncMins,
+		__constant int* gridSizes,
+		float earlyRayTerminationThreshold,
+		bool* hit
+		VOLUME_ARGUMENTS(0)
+#if numberOfVolumes > 1
+		VOLUME_ARGUMENTS(1)
+#endif
+#if numberOfVolumes > 2
+		VOLUME_ARGUMENTS(2)
+#endif
+#if numberOfVolumes > 3
+		VOLUME_ARGUMENTS(3)
+#endif
+#if numberOfVolumes > 4
+		VOLUME_ARGUMENTS(4)
+#endif
+		) {
+    float u = (((x / (float) imageW)*2.0f)-1.0f)*right;
+    float v = (((y / (float) imageH)*2.0f)-1.0f)*top;
+
+    // calculate eye ray in world space, and the part of the ray which is inside each volume
+	float4 eyeRay_o[numberOfVolumes];
+	float4 eyeRay_d[numberOfVolumes];
+	float volumeNear[numberOfVolumes];
+	float volumeFar[numberOfVolumes];
+	const float4 temp_eyeRay_d = normalize((float4)(u, v, -zNear, 0.0f));
+
+	float tnear = FAR_AWAY;
+	float tfar = -FAR_AWAY;
+	for (int i = 0; i < numberOfVolumes; i++)
+	{
+		eyeRay_o[i] = (float4)(invViewMatrix[(i * 16) + 12], invViewMatrix[(i * 16) + 13], invViewMatrix[(i * 16) + 14], 0.0f);
+
+		eyeRay_d[i].x = dot(temp_eyeRay_d, ((float4)(invViewMatrix[(i * 16) + 0], invViewMatrix[(i * 16) + 4], invViewMatrix[(i * 16) + 8], 0.0f)));
+		eyeRay_d[i].y = dot(temp_eyeRay_d, ((float4)(invViewMatrix[(i * 16) + 1], invViewMatrix[(i * 16) + 5], invViewMatrix[(i * 16) + 9], 0.0f)));
+		eyeRay_d[i].z = dot(temp_eyeRay_d, ((float4)(invViewMatrix[(i * 16) + 2], invViewMatrix[(i * 16) + 6], invViewMatrix[(i * 16) + 10], 0.0f)));
+		eyeRay_d[i].w = 1.0f;
+
+		const float4 boxMax = (float4)(boxMaxs[i*3], boxMaxs[i*3 + 1], boxMaxs[i*3 + 2], 0.0f);
+		if(intersectBox(eyeRay_o[i], eyeRay_d[i], boxMax, &volumeNear[i], &volumeFar[i])) {
+			tnear = min(tnear, volumeNear[i]);
+			tfar = max(tfar, volumeFar[i]);
+		} else {
+			volumeNear[i] = FAR_AWAY;
+			volumeFar[i] = -FAR_AWAY;
+		}
+	}
+
+	*hit = tfar > tnear;
+	if(!*hit)
+		return (float4)(0.0f, 0.0f, 0.0f, 0.0f);
+
+	if (tfar > maxDepth) tfar = maxDepth; // clamp to geometry
+	if (tnear < zNear) tnear = zNear;	// clamp to near plane
+	if (tfar > zFar) tfar= zFar;	// clamp to far  plane
+
+    // march along ray from front to back, accumulating color
+	float4 color = (float4)(0.0f, 0.0f, 0.0f, 0.0f);
+	float opacity = 0.0f;
+	uint sampleNr = 0;
+	while(sampleNr < maxSteps*200) {
+		const float t = tnear + sampleNr*tstep;
+		if(t > tfar)
+			break;
+
+#ifdef EMPTY_SPACE_SKIPPING
+		bool empty = true;
+		float skipTo = tfar + tstep;
+		FIND_EMPTY_SPACE(0)
+#if numberOfVolumes > 1
+		FIND_EMPTY_SPACE(1)
+#endif
+#if numberOfVolumes > 2
+		FIND_EMPTY_SPACE(2)
+#endif
+#if numberOfVolumes > 3
+		FIND_EMPTY_SPACE(3)
+#endif
+#if numberOfVolumes > 4
+		FIND_EMPTY_SPACE(4)
+#endif
+		if(empty) {
+			// Continue at the first sample after the empty space, so that the samples are at the same positions as
+			// without skipping
+			sampleNr = max(sampleNr + 1, (uint)ceil((skipTo - tnear) / tstep));
+			continue;
+		}
+#endif
+
+		// Volumes with a higher index are in front of lower ones at the same position
+#if numberOfVolumes > 4
+		SAMPLE_VOLUME(4)
+#endif
+#if numberOfVolumes > 3
+		SAMPLE_VOLUME(3)
+#endif
+#if numberOfVolumes > 2
+		SAMPLE_VOLUME(2)
+#endif
+#if numberOfVolumes > 1
+		SAMPLE_VOLUME(1)
+#endif
+		SAMPLE_VOLUME(0)
+
+		// Early ray termination
+		if(opacity >= earlyRayTerminationThreshold)
+			break;
+		sampleNr++;
+	}
+
+	return color;
+}
+
+#define VOLUME_PARAMETERS(i) ,volume##i, transferFunc##i, opacityFunc##i, occupancy##i
+
+/*
+ * Each work-item renders one block of resolutionDivisor x resolutionDivisor pixels, by casting one ray through the
+ * center of the block. A resolution divisor of 1 renders every pixel.
+ */
+__kernel void
+d_render(__global uint *d_output,
+         uint imageW, uint imageH,
+         float density, float brightness,
+         float zNear, float zFar,
+		 float top, float right,
+		 float projectionMatrix10, float projectionMatrix14,
+         __constant float* invViewMatrix,
+		  __constant float* boxMaxs,
+		  __constant float* opacityFuncDefs,
+		  __constant float* opacityFuncMins,
+		  __constant float* colorFuncDefs,
+		  __constant float* colorFuncMins,
+		  __constant int* gridSizes,
+		  int resolutionDivisor,
+		  float earlyRayTerminationThreshold
+#ifdef INCLUDE_GEOMETRY
+		  ,__read_only image2d_t geoColorTexture
+		  ,__read_only image2d_t geoDepthTexture
+#endif
+		  VOLUME_ARGUMENTS(0)
+#if numberOfVolumes > 1
+		  VOLUME_ARGUMENTS(1)
+#endif
+#if numberOfVolumes > 2
+		  VOLUME_ARGUMENTS(2)
+#endif
+#if numberOfVolumes > 3
+		  VOLUME_ARGUMENTS(3)
+#endif
+#if numberOfVolumes > 4
+		  VOLUME_ARGUMENTS(4)
+#endif
+         )
+{
+	const uint blockX = get_global_id(0)*resolutionDivisor;
+	const uint blockY = get_global_id(1)*resolutionDivisor;
+	if ((blockX >= imageW) || (blockY >= imageH)) return;
+	const uint x = min(blockX + resolutionDivisor/2, imageW - 1);
+	const uint y = min(blockY + resolutionDivisor/2, imageH - 1);
+
+#ifdef INCLUDE_GEOMETRY
+	float winZ = ((read_imagef(geoDepthTexture, geometrySampler, (int2)(x,y)).x)*-2.0f)+1.0f;
+	float Z = projectionMatrix14 / (winZ+projectionMatrix10);
+	const float maxDepth = -Z;
+	float4 geoColor = read_imagef(geoColorTexture, geometrySampler, (int2)(x,y));
+#else
+	const float maxDepth = FAR_AWAY;
+	float4 geoColor = (float4)(0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+
+	bool hit;
+	float4 volumeColor = castRay(x, y, imageW, imageH, density, zNear, zFar, top, right, maxDepth, invViewMatrix,
+			boxMaxs, opacityFuncDefs, opacityFuncMins, colorFuncDefs, colorFuncMins, gridSizes,
+			earlyRayTerminationThreshold, &hit
+			VOLUME_PARAMETERS(0)
+#if numberOfVolumes > 1
+			VOLUME_PARAMETERS(1)
+#endif
+#if numberOfVolumes > 2
+			VOLUME_PARAMETERS(2)
+#endif
+#if numberOfVolumes > 3
+			VOLUME_PARAMETERS(3)
+#endif
+#if numberOfVolumes > 4
+			VOLUME_PARAMETERS(4)
+#endif
+			);
+
+	if(!hit) {
+		volumeColor = geoColor;
+	} else {
+		volumeColor *= brightness;
+#ifdef INCLUDE_GEOMETRY
+		volumeColor = mix(geoColor, volumeColor, volumeColor.w);
+#endif
+	}
+	volumeColor.w = 1.0f;
+
+	// write output color to all pixels of the block
+	const uint outputColor = rgbaFloatToInt(volumeColor);
+	for(uint j = blockY; j < min(blockY + resolutionDivisor, imageH); ++j) {
+		for(uint k = blockX; k < min(blockX + resolutionDivisor, imageW); ++k) {
+			d_output[(j * imageW) + k] = outputColor;
+		}
+	}
+}
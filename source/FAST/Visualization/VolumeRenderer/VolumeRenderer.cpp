@@ -13,6 +13,18 @@
 
 namespace fast {
 
+// Size in voxels of the macro cells used for empty space skipping
+static const int cellSize = 8;
+
+// How the kernels read each volume: 0 float, 1 unsigned integer, 2 signed integer
+static int getVolumeType(DataType type) {
+	if(type == TYPE_FLOAT)
+		return 0;
+	if(type == TYPE_UINT8 || type == TYPE_UINT16)
+		return 1;
+	return 2;
+}
+
 void VolumeRenderer::resize(GLuint height, GLuint width){
 	mHeight = height;
 	mWidth = width;
@@ -35,96 +47,88 @@ void VolumeRenderer::setProjectionParameters(float fov, float aspect, float near
 	mIsModified = true;
 }
 uint VolumeRenderer::addInputConnection(DataPort::pointer port) {
-
-	
-
-	if(numberOfVolumes<0)
-        throw Exception("Not a correct number of volumes is given to VolumeRenderer");
-	if(numberOfVolumes<maxNumberOfVolumes)
-	{
-		uint nr = getNrOfInputConnections();
-		if(nr > 0)
-		    createInputPort<Image>(nr);
-	//	releaseInputAfterExecute(nr, false);
-		setInputConnection(nr, port);
-		//mInputs.push_back(getInputData<Image>(0));
-		
-		//addParent(mInputs[numberOfVolumes]);
-		numberOfVolumes++;
-		mIsModified = true;
-		mInputIsModified=true;
-		return nr;
-	}
-	else
-		printf("\n Warning: Volume Renderer currently supports only up to %d volumes. Extera inputs are denied. \n", maxNumberOfVolumes);
-
-
+	if(numberOfVolumes >= maxNumberOfVolumes)
+		throw Exception("The VolumeRenderer supports only up to " + std::to_string(maxNumberOfVolumes) + " volumes");
+
+	uint nr = getNrOfInputConnections();
+	if(nr > 0)
+		createInputPort<Image>(nr);
+	setInputConnection(nr, port);
+	numberOfVolumes++;
+	mIsModified = true;
+	mInputIsModified=true;
+	return nr;
+}
+uint VolumeRenderer::addInputData(DataObject::pointer data) {
+	if(numberOfVolumes >= maxNumberOfVolumes)
+		throw Exception("The VolumeRenderer supports only up to " + std::to_string(maxNumberOfVolumes) + " volumes");
+
+	uint nr = getNrOfInputConnections();
+	if(nr > 0)
+		createInputPort<Image>(nr);
+	setInputData(nr, data);
+	numberOfVolumes++;
+	mIsModified = true;
+	mInputIsModified=true;
+	return nr;
 }
 void VolumeRenderer::setOpacityTransferFunction(int volumeIndex, OpacityTransferFunction::pointer otf) {
 
-	if (volumeIndex>=maxNumberOfVolumes)
+	if (volumeIndex < 0 || volumeIndex>=maxNumberOfVolumes)
 		throw Exception("\nError: The volumeIndex for OpacityTransferFunction is out of range.");
 
 	double xMin = otf->getXMin();
 	double xMax = otf->getXMax();
 	unsigned int XDef = static_cast<unsigned int>(xMax - xMin);
 
-	if(((OpenCLDevice::pointer)getMainDevice())->isImageFormatSupported(CL_A, CL_FLOAT, CL_MEM_OBJECT_IMAGE2D)) {
-        opacityFunc=(float *)(malloc(sizeof(float)*XDef));
-
-        for (unsigned int c=0; c<otf->v.size()-1; c++)
-        {
-                int   S=otf->v[c+0].X;
-                int   E=otf->v[c+1].X;
-                float A1=otf->v[c].A;
-                float A= (otf->v[c+1].A) - A1;
-                float D=E-S;
-
-                unsigned int index=0;
-                for(unsigned int i=S-xMin; i<E-xMin; i++, index++)
-                {
-                        opacityFunc[i]=A1+A*index/D;//A
-
-                }
-        }
-        d_opacityFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_A, CL_FLOAT), XDef, 1, 0, opacityFunc, 0);
+	std::vector<float> opacityFunc(XDef, 0.0f);
+	for (unsigned int c=0; c<otf->v.size()-1; c++)
+	{
+		int   S=otf->v[c+0].X;
+		int   E=otf->v[c+1].X;
+		float A1=otf->v[c].A;
+		float A= (otf->v[c+1].A) - A1;
+		float D=E-S;
+
+		unsigned int index=0;
+		for(unsigned int i=S-xMin; i<E-xMin; i++, index++)
+		{
+			opacityFunc[i]=A1+A*index/D;//A
+		}
+	}
+
+	if(mDevice->isImageFormatSupported(CL_A, CL_FLOAT, CL_MEM_OBJECT_IMAGE2D)) {
+		d_opacityFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_A, CL_FLOAT), XDef, 1, 0, opacityFunc.data(), 0);
 	} else {
 		// Single channel images is not support on all platforms (e.g. Mac), thus use regular 4 channel images if it is not supported
-        opacityFunc=(float *)(malloc(sizeof(float)*XDef*4));
-
-        for (unsigned int c=0; c<otf->v.size()-1; c++)
-        {
-                int   S=otf->v[c+0].X;
-                int   E=otf->v[c+1].X;
-                float A1=otf->v[c].A;
-                float A= (otf->v[c+1].A) - A1;
-                float D=E-S;
-
-                unsigned int index=0;
-                for(unsigned int i=S-xMin; i<E-xMin; i++, index++)
-                {
-                        opacityFunc[i*4]=A1+A*index/D;//A
-
-                }
-        }
-        d_opacityFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_RGBA, CL_FLOAT), XDef, 1, 0, opacityFunc, 0);
+		std::vector<float> opacityFuncRGBA(XDef*4, 0.0f);
+		for(unsigned int i = 0; i < XDef; i++)
+			opacityFuncRGBA[i*4+3] = opacityFunc[i];
+		d_opacityFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_RGBA, CL_FLOAT), XDef, 1, 0, opacityFuncRGBA.data(), 0);
 	}
+
+	// Count the non-zero entries, so that the occupancy grid can check if a range of the function is zero
+	std::vector<uint> prefix(XDef + 1, 0);
+	for(unsigned int i = 0; i < XDef; i++)
+		prefix[i+1] = prefix[i] + (opacityFunc[i] > 0.0f ? 1 : 0);
+	d_opacityFuncPrefix[volumeIndex] = cl::Buffer(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, prefix.size()*sizeof(uint), prefix.data());
+
 	opacityFuncDefs[volumeIndex] = XDef;
 	opacityFuncMins[volumeIndex] = xMin;
-	
+	mOccupancyIsModified[volumeIndex] = true;
+
 	mIsModified = true;
 }
 void VolumeRenderer::setColorTransferFunction(int volumeIndex, ColorTransferFunction::pointer ctf) {
 
-	if (volumeIndex >= maxNumberOfVolumes)
+	if (volumeIndex < 0 || volumeIndex >= maxNumberOfVolumes)
 		throw Exception("\nError: The volumeIndex for ColorTransferFunction is out of range.");
 
 	double xMin = ctf->getXMin();
 	double xMax = ctf->getXMax();
 	unsigned int XDef = static_cast<unsigned int>(xMax - xMin);
 
-	transferFunc=(float *)(malloc(sizeof(float)*4*XDef));
-	
+	std::vector<float> transferFunc(4*XDef, 0.0f);
 	for (unsigned int c=0; c<ctf->v.size()-1; c++)
 	{
 		int   S=ctf->v[c+0].X;
@@ -147,7 +151,7 @@ void VolumeRenderer::setColorTransferFunction(int volumeIndex, ColorTransferFunc
 		}
 	}
 
-	d_transferFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_RGBA, CL_FLOAT), XDef, 1, 0, transferFunc, 0);
+	d_transferFuncArray[volumeIndex]=cl::Image2D(clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cl::ImageFormat(CL_RGBA, CL_FLOAT), XDef, 1, 0, transferFunc.data(), 0);
 	colorFuncDefs[volumeIndex] = XDef;
 	colorFuncMins[volumeIndex] = xMin;
 	mIsModified = true;
@@ -175,16 +179,13 @@ void VolumeRenderer::turnOffTransformations() {
 BoundingBox VolumeRenderer::getBoundingBox()
 {
 	Image::pointer mImageToRender = inputs[0];//getInputData(0);
-		
-	
-	float tr[16];
 
 	BoundingBox inputBoundingBox = mImageToRender->getBoundingBox();
 
     if(mDoTransformations) {
         AffineTransformation::pointer transform = SceneGraph::getAffineTransformationFromData(mImageToRender);
 		BoundingBox transformedBoundingBox = inputBoundingBox.getTransformedBoundingBox(transform);
-        
+
 		return transformedBoundingBox;
 
     } else {
@@ -194,37 +195,34 @@ BoundingBox VolumeRenderer::getBoundingBox()
 
 }
 void VolumeRenderer::setUserTransform(int volumeIndex, const float userTransform[16]){
-	
-	for(int i=0; i<16; i++)
-		mUserTransforms[volumeIndex*i]=userTransform[i];
-
-	switch (volumeIndex)
-	{
-	case 0: 
-		for(int i=0; i<16; i++)
-			mUserTransform0[i]=userTransform[i];
-		break;
-	case 1: 
-		for(int i=0; i<16; i++)
-			mUserTransform1[i]=userTransform[i]; 
-		break;
-	case 2: 
-		for(int i=0; i<16; i++)
-			mUserTransform2[i]=userTransform[i]; 
-		break;
-	case 3: 
-		for(int i=0; i<16; i++)
-			mUserTransform3[i]=userTransform[i]; 
-		break;
-	case 4: 
-		for(int i=0; i<16; i++)
-			mUserTransform4[i]=userTransform[i]; 
-		break;
+	if (volumeIndex < 0 || volumeIndex >= maxNumberOfVolumes)
+		throw Exception("\nError: The volumeIndex for the user transform is out of range.");
 
-	}
+	for(int i=0; i<16; i++)
+		mUserTransforms[volumeIndex*16 + i]=userTransform[i];
 
 	doUserTransforms[volumeIndex]=true;
-	
+	mInteracting = true;
+	mIsModified = true;
+}
+void VolumeRenderer::setEmptySpaceSkipping(bool skip) {
+	mEmptySpaceSkipping = skip;
+	mIsModified = true;
+}
+void VolumeRenderer::setEarlyRayTerminationThreshold(float threshold) {
+	mEarlyRayTerminationThreshold = threshold;
+	mIsModified = true;
+}
+void VolumeRenderer::setProgressiveRendering(bool progressive, int resolutionDivisor) {
+	if(resolutionDivisor < 1)
+		throw Exception("The resolution divisor of progressive rendering must be at least 1");
+	mProgressiveRendering = progressive;
+	mProgressiveResolutionDivisor = resolutionDivisor;
+	mIsModified = true;
+}
+void VolumeRenderer::setOffscreenRendering(bool offscreen) {
+	mOffscreen = offscreen;
+	mIsModified = true;
 }
 VolumeRenderer::VolumeRenderer() : Renderer() {
     createInputPort<Image>(0, false);
@@ -236,6 +234,15 @@ VolumeRenderer::VolumeRenderer() : Renderer() {
 	mIsModified = true;
 	mDoTransformations = true;
 	mOutputIsCreated=false;
+	mRenderIsPending = false;
+	mEmptySpaceSkipping = true;
+	mEarlyRayTerminationThreshold = 0.99f;
+	mProgressiveRendering = false;
+	mProgressiveResolutionDivisor = 4;
+	mInteracting = false;
+	mOffscreen = false;
+	mOutputBufferWidth = 0;
+	mOutputBufferHeight = 0;
 
 	numberOfVolumes=0;
 
@@ -244,386 +251,320 @@ VolumeRenderer::VolumeRenderer() : Renderer() {
 	//Default window size
 	mHeight = 512;
 	mWidth = 512;
+	setProjectionParameters(45.0f, 1.0f, 0.1f, 1000.0f);
 
 	d_invViewMatrices= cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes*16*sizeof(float));
 	d_boxMaxs = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * 3 * sizeof(float));
+	d_gridSizes = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * 4 * sizeof(int));
 	d_opacityFuncDefs = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * sizeof(float));
 	d_opacityFuncMins = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * sizeof(float));
 	d_colorFuncDefs = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * sizeof(float));
 	d_colorFuncMins = cl::Buffer(clContext, CL_MEM_READ_WRITE, maxNumberOfVolumes * sizeof(float));
+	// Used as occupancy grid argument when empty space skipping is disabled
+	d_noOccupancyGrid = cl::Buffer(clContext, CL_MEM_READ_ONLY, sizeof(cl_uchar));
 
 	includeGeometry=false;
 
 	pbo=0;
 
-	for (int i=0; i<maxNumberOfVolumes; i++)
-		doUserTransforms[i]=false;
+	for (int i = 0; i < 16; i++)
+		modelView[i] = i % 5 == 0 ? 1.0f : 0.0f;
 
+	for (int i=0; i<maxNumberOfVolumes; i++) {
+		doUserTransforms[i]=false;
+		for (int j = 0; j < 4; j++)
+			gridSizes[i*4 + j] = 0;
+		mGridTimestamps[i] = 0;
+		mOccupancyIsModified[i] = true;
+	}
 }
 void VolumeRenderer::setIncludeGeometry(bool p){
-	
+
 	includeGeometry=p;
 	mInputIsModified = true;
 }
 void VolumeRenderer::setModelViewMatrix(GLfloat mView[16]){
 
+	if(std::equal(mView, mView + 16, modelView))
+		return;
+
 	for (int i = 0; i < 16; i++)
 		modelView[i] = mView[i];
+	mInteracting = true;
+	mIsModified = true;
 }
-void VolumeRenderer::execute() {
-
-	std::lock_guard<std::mutex> lock(mMutex);
+void VolumeRenderer::updateOccupancyGrid(int volumeIndex) {
+	Image::pointer image = inputs[volumeIndex];
+	cl::CommandQueue queue = mDevice->getCommandQueue();
+	int* gridSize = &gridSizes[volumeIndex*4];
+
+	// The min-max grid only depends on the volume
+	if(mGridImages[volumeIndex].get() != image.get() || mGridTimestamps[volumeIndex] != image->getTimestamp()) {
+		const int width = (image->getWidth() + cellSize - 1) / cellSize;
+		const int height = (image->getHeight() + cellSize - 1) / cellSize;
+		const int depth = (image->getDepth() + cellSize - 1) / cellSize;
+		if(width != gridSize[0] || height != gridSize[1] || depth != gridSize[2]) {
+			gridSize[0] = width;
+			gridSize[1] = height;
+			gridSize[2] = depth;
+			d_minMaxGrids[volumeIndex] = cl::Buffer(clContext, CL_MEM_READ_WRITE, width*height*depth*sizeof(float)*2);
+			d_occupancyGrids[volumeIndex] = cl::Buffer(clContext, CL_MEM_READ_WRITE, width*height*depth*sizeof(cl_uchar));
+		}
 
-	if (!inputs.empty())
-		inputs.clear();
+		OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, mDevice);
+		cl::Kernel kernel(mGridPrograms[volumeIndex], "createMinMaxGrid");
+		kernel.setArg(0, *access->get3DImage());
+		kernel.setArg(1, d_minMaxGrids[volumeIndex]);
+		kernel.setArg(2, cellSize);
+		queue.enqueueNDRangeKernel(
+				kernel,
+				cl::NullRange,
+				cl::NDRange(width, height, depth),
+				cl::NullRange
+		);
+
+		mGridImages[volumeIndex] = image;
+		mGridTimestamps[volumeIndex] = image->getTimestamp();
+		mOccupancyIsModified[volumeIndex] = true;
+	}
 
-	if(numberOfVolumes<0)
-        throw Exception("Not a correct number of volumes is given to VolumeRenderer.");
-	if(numberOfVolumes>maxNumberOfVolumes)
-		printf("Warning: Volume Renderer currently supports only up to %d volumes. Extera inputs are denied. \n", maxNumberOfVolumes);
+	// The occupancy grid has to be updated if the min-max grid or the opacity transfer function has changed
+	if(mOccupancyIsModified[volumeIndex]) {
+		cl::Kernel kernel(mGridPrograms[volumeIndex], "createOccupancyGrid");
+		kernel.setArg(0, d_minMaxGrids[volumeIndex]);
+		kernel.setArg(1, d_occupancyGrids[volumeIndex]);
+		kernel.setArg(2, d_opacityFuncPrefix[volumeIndex]);
+		kernel.setArg(3, (int)opacityFuncDefs[volumeIndex]);
+		kernel.setArg(4, opacityFuncMins[volumeIndex]);
+		queue.enqueueNDRangeKernel(
+				kernel,
+				cl::NullRange,
+				cl::NDRange(gridSize[0]*gridSize[1]*gridSize[2]),
+				cl::NullRange
+		);
+		mOccupancyIsModified[volumeIndex] = false;
+	}
+}
+void VolumeRenderer::execute() {
+	if(mStop)
+		return;
 
+	std::vector<Image::pointer> volumes;
 	for(unsigned int i=0;i<numberOfVolumes;i++)
 	{
-		/*
-		if(!mInputs[i].isValid())
-		{
-			char errorMessage[255];
-			sprintf(errorMessage, "No input was given to VolumeRenderer; check input number %d.", i);
-			throw Exception(errorMessage);
-		}
-		if(mInputs[i]->isDynamicData()) 
-		{
-		
-			inputs.push_back( DynamicImage::pointer(mInputs[i])->getNextFrame(mPtr));
-			
-		} 
-		else 
-		{
-			inputs.push_back( mInputs[i]);
-		}
-		*/
-		inputs.push_back(getInputData<Image>(i));
-		if(inputs[i]->getDimensions() != 3)
-		{
-			char errorMessage[255];
-			sprintf(errorMessage, "The VolumeRenderer only supports 3D images; check input number %d.", i);
-			throw Exception(errorMessage);
-		}
-		/*
-		if(inputs[i]->getNrOfComponents() !=1)
-		{
-			char errorMessage[255];
-			sprintf(errorMessage, "The VolumeRenderer currentlt only supports single chanel images; check input volume number %d.", i);
-			throw Exception(errorMessage);
-		}*/
+		volumes.push_back(getInputData<Image>(i));
+		if(volumes[i]->getDimensions() != 3)
+			throw Exception("The VolumeRenderer only supports 3D images; check input number " + std::to_string(i));
+		if(d_transferFuncArray[i]() == NULL || d_opacityFuncArray[i]() == NULL)
+			throw Exception("No transfer functions were given to the VolumeRenderer for input number " + std::to_string(i));
 	}
 
+	if(mOffscreen) {
+		// No view draws an off-screen renderer, thus the volumes are rendered right away
+		std::lock_guard<std::mutex> lock(mOutputMutex);
+		inputs = volumes;
+		render();
+	} else {
+		// The pixel buffer is rendered in the rendering thread, where the OpenGL context is current
+		mVolumeBuffer.publish(volumes);
+	}
+}
+
+void VolumeRenderer::preDraw() {
+	if(mVolumeBuffer.consume(inputs))
+		mRenderIsPending = true;
+}
+
+void VolumeRenderer::render() {
 	mOutputIsCreated=false;
 
 	float density = 0.05f;
 	float brightness = 1.0f;
 
-	
-
-
-   
-    glEnable(GL_NORMALIZE);
-    glEnable(GL_DEPTH_TEST);
-
-	//Update Camera Matrix
-	//GLfloat modelView[16];
-	//glMatrixMode(GL_MODELVIEW);
-	//glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
-	QOpenGLFunctions_3_3_Compatibility *fun = new QOpenGLFunctions_3_3_Compatibility;
-	fun->initializeOpenGLFunctions();
-
-	glPushMatrix();
-
-	for (int i = 0; i < numberOfVolumes; i++)
+	// Calculate the inverse view matrix of each volume
+	const Matrix4f modelViewMatrix = Eigen::Map<Matrix4f>(modelView);
+	for (unsigned int i = 0; i < numberOfVolumes; i++)
 	{
-		glLoadIdentity();
-		glMultMatrixf(modelView);
-
-		if(mDoTransformations) 
-		{
-			AffineTransformation::pointer transform = SceneGraph::getAffineTransformationFromData(inputs[i]);
-
-            glMultMatrixf(transform->getTransform().data());
-		}
-
-		
-		if (doUserTransforms[i])
-			switch(i)
-			{
-				case 0: fun->glMultTransposeMatrixf(mUserTransform0); break;
-				case 1: fun->glMultTransposeMatrixf(mUserTransform1); break;
-				case 2: fun->glMultTransposeMatrixf(mUserTransform2); break;
-				case 3: fun->glMultTransposeMatrixf(mUserTransform3); break;
-				case 4: fun->glMultTransposeMatrixf(mUserTransform4); break;
-			}
-		
-
-		GLfloat modelViewMatrix[16];
-		glGetFloatv(GL_MODELVIEW_MATRIX, modelViewMatrix);
-		switch (i)
-		{
-			case 0: 
-				gluInvertMatrix(modelViewMatrix, invViewMatrix0); 
-				for (uint i = 0; i < 16; i++)	
-					invViewMatrices[i] = invViewMatrix0[i];
-				break;
-			case 1: 
-				gluInvertMatrix(modelViewMatrix, invViewMatrix1);
-				for (uint i = 0; i < 16; i++)
-					invViewMatrices[i+16] = invViewMatrix1[i];
-				break;
-			case 2: 
-				gluInvertMatrix(modelViewMatrix, invViewMatrix2);
-				for (uint i = 0; i < 16; i++)
-					invViewMatrices[i+32] = invViewMatrix2[i];
-				break;
-			case 3: 
-				gluInvertMatrix(modelViewMatrix, invViewMatrix3); 
-				for (uint i = 0; i < 16; i++)
-					invViewMatrices[i+48] = invViewMatrix3[i];
-				break;
-			case 4: 
-				gluInvertMatrix(modelViewMatrix, invViewMatrix4); 
-				for (uint i = 0; i < 16; i++)
-					invViewMatrices[i+64] = invViewMatrix4[i];
-				break;
-		}
+		Matrix4f volumeModelViewMatrix = modelViewMatrix;
+		if(mDoTransformations)
+			volumeModelViewMatrix *= SceneGraph::getAffineTransformationFromData(inputs[i])->getTransform().matrix();
+		if(doUserTransforms[i])
+			volumeModelViewMatrix *= Eigen::Map<Eigen::Matrix<float, 4, 4, Eigen::RowMajor> >(&mUserTransforms[i*16]);
+		Eigen::Map<Matrix4f> invViewMatrix(&invViewMatrices[i*16]);
+		invViewMatrix = volumeModelViewMatrix.inverse();
+
+		boxMaxs[i * 3 + 0] = inputs[i]->getWidth();
+		boxMaxs[i * 3 + 1] = inputs[i]->getHeight();
+		boxMaxs[i * 3 + 2] = inputs[i]->getDepth();
 	}
-	
-	glPopMatrix();
 
-
-
-	if(mInputIsModified)   
+	// Compile program, the volume data types are compiled into the kernel
+	std::string buildOptions = "-cl-fast-relaxed-math -D numberOfVolumes=" + std::to_string(numberOfVolumes) +
+			" -D CELL_SIZE=" + std::to_string(cellSize);
+	for(unsigned int i=0; i<numberOfVolumes;i++)
+		buildOptions += " -D VOLUME_TYPE" + std::to_string(i) + "=" + std::to_string(getVolumeType(inputs[i]->getDataType()));
+	if(includeGeometry)
+		buildOptions += " -D INCLUDE_GEOMETRY";
+	if(mEmptySpaceSkipping)
+		buildOptions += " -D EMPTY_SPACE_SKIPPING";
+	if(mInputIsModified || buildOptions != mBuildOptions)
 	{
-		// Compile program
-		char buffer[128];
-		sprintf(buffer, "-cl-fast-relaxed-math -D VOL%d -D numberOfVolumes=%d", numberOfVolumes, numberOfVolumes);
-		for(unsigned int i=0; i<numberOfVolumes;i++)
-		{
-			char dataTypeBuffer[128];
-			unsigned int volumeDataType = inputs[i]->getDataType();
-			
-			if (volumeDataType==fast::TYPE_FLOAT)
-				sprintf(dataTypeBuffer, " -D TYPE_FLOAT%d ", i+1);
-			else
-			{
-				if ((volumeDataType == fast::TYPE_UINT8) || (volumeDataType == fast::TYPE_UINT16))
-					sprintf(dataTypeBuffer, " -D TYPE_UINT%d ", i+1);
-				else
-					sprintf(dataTypeBuffer, " -D TYPE_INT%d ", i+1);
-			}
-			strcat(buffer, dataTypeBuffer);
-
-			boxMaxs[i * 3 + 0] = inputs[i]->getWidth();
-			boxMaxs[i * 3 + 1] = inputs[i]->getHeight();
-			boxMaxs[i * 3 + 2] = inputs[i]->getDepth();
-
-		}
-
-        std::string str(buffer);
-		int programNr;
-		if (includeGeometry)
-			programNr = mDevice->createProgramFromSource(Config::getKernelSourcePath() + "/Visualization/VolumeRenderer/VolumeRendererWithGeo.cl", str);
-		else
-			programNr = mDevice->createProgramFromSource(Config::getKernelSourcePath() + "/Visualization/VolumeRenderer/VolumeRendererNoGeo.cl", str);
+		int programNr = mDevice->createProgramFromSource(Config::getKernelSourcePath() + "/Visualization/VolumeRenderer/VolumeRenderer.cl", buildOptions);
         program = mDevice->getProgram(programNr);
 		renderKernel = cl::Kernel(program, "d_render");
 
-		
+		for(unsigned int i=0; i<numberOfVolumes;i++) {
+			int gridProgramNr = mDevice->createProgramFromSource(
+					Config::getKernelSourcePath() + "/Visualization/VolumeRenderer/VolumeRendererGrid.cl",
+					"-D VOLUME_TYPE=" + std::to_string(getVolumeType(inputs[i]->getDataType())));
+			mGridPrograms[i] = mDevice->getProgram(gridProgramNr);
+		}
 
+		mBuildOptions = buildOptions;
 		mInputIsModified = false;
 	}
 
-	if(!pbo)
-	{
-		// create pixel buffer object for display
-
-		fun->glGenBuffers(1, &pbo);
-		fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo);
-		fun->glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, mHeight * mWidth * sizeof(GLubyte) * 4, 0, GL_STREAM_DRAW_ARB);
-		fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-			
-		// Create CL-GL image
-		pbo_cl = cl::BufferGL(clContext, CL_MEM_WRITE_ONLY, pbo);
-
-		// delete old buffer
-		//glDeleteBuffersARB(1, &pbo);
+	if(mEmptySpaceSkipping) {
+		for(unsigned int i = 0; i < numberOfVolumes; i++)
+			updateOccupancyGrid(i);
 	}
-		
-		
-	if (includeGeometry)
-	{
-		OpenCLImageAccess::pointer access = inputs[0]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-		cl::Image3D* clImage = access->get3DImage();
 
-		renderKernel.setArg(0, pbo_cl);
-		renderKernel.setArg(1, mWidth);
-		renderKernel.setArg(2, mHeight);
-        renderKernel.setArg(3, density);
-        renderKernel.setArg(4, brightness);
-        renderKernel.setArg(5, zNear);
-        renderKernel.setArg(6, zFar);
-		renderKernel.setArg(7, topOfViewPlane);
-        renderKernel.setArg(8, rightOfViewPlane);
-		renderKernel.setArg(9, projectionMatrix10);
-		renderKernel.setArg(10, projectionMatrix14);
-		renderKernel.setArg(11, d_invViewMatrices);
-		renderKernel.setArg(12, *clImage);
-		renderKernel.setArg(13, d_transferFuncArray[0]);
-		renderKernel.setArg(14, d_opacityFuncArray[0]);
-		renderKernel.setArg(15, mImageGLGeoColor);
-		renderKernel.setArg(16, mImageGLGeoDepth);
-		renderKernel.setArg(17, d_boxMaxs);
-		renderKernel.setArg(18, d_opacityFuncDefs);
-		renderKernel.setArg(19, d_opacityFuncMins);
-		renderKernel.setArg(20, d_colorFuncDefs);
-		renderKernel.setArg(21, d_colorFuncMins);
-		if (numberOfVolumes>1)
+	// When interacting, render a low resolution image first and the full resolution image on the next update
+	int resolutionDivisor = 1;
+	if(mProgressiveRendering && mInteracting) {
+		resolutionDivisor = mProgressiveResolutionDivisor;
+		mIsModified = true;
+	}
+	mInteracting = false;
+
+	QOpenGLFunctions_3_3_Compatibility *fun = NULL;
+	if(mOffscreen) {
+		if(mWidth != mOutputBufferWidth || mHeight != mOutputBufferHeight) {
+			mOutputBuffer = cl::Buffer(clContext, CL_MEM_READ_WRITE, mWidth*mHeight*sizeof(cl_uint));
+			mOutputBufferWidth = mWidth;
+			mOutputBufferHeight = mHeight;
+		}
+	} else {
+		glEnable(GL_NORMALIZE);
+		glEnable(GL_DEPTH_TEST);
+		fun = new QOpenGLFunctions_3_3_Compatibility;
+		fun->initializeOpenGLFunctions();
+		if(!pbo)
 		{
-			OpenCLImageAccess::pointer access2 = inputs[1]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-			cl::Image3D* clImage2 = access2->get3DImage();
-			renderKernel.setArg(18, *clImage2);
-			renderKernel.setArg(19, d_transferFuncArray[1]);
-			renderKernel.setArg(20, d_opacityFuncArray[1]);
-
-			if (numberOfVolumes>2)
-			{
-				OpenCLImageAccess::pointer access3 = inputs[2]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-				cl::Image3D* clImage3 = access3->get3DImage();
-				renderKernel.setArg(21, *clImage3);
-				renderKernel.setArg(22, d_transferFuncArray[2]);
-				renderKernel.setArg(23, d_opacityFuncArray[2]);
-				
-				if (numberOfVolumes>3)
-				{
-					OpenCLImageAccess::pointer access4 = inputs[3]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-					cl::Image3D* clImage4 = access4->get3DImage();
-					renderKernel.setArg(24, *clImage4);
-					renderKernel.setArg(25, d_transferFuncArray[3]);
-					renderKernel.setArg(26, d_opacityFuncArray[3]);
-
-					if (numberOfVolumes>4)
-					{	
-						OpenCLImageAccess::pointer access5 = inputs[4]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-						cl::Image3D* clImage5 = access5->get3DImage();
-						renderKernel.setArg(27, *clImage5);
-						renderKernel.setArg(28, d_transferFuncArray[4]);
-						renderKernel.setArg(29, d_opacityFuncArray[4]);
-					}
-				}
-
-			}
-
+			// create pixel buffer object for display
+			fun->glGenBuffers(1, &pbo);
+			fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo);
+			fun->glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, mHeight * mWidth * sizeof(GLubyte) * 4, 0, GL_STREAM_DRAW_ARB);
+			fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+
+			// Create CL-GL image
+			pbo_cl = cl::BufferGL(clContext, CL_MEM_WRITE_ONLY, pbo);
 		}
-		
-
 	}
-	else //NO Geometry
-	{
-		OpenCLImageAccess::pointer access = inputs[0]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-		cl::Image3D* clImage = access->get3DImage();
 
+	if(mOffscreen) {
+		renderKernel.setArg(0, mOutputBuffer);
+	} else {
 		renderKernel.setArg(0, pbo_cl);
-		renderKernel.setArg(1, mWidth);
-		renderKernel.setArg(2, mHeight);
-        renderKernel.setArg(3, density);
-        renderKernel.setArg(4, brightness);
-        renderKernel.setArg(5, zNear);
-        renderKernel.setArg(6, zFar);
-		renderKernel.setArg(7, topOfViewPlane);
-        renderKernel.setArg(8, rightOfViewPlane);
-		renderKernel.setArg(9, projectionMatrix10);
-		renderKernel.setArg(10, projectionMatrix14);
-		renderKernel.setArg(11, d_invViewMatrices);
-		renderKernel.setArg(12, *clImage);
-		renderKernel.setArg(13, d_transferFuncArray[0]);
-		renderKernel.setArg(14, d_opacityFuncArray[0]);
-		renderKernel.setArg(15, d_boxMaxs);
-		renderKernel.setArg(16, d_opacityFuncDefs);
-		renderKernel.setArg(17, d_opacityFuncMins);
-		renderKernel.setArg(18, d_colorFuncDefs);
-		renderKernel.setArg(19, d_colorFuncMins);
-		if (numberOfVolumes>1)
-		{
-			OpenCLImageAccess::pointer access2 = inputs[1]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-			cl::Image3D* clImage2 = access2->get3DImage();
-			renderKernel.setArg(16, *clImage2);
-			renderKernel.setArg(17, d_transferFuncArray[1]);
-			renderKernel.setArg(18, d_opacityFuncArray[1]);
-
-			if (numberOfVolumes>2)
-			{
-				OpenCLImageAccess::pointer access3 = inputs[2]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-				cl::Image3D* clImage3 = access3->get3DImage();
-				renderKernel.setArg(19, *clImage3);
-				renderKernel.setArg(20, d_transferFuncArray[2]);
-				renderKernel.setArg(21, d_opacityFuncArray[2]);
-				
-				if (numberOfVolumes>3)
-				{
-					OpenCLImageAccess::pointer access4 = inputs[3]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-					cl::Image3D* clImage4 = access4->get3DImage();
-					renderKernel.setArg(22, *clImage4);
-					renderKernel.setArg(23, d_transferFuncArray[3]);
-					renderKernel.setArg(24, d_opacityFuncArray[3]);
-
-					if (numberOfVolumes>4)
-					{	
-						OpenCLImageAccess::pointer access5 = inputs[4]->getOpenCLImageAccess(ACCESS_READ, mDevice);
-						cl::Image3D* clImage5 = access5->get3DImage();
-						renderKernel.setArg(25, *clImage5);
-						renderKernel.setArg(26, d_transferFuncArray[4]);
-						renderKernel.setArg(27, d_opacityFuncArray[4]);
-					}
-				}
-
-			}
-
-		}
 	}
-	std::vector<cl::Memory> v;
-	v.push_back(pbo_cl);
+	renderKernel.setArg(1, mWidth);
+	renderKernel.setArg(2, mHeight);
+	renderKernel.setArg(3, density);
+	renderKernel.setArg(4, brightness);
+	renderKernel.setArg(5, zNear);
+	renderKernel.setArg(6, zFar);
+	renderKernel.setArg(7, topOfViewPlane);
+	renderKernel.setArg(8, rightOfViewPlane);
+	renderKernel.setArg(9, projectionMatrix10);
+	renderKernel.setArg(10, projectionMatrix14);
+	renderKernel.setArg(11, d_invViewMatrices);
+	renderKernel.setArg(12, d_boxMaxs);
+	renderKernel.setArg(13, d_opacityFuncDefs);
+	renderKernel.setArg(14, d_opacityFuncMins);
+	renderKernel.setArg(15, d_colorFuncDefs);
+	renderKernel.setArg(16, d_colorFuncMins);
+	renderKernel.setArg(17, d_gridSizes);
+	renderKernel.setArg(18, resolutionDivisor);
+	renderKernel.setArg(19, mEarlyRayTerminationThreshold);
+	int argument = 20;
 	if (includeGeometry)
 	{
-		v.push_back(mImageGLGeoColor);
-		v.push_back(mImageGLGeoDepth);
+		renderKernel.setArg(argument++, mImageGLGeoColor);
+		renderKernel.setArg(argument++, mImageGLGeoDepth);
+	}
+	// The accesses must be kept until the kernel has finished
+	std::vector<OpenCLImageAccess::pointer> accesses;
+	for(unsigned int i = 0; i < numberOfVolumes; i++)
+	{
+		accesses.push_back(inputs[i]->getOpenCLImageAccess(ACCESS_READ, mDevice));
+		renderKernel.setArg(argument++, *accesses.back()->get3DImage());
+		renderKernel.setArg(argument++, d_transferFuncArray[i]);
+		renderKernel.setArg(argument++, d_opacityFuncArray[i]);
+		renderKernel.setArg(argument++, mEmptySpaceSkipping ? d_occupancyGrids[i] : d_noOccupancyGrid);
 	}
-	mDevice->getCommandQueue().enqueueAcquireGLObjects(&v);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_invViewMatrices, CL_FALSE, 0, sizeof(invViewMatrices), invViewMatrices);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_boxMaxs, CL_FALSE, 0, sizeof(boxMaxs), boxMaxs);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_opacityFuncDefs, CL_FALSE, 0, sizeof(opacityFuncDefs), opacityFuncDefs);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_opacityFuncMins, CL_FALSE, 0, sizeof(opacityFuncMins), opacityFuncMins);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_colorFuncDefs, CL_FALSE, 0, sizeof(colorFuncDefs), colorFuncDefs);
-	mDevice->getCommandQueue().enqueueWriteBuffer(d_colorFuncMins, CL_FALSE, 0, sizeof(colorFuncMins), colorFuncMins);
-
-    mDevice->getCommandQueue().enqueueNDRangeKernel(
+
+	cl::CommandQueue queue = mDevice->getCommandQueue();
+	std::vector<cl::Memory> v;
+	if(!mOffscreen) {
+		v.push_back(pbo_cl);
+		if (includeGeometry)
+		{
+			v.push_back(mImageGLGeoColor);
+			v.push_back(mImageGLGeoDepth);
+		}
+		queue.enqueueAcquireGLObjects(&v);
+	}
+	queue.enqueueWriteBuffer(d_invViewMatrices, CL_FALSE, 0, sizeof(invViewMatrices), invViewMatrices);
+	queue.enqueueWriteBuffer(d_boxMaxs, CL_FALSE, 0, sizeof(boxMaxs), boxMaxs);
+	queue.enqueueWriteBuffer(d_gridSizes, CL_FALSE, 0, sizeof(gridSizes), gridSizes);
+	queue.enqueueWriteBuffer(d_opacityFuncDefs, CL_FALSE, 0, sizeof(opacityFuncDefs), opacityFuncDefs);
+	queue.enqueueWriteBuffer(d_opacityFuncMins, CL_FALSE, 0, sizeof(opacityFuncMins), opacityFuncMins);
+	queue.enqueueWriteBuffer(d_colorFuncDefs, CL_FALSE, 0, sizeof(colorFuncDefs), colorFuncDefs);
+	queue.enqueueWriteBuffer(d_colorFuncMins, CL_FALSE, 0, sizeof(colorFuncMins), colorFuncMins);
+
+    queue.enqueueNDRangeKernel(
             renderKernel,
             cl::NullRange,
-            cl::NDRange(mWidth, mHeight),
+            cl::NDRange(
+					(mWidth + resolutionDivisor - 1) / resolutionDivisor,
+					(mHeight + resolutionDivisor - 1) / resolutionDivisor
+			),
             cl::NullRange
     );
-		
-	mDevice->getCommandQueue().enqueueReleaseGLObjects(&v);
-	mDevice->getCommandQueue().finish();
-    
+
+	if(!mOffscreen)
+		queue.enqueueReleaseGLObjects(&v);
+	queue.finish();
+	delete fun;
+
 	mOutputIsCreated=true;
+}
 
+Image::pointer VolumeRenderer::getRenderedImage() {
+	std::lock_guard<std::mutex> lock(mOutputMutex);
+	if(!mOffscreen)
+		throw Exception("VolumeRenderer::getRenderedImage requires off-screen rendering");
+	if(!mOutputIsCreated)
+		throw Exception("The VolumeRenderer has not rendered anything yet");
 
+	std::vector<uchar> pixels(mOutputBufferWidth*mOutputBufferHeight*4);
+	mDevice->getCommandQueue().enqueueReadBuffer(mOutputBuffer, CL_TRUE, 0, pixels.size(), pixels.data());
+	Image::pointer image = Image::New();
+	image->create(mOutputBufferWidth, mOutputBufferHeight, TYPE_UINT8, 4, pixels.data());
+	return image;
 }
 
 void VolumeRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D) {
-	
-	std::lock_guard<std::mutex> lock(mMutex);
+	if(mOffscreen)
+		return;
 
+	if(mRenderIsPending) {
+		render();
+		mRenderIsPending = false;
+	}
 	if(!mOutputIsCreated)
         return;
-	
+
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 	glMatrixMode(GL_PROJECTION);
@@ -640,143 +581,15 @@ void VolumeRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bo
     fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo);
 	glDrawPixels(mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, 0);
     fun->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-	
+
 }
 
 
-void VolumeRenderer::mouseEvents() 
+void VolumeRenderer::mouseEvents()
 {
+	mInteracting = true;
 	mIsModified = true;
 }
-bool VolumeRenderer::gluInvertMatrix(const float m[16], float invOut[16])
-{
-    float inv[16], det;
-    int i;
-
-    inv[0] = m[5]  * m[10] * m[15] - 
-             m[5]  * m[11] * m[14] - 
-             m[9]  * m[6]  * m[15] + 
-             m[9]  * m[7]  * m[14] +
-             m[13] * m[6]  * m[11] - 
-             m[13] * m[7]  * m[10];
-
-    inv[4] = -m[4]  * m[10] * m[15] + 
-              m[4]  * m[11] * m[14] + 
-              m[8]  * m[6]  * m[15] - 
-              m[8]  * m[7]  * m[14] - 
-              m[12] * m[6]  * m[11] + 
-              m[12] * m[7]  * m[10];
-
-    inv[8] = m[4]  * m[9] * m[15] - 
-             m[4]  * m[11] * m[13] - 
-             m[8]  * m[5] * m[15] + 
-             m[8]  * m[7] * m[13] + 
-             m[12] * m[5] * m[11] - 
-             m[12] * m[7] * m[9];
-
-    inv[12] = -m[4]  * m[9] * m[14] + 
-               m[4]  * m[10] * m[13] +
-               m[8]  * m[5] * m[14] - 
-               m[8]  * m[6] * m[13] - 
-               m[12] * m[5] * m[10] + 
-               m[12] * m[6] * m[9];
-
-    inv[1] = -m[1]  * m[10] * m[15] + 
-              m[1]  * m[11] * m[14] + 
-              m[9]  * m[2] * m[15] - 
-              m[9]  * m[3] * m[14] - 
-              m[13] * m[2] * m[11] + 
-              m[13] * m[3] * m[10];
-
-    inv[5] = m[0]  * m[10] * m[15] - 
-             m[0]  * m[11] * m[14] - 
-             m[8]  * m[2] * m[15] + 
-             m[8]  * m[3] * m[14] + 
-             m[12] * m[2] * m[11] - 
-             m[12] * m[3] * m[10];
-
-    inv[9] = -m[0]  * m[9] * m[15] + 
-              m[0]  * m[11] * m[13] + 
-              m[8]  * m[1] * m[15] - 
-              m[8]  * m[3] * m[13] - 
-              m[12] * m[1] * m[11] + 
-              m[12] * m[3] * m[9];
-
-    inv[13] = m[0]  * m[9] * m[14] - 
-              m[0]  * m[10] * m[13] - 
-              m[8]  * m[1] * m[14] + 
-              m[8]  * m[2] * m[13] + 
-              m[12] * m[1] * m[10] - 
-              m[12] * m[2] * m[9];
-
-    inv[2] = m[1]  * m[6] * m[15] - 
-             m[1]  * m[7] * m[14] - 
-             m[5]  * m[2] * m[15] + 
-             m[5]  * m[3] * m[14] + 
-             m[13] * m[2] * m[7] - 
-             m[13] * m[3] * m[6];
-
-    inv[6] = -m[0]  * m[6] * m[15] + 
-              m[0]  * m[7] * m[14] + 
-              m[4]  * m[2] * m[15] - 
-              m[4]  * m[3] * m[14] - 
-              m[12] * m[2] * m[7] + 
-              m[12] * m[3] * m[6];
-
-    inv[10] = m[0]  * m[5] * m[15] - 
-              m[0]  * m[7] * m[13] - 
-              m[4]  * m[1] * m[15] + 
-              m[4]  * m[3] * m[13] + 
-              m[12] * m[1] * m[7] - 
-              m[12] * m[3] * m[5];
-
-    inv[14] = -m[0]  * m[5] * m[14] + 
-               m[0]  * m[6] * m[13] + 
-               m[4]  * m[1] * m[14] - 
-               m[4]  * m[2] * m[13] - 
-               m[12] * m[1] * m[6] + 
-               m[12] * m[2] * m[5];
-
-    inv[3] = -m[1] * m[6] * m[11] + 
-              m[1] * m[7] * m[10] + 
-              m[5] * m[2] * m[11] - 
-              m[5] * m[3] * m[10] - 
-              m[9] * m[2] * m[7] + 
-              m[9] * m[3] * m[6];
-
-    inv[7] = m[0] * m[6] * m[11] - 
-             m[0] * m[7] * m[10] - 
-             m[4] * m[2] * m[11] + 
-             m[4] * m[3] * m[10] + 
-             m[8] * m[2] * m[7] - 
-             m[8] * m[3] * m[6];
-
-    inv[11] = -m[0] * m[5] * m[11] + 
-               m[0] * m[7] * m[9] + 
-               m[4] * m[1] * m[11] - 
-               m[4] * m[3] * m[9] - 
-               m[8] * m[1] * m[7] + 
-               m[8] * m[3] * m[5];
-
-    inv[15] = m[0] * m[5] * m[10] - 
-              m[0] * m[6] * m[9] - 
-              m[4] * m[1] * m[10] + 
-              m[4] * m[2] * m[9] + 
-              m[8] * m[1] * m[6] - 
-              m[8] * m[2] * m[5];
-
-    det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
-
-    if (det == 0)
-        return false;
-
-    det = 1.0 / det;
-
-    for (i = 0; i < 16; i++)
-        invOut[i] = inv[i] * det;
-
-    return true;
-}
 
 
 } // namespace fast
@@ -10,10 +10,21 @@
 
 namespace fast {
 
+/**
+ * Ray casting of up to 5 volumes with separate transfer functions.
+ *
+ * Each volume has a grid with the min and max intensity of each macro cell, which is created only when the volume
+ * changes. A cell is empty if the opacity transfer function is zero in its whole range, and rays skip cells
+ * which are empty in all volumes. Rays are composited from front to back and stop when they are almost opaque.
+ *
+ * While the camera is moved, a lower resolution image can be rendered first, and the full resolution image
+ * on the next update.
+ */
 class FAST_EXPORT  VolumeRenderer : public Renderer {
     FAST_OBJECT(VolumeRenderer)
     public:
         uint addInputConnection(DataPort::pointer port) override;
+        uint addInputData(DataObject::pointer data) override;
 		void setColorTransferFunction(int volumeIndex, ColorTransferFunction::pointer ctf);
 		void setOpacityTransferFunction(int volumeIndex, OpacityTransferFunction::pointer otf);
 		void setModelViewMatrix(GLfloat mView[16]);
@@ -27,18 +38,50 @@ class FAST_EXPORT  VolumeRenderer : public Renderer {
 		void setIncludeGeometry(bool p);
 		void addGeometryColorTexture(GLuint geoColorTex);
 		void addGeometryDepthTexture(GLuint geoDepthTex);
-        
+
 		void resize(GLuint, GLuint);
 		void setProjectionParameters(float fov, float aspect, float nearPlane, float farPlane);
 		void setUserTransform(int volumeIndex, const float userTransform[16]);
 
 		void turnOffTransformations();
+		/**
+		 * Skip macro cells which are transparent in all volumes. Enabled by default.
+		 * @param skip
+		 */
+		void setEmptySpaceSkipping(bool skip);
+		/**
+		 * Stop a ray when its accumulated opacity reaches this threshold. Default is 0.99, a value above 1
+		 * disables early ray termination.
+		 * @param threshold
+		 */
+		void setEarlyRayTerminationThreshold(float threshold);
+		/**
+		 * Render an image with a lower resolution when the camera or a user transform has changed, and the full
+		 * resolution image on the next update. Disabled by default.
+		 * @param progressive
+		 * @param resolutionDivisor each ray of the low resolution image covers resolutionDivisor x resolutionDivisor pixels
+		 */
+		void setProgressiveRendering(bool progressive, int resolutionDivisor = 4);
+		/**
+		 * Render to an OpenCL buffer instead of an OpenGL pixel buffer, so that no OpenGL context is needed.
+		 * The result can be retrieved with getRenderedImage.
+		 * @param offscreen
+		 */
+		void setOffscreenRendering(bool offscreen);
+		/**
+		 * @return the last rendered image as a 2D RGBA image of type TYPE_UINT8, requires off-screen rendering
+		 */
+		Image::pointer getRenderedImage();
 
     private:
         VolumeRenderer();
         void execute();
+        void preDraw() override;
         void draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, bool mode2D);
-		
+		// Ray casting of the current inputs, to the pixel buffer or the off-screen output buffer
+		void render();
+		void updateOccupancyGrid(int volumeIndex);
+
 
 		GLuint mHeight;
 		GLuint mWidth;
@@ -53,32 +96,49 @@ class FAST_EXPORT  VolumeRenderer : public Renderer {
 		cl::Image2DGL mImageGLGeoColor;
 		cl::Image2DGL mImageGLGeoDepth;
 #endif
-		
+
         OpenCLDevice::pointer mDevice;
-        
+
 		bool includeGeometry;
 
         bool mOutputIsCreated;
 		bool mDoTransformations;
-        //unsigned int windowWidth, windowHeight;
+		bool mEmptySpaceSkipping;
+		float mEarlyRayTerminationThreshold;
+		bool mProgressiveRendering;
+		int mProgressiveResolutionDivisor;
+		bool mInteracting;
+		bool mOffscreen;
 
 
         cl::Program program;
+		std::string mBuildOptions;
+		cl::Program mGridPrograms[maxNumberOfVolumes];
 		cl::Context clContext;
 
-       // unsigned int mWidth, mHeight;
-
 
 		GLuint pbo;
 		cl::BufferGL pbo_cl;
+		cl::Buffer mOutputBuffer;
+		GLuint mOutputBufferWidth;
+		GLuint mOutputBufferHeight;
 
 		cl::Image2D d_transferFuncArray[maxNumberOfVolumes];
 		cl::Image2D d_opacityFuncArray[maxNumberOfVolumes];
+		// Nr of non-zero entries of the opacity transfer function before each entry
+		cl::Buffer d_opacityFuncPrefix[maxNumberOfVolumes];
 
 		cl::Buffer d_invViewMatrices;
 		cl::Buffer d_boxMaxs;
-		
-		
+		cl::Buffer d_gridSizes;
+
+		// Min and max of each macro cell, and which are occupied with the current opacity transfer function
+		cl::Buffer d_minMaxGrids[maxNumberOfVolumes];
+		cl::Buffer d_occupancyGrids[maxNumberOfVolumes];
+		cl::Buffer d_noOccupancyGrid;
+		Image::pointer mGridImages[maxNumberOfVolumes];
+		unsigned long mGridTimestamps[maxNumberOfVolumes];
+		bool mOccupancyIsModified[maxNumberOfVolumes];
 
 		cl::Kernel renderKernel;
 
@@ -86,40 +146,25 @@ class FAST_EXPORT  VolumeRenderer : public Renderer {
 
 		int ox, oy;
 
-		//GLfloat viewRotation[3];
-		//GLfloat viewTranslation[3];
-		//GLfloat viewRotationPoint[3];
-		bool gluInvertMatrix(const float m[16], float invOut[16]);
-
 		unsigned int numberOfVolumes;
-		
-		
-		//Image::pointer 
-		Image::pointer mI;
-		std::vector<Image::pointer> mInputs;
+
+		// Latest volumes from execute, taken by the rendering thread in preDraw
+		TripleBuffer<std::vector<Image::pointer>> mVolumeBuffer;
+		// Volumes which are rendered, only used in the rendering thread unless rendering off-screen
 		std::vector<Image::pointer> inputs;
-		
-		GLfloat modelView[16];
+		bool mRenderIsPending;
+		// Guards the off-screen output buffer, which is rendered in execute and read by getRenderedImage
+		std::mutex mOutputMutex;
 
-		float* transferFunc;
-		float* opacityFunc;
+		GLfloat modelView[16];
 
 		bool doUserTransforms[maxNumberOfVolumes];
 		float mUserTransforms[maxNumberOfVolumes * 16];
-		float mUserTransform0[16];
-		float mUserTransform1[16];
-		float mUserTransform2[16];
-		float mUserTransform3[16];
-		float mUserTransform4[16];
-
-		float invViewMatrix0[16];
-		float invViewMatrix1[16];
-		float invViewMatrix2[16];
-		float invViewMatrix3[16];
-		float invViewMatrix4[16];
+
 		float invViewMatrices[maxNumberOfVolumes * 16];
-		
+
 		float boxMaxs[maxNumberOfVolumes * 3];
+		int gridSizes[maxNumberOfVolumes * 4];
 
 		float opacityFuncDefs[maxNumberOfVolumes];
 		float opacityFuncMins[maxNumberOfVolumes];
@@ -0,0 +1,49 @@
+const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+#define READ_VOXEL(volume, pos) (VOLUME_TYPE == 0 ? read_imagef(volume, sampler, pos).x : \
+		VOLUME_TYPE == 1 ? (float)read_imageui(volume, sampler, pos).x : (float)read_imagei(volume, sampler, pos).x)
+
+/*
+ * Find the min and max of each macro cell of the volume. The cell is extended by one voxel in each direction, since
+ * the ray caster interpolates linearly between the voxels of neighbouring cells.
+ */
+__kernel void createMinMaxGrid(
+		__read_only image3d_t volume,
+		__global float2* grid,
+		int cellSize
+		) {
+	const int4 cell = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0);
+	const int4 start = max(cell*cellSize - 1, (int4)(0, 0, 0, 0));
+	const int4 end = min(cell*cellSize + cellSize + 1, get_image_dim(volume));
+
+	float minimum = FLT_MAX;
+	float maximum = -FLT_MAX;
+	for(int z = start.z; z < end.z; ++z) {
+	for(int y = start.y; y < end.y; ++y) {
+	for(int x = start.x; x < end.x; ++x) {
+		const float value = READ_VOXEL(volume, (int4)(x, y, z, 0));
+		minimum = min(minimum, value);
+		maximum = max(maximum, value);
+	}}}
+
+	grid[cell.x + (cell.y + cell.z*get_global_size(1))*get_global_size(0)] = (float2)(minimum, maximum);
+}
+
+/*
+ * A macro cell is occupied if any entry of the opacity transfer function in the min-max range of the cell is not
+ * zero. opacityPrefix[i] is the nr of non-zero entries before entry i, so the range can be checked in constant time.
+ * The range is extended by one entry in each direction, since the transfer function is interpolated linearly.
+ */
+__kernel void createOccupancyGrid(
+		__global const float2* grid,
+		__global uchar* occupancy,
+		__global const uint* opacityPrefix,
+		int entries,
+		float opacityFuncMin
+		) {
+	const int i = get_global_id(0);
+	const float2 range = grid[i];
+	const int first = clamp((int)floor(range.x - opacityFuncMin) - 1, 0, entries);
+	const int last = clamp((int)ceil(range.y - opacityFuncMin) + 2, 0, entries);
+	occupancy[i] = opacityPrefix[last] > opacityPrefix[first] ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Data/Image.hpp"
+#include "VolumeRenderer.hpp"
+
+using namespace fast;
+
+// Volume with a bright ball in the center
+static Image::pointer createBallVolume(uint size) {
+    std::vector<uchar> data(size*size*size, 0);
+    const float radius = size*0.45f;
+    for(uint z = 0; z < size; ++z) {
+    for(uint y = 0; y < size; ++y) {
+    for(uint x = 0; x < size; ++x) {
+        Vector3f position(x - size*0.5f, y - size*0.5f, z - size*0.5f);
+        if(position.norm() < radius)
+            data[x + (y + z*size)*size] = 200;
+    }}}
+    Image::pointer image = Image::New();
+    image->create(size, size, size, TYPE_UINT8, 1, data.data());
+    return image;
+}
+
+static VolumeRenderer::pointer createRenderer(Image::pointer volume) {
+    ColorTransferFunction::pointer colorFunction = ColorTransferFunction::New();
+    colorFunction->addRGBPoint(0, 1, 0, 0);
+    colorFunction->addRGBPoint(255, 1, 1, 1);
+    OpacityTransferFunction::pointer opacityFunction = OpacityTransferFunction::New();
+    opacityFunction->addAlphaPoint(0, 0);
+    opacityFunction->addAlphaPoint(100, 0);
+    opacityFunction->addAlphaPoint(150, 1);
+    opacityFunction->addAlphaPoint(255, 1);
+
+    VolumeRenderer::pointer renderer = VolumeRenderer::New();
+    renderer->addInputData(volume);
+    renderer->setColorTransferFunction(0, colorFunction);
+    renderer->setOpacityTransferFunction(0, opacityFunction);
+    renderer->setOffscreenRendering(true);
+    renderer->resize(128, 128);
+    renderer->setProjectionParameters(45, 1, 0.1, 1000);
+    // Camera in front of the center of the volume
+    GLfloat modelView[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, -(volume->getWidth()*0.5f), -(volume->getHeight()*0.5f), -160, 1};
+    renderer->setModelViewMatrix(modelView);
+    return renderer;
+}
+
+static int getMaxDifference(Image::pointer a, Image::pointer b) {
+    REQUIRE(a->getSize() == b->getSize());
+    ImageAccess::pointer accessA = a->getImageAccess(ACCESS_READ);
+    ImageAccess::pointer accessB = b->getImageAccess(ACCESS_READ);
+    const uchar* dataA = (const uchar*)accessA->get();
+    const uchar* dataB = (const uchar*)accessB->get();
+    int maxDifference = 0;
+    for(uint i = 0; i < a->getWidth()*a->getHeight()*4; ++i)
+        maxDifference = std::max(maxDifference, std::abs((int)dataA[i] - (int)dataB[i]));
+    return maxDifference;
+}
+
+TEST_CASE("VolumeRenderer gives the same image with and without empty space skipping and early ray termination", "[fast][VolumeRenderer]") {
+    Image::pointer volume = createBallVolume(64);
+
+    VolumeRenderer::pointer reference = createRenderer(volume);
+    reference->setEmptySpaceSkipping(false);
+    reference->setEarlyRayTerminationThreshold(2.0f);
+    reference->update(0);
+    Image::pointer referenceImage = reference->getRenderedImage();
+
+    VolumeRenderer::pointer renderer = createRenderer(volume);
+    renderer->update(0);
+    Image::pointer image = renderer->getRenderedImage();
+
+    CHECK(image->getWidth() == 128);
+    CHECK(image->getHeight() == 128);
+    // The ball must be visible in the center, and the corners must be background
+    ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector2i(64, 64), 0) > 100);
+    CHECK(access->getScalar(Vector2i(0, 0), 0) == 0);
+    access->release();
+    // Early ray termination leaves out at most 1 % of the color
+    CHECK(getMaxDifference(image, referenceImage) <= 3);
+}
+
+TEST_CASE("VolumeRenderer renders low resolution image while interacting and refines it on next update", "[fast][VolumeRenderer]") {
+    Image::pointer volume = createBallVolume(64);
+    VolumeRenderer::pointer renderer = createRenderer(volume);
+    renderer->update(0);
+    Image::pointer fullResolution = renderer->getRenderedImage();
+
+    renderer->setProgressiveRendering(true, 4);
+    renderer->mouseEvents();
+    renderer->update(0);
+    Image::pointer lowResolution = renderer->getRenderedImage();
+    {
+        // All pixels of each 4x4 block are equal
+        ImageAccess::pointer access = lowResolution->getImageAccess(ACCESS_READ);
+        const uint* pixels = (const uint*)access->get();
+        bool blocksAreEqual = true;
+        for(uint y = 0; y < 128; ++y) {
+            for(uint x = 0; x < 128; ++x) {
+                if(pixels[x + y*128] != pixels[(x/4)*4 + (y/4)*4*128])
+                    blocksAreEqual = false;
+            }
+        }
+        CHECK(blocksAreEqual);
+    }
+
+    renderer->update(0);
+    CHECK(getMaxDifference(renderer->getRenderedImage(), fullResolution) == 0);
+}
+
+TEST_CASE("VolumeRenderer rebuilds occupancy grid when opacity transfer function changes", "[fast][VolumeRenderer]") {
+    Image::pointer volume = createBallVolume(64);
+    VolumeRenderer::pointer renderer = createRenderer(volume);
+    renderer->update(0);
+
+    // Make the ball transparent
+    OpacityTransferFunction::pointer opacityFunction = OpacityTransferFunction::New();
+    opacityFunction->addAlphaPoint(0, 0);
+    opacityFunction->addAlphaPoint(210, 0);
+    opacityFunction->addAlphaPoint(255, 1);
+    renderer->setOpacityTransferFunction(0, opacityFunction);
+    renderer->update(0);
+
+    ImageAccess::pointer access = renderer->getRenderedImage()->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector2i(64, 64), 0) == 0);
+}